@@ -0,0 +1,730 @@
+#include "AnimationClip.h"
+
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "ParallelFor.h"
+#include "Scene.h"
+
+namespace Olex
+{
+    using namespace DirectX;
+
+    namespace
+    {
+        constexpr float UnormScale = 65535.f;
+        constexpr float QuaternionRange = 0.70710678f; // 1 / sqrt( 2 ), bound of the three smallest components
+        constexpr float QuaternionSteps = 32767.f; // 15 bits
+
+        float Dot( const XMFLOAT4& a, const XMFLOAT4& b ) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+        XMFLOAT4 Normalize( const XMFLOAT4& q )
+        {
+            const float length = std::sqrt( Dot( q, q ) );
+            const float invLength = length > 0.f ? 1.f / length : 0.f;
+            return { q.x * invLength, q.y * invLength, q.z * invLength, q.w * invLength };
+        }
+
+        // Normalized linear interpolation along the shorter arc, as the sampler does it.
+        XMFLOAT4 Nlerp( const XMFLOAT4& a, XMFLOAT4 b, float alpha )
+        {
+            if ( Dot( a, b ) < 0.f )
+                b = { -b.x, -b.y, -b.z, -b.w };
+            return Normalize( { a.x + ( b.x - a.x ) * alpha, a.y + ( b.y - a.y ) * alpha, a.z + ( b.z - a.z ) * alpha, a.w + ( b.w - a.w ) * alpha } );
+        }
+
+        XMFLOAT3 Lerp( const XMFLOAT3& a, const XMFLOAT3& b, float alpha )
+        {
+            return { a.x + ( b.x - a.x ) * alpha, a.y + ( b.y - a.y ) * alpha, a.z + ( b.z - a.z ) * alpha };
+        }
+
+        // Angle in radians between two rotations, from their relative rotation: acos of the dot alone loses everything below ~0.05 degrees in float.
+        float RotationAngle( const XMFLOAT4& a, const XMFLOAT4& b )
+        {
+            const float x = a.w * b.x - b.w * a.x - ( a.y * b.z - a.z * b.y );
+            const float y = a.w * b.y - b.w * a.y - ( a.z * b.x - a.x * b.z );
+            const float z = a.w * b.z - b.w * a.z - ( a.x * b.y - a.y * b.x );
+            return 2.f * std::atan2( std::sqrt( x * x + y * y + z * z ), std::fabs( Dot( a, b ) ) );
+        }
+
+        float MaxAbsDifference( const XMFLOAT3& a, const XMFLOAT3& b )
+        {
+            return std::max( { std::fabs( a.x - b.x ), std::fabs( a.y - b.y ), std::fabs( a.z - b.z ) } );
+        }
+
+        float MaxRelativeDifference( const XMFLOAT3& a, const XMFLOAT3& b )
+        {
+            auto relative = []( float value, float reference ) { return std::fabs( value - reference ) / std::max( std::fabs( reference ), 1e-6f ); };
+            return std::max( { relative( a.x, b.x ), relative( a.y, b.y ), relative( a.z, b.z ) } );
+        }
+
+        // Shared by the compressor and the sampler, so keys are chosen on exactly the values played back.
+        XMFLOAT3 DecodeKey( const uint16_t* encoded, const XMFLOAT3& offset, const XMFLOAT3& range )
+        {
+            constexpr float invScale = 1.f / UnormScale;
+            return { offset.x + encoded[0] * ( range.x * invScale ), offset.y + encoded[1] * ( range.y * invScale ), offset.z + encoded[2] * ( range.z * invScale ) };
+        }
+
+        // 16-bit quantization of a float3 channel over the range of the track.
+        struct RangeQuantizer
+        {
+            XMFLOAT3 m_offset = { 0.f, 0.f, 0.f };
+            XMFLOAT3 m_range = { 0.f, 0.f, 0.f };
+
+            void Fit( const XMFLOAT3* values, size_t count )
+            {
+                XMFLOAT3 minimum = values[0];
+                XMFLOAT3 maximum = values[0];
+                for ( size_t i = 1; i < count; ++i )
+                {
+                    minimum = { std::min( minimum.x, values[i].x ), std::min( minimum.y, values[i].y ), std::min( minimum.z, values[i].z ) };
+                    maximum = { std::max( maximum.x, values[i].x ), std::max( maximum.y, values[i].y ), std::max( maximum.z, values[i].z ) };
+                }
+                m_offset = minimum;
+                m_range = { maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z };
+            }
+
+            static uint16_t Quantize( float value, float offset, float range )
+            {
+                if ( range <= 0.f )
+                    return 0;
+                const float unorm = std::min( std::max( ( value - offset ) / range, 0.f ), 1.f );
+                return static_cast<uint16_t>( unorm * UnormScale + 0.5f );
+            }
+
+            void Encode( const XMFLOAT3& value, uint16_t* encoded ) const
+            {
+                encoded[0] = Quantize( value.x, m_offset.x, m_range.x );
+                encoded[1] = Quantize( value.y, m_offset.y, m_range.y );
+                encoded[2] = Quantize( value.z, m_offset.z, m_range.z );
+            }
+
+            XMFLOAT3 Decode( const uint16_t* encoded ) const { return DecodeKey( encoded, m_offset, m_range ); }
+        };
+
+        // Key of a translation or scale channel, from the float keys when the track has them.
+        XMFLOAT3 ReadKey( const uint16_t* encoded, const float* floats, uint32_t key, const XMFLOAT3& offset, const XMFLOAT3& range )
+        {
+            if ( floats )
+                return { floats[key * 3], floats[key * 3 + 1], floats[key * 3 + 2] };
+            return DecodeKey( encoded + key * 3, offset, range );
+        }
+
+        /**
+         * Greedy key reduction over frameCount frames: every segment is extended for as long as
+         * fits( start, end ) holds, i.e. interpolating its two end keys reproduces every frame in
+         * between. Returns the kept frames, a single one for a constant channel.
+         */
+        template <typename Fits, typename Constant>
+        std::vector<uint16_t> ReduceKeys( uint32_t frameCount, Fits fits, Constant isConstant )
+        {
+            std::vector<uint16_t> keys = { 0 };
+            if ( frameCount <= 1 || isConstant() )
+                return keys;
+
+            uint32_t start = 0;
+            while ( start + 1 < frameCount )
+            {
+                uint32_t end = start + 1;
+                while ( end + 1 < frameCount && fits( start, end + 1 ) )
+                    ++end;
+
+                keys.push_back( static_cast<uint16_t>( end ) );
+                start = end;
+            }
+            return keys;
+        }
+
+        // Compressed data of one track, concatenated into the clip once every track is done.
+        struct CompressedTrack
+        {
+            AnimationTrack m_track;
+            std::vector<uint16_t> m_translationFrames;
+            std::vector<uint16_t> m_rotationFrames;
+            std::vector<uint16_t> m_scaleFrames;
+            std::vector<uint16_t> m_translations;
+            std::vector<QuantizedQuaternion> m_rotations;
+            std::vector<uint16_t> m_scales;
+            std::vector<float> m_floatTranslations;
+            std::vector<float> m_floatScales;
+        };
+
+        CompressedTrack CompressTrack( const BakedClip& baked, size_t trackIndex, const AnimationCompressionSettings& settings )
+        {
+            const uint32_t frameCount = baked.m_frameCount;
+            const TransformSample* samples = &baked.m_samples[trackIndex * frameCount];
+
+            CompressedTrack result;
+            result.m_track.m_node = baked.m_nodes[trackIndex];
+
+            std::vector<XMFLOAT3> translations( frameCount );
+            std::vector<XMFLOAT4> rotations( frameCount );
+            std::vector<XMFLOAT3> scales( frameCount );
+            for ( uint32_t frame = 0; frame < frameCount; ++frame )
+            {
+                translations[frame] = samples[frame].m_translation;
+                scales[frame] = samples[frame].m_scale;
+                // Keep consecutive rotations on the same hemisphere, so interpolation takes the short way.
+                rotations[frame] = Normalize( samples[frame].m_rotation );
+                if ( frame > 0 && Dot( rotations[frame], rotations[frame - 1] ) < 0.f )
+                    rotations[frame] = { -rotations[frame].x, -rotations[frame].y, -rotations[frame].z, -rotations[frame].w };
+            }
+
+            // Keys are chosen on the quantized values, so the tolerances cover quantization too.
+            RangeQuantizer translationQuantizer;
+            RangeQuantizer scaleQuantizer;
+            translationQuantizer.Fit( translations.data(), frameCount );
+            scaleQuantizer.Fit( scales.data(), frameCount );
+
+            std::vector<uint16_t> encodedTranslations( frameCount * 3 );
+            std::vector<uint16_t> encodedScales( frameCount * 3 );
+            std::vector<QuantizedQuaternion> encodedRotations( frameCount );
+            std::vector<XMFLOAT3> decodedTranslations( frameCount );
+            std::vector<XMFLOAT3> decodedScales( frameCount );
+            std::vector<XMFLOAT4> decodedRotations( frameCount );
+            for ( uint32_t frame = 0; frame < frameCount; ++frame )
+            {
+                translationQuantizer.Encode( translations[frame], &encodedTranslations[frame * 3] );
+                scaleQuantizer.Encode( scales[frame], &encodedScales[frame * 3] );
+                encodedRotations[frame] = QuantizeQuaternion( rotations[frame] );
+                decodedTranslations[frame] = translationQuantizer.Decode( &encodedTranslations[frame * 3] );
+                decodedScales[frame] = scaleQuantizer.Decode( &encodedScales[frame * 3] );
+                decodedRotations[frame] = DequantizeQuaternion( encodedRotations[frame] );
+            }
+
+            // Key reduction only checks the frames between two keys, so the keys themselves have to be
+            // within the tolerance already. Where 16 bits over the track's range are too coarse for
+            // that, the channel keeps float keys; rotations have a fixed precision and cannot.
+            float translationError = 0.f;
+            float scaleError = 0.f;
+            for ( uint32_t frame = 0; frame < frameCount; ++frame )
+            {
+                translationError = std::max( translationError, MaxAbsDifference( decodedTranslations[frame], translations[frame] ) );
+                scaleError = std::max( scaleError, MaxRelativeDifference( decodedScales[frame], scales[frame] ) );
+                if ( RotationAngle( decodedRotations[frame], rotations[frame] ) > settings.m_rotationTolerance )
+                {
+                    throw std::invalid_argument( "Rotation tolerance is finer than quantized rotation keys can hold" );
+                }
+            }
+            if ( translationError > settings.m_translationTolerance )
+            {
+                result.m_track.m_floatChannels |= AnimationTrack::FloatTranslations;
+                decodedTranslations = translations;
+            }
+            if ( scaleError > settings.m_scaleTolerance )
+            {
+                result.m_track.m_floatChannels |= AnimationTrack::FloatScales;
+                decodedScales = scales;
+            }
+
+            auto alpha = []( uint32_t start, uint32_t end, uint32_t frame ) { return float( frame - start ) / float( end - start ); };
+
+            result.m_translationFrames = ReduceKeys( frameCount,
+                [&]( uint32_t start, uint32_t end )
+                {
+                    for ( uint32_t frame = start + 1; frame < end; ++frame )
+                    {
+                        const XMFLOAT3 value = Lerp( decodedTranslations[start], decodedTranslations[end], alpha( start, end, frame ) );
+                        if ( MaxAbsDifference( value, translations[frame] ) > settings.m_translationTolerance )
+                            return false;
+                    }
+                    return true;
+                },
+                [&]()
+                {
+                    return std::all_of( translations.begin(), translations.end(),
+                        [&]( const XMFLOAT3& value ) { return MaxAbsDifference( decodedTranslations[0], value ) <= settings.m_translationTolerance; } );
+                } );
+
+            result.m_rotationFrames = ReduceKeys( frameCount,
+                [&]( uint32_t start, uint32_t end )
+                {
+                    for ( uint32_t frame = start + 1; frame < end; ++frame )
+                    {
+                        const XMFLOAT4 value = Nlerp( decodedRotations[start], decodedRotations[end], alpha( start, end, frame ) );
+                        if ( RotationAngle( value, rotations[frame] ) > settings.m_rotationTolerance )
+                            return false;
+                    }
+                    return true;
+                },
+                [&]()
+                {
+                    return std::all_of( rotations.begin(), rotations.end(),
+                        [&]( const XMFLOAT4& value ) { return RotationAngle( decodedRotations[0], value ) <= settings.m_rotationTolerance; } );
+                } );
+
+            result.m_scaleFrames = ReduceKeys( frameCount,
+                [&]( uint32_t start, uint32_t end )
+                {
+                    for ( uint32_t frame = start + 1; frame < end; ++frame )
+                    {
+                        const XMFLOAT3 value = Lerp( decodedScales[start], decodedScales[end], alpha( start, end, frame ) );
+                        if ( MaxRelativeDifference( value, scales[frame] ) > settings.m_scaleTolerance )
+                            return false;
+                    }
+                    return true;
+                },
+                [&]()
+                {
+                    return std::all_of( scales.begin(), scales.end(),
+                        [&]( const XMFLOAT3& value ) { return MaxRelativeDifference( decodedScales[0], value ) <= settings.m_scaleTolerance; } );
+                } );
+
+            for ( const uint16_t frame : result.m_translationFrames )
+            {
+                if ( result.m_track.m_floatChannels & AnimationTrack::FloatTranslations )
+                    result.m_floatTranslations.insert( result.m_floatTranslations.end(), { translations[frame].x, translations[frame].y, translations[frame].z } );
+                else
+                    result.m_translations.insert( result.m_translations.end(), &encodedTranslations[frame * 3], &encodedTranslations[frame * 3] + 3 );
+            }
+            for ( const uint16_t frame : result.m_rotationFrames )
+                result.m_rotations.push_back( encodedRotations[frame] );
+            for ( const uint16_t frame : result.m_scaleFrames )
+            {
+                if ( result.m_track.m_floatChannels & AnimationTrack::FloatScales )
+                    result.m_floatScales.insert( result.m_floatScales.end(), { scales[frame].x, scales[frame].y, scales[frame].z } );
+                else
+                    result.m_scales.insert( result.m_scales.end(), &encodedScales[frame * 3], &encodedScales[frame * 3] + 3 );
+            }
+
+            result.m_track.m_translationOffset = translationQuantizer.m_offset;
+            result.m_track.m_translationRange = translationQuantizer.m_range;
+            result.m_track.m_scaleOffset = scaleQuantizer.m_offset;
+            result.m_track.m_scaleRange = scaleQuantizer.m_range;
+            return result;
+        }
+
+        // Keys around frame, as offsets within the channel, and the blend between them.
+        struct KeySpan
+        {
+            uint32_t m_a;
+            uint32_t m_b;
+            float m_alpha;
+        };
+
+        /**
+         * cursor is the span found by the previous call for this channel. Playback moves forward a
+         * frame or so per call, so the span is usually the same or the next one and the binary
+         * search only runs after a seek.
+         */
+        KeySpan LocateKeys( const AnimationClip& clip, const AnimationChannel& channel, float frame, uint32_t& cursor )
+        {
+            const uint16_t* keys = clip.m_keyFrames.data() + channel.m_firstKey;
+            const uint32_t last = channel.m_keyCount - 1;
+            if ( last == 0 || frame >= keys[last] )
+                return { last, last, 0.f };
+
+            uint32_t a = std::min( cursor, last - 1 );
+            if ( frame < keys[a] || frame >= keys[a + 1] )
+            {
+                if ( a + 2 <= last && frame >= keys[a + 1] && frame < keys[a + 2] )
+                {
+                    ++a;
+                }
+                else
+                {
+                    // First key after frame; the span starts one before it.
+                    const uint16_t* next = std::upper_bound( keys + 1, keys + last, frame, []( float value, uint16_t key ) { return value < key; } );
+                    a = static_cast<uint32_t>( next - keys ) - 1;
+                }
+            }
+            cursor = a;
+
+            const float alpha = std::max( frame - keys[a], 0.f ) / float( keys[a + 1] - keys[a] );
+            return { a, a + 1, alpha };
+        }
+
+        // Channel-major scratch: component c of track t at base[c * stride + t].
+        void Scatter( float* base, size_t stride, size_t track, std::initializer_list<float> components )
+        {
+            size_t component = 0;
+            for ( const float value : components )
+                base[component++ * stride + track] = value;
+        }
+
+        // Encoded component of 0, which with a dropped index of 3 pads the scratch with identity rotations.
+        constexpr float IdentityComponent = QuaternionSteps * 0.5f;
+
+        __m128 Select4( __m128 mask, __m128 a, __m128 b ) { return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) ); }
+
+        // DequantizeQuaternion for four quaternions, from their components and dropped index as floats.
+        void DequantizeQuaternions4( __m128 c0, __m128 c1, __m128 c2, __m128 largest, __m128& x, __m128& y, __m128& z, __m128& w )
+        {
+            const __m128 scale = _mm_set1_ps( 2.f * QuaternionRange / QuaternionSteps );
+            const __m128 bias = _mm_set1_ps( -QuaternionRange );
+            c0 = _mm_add_ps( _mm_mul_ps( c0, scale ), bias );
+            c1 = _mm_add_ps( _mm_mul_ps( c1, scale ), bias );
+            c2 = _mm_add_ps( _mm_mul_ps( c2, scale ), bias );
+            const __m128 sumSquares = _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, c0 ), _mm_mul_ps( c1, c1 ) ), _mm_mul_ps( c2, c2 ) );
+            const __m128 dropped = _mm_sqrt_ps( _mm_max_ps( _mm_sub_ps( _mm_set1_ps( 1.f ), sumSquares ), _mm_setzero_ps() ) );
+
+            // Components before the dropped one keep their slot, the ones after it move up by one.
+            const __m128 is0 = _mm_cmpeq_ps( largest, _mm_setzero_ps() );
+            const __m128 is1 = _mm_cmpeq_ps( largest, _mm_set1_ps( 1.f ) );
+            const __m128 is2 = _mm_cmpeq_ps( largest, _mm_set1_ps( 2.f ) );
+            const __m128 is3 = _mm_cmpeq_ps( largest, _mm_set1_ps( 3.f ) );
+            x = Select4( is0, dropped, c0 );
+            y = Select4( is1, dropped, Select4( is0, c0, c1 ) );
+            z = Select4( is2, dropped, Select4( _mm_or_ps( is0, is1 ), c1, c2 ) );
+            w = Select4( is3, dropped, c2 );
+        }
+
+        __m128 Lerp4( __m128 a, __m128 b, __m128 alpha ) { return _mm_add_ps( a, _mm_mul_ps( _mm_sub_ps( b, a ), alpha ) ); }
+    }
+
+    TransformSample DecomposeTransform( const XMFLOAT4X4& matrix )
+    {
+        const XMFLOAT4X4& m = matrix;
+        TransformSample sample;
+        sample.m_translation = { m.m[3][0], m.m[3][1], m.m[3][2] };
+
+        float sx = std::sqrt( m.m[0][0] * m.m[0][0] + m.m[0][1] * m.m[0][1] + m.m[0][2] * m.m[0][2] );
+        const float sy = std::sqrt( m.m[1][0] * m.m[1][0] + m.m[1][1] * m.m[1][1] + m.m[1][2] * m.m[1][2] );
+        const float sz = std::sqrt( m.m[2][0] * m.m[2][0] + m.m[2][1] * m.m[2][1] + m.m[2][2] * m.m[2][2] );
+
+        const float determinant =
+            m.m[0][0] * ( m.m[1][1] * m.m[2][2] - m.m[1][2] * m.m[2][1] ) -
+            m.m[0][1] * ( m.m[1][0] * m.m[2][2] - m.m[1][2] * m.m[2][0] ) +
+            m.m[0][2] * ( m.m[1][0] * m.m[2][1] - m.m[1][1] * m.m[2][0] );
+        if ( determinant < 0.f )
+            sx = -sx;
+        sample.m_scale = { sx, sy, sz };
+
+        float r[3][3];
+        const float invScale[3] = { sx != 0.f ? 1.f / sx : 0.f, sy != 0.f ? 1.f / sy : 0.f, sz != 0.f ? 1.f / sz : 0.f };
+        for ( int row = 0; row < 3; ++row )
+        {
+            for ( int column = 0; column < 3; ++column )
+                r[row][column] = m.m[row][column] * invScale[row];
+        }
+
+        // Row-vector rotation matrix to quaternion, branching on the largest diagonal term for precision.
+        XMFLOAT4 q;
+        const float trace = r[0][0] + r[1][1] + r[2][2];
+        if ( trace > 0.f )
+        {
+            const float s = std::sqrt( trace + 1.f ) * 2.f;
+            q = { ( r[1][2] - r[2][1] ) / s, ( r[2][0] - r[0][2] ) / s, ( r[0][1] - r[1][0] ) / s, 0.25f * s };
+        }
+        else if ( r[0][0] > r[1][1] && r[0][0] > r[2][2] )
+        {
+            const float s = std::sqrt( 1.f + r[0][0] - r[1][1] - r[2][2] ) * 2.f;
+            q = { 0.25f * s, ( r[0][1] + r[1][0] ) / s, ( r[0][2] + r[2][0] ) / s, ( r[1][2] - r[2][1] ) / s };
+        }
+        else if ( r[1][1] > r[2][2] )
+        {
+            const float s = std::sqrt( 1.f + r[1][1] - r[0][0] - r[2][2] ) * 2.f;
+            q = { ( r[0][1] + r[1][0] ) / s, 0.25f * s, ( r[1][2] + r[2][1] ) / s, ( r[2][0] - r[0][2] ) / s };
+        }
+        else
+        {
+            const float s = std::sqrt( 1.f + r[2][2] - r[0][0] - r[1][1] ) * 2.f;
+            q = { ( r[0][2] + r[2][0] ) / s, ( r[1][2] + r[2][1] ) / s, 0.25f * s, ( r[0][1] - r[1][0] ) / s };
+        }
+        sample.m_rotation = Normalize( q );
+        return sample;
+    }
+
+    XMFLOAT4X4 ComposeTransform( const TransformSample& sample )
+    {
+        const XMFLOAT4& q = sample.m_rotation;
+        const XMFLOAT3& s = sample.m_scale;
+        const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        const float xw = q.x * q.w, yw = q.y * q.w, zw = q.z * q.w;
+
+        XMFLOAT4X4 m;
+        m.m[0][0] = ( 1.f - 2.f * ( yy + zz ) ) * s.x; m.m[0][1] = 2.f * ( xy + zw ) * s.x; m.m[0][2] = 2.f * ( xz - yw ) * s.x; m.m[0][3] = 0.f;
+        m.m[1][0] = 2.f * ( xy - zw ) * s.y; m.m[1][1] = ( 1.f - 2.f * ( xx + zz ) ) * s.y; m.m[1][2] = 2.f * ( yz + xw ) * s.y; m.m[1][3] = 0.f;
+        m.m[2][0] = 2.f * ( xz + yw ) * s.z; m.m[2][1] = 2.f * ( yz - xw ) * s.z; m.m[2][2] = ( 1.f - 2.f * ( xx + yy ) ) * s.z; m.m[2][3] = 0.f;
+        m.m[3][0] = sample.m_translation.x; m.m[3][1] = sample.m_translation.y; m.m[3][2] = sample.m_translation.z; m.m[3][3] = 1.f;
+        return m;
+    }
+
+    QuantizedQuaternion QuantizeQuaternion( const XMFLOAT4& rotation )
+    {
+        const float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+        uint32_t largest = 0;
+        for ( uint32_t i = 1; i < 4; ++i )
+        {
+            if ( std::fabs( components[i] ) > std::fabs( components[largest] ) )
+                largest = i;
+        }
+
+        const float sign = components[largest] < 0.f ? -1.f : 1.f;
+        QuantizedQuaternion quantized;
+        uint32_t slot = 0;
+        for ( uint32_t i = 0; i < 4; ++i )
+        {
+            if ( i == largest )
+                continue;
+            const float value = std::min( std::max( components[i] * sign / QuaternionRange, -1.f ), 1.f );
+            quantized.m_data[slot++] = static_cast<uint16_t>( std::lrint( ( value * 0.5f + 0.5f ) * QuaternionSteps ) );
+        }
+
+        quantized.m_data[0] |= static_cast<uint16_t>( ( largest & 1u ) << 15 );
+        quantized.m_data[1] |= static_cast<uint16_t>( ( largest >> 1 ) << 15 );
+        return quantized;
+    }
+
+    XMFLOAT4 DequantizeQuaternion( const QuantizedQuaternion& quantized )
+    {
+        const uint32_t largest = ( quantized.m_data[0] >> 15 ) | ( ( quantized.m_data[1] >> 15 ) << 1 );
+
+        float components[4];
+        float sumSquares = 0.f;
+        uint32_t slot = 0;
+        for ( uint32_t i = 0; i < 4; ++i )
+        {
+            if ( i == largest )
+                continue;
+            const float value = ( quantized.m_data[slot++] & 0x7FFF ) / QuaternionSteps * 2.f - 1.f;
+            components[i] = value * QuaternionRange;
+            sumSquares += components[i] * components[i];
+        }
+        components[largest] = std::sqrt( std::max( 1.f - sumSquares, 0.f ) );
+        return { components[0], components[1], components[2], components[3] };
+    }
+
+    size_t AnimationClip::GetByteSize() const
+    {
+        return sizeof( AnimationClip ) + m_name.size() +
+            m_tracks.size() * sizeof( AnimationTrack ) +
+            m_keyFrames.size() * sizeof( uint16_t ) +
+            m_translations.size() * sizeof( uint16_t ) +
+            m_rotations.size() * sizeof( QuantizedQuaternion ) +
+            m_scales.size() * sizeof( uint16_t ) +
+            ( m_floatTranslations.size() + m_floatScales.size() ) * sizeof( float );
+    }
+
+    AnimationClip CompressClip( const BakedClip& baked, const AnimationCompressionSettings& settings )
+    {
+        if ( baked.m_frameCount > 65536 )
+        {
+            throw std::invalid_argument( "Animation clips are limited to 65536 frames" );
+        }
+        if ( baked.m_samples.size() != baked.m_nodes.size() * baked.m_frameCount )
+        {
+            throw std::invalid_argument( "Baked clip must hold one sample per track and frame" );
+        }
+
+        std::vector<CompressedTrack> tracks( baked.m_nodes.size() );
+        if ( baked.m_frameCount > 0 )
+        {
+            ParallelFor( tracks.size(), [&]( size_t i )
+            {
+                tracks[i] = CompressTrack( baked, i, settings );
+            } );
+        }
+
+        AnimationClip clip;
+        clip.m_name = baked.m_name;
+        clip.m_sampleRate = baked.m_sampleRate;
+        clip.m_frameCount = baked.m_frameCount;
+
+        auto appendChannel = [&clip]( const std::vector<uint16_t>& frames, uint32_t firstValue, AnimationChannel& channel )
+        {
+            channel.m_firstKey = static_cast<uint32_t>( clip.m_keyFrames.size() );
+            channel.m_firstValue = firstValue;
+            channel.m_keyCount = static_cast<uint32_t>( frames.size() );
+            clip.m_keyFrames.insert( clip.m_keyFrames.end(), frames.begin(), frames.end() );
+        };
+
+        for ( CompressedTrack& track : tracks )
+        {
+            const bool floatTranslations = ( track.m_track.m_floatChannels & AnimationTrack::FloatTranslations ) != 0;
+            const bool floatScales = ( track.m_track.m_floatChannels & AnimationTrack::FloatScales ) != 0;
+            appendChannel( track.m_translationFrames,
+                static_cast<uint32_t>( floatTranslations ? clip.m_floatTranslations.size() / 3 : clip.m_translations.size() / 3 ), track.m_track.m_translation );
+            appendChannel( track.m_rotationFrames, static_cast<uint32_t>( clip.m_rotations.size() ), track.m_track.m_rotation );
+            appendChannel( track.m_scaleFrames,
+                static_cast<uint32_t>( floatScales ? clip.m_floatScales.size() / 3 : clip.m_scales.size() / 3 ), track.m_track.m_scale );
+            clip.m_translations.insert( clip.m_translations.end(), track.m_translations.begin(), track.m_translations.end() );
+            clip.m_rotations.insert( clip.m_rotations.end(), track.m_rotations.begin(), track.m_rotations.end() );
+            clip.m_scales.insert( clip.m_scales.end(), track.m_scales.begin(), track.m_scales.end() );
+            clip.m_floatTranslations.insert( clip.m_floatTranslations.end(), track.m_floatTranslations.begin(), track.m_floatTranslations.end() );
+            clip.m_floatScales.insert( clip.m_floatScales.end(), track.m_floatScales.begin(), track.m_floatScales.end() );
+            clip.m_tracks.push_back( track.m_track );
+        }
+        return clip;
+    }
+
+    AnimationError MeasureClipError( const BakedClip& baked, const AnimationClip& clip )
+    {
+        AnimationError error;
+        if ( clip.m_tracks.empty() )
+            return error;
+
+        ClipSampler sampler;
+        std::vector<XMFLOAT4X4> transforms( clip.m_tracks.size() );
+        for ( uint32_t frame = 0; frame < baked.m_frameCount; ++frame )
+        {
+            sampler.Sample( clip, frame / clip.m_sampleRate, transforms.data() );
+            for ( size_t track = 0; track < clip.m_tracks.size(); ++track )
+            {
+                const TransformSample& expected = baked.m_samples[track * baked.m_frameCount + frame];
+                const TransformSample actual = sampler.GetSample( track );
+                error.m_maxTranslationError = std::max( error.m_maxTranslationError, MaxAbsDifference( actual.m_translation, expected.m_translation ) );
+                error.m_maxRotationError = std::max( error.m_maxRotationError, RotationAngle( actual.m_rotation, Normalize( expected.m_rotation ) ) );
+                error.m_maxScaleError = std::max( error.m_maxScaleError, MaxRelativeDifference( actual.m_scale, expected.m_scale ) );
+            }
+        }
+        return error;
+    }
+
+    void ClipSampler::Sample( const AnimationClip& clip, float time, XMFLOAT4X4* trackTransforms )
+    {
+        const size_t trackCount = clip.m_tracks.size();
+        const size_t stride = ( trackCount + 3 ) & ~size_t( 3 );
+        if ( stride != m_stride )
+        {
+            // Padding lanes stay at identity, so the tail block needs no special case.
+            m_stride = stride;
+            m_translationsA.assign( stride * 3, 0.f );
+            m_translationsB.assign( stride * 3, 0.f );
+            m_rotationsA.assign( stride * 4, IdentityComponent );
+            m_rotationsB.assign( stride * 4, IdentityComponent );
+            m_scalesA.assign( stride * 3, 1.f );
+            m_scalesB.assign( stride * 3, 1.f );
+            m_alphas.assign( stride * 3, 0.f );
+            m_cursors.assign( stride * 3, 0 );
+            m_results.assign( stride * 10, 0.f );
+            std::fill( m_rotationsA.begin() + stride * 3, m_rotationsA.end(), 3.f );
+            std::fill( m_rotationsB.begin() + stride * 3, m_rotationsB.end(), 3.f );
+        }
+
+        const float lastFrame = clip.m_frameCount > 0 ? float( clip.m_frameCount - 1 ) : 0.f;
+        const float frame = std::min( std::max( time * clip.m_sampleRate, 0.f ), lastFrame );
+
+        // Locate the keys around frame for every channel. Translations and scales are decoded here,
+        // rotations are left as their three 15-bit values and dropped index for the SIMD pass.
+        for ( size_t t = 0; t < trackCount; ++t )
+        {
+            const AnimationTrack& track = clip.m_tracks[t];
+
+            const KeySpan translation = LocateKeys( clip, track.m_translation, frame, m_cursors[t * 3] );
+            const bool floatTranslations = ( track.m_floatChannels & AnimationTrack::FloatTranslations ) != 0;
+            const size_t firstTranslation = size_t( track.m_translation.m_firstValue ) * 3;
+            const uint16_t* translations = floatTranslations ? nullptr : clip.m_translations.data() + firstTranslation;
+            const float* floatTranslationKeys = floatTranslations ? clip.m_floatTranslations.data() + firstTranslation : nullptr;
+            const XMFLOAT3 ta = ReadKey( translations, floatTranslationKeys, translation.m_a, track.m_translationOffset, track.m_translationRange );
+            const XMFLOAT3 tb = ReadKey( translations, floatTranslationKeys, translation.m_b, track.m_translationOffset, track.m_translationRange );
+            Scatter( m_translationsA.data(), stride, t, { ta.x, ta.y, ta.z } );
+            Scatter( m_translationsB.data(), stride, t, { tb.x, tb.y, tb.z } );
+
+            const KeySpan rotation = LocateKeys( clip, track.m_rotation, frame, m_cursors[t * 3 + 1] );
+            const QuantizedQuaternion* rotations = clip.m_rotations.data() + track.m_rotation.m_firstValue;
+            const QuantizedQuaternion& ra = rotations[rotation.m_a];
+            const QuantizedQuaternion& rb = rotations[rotation.m_b];
+            Scatter( m_rotationsA.data(), stride, t, { float( ra.m_data[0] & 0x7FFF ), float( ra.m_data[1] & 0x7FFF ), float( ra.m_data[2] ), float( ( ra.m_data[0] >> 15 ) | ( ( ra.m_data[1] >> 15 ) << 1 ) ) } );
+            Scatter( m_rotationsB.data(), stride, t, { float( rb.m_data[0] & 0x7FFF ), float( rb.m_data[1] & 0x7FFF ), float( rb.m_data[2] ), float( ( rb.m_data[0] >> 15 ) | ( ( rb.m_data[1] >> 15 ) << 1 ) ) } );
+
+            const KeySpan scale = LocateKeys( clip, track.m_scale, frame, m_cursors[t * 3 + 2] );
+            const bool floatScales = ( track.m_floatChannels & AnimationTrack::FloatScales ) != 0;
+            const size_t firstScale = size_t( track.m_scale.m_firstValue ) * 3;
+            const uint16_t* scales = floatScales ? nullptr : clip.m_scales.data() + firstScale;
+            const float* floatScaleKeys = floatScales ? clip.m_floatScales.data() + firstScale : nullptr;
+            const XMFLOAT3 sa = ReadKey( scales, floatScaleKeys, scale.m_a, track.m_scaleOffset, track.m_scaleRange );
+            const XMFLOAT3 sb = ReadKey( scales, floatScaleKeys, scale.m_b, track.m_scaleOffset, track.m_scaleRange );
+            Scatter( m_scalesA.data(), stride, t, { sa.x, sa.y, sa.z } );
+            Scatter( m_scalesB.data(), stride, t, { sb.x, sb.y, sb.z } );
+
+            Scatter( m_alphas.data(), stride, t, { translation.m_alpha, rotation.m_alpha, scale.m_alpha } );
+        }
+
+        // Interpolate and build the matrices four tracks at a time.
+        const __m128 one = _mm_set1_ps( 1.f );
+        const __m128 two = _mm_set1_ps( 2.f );
+        const __m128 signMask = _mm_set1_ps( -0.f );
+        for ( size_t t = 0; t < stride; t += 4 )
+        {
+            auto load = [t, stride]( const std::vector<float>& values, size_t component ) { return _mm_loadu_ps( &values[component * stride + t] ); };
+            const __m128 translationAlpha = load( m_alphas, 0 );
+            const __m128 rotationAlpha = load( m_alphas, 1 );
+            const __m128 scaleAlpha = load( m_alphas, 2 );
+
+            const __m128 tx = Lerp4( load( m_translationsA, 0 ), load( m_translationsB, 0 ), translationAlpha );
+            const __m128 ty = Lerp4( load( m_translationsA, 1 ), load( m_translationsB, 1 ), translationAlpha );
+            const __m128 tz = Lerp4( load( m_translationsA, 2 ), load( m_translationsB, 2 ), translationAlpha );
+            const __m128 sx = Lerp4( load( m_scalesA, 0 ), load( m_scalesB, 0 ), scaleAlpha );
+            const __m128 sy = Lerp4( load( m_scalesA, 1 ), load( m_scalesB, 1 ), scaleAlpha );
+            const __m128 sz = Lerp4( load( m_scalesA, 2 ), load( m_scalesB, 2 ), scaleAlpha );
+
+            __m128 ax, ay, az, aw, bx, by, bz, bw;
+            DequantizeQuaternions4( load( m_rotationsA, 0 ), load( m_rotationsA, 1 ), load( m_rotationsA, 2 ), load( m_rotationsA, 3 ), ax, ay, az, aw );
+            DequantizeQuaternions4( load( m_rotationsB, 0 ), load( m_rotationsB, 1 ), load( m_rotationsB, 2 ), load( m_rotationsB, 3 ), bx, by, bz, bw );
+
+            // nlerp: flip b onto a's hemisphere, blend, renormalize.
+            const __m128 dot = _mm_add_ps( _mm_add_ps( _mm_mul_ps( ax, bx ), _mm_mul_ps( ay, by ) ), _mm_add_ps( _mm_mul_ps( az, bz ), _mm_mul_ps( aw, bw ) ) );
+            const __m128 flip = _mm_and_ps( dot, signMask );
+            bx = _mm_xor_ps( bx, flip );
+            by = _mm_xor_ps( by, flip );
+            bz = _mm_xor_ps( bz, flip );
+            bw = _mm_xor_ps( bw, flip );
+            __m128 qx = Lerp4( ax, bx, rotationAlpha );
+            __m128 qy = Lerp4( ay, by, rotationAlpha );
+            __m128 qz = Lerp4( az, bz, rotationAlpha );
+            __m128 qw = Lerp4( aw, bw, rotationAlpha );
+            const __m128 lengthSquared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( qx, qx ), _mm_mul_ps( qy, qy ) ), _mm_add_ps( _mm_mul_ps( qz, qz ), _mm_mul_ps( qw, qw ) ) );
+            const __m128 invLength = _mm_div_ps( one, _mm_sqrt_ps( lengthSquared ) );
+            qx = _mm_mul_ps( qx, invLength );
+            qy = _mm_mul_ps( qy, invLength );
+            qz = _mm_mul_ps( qz, invLength );
+            qw = _mm_mul_ps( qw, invLength );
+
+            const __m128 results[10] = { tx, ty, tz, qx, qy, qz, qw, sx, sy, sz };
+            for ( size_t component = 0; component < 10; ++component )
+                _mm_storeu_ps( &m_results[component * stride + t], results[component] );
+
+            // Same terms as ComposeTransform, one lane per track.
+            const __m128 xx = _mm_mul_ps( qx, qx ), yy = _mm_mul_ps( qy, qy ), zz = _mm_mul_ps( qz, qz );
+            const __m128 xy = _mm_mul_ps( qx, qy ), xz = _mm_mul_ps( qx, qz ), yz = _mm_mul_ps( qy, qz );
+            const __m128 xw = _mm_mul_ps( qx, qw ), yw = _mm_mul_ps( qy, qw ), zw = _mm_mul_ps( qz, qw );
+            const __m128 zero = _mm_setzero_ps();
+
+            __m128 rows[4][4] = {
+                { _mm_mul_ps( _mm_sub_ps( one, _mm_mul_ps( two, _mm_add_ps( yy, zz ) ) ), sx ), _mm_mul_ps( _mm_mul_ps( two, _mm_add_ps( xy, zw ) ), sx ), _mm_mul_ps( _mm_mul_ps( two, _mm_sub_ps( xz, yw ) ), sx ), zero },
+                { _mm_mul_ps( _mm_mul_ps( two, _mm_sub_ps( xy, zw ) ), sy ), _mm_mul_ps( _mm_sub_ps( one, _mm_mul_ps( two, _mm_add_ps( xx, zz ) ) ), sy ), _mm_mul_ps( _mm_mul_ps( two, _mm_add_ps( yz, xw ) ), sy ), zero },
+                { _mm_mul_ps( _mm_mul_ps( two, _mm_add_ps( xz, yw ) ), sz ), _mm_mul_ps( _mm_mul_ps( two, _mm_sub_ps( yz, xw ) ), sz ), _mm_mul_ps( _mm_sub_ps( one, _mm_mul_ps( two, _mm_add_ps( xx, yy ) ) ), sz ), zero },
+                { tx, ty, tz, one } };
+
+            // Each row holds one matrix row for four tracks; transposing gives that row per track.
+            XMFLOAT4X4 block[4];
+            for ( int row = 0; row < 4; ++row )
+            {
+                _MM_TRANSPOSE4_PS( rows[row][0], rows[row][1], rows[row][2], rows[row][3] );
+                for ( int lane = 0; lane < 4; ++lane )
+                    _mm_storeu_ps( block[lane].m[row], rows[row][lane] );
+            }
+
+            const size_t count = std::min<size_t>( 4, trackCount - std::min( t, trackCount ) );
+            std::copy( block, block + count, trackTransforms + t );
+        }
+    }
+
+    void ClipSampler::Apply( const AnimationClip& clip, float time, Scene& scene )
+    {
+        m_scratch.resize( clip.m_tracks.size() );
+        Sample( clip, time, m_scratch.data() );
+        for ( size_t t = 0; t < clip.m_tracks.size(); ++t )
+            scene.SetLocalTransform( clip.m_tracks[t].m_node, m_scratch[t] );
+    }
+
+    TransformSample ClipSampler::GetSample( size_t track ) const
+    {
+        if ( track >= m_stride )
+        {
+            throw std::out_of_range( "Track was not sampled" );
+        }
+
+        auto component = [this, track]( size_t c ) { return m_results[c * m_stride + track]; };
+        TransformSample sample;
+        sample.m_translation = { component( 0 ), component( 1 ), component( 2 ) };
+        sample.m_rotation = { component( 3 ), component( 4 ), component( 5 ), component( 6 ) };
+        sample.m_scale = { component( 7 ), component( 8 ), component( 9 ) };
+        return sample;
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Olex
+{
+    class Scene;
+
+    // Local transform split into translation, unit rotation quaternion (x, y, z, w) and scale.
+    struct TransformSample
+    {
+        DirectX::XMFLOAT3 m_translation;
+        DirectX::XMFLOAT4 m_rotation;
+        DirectX::XMFLOAT3 m_scale;
+    };
+
+    /**
+     * Splits an affine row-vector matrix (DirectXMath convention) into translation, rotation and scale.
+     * A mirroring matrix gets a negative x scale. Shear is lost.
+     */
+    TransformSample DecomposeTransform( const DirectX::XMFLOAT4X4& matrix );
+
+    // Inverse of DecomposeTransform: scale, then rotation, then translation.
+    DirectX::XMFLOAT4X4 ComposeTransform( const TransformSample& sample );
+
+    /**
+     * Uncompressed animation as baked from the source: every track holds one sample per frame
+     * at a fixed rate. m_samples[track * m_frameCount + frame].
+     */
+    struct BakedClip
+    {
+        std::string m_name;
+        float m_sampleRate = 30.f;
+        uint32_t m_frameCount = 0;
+        // Scene node animated by each track.
+        std::vector<uint32_t> m_nodes;
+        std::vector<TransformSample> m_samples;
+    };
+
+    // Largest error a reduced or quantized key may introduce, measured on every baked frame.
+    struct AnimationCompressionSettings
+    {
+        // In scene units.
+        float m_translationTolerance = 1e-3f;
+        // In radians, around 0.03 degrees.
+        float m_rotationTolerance = 5e-4f;
+        // Relative to the scale value.
+        float m_scaleTolerance = 1e-3f;
+    };
+
+    /**
+     * Smallest-three quaternion in 48 bits: the largest component is dropped (its sign is made
+     * positive, q and -q are the same rotation) and the other three are stored as 15-bit values
+     * in [-1/sqrt(2), 1/sqrt(2)]. The top bits of m_data[0] and m_data[1] hold the dropped index.
+     * Worst case error under 0.01 degrees.
+     */
+    struct QuantizedQuaternion
+    {
+        uint16_t m_data[3];
+    };
+
+    QuantizedQuaternion QuantizeQuaternion( const DirectX::XMFLOAT4& rotation );
+    DirectX::XMFLOAT4 DequantizeQuaternion( const QuantizedQuaternion& quantized );
+
+    /**
+     * Keys of one channel of one track: m_keyCount frames from AnimationClip::m_keyFrames[m_firstKey]
+     * and as many values from the channel's value array at m_firstValue.
+     */
+    struct AnimationChannel
+    {
+        uint32_t m_firstKey = 0;
+        uint32_t m_firstValue = 0;
+        uint32_t m_keyCount = 0;
+    };
+
+    struct AnimationTrack
+    {
+        uint32_t m_node = 0;
+        AnimationChannel m_translation;
+        AnimationChannel m_rotation;
+        AnimationChannel m_scale;
+        // Dequantization of the 16-bit translation and scale keys: value = offset + unorm * range.
+        DirectX::XMFLOAT3 m_translationOffset;
+        DirectX::XMFLOAT3 m_translationRange;
+        DirectX::XMFLOAT3 m_scaleOffset;
+        DirectX::XMFLOAT3 m_scaleRange;
+        // Channels whose range is too wide for 16-bit keys within the tolerance keep float keys instead.
+        static constexpr uint32_t FloatTranslations = 1u;
+        static constexpr uint32_t FloatScales = 2u;
+        uint32_t m_floatChannels = 0;
+    };
+
+    /**
+     * Compressed clip. Each channel only keeps the frames that linear interpolation (normalized
+     * for rotations) of their neighbours cannot reproduce within the tolerances; rotations are
+     * smallest-three quantized and translations and scales 16-bit quantized per track, or stored
+     * as floats when 16 bits over the track's range would already exceed the tolerance.
+     */
+    struct AnimationClip
+    {
+        std::string m_name;
+        float m_sampleRate = 30.f;
+        uint32_t m_frameCount = 0;
+        std::vector<AnimationTrack> m_tracks;
+        // Frame index of every key, per channel in increasing order; the first key of a channel is frame 0, the last its final frame.
+        std::vector<uint16_t> m_keyFrames;
+        // Key values, addressed through AnimationChannel::m_firstValue.
+        std::vector<uint16_t> m_translations; // 3 per key
+        std::vector<QuantizedQuaternion> m_rotations;
+        std::vector<uint16_t> m_scales; // 3 per key
+        // Key values of the channels flagged in AnimationTrack::m_floatChannels.
+        std::vector<float> m_floatTranslations; // 3 per key
+        std::vector<float> m_floatScales; // 3 per key
+
+        [[nodiscard]] float GetDuration() const { return m_frameCount > 1 ? ( m_frameCount - 1 ) / m_sampleRate : 0.f; }
+        [[nodiscard]] size_t GetByteSize() const;
+    };
+
+    /**
+     * Tracks are compressed in parallel. Throws std::invalid_argument for clips over 65536 frames,
+     * and when the rotation tolerance is finer than the quantized rotations of a track can hold.
+     */
+    AnimationClip CompressClip( const BakedClip& baked, const AnimationCompressionSettings& settings = {} );
+
+    struct AnimationError
+    {
+        float m_maxTranslationError = 0.f;
+        float m_maxRotationError = 0.f;
+        float m_maxScaleError = 0.f;
+    };
+
+    // Compares the compressed clip against the baked samples on every frame.
+    AnimationError MeasureClipError( const BakedClip& baked, const AnimationClip& clip );
+
+    /**
+     * Evaluates every track of a clip at once.
+     *
+     * Keys are located and decoded per track into structure-of-arrays scratch buffers, then
+     * interpolated (nlerp for rotations) and turned into matrices four tracks at a time with SSE.
+     * The key spans found are remembered per channel, so playing forward rarely searches.
+     * The scratch buffers are kept between calls, so use one sampler per thread.
+     */
+    class ClipSampler
+    {
+    public:
+        // Writes one local transform per track; time is clamped to the clip.
+        void Sample( const AnimationClip& clip, float time, DirectX::XMFLOAT4X4* trackTransforms );
+        // Samples and stores the results as the local transforms of the animated scene nodes.
+        void Apply( const AnimationClip& clip, float time, Scene& scene );
+
+        // The interpolated values behind the last Sample, for checks against the baked clip.
+        [[nodiscard]] TransformSample GetSample( size_t track ) const;
+
+    private:
+        // Channel-major: component c of track t lives at [c * m_stride + t].
+        std::vector<float> m_rotationsA;
+        std::vector<float> m_rotationsB;
+        std::vector<float> m_translationsA;
+        std::vector<float> m_translationsB;
+        std::vector<float> m_scalesA;
+        std::vector<float> m_scalesB;
+        std::vector<float> m_alphas; // translation, rotation, scale
+        std::vector<uint32_t> m_cursors; // 3 per track
+        std::vector<float> m_results; // 10 components: translation, rotation, scale
+        std::vector<DirectX::XMFLOAT4X4> m_scratch;
+        size_t m_stride = 0;
+    };
+}
@@ -0,0 +1,291 @@
+// Offline asset baker: turns fbx models and source images into the .mesh, .scene and .tex
+// containers the runtime maps at startup. It is the only part of the project that links the FBX SDK.
+// Baked outputs are kept in a content-addressed AssetCache, so only changed assets are imported again.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AssetCache.h"
+#include "ChunkedMesh.h"
+#include "FbxLoader.h"
+#include "ImageDecoder.h"
+#include "MeshCache.h"
+#include "ParallelFor.h"
+#include "SceneCache.h"
+#include "TextureCache.h"
+
+namespace Olex
+{
+    namespace
+    {
+        using std::filesystem::path;
+
+        // Part of every cache key. Bump it when the baked output changes without a container version bump.
+        constexpr uint32_t BakerVersion = 1;
+
+        struct BakeOptions
+        {
+            MeshImportSettings m_importSettings;
+            // Empty writes every output next to its input.
+            path m_outputDirectory;
+            path m_cacheDirectory = ".assetcache";
+            // Cell size of the streaming .chunks container, 0 bakes none.
+            float m_chunkSize = 0.f;
+            // Bake even when the cache has the outputs.
+            bool m_force = false;
+        };
+
+        struct TextureJob
+        {
+            path m_source;
+            path m_target;
+            bool m_hit = false;
+        };
+
+        void PrintUsage()
+        {
+            std::fputs(
+                "Usage: AssetBaker [options] <input>...\n"
+                "\n"
+                "Inputs are .fbx models, baked to <name>.mesh and <name>.scene plus a .tex for every\n"
+                "material texture, and images, baked to <name>.tex.\n"
+                "\n"
+                "Options:\n"
+                "  -o <dir>               output directory, defaults to next to each input\n"
+                "  --lods <n>             simplified levels of detail per mesh\n"
+                "  --lod-reduction <f>    triangles of each level relative to the one before\n"
+                "  --tangents             generate MikkTSpace tangent frames\n"
+                "  --meshlets             split meshes into meshlets\n"
+                "  --no-skins             ignore skin weights\n"
+                "  --no-animations        ignore animation stacks\n"
+                "  --sample-rate <hz>     animation sample rate, 30 by default\n"
+                "  --chunk-size <size>    also bake <name>.chunks for streaming, in cells of this size\n"
+                "  --cache <dir>          baked output cache, .assetcache by default\n"
+                "  --force                bake even when the cache has the outputs\n",
+                stdout );
+        }
+
+        std::string GetExtension( const path& file )
+        {
+            std::string extension = file.extension().string();
+            std::transform( extension.begin(), extension.end(), extension.begin(), []( unsigned char c ) { return static_cast<char>( std::tolower( c ) ); } );
+            return extension;
+        }
+
+        bool IsImage( const path& file )
+        {
+            static const char* const extensions[] = { ".bmp", ".gif", ".jpeg", ".jpg", ".png", ".tga", ".tif", ".tiff" };
+            const std::string extension = GetExtension( file );
+            return std::any_of( std::begin( extensions ), std::end( extensions ), [&]( const char* known ) { return extension == known; } );
+        }
+
+        path GetOutputPath( const BakeOptions& options, const path& source, const char* extension )
+        {
+            const path directory = options.m_outputDirectory.empty() ? source.parent_path() : options.m_outputDirectory;
+            return directory / source.filename().replace_extension( extension );
+        }
+
+        // Everything that decides the bytes of a baked model: the source, every import setting and the versions.
+        uint64_t GetModelKey( uint64_t sourceHash, const MeshImportSettings& settings, float chunkSize )
+        {
+            ContentHasher hasher;
+            hasher.Update( std::string( "model" ) );
+            hasher.Update( BakerVersion );
+            hasher.Update( MeshCacheFormat::Version );
+            hasher.Update( SceneCacheFormat::Version );
+            hasher.Update( sourceHash );
+            hasher.Update( settings.m_optimizeVertexCache );
+            hasher.Update( settings.m_optimizeOverdraw );
+            hasher.Update( settings.m_overdrawThreshold );
+            hasher.Update( settings.m_optimizeVertexFetch );
+            hasher.Update( settings.m_importSkins );
+            hasher.Update( settings.m_importAnimations );
+            hasher.Update( settings.m_animationSampleRate );
+            hasher.Update( settings.m_animationCompression.m_translationTolerance );
+            hasher.Update( settings.m_animationCompression.m_rotationTolerance );
+            hasher.Update( settings.m_animationCompression.m_scaleTolerance );
+            hasher.Update( settings.m_generateTangents );
+            hasher.Update( settings.m_buildMeshlets );
+            hasher.Update( settings.m_lodCount );
+            hasher.Update( settings.m_lodReduction );
+            if ( chunkSize > 0.f )
+            {
+                hasher.Update( ChunkedMeshFormat::Version );
+                hasher.Update( chunkSize );
+            }
+            return hasher.Finish();
+        }
+
+        uint64_t GetTextureKey( uint64_t sourceHash )
+        {
+            ContentHasher hasher;
+            hasher.Update( std::string( "texture" ) );
+            hasher.Update( BakerVersion );
+            hasher.Update( TextureCacheFormat::Version );
+            hasher.Update( sourceHash );
+            return hasher.Finish();
+        }
+
+        void BakeTexture( TextureJob& job, AssetCache& cache, bool force )
+        {
+            const uint64_t key = GetTextureKey( cache.HashSource( job.m_source ) );
+            job.m_hit = cache.GetOrBake( key, { ".tex" }, force, [&]( const std::vector<path>& outputs )
+            {
+                WriteTextureCache( outputs[0], GenerateMips( DecodeImage( job.m_source ) ), SourceStamp::FromFile( job.m_source ) );
+            } );
+            cache.Materialize( key, ".tex", job.m_target );
+        }
+
+        // Bakes the model unless the cache has it and queues the textures its materials use.
+        void BakeModel( const path& source, const BakeOptions& options, AssetCache& cache, std::vector<TextureJob>& textures )
+        {
+            const path meshPath = GetOutputPath( options, source, ".mesh" );
+            const path scenePath = GetOutputPath( options, source, ".scene" );
+            const bool chunked = options.m_chunkSize > 0.f;
+            std::vector<const char*> extensions = { ".mesh", ".scene" };
+            if ( chunked )
+                extensions.push_back( ".chunks" );
+
+            const uint64_t key = GetModelKey( cache.HashSource( source ), options.m_importSettings, options.m_chunkSize );
+            const bool hit = cache.GetOrBake( key, extensions, options.m_force, [&]( const std::vector<path>& outputs )
+            {
+                const SourceStamp stamp = SourceStamp::FromFile( source );
+                const FbxLoader loader( source.string().c_str(), options.m_importSettings );
+                WriteMeshCache( outputs[0], loader.GetMeshes(), stamp );
+                WriteSceneCache( outputs[1], loader.GetScene(), loader.GetSkeleton(), loader.GetAnimations(), stamp );
+                if ( chunked )
+                    WriteChunkedMesh( outputs[2], loader.GetMeshes(), options.m_chunkSize, stamp );
+            } );
+            cache.Materialize( key, ".mesh", meshPath );
+            cache.Materialize( key, ".scene", scenePath );
+            std::printf( "%s -> %s, %s%s\n", source.string().c_str(), meshPath.string().c_str(), scenePath.string().c_str(), hit ? " (cached)" : "" );
+            if ( chunked )
+            {
+                const path chunksPath = GetOutputPath( options, source, ".chunks" );
+                cache.Materialize( key, ".chunks", chunksPath );
+                std::printf( "%s -> %s\n", source.string().c_str(), chunksPath.string().c_str() );
+            }
+
+            const std::vector<Material> materials = MappedSceneCache( cache.GetObjectPath( key, ".scene" ) ).Load().m_scene.GetMaterials();
+
+            // Texture paths are relative to the scene file, see Material::m_baseColorTexture.
+            for ( const Material& material : materials )
+            {
+                if ( material.m_baseColorTexture.empty() )
+                    continue;
+                const path texture( material.m_baseColorTexture );
+                path target = scenePath.parent_path() / texture;
+                target.replace_extension( ".tex" );
+                textures.push_back( { source.parent_path() / texture, target } );
+            }
+        }
+    }
+}
+
+int main( int argc, char** argv )
+{
+    using namespace Olex;
+
+    BakeOptions options;
+    std::vector<path> inputs;
+    try
+    {
+        for ( int i = 1; i < argc; ++i )
+        {
+            const std::string argument = argv[i];
+            auto value = [&]() -> std::string
+            {
+                if ( i + 1 >= argc )
+                    throw std::invalid_argument( argument + " needs a value" );
+                return argv[++i];
+            };
+
+            if ( argument == "-o" )
+                options.m_outputDirectory = value();
+            else if ( argument == "--lods" )
+                options.m_importSettings.m_lodCount = static_cast<uint32_t>( std::stoul( value() ) );
+            else if ( argument == "--lod-reduction" )
+                options.m_importSettings.m_lodReduction = std::stof( value() );
+            else if ( argument == "--tangents" )
+                options.m_importSettings.m_generateTangents = true;
+            else if ( argument == "--meshlets" )
+                options.m_importSettings.m_buildMeshlets = true;
+            else if ( argument == "--no-skins" )
+                options.m_importSettings.m_importSkins = false;
+            else if ( argument == "--no-animations" )
+                options.m_importSettings.m_importAnimations = false;
+            else if ( argument == "--sample-rate" )
+                options.m_importSettings.m_animationSampleRate = std::stof( value() );
+            else if ( argument == "--chunk-size" )
+                options.m_chunkSize = std::stof( value() );
+            else if ( argument == "--cache" )
+                options.m_cacheDirectory = value();
+            else if ( argument == "--force" )
+                options.m_force = true;
+            else if ( argument == "-h" || argument == "--help" )
+            {
+                PrintUsage();
+                return 0;
+            }
+            else if ( !argument.empty() && argument[0] == '-' )
+                throw std::invalid_argument( "unknown option " + argument );
+            else
+                inputs.emplace_back( argument );
+        }
+
+        if ( inputs.empty() )
+            throw std::invalid_argument( "no inputs" );
+    }
+    catch ( const std::exception& error )
+    {
+        std::fprintf( stderr, "AssetBaker: %s\n\n", error.what() );
+        PrintUsage();
+        return 2;
+    }
+
+    try
+    {
+        AssetCache cache( options.m_cacheDirectory );
+        std::vector<TextureJob> textures;
+        for ( const path& input : inputs )
+        {
+            if ( GetExtension( input ) == ".fbx" )
+                BakeModel( input, options, cache, textures );
+            else if ( IsImage( input ) )
+                textures.push_back( { input, GetOutputPath( options, input, ".tex" ) } );
+            else
+                throw std::runtime_error( "Don't know how to bake " + input.string() );
+        }
+
+        // Materials of several models may share a texture, bake each one once.
+        std::sort( textures.begin(), textures.end(), []( const TextureJob& lhs, const TextureJob& rhs ) { return lhs.m_target < rhs.m_target; } );
+        textures.erase( std::unique( textures.begin(), textures.end(), []( const TextureJob& lhs, const TextureJob& rhs ) { return lhs.m_target == rhs.m_target; } ), textures.end() );
+
+        // Decoding and mip generation dominate, the images are independent.
+        ParallelFor( textures.size(), [&]( size_t i ) { BakeTexture( textures[i], cache, options.m_force ); } );
+        for ( const TextureJob& texture : textures )
+            std::printf( "%s -> %s%s\n", texture.m_source.string().c_str(), texture.m_target.string().c_str(), texture.m_hit ? " (cached)" : "" );
+
+        cache.SaveIndex();
+
+        // One line, stable for build machines to grep.
+        const AssetCacheStats& stats = cache.GetStats();
+        std::printf( "cache: %llu hits, %llu misses, %llu sources hashed (%.1f MB), %llu outputs copied\n",
+            static_cast<unsigned long long>( stats.m_hits ), static_cast<unsigned long long>( stats.m_misses ),
+            static_cast<unsigned long long>( stats.m_sourcesHashed ), stats.m_bytesHashed * ( 1.0 / ( 1 << 20 ) ),
+            static_cast<unsigned long long>( stats.m_outputsCopied ) );
+    }
+    catch ( const std::exception& error )
+    {
+        std::fprintf( stderr, "AssetBaker: %s\n", error.what() );
+        return 1;
+    }
+    return 0;
+}
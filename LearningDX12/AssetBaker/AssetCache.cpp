@@ -0,0 +1,412 @@
+#include "AssetCache.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "MappedFile.h"
+
+namespace Olex
+{
+    namespace
+    {
+        constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+        constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+        constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+        // First line of the index file, bump the number when the record layout changes.
+        constexpr char IndexHeader[] = "OlexAssetCacheIndex 1";
+
+        // A lock file older than this was left behind by a baker that died holding it.
+        constexpr auto StaleLockAge = std::chrono::minutes( 2 );
+        constexpr auto LockTimeout = std::chrono::seconds( 60 );
+
+        uint64_t RotateLeft( uint64_t value, int bits )
+        {
+            return ( value << bits ) | ( value >> ( 64 - bits ) );
+        }
+
+        uint64_t Round( uint64_t lane, uint64_t input )
+        {
+            lane += input * Prime2;
+            return RotateLeft( lane, 31 ) * Prime1;
+        }
+
+        uint64_t MergeRound( uint64_t hash, uint64_t lane )
+        {
+            hash ^= Round( 0, lane );
+            return hash * Prime1 + Prime4;
+        }
+
+        uint64_t Read64( const uint8_t* data )
+        {
+            uint64_t value;
+            std::memcpy( &value, data, sizeof( value ) );
+            return value;
+        }
+
+        uint32_t Read32( const uint8_t* data )
+        {
+            uint32_t value;
+            std::memcpy( &value, data, sizeof( value ) );
+            return value;
+        }
+
+        /**
+         * Cross-process mutex on a lock file created with exclusive mode, the one atomic
+         * create-if-absent the standard library offers on every platform.
+         */
+        class IndexLock
+        {
+        public:
+            explicit IndexLock( std::filesystem::path path )
+                : m_path( std::move( path ) )
+            {
+                const auto deadline = std::chrono::steady_clock::now() + LockTimeout;
+                for ( ;; )
+                {
+                    if ( std::FILE* file = std::fopen( m_path.string().c_str(), "wx" ) )
+                    {
+                        std::fclose( file );
+                        return;
+                    }
+
+                    if ( IsStale( m_path ) )
+                        BreakStaleLock();
+
+                    if ( std::chrono::steady_clock::now() > deadline )
+                        throw std::runtime_error( "Timed out waiting for the asset cache lock " + m_path.string() );
+                    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+                }
+            }
+
+            ~IndexLock()
+            {
+                std::error_code error;
+                std::filesystem::remove( m_path, error );
+            }
+
+            IndexLock( const IndexLock& ) = delete;
+            IndexLock& operator=( const IndexLock& ) = delete;
+
+        private:
+            std::filesystem::path m_path;
+
+            static bool IsStale( const std::filesystem::path& path )
+            {
+                std::error_code error;
+                const auto writeTime = std::filesystem::last_write_time( path, error );
+                return !error && std::filesystem::file_time_type::clock::now() - writeTime > StaleLockAge;
+            }
+
+            /**
+             * Between the age check and the removal another waiter may break the same lock and a new
+             * holder take it, so the lock is first renamed to a private name and only deleted when the
+             * renamed file itself is stale. A live lock caught that way is linked back into place,
+             * which like the exclusive create fails when the lock has been taken again meanwhile.
+             */
+            void BreakStaleLock()
+            {
+                std::filesystem::path claimed = m_path;
+                claimed += "." + MakeUniqueName() + ".stale";
+
+                std::error_code error;
+                std::filesystem::rename( m_path, claimed, error );
+                if ( error )
+                    return;
+
+                if ( !IsStale( claimed ) )
+                    std::filesystem::create_hard_link( claimed, m_path, error );
+                std::filesystem::remove( claimed, error );
+            }
+        };
+    }
+
+    ContentHasher::ContentHasher( uint64_t seed )
+        : m_lanes{ seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 }
+        , m_seed( seed )
+    {
+    }
+
+    void ContentHasher::Update( const void* data, size_t size )
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>( data );
+        m_length += size;
+
+        if ( m_buffered + size < sizeof( m_buffer ) )
+        {
+            std::memcpy( m_buffer + m_buffered, bytes, size );
+            m_buffered += size;
+            return;
+        }
+
+        if ( m_buffered > 0 )
+        {
+            const size_t fill = sizeof( m_buffer ) - m_buffered;
+            std::memcpy( m_buffer + m_buffered, bytes, fill );
+            for ( int lane = 0; lane < 4; ++lane )
+                m_lanes[lane] = Round( m_lanes[lane], Read64( m_buffer + lane * 8 ) );
+            bytes += fill;
+            size -= fill;
+            m_buffered = 0;
+        }
+
+        for ( ; size >= 32; bytes += 32, size -= 32 )
+        {
+            for ( int lane = 0; lane < 4; ++lane )
+                m_lanes[lane] = Round( m_lanes[lane], Read64( bytes + lane * 8 ) );
+        }
+
+        std::memcpy( m_buffer, bytes, size );
+        m_buffered = size;
+    }
+
+    void ContentHasher::Update( const std::string& text )
+    {
+        // The length keeps "ab" + "c" apart from "a" + "bc".
+        Update( uint64_t( text.size() ) );
+        Update( text.data(), text.size() );
+    }
+
+    uint64_t ContentHasher::Finish() const
+    {
+        uint64_t hash;
+        if ( m_length >= 32 )
+        {
+            hash = RotateLeft( m_lanes[0], 1 ) + RotateLeft( m_lanes[1], 7 ) + RotateLeft( m_lanes[2], 12 ) + RotateLeft( m_lanes[3], 18 );
+            for ( const uint64_t lane : m_lanes )
+                hash = MergeRound( hash, lane );
+        }
+        else
+        {
+            hash = m_seed + Prime5;
+        }
+        hash += m_length;
+
+        const uint8_t* bytes = m_buffer;
+        size_t size = m_buffered;
+        for ( ; size >= 8; bytes += 8, size -= 8 )
+            hash = RotateLeft( hash ^ Round( 0, Read64( bytes ) ), 27 ) * Prime1 + Prime4;
+        if ( size >= 4 )
+        {
+            hash = RotateLeft( hash ^ ( uint64_t( Read32( bytes ) ) * Prime1 ), 23 ) * Prime2 + Prime3;
+            bytes += 4;
+            size -= 4;
+        }
+        for ( ; size > 0; ++bytes, --size )
+            hash = RotateLeft( hash ^ ( *bytes * Prime5 ), 11 ) * Prime1;
+
+        hash ^= hash >> 33;
+        hash *= Prime2;
+        hash ^= hash >> 29;
+        hash *= Prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    uint64_t HashFile( const std::filesystem::path& path )
+    {
+        std::ifstream stream( path, std::ios::binary );
+        if ( !stream )
+            throw std::runtime_error( "Unable to read " + path.string() );
+
+        ContentHasher hasher;
+        std::vector<char> chunk( 1 << 20 );
+        while ( stream )
+        {
+            stream.read( chunk.data(), static_cast<std::streamsize>( chunk.size() ) );
+            hasher.Update( chunk.data(), static_cast<size_t>( stream.gcount() ) );
+        }
+        if ( !stream.eof() )
+            throw std::runtime_error( "Unable to read " + path.string() );
+        return hasher.Finish();
+    }
+
+    AssetCache::AssetCache( const std::filesystem::path& directory )
+        : m_directory( directory )
+    {
+        std::filesystem::create_directories( m_directory / "objects" );
+        std::filesystem::create_directories( m_directory / "staging" );
+
+        const IndexLock lock( m_directory / "index.lock" );
+        m_files = ReadIndex();
+    }
+
+    uint64_t AssetCache::HashSource( const std::filesystem::path& source )
+    {
+        const std::string recordPath = GetRecordPath( source );
+        const SourceStamp stamp = SourceStamp::FromFile( source );
+        {
+            std::lock_guard<std::mutex> guard( m_mutex );
+            const auto record = m_files.find( recordPath );
+            if ( record != m_files.end() && record->second.m_stamp == stamp )
+                return record->second.m_hash;
+        }
+
+        const uint64_t hash = HashFile( source );
+        ++m_stats.m_sourcesHashed;
+        m_stats.m_bytesHashed += stamp.m_size;
+        SetRecord( recordPath, { stamp, hash } );
+        return hash;
+    }
+
+    std::filesystem::path AssetCache::GetObjectPath( uint64_t key, const char* extension ) const
+    {
+        // Two hex digits of fan-out keep directories small with tens of thousands of objects.
+        char name[24];
+        std::snprintf( name, sizeof( name ), "%016" PRIx64, key );
+        return m_directory / "objects" / std::string( name, 2 ) / ( name + std::string( extension ) );
+    }
+
+    bool AssetCache::GetOrBake( uint64_t key, const std::vector<const char*>& extensions, bool force,
+        const std::function<void( const std::vector<std::filesystem::path>& outputs )>& bake )
+    {
+        bool hit = !force;
+        for ( const char* extension : extensions )
+            hit = hit && std::filesystem::exists( GetObjectPath( key, extension ) );
+        if ( hit )
+        {
+            ++m_stats.m_hits;
+            return true;
+        }
+        ++m_stats.m_misses;
+
+        const std::filesystem::path staging = m_directory / "staging" / MakeUniqueName();
+        std::filesystem::create_directories( staging );
+        try
+        {
+            std::vector<std::filesystem::path> outputs;
+            for ( const char* extension : extensions )
+                outputs.push_back( staging / GetObjectPath( key, extension ).filename() );
+            bake( outputs );
+
+            for ( size_t i = 0; i < outputs.size(); ++i )
+            {
+                const std::filesystem::path object = GetObjectPath( key, extensions[i] );
+                std::filesystem::create_directories( object.parent_path() );
+                std::error_code error;
+                std::filesystem::rename( outputs[i], object, error );
+                // Losing the race to another baker is fine, it stored the same bytes.
+                if ( error && !std::filesystem::exists( object ) )
+                    throw std::filesystem::filesystem_error( "Unable to store a cache object", outputs[i], object, error );
+            }
+        }
+        catch ( ... )
+        {
+            std::error_code error;
+            std::filesystem::remove_all( staging, error );
+            throw;
+        }
+
+        std::error_code error;
+        std::filesystem::remove_all( staging, error );
+        return false;
+    }
+
+    void AssetCache::Materialize( uint64_t key, const char* extension, const std::filesystem::path& target )
+    {
+        const std::string recordPath = GetRecordPath( target );
+        {
+            std::lock_guard<std::mutex> guard( m_mutex );
+            const auto record = m_files.find( recordPath );
+            if ( record != m_files.end() && record->second.m_hash == key && record->second.m_stamp == SourceStamp::FromFile( target ) )
+                return;
+        }
+
+        // Copy next to the target and rename, a running demo never maps a half written file. The
+        // temporary name is unique, as bakers sharing the output directory may materialize the same target.
+        std::filesystem::create_directories( target.parent_path() );
+        std::filesystem::path temporary = target;
+        temporary += "." + MakeUniqueName() + ".tmp";
+        try
+        {
+            std::filesystem::copy_file( GetObjectPath( key, extension ), temporary );
+            std::filesystem::rename( temporary, target );
+        }
+        catch ( ... )
+        {
+            std::error_code error;
+            std::filesystem::remove( temporary, error );
+            throw;
+        }
+        ++m_stats.m_outputsCopied;
+
+        SetRecord( recordPath, { SourceStamp::FromFile( target ), key } );
+    }
+
+    void AssetCache::SaveIndex()
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        if ( m_changed.empty() )
+            return;
+
+        const IndexLock lock( m_directory / "index.lock" );
+        FileRecords files = ReadIndex();
+        for ( const std::string& path : m_changed )
+            files[path] = m_files.at( path );
+        WriteIndex( files );
+        m_changed.clear();
+    }
+
+    AssetCache::FileRecords AssetCache::ReadIndex() const
+    {
+        FileRecords files;
+        std::ifstream stream( m_directory / "index" );
+        std::string line;
+        // A missing index or one from another version starts the cache index over, the objects stay valid.
+        if ( !std::getline( stream, line ) || line != IndexHeader )
+            return files;
+
+        while ( std::getline( stream, line ) )
+        {
+            uint64_t hash;
+            uint64_t size;
+            int64_t writeTime;
+            int pathStart = 0;
+            if ( std::sscanf( line.c_str(), "%" SCNx64 " %" SCNu64 " %" SCNd64 " %n", &hash, &size, &writeTime, &pathStart ) == 3 && pathStart > 0 )
+                files[line.substr( pathStart )] = { { size, writeTime }, hash };
+        }
+        return files;
+    }
+
+    void AssetCache::WriteIndex( const FileRecords& files ) const
+    {
+        const std::filesystem::path indexPath = m_directory / "index";
+        std::filesystem::path temporaryPath = indexPath;
+        temporaryPath += ".tmp";
+        {
+            std::ofstream stream( temporaryPath, std::ios::trunc );
+            stream << IndexHeader << '\n';
+            char fields[64];
+            for ( const auto& [path, record] : files )
+            {
+                std::snprintf( fields, sizeof( fields ), "%016" PRIx64 " %" PRIu64 " %" PRId64 " ", record.m_hash,
+                    record.m_stamp.m_size, record.m_stamp.m_writeTime );
+                stream << fields << path << '\n';
+            }
+            if ( !stream.flush() )
+                throw std::runtime_error( "Unable to write " + temporaryPath.string() );
+        }
+        std::filesystem::rename( temporaryPath, indexPath );
+    }
+
+    void AssetCache::SetRecord( const std::string& path, const FileRecord& record )
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        m_files[path] = record;
+        m_changed.insert( path );
+    }
+
+    std::string AssetCache::GetRecordPath( const std::filesystem::path& path )
+    {
+        // Relative and absolute spellings of a path share one record.
+        return std::filesystem::absolute( path ).lexically_normal().generic_string();
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "MeshCache.h"
+
+namespace Olex
+{
+    /**
+     * Streaming XXH64. Arithmetic values are hashed in host byte order, which is fine as long as
+     * a cache directory is not shared between hosts of different endianness.
+     */
+    class ContentHasher
+    {
+    public:
+        explicit ContentHasher( uint64_t seed = 0 );
+
+        void Update( const void* data, size_t size );
+        void Update( const std::string& text );
+        template <typename T>
+        void Update( T value )
+        {
+            static_assert( std::is_arithmetic_v<T>, "Hash structs field by field, padding bytes are not deterministic" );
+            Update( &value, sizeof( value ) );
+        }
+
+        [[nodiscard]] uint64_t Finish() const;
+
+    private:
+        uint64_t m_lanes[4];
+        uint8_t m_buffer[32];
+        size_t m_buffered = 0;
+        uint64_t m_length = 0;
+        uint64_t m_seed;
+    };
+
+    // Hashes the whole file; throws std::runtime_error when it cannot be read.
+    uint64_t HashFile( const std::filesystem::path& path );
+
+    // Counters of one run, safe to bump from the texture worker threads.
+    struct AssetCacheStats
+    {
+        std::atomic<uint64_t> m_hits{ 0 };
+        std::atomic<uint64_t> m_misses{ 0 };
+        // Sources read and hashed because the index had no record of their current size and write time.
+        std::atomic<uint64_t> m_sourcesHashed{ 0 };
+        std::atomic<uint64_t> m_bytesHashed{ 0 };
+        // Outputs copied out of the cache because they were missing or stale.
+        std::atomic<uint64_t> m_outputsCopied{ 0 };
+    };
+
+    /**
+     * Content-addressed store of baked outputs.
+     *
+     * Objects live under <directory>/objects, named by a key the caller derives from the hash of
+     * the source bytes, the import settings and the format versions, so an object never has to be
+     * invalidated: different inputs simply give a different key. One key may own several objects,
+     * one per extension (a model bakes to .mesh and .scene).
+     *
+     * The index file remembers, for every file path the cache has seen, its size and write time with
+     * the content hash of a source or the key of the object an output was copied from. Unchanged
+     * sources are not re-read to find their hash and unchanged outputs are not copied again.
+     *
+     * Several bakers may share the directory. Objects are baked into a private staging directory and
+     * renamed into place, so readers only ever see complete files; two bakers racing on the same key
+     * produce the same bytes and the first rename wins. The index is read and merged under a lock file.
+     */
+    class AssetCache
+    {
+    public:
+        // Creates the directory when needed and loads the index.
+        explicit AssetCache( const std::filesystem::path& directory );
+
+        // Content hash of the source, read from the index when its size and write time have not changed.
+        uint64_t HashSource( const std::filesystem::path& source );
+
+        [[nodiscard]] std::filesystem::path GetObjectPath( uint64_t key, const char* extension ) const;
+
+        /**
+         * Makes sure an object exists for every extension of key. On a miss, or always when force is set,
+         * bake is called with the paths to write, one per extension, in a staging directory.
+         * Returns true on a hit.
+         */
+        bool GetOrBake( uint64_t key, const std::vector<const char*>& extensions, bool force,
+            const std::function<void( const std::vector<std::filesystem::path>& outputs )>& bake );
+
+        // Copies the object to target unless target still holds the copy made by an earlier run.
+        void Materialize( uint64_t key, const char* extension, const std::filesystem::path& target );
+
+        // Merges the records of this run into the index file. Other bakers' records are kept.
+        void SaveIndex();
+
+        [[nodiscard]] const AssetCacheStats& GetStats() const { return m_stats; }
+
+    private:
+        struct FileRecord
+        {
+            SourceStamp m_stamp;
+            // Content hash for a source, object key for an output.
+            uint64_t m_hash = 0;
+        };
+
+        using FileRecords = std::unordered_map<std::string, FileRecord>;
+
+        std::filesystem::path m_directory;
+        std::mutex m_mutex;
+        FileRecords m_files;
+        // Records added or changed by this run, merged by SaveIndex.
+        std::unordered_set<std::string> m_changed;
+        AssetCacheStats m_stats;
+
+        [[nodiscard]] FileRecords ReadIndex() const;
+        void WriteIndex( const FileRecords& files ) const;
+        void SetRecord( const std::string& path, const FileRecord& record );
+        [[nodiscard]] static std::string GetRecordPath( const std::filesystem::path& path );
+    };
+}
@@ -0,0 +1,163 @@
+#include "ImageDecoder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <wincodec.h>
+#include <wrl/client.h>
+#endif
+
+namespace Olex
+{
+    namespace
+    {
+        std::runtime_error DecodeError( const std::filesystem::path& path, const char* reason )
+        {
+            return std::runtime_error( "Unable to decode " + path.string() + ": " + reason );
+        }
+
+        Image DecodeTga( const std::filesystem::path& path )
+        {
+            std::ifstream stream( path, std::ios::binary );
+            const std::vector<uint8_t> file( ( std::istreambuf_iterator<char>( stream ) ), std::istreambuf_iterator<char>() );
+            if ( !stream.eof() && !stream.good() )
+                throw DecodeError( path, "read failed" );
+            if ( file.size() < 18 )
+                throw DecodeError( path, "truncated header" );
+
+            const uint8_t idLength = file[0];
+            const uint8_t colorMapType = file[1];
+            const uint8_t imageType = file[2];
+            const uint32_t width = file[12] | ( file[13] << 8 );
+            const uint32_t height = file[14] | ( file[15] << 8 );
+            const uint32_t bytesPerPixel = file[16] / 8u;
+            const uint8_t descriptor = file[17];
+
+            const bool runLength = imageType == 10;
+            if ( colorMapType != 0 || ( imageType != 2 && !runLength ) || ( bytesPerPixel != 3 && bytesPerPixel != 4 ) )
+                throw DecodeError( path, "only true color TGA files are supported" );
+            if ( width == 0 || height == 0 )
+                throw DecodeError( path, "empty image" );
+
+            // Pixels in file order, BGR(A).
+            const size_t pixelCount = size_t( width ) * height;
+            std::vector<uint8_t> source( pixelCount * bytesPerPixel );
+            size_t read = 18 + idLength;
+            auto take = [&]( uint8_t* target, size_t size )
+            {
+                if ( read + size > file.size() )
+                    throw DecodeError( path, "truncated pixel data" );
+                std::memcpy( target, &file[read], size );
+                read += size;
+            };
+
+            if ( !runLength )
+            {
+                take( source.data(), source.size() );
+            }
+            else
+            {
+                for ( size_t pixel = 0; pixel < pixelCount; )
+                {
+                    uint8_t packet;
+                    take( &packet, 1 );
+                    const size_t count = std::min<size_t>( ( packet & 0x7F ) + 1u, pixelCount - pixel );
+                    if ( packet & 0x80 )
+                    {
+                        take( &source[pixel * bytesPerPixel], bytesPerPixel );
+                        for ( size_t i = 1; i < count; ++i )
+                            std::memcpy( &source[( pixel + i ) * bytesPerPixel], &source[pixel * bytesPerPixel], bytesPerPixel );
+                    }
+                    else
+                    {
+                        take( &source[pixel * bytesPerPixel], count * bytesPerPixel );
+                    }
+                    pixel += count;
+                }
+            }
+
+            // Rows are stored bottom-up unless the descriptor says top-down.
+            const bool topDown = ( descriptor & 0x20 ) != 0;
+            Image image;
+            image.m_width = width;
+            image.m_height = height;
+            image.m_pixels.resize( pixelCount * 4 );
+            for ( uint32_t y = 0; y < height; ++y )
+            {
+                const uint32_t sourceRow = topDown ? y : height - 1 - y;
+                for ( uint32_t x = 0; x < width; ++x )
+                {
+                    const uint8_t* texel = &source[( size_t( sourceRow ) * width + x ) * bytesPerPixel];
+                    uint8_t* target = &image.m_pixels[( size_t( y ) * width + x ) * 4];
+                    target[0] = texel[2];
+                    target[1] = texel[1];
+                    target[2] = texel[0];
+                    target[3] = bytesPerPixel == 4 ? texel[3] : 255;
+                }
+            }
+            return image;
+        }
+
+#if defined(_WIN32)
+        Image DecodeWic( const std::filesystem::path& path )
+        {
+            // Textures are decoded on worker threads, each one joins the multithreaded apartment for the call.
+            const HRESULT initialized = ::CoInitializeEx( nullptr, COINIT_MULTITHREADED );
+            struct Uninitialize
+            {
+                bool m_active;
+                ~Uninitialize() { if ( m_active ) ::CoUninitialize(); }
+            } uninitialize{ SUCCEEDED( initialized ) };
+
+            using Microsoft::WRL::ComPtr;
+            ComPtr<IWICImagingFactory> factory;
+            ComPtr<IWICBitmapDecoder> decoder;
+            ComPtr<IWICBitmapFrameDecode> frame;
+            ComPtr<IWICFormatConverter> converter;
+            if ( FAILED( ::CoCreateInstance( CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS( &factory ) ) ) ||
+                FAILED( factory->CreateDecoderFromFilename( path.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder ) ) ||
+                FAILED( decoder->GetFrame( 0, &frame ) ) ||
+                FAILED( factory->CreateFormatConverter( &converter ) ) ||
+                FAILED( converter->Initialize( frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom ) ) )
+            {
+                throw DecodeError( path, "WIC could not read the file" );
+            }
+
+            UINT width = 0;
+            UINT height = 0;
+            converter->GetSize( &width, &height );
+            if ( width == 0 || height == 0 )
+                throw DecodeError( path, "empty image" );
+
+            Image image;
+            image.m_width = width;
+            image.m_height = height;
+            image.m_pixels.resize( size_t( width ) * height * 4 );
+            if ( FAILED( converter->CopyPixels( nullptr, width * 4, static_cast<UINT>( image.m_pixels.size() ), image.m_pixels.data() ) ) )
+                throw DecodeError( path, "WIC could not convert the pixels" );
+            return image;
+        }
+#endif
+    }
+
+    Image DecodeImage( const std::filesystem::path& path )
+    {
+        std::string extension = path.extension().string();
+        std::transform( extension.begin(), extension.end(), extension.begin(), []( unsigned char c ) { return static_cast<char>( std::tolower( c ) ); } );
+        if ( extension == ".tga" )
+            return DecodeTga( path );
+
+#if defined(_WIN32)
+        return DecodeWic( path );
+#else
+        throw DecodeError( path, "only TGA images can be decoded without WIC" );
+#endif
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+
+#include "TextureCache.h"
+
+namespace Olex
+{
+    /**
+     * Decodes an image file into 8-bit RGBA.
+     *
+     * Uncompressed and run-length encoded 24/32-bit TGA files are read on every platform.
+     * Everything else (jpg, png, bmp, ...) goes through WIC and is only available on Windows.
+     * Throws std::runtime_error when the file cannot be decoded.
+     */
+    Image DecodeImage( const std::filesystem::path& path );
+}
@@ -1,10 +1,14 @@
 #include "BaseGameInterface.h"
 
+#include <stdexcept>
+#include <vector>
 #include <wrl/client.h>
 
 #include "CommandQueue.h"
 #include "d3dx12.h"
 #include "DX12App.h"
+#include "TextureCache.h"
+#include "UploadService.h"
 
 namespace Olex
 {
@@ -38,10 +42,7 @@ namespace Olex
     }
 
 
-    void BaseGameInterface::UpdateBufferResource(
-        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> commandList,
-        ID3D12Resource** pDestinationResource,
-        ID3D12Resource** pIntermediateResource,
+    void BaseGameInterface::UpdateBufferResource( ID3D12Resource** pDestinationResource,
         size_t numElements, size_t elementSize, const void* bufferData,
         D3D12_RESOURCE_FLAGS flags )
     {
@@ -50,36 +51,55 @@ namespace Olex
         const size_t bufferSize = numElements * elementSize;
 
         // Create a committed resource for the GPU resource in a default heap.
+        // The copy queue promotes it from the common state, see UploadService.
         ThrowIfFailed( device->CreateCommittedResource(
             &CD3DX12_HEAP_PROPERTIES( D3D12_HEAP_TYPE_DEFAULT ),
             D3D12_HEAP_FLAG_NONE,
             &CD3DX12_RESOURCE_DESC::Buffer( bufferSize, flags ),
-            D3D12_RESOURCE_STATE_COPY_DEST,
+            D3D12_RESOURCE_STATE_COMMON,
             nullptr,
             IID_PPV_ARGS( pDestinationResource ) ) );
 
-        // Create an committed resource for the upload.
         if ( bufferData )
         {
-            ThrowIfFailed( device->CreateCommittedResource(
-                &CD3DX12_HEAP_PROPERTIES( D3D12_HEAP_TYPE_UPLOAD ),
-                D3D12_HEAP_FLAG_NONE,
-                &CD3DX12_RESOURCE_DESC::Buffer( bufferSize ),
-                D3D12_RESOURCE_STATE_GENERIC_READ,
-                nullptr,
-                IID_PPV_ARGS( pIntermediateResource ) ) );
-
-            D3D12_SUBRESOURCE_DATA subresourceData = {};
-            subresourceData.pData = bufferData;
-            subresourceData.RowPitch = bufferSize;
-            subresourceData.SlicePitch = subresourceData.RowPitch;
-
-            UpdateSubresources( commandList.Get(),
-                *pDestinationResource, *pIntermediateResource,
-                0, 0, 1, &subresourceData );
+            m_app.GetUploadService().UploadBuffer( *pDestinationResource, 0, bufferData, bufferSize );
         }
     }
 
+    Microsoft::WRL::ComPtr<ID3D12Resource> BaseGameInterface::LoadBakedTexture( UploadService& uploadService,
+        const std::filesystem::path& texturePath )
+    {
+        const MappedTextureCache texture( texturePath );
+        if ( !texture.IsValid() )
+        {
+            throw std::runtime_error( texturePath.string() + " is missing or was baked by an older version, run the asset baker" );
+        }
+
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+        ThrowIfFailed( m_app.GetDevice()->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES( D3D12_HEAP_TYPE_DEFAULT ),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Tex2D( static_cast<DXGI_FORMAT>( texture.GetFormat() ),
+                texture.GetWidth(), texture.GetHeight(), 1, static_cast<UINT16>( texture.GetMipCount() ) ),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS( resource.ReleaseAndGetAddressOf() ) ) );
+
+        // Rows are already padded to the D3D12 pitch alignment, so each mip is copied as is.
+        std::vector<D3D12_SUBRESOURCE_DATA> subresources( texture.GetMipCount() );
+        for ( uint32_t mip = 0; mip < texture.GetMipCount(); ++mip )
+        {
+            const TextureMipView view = texture.GetMip( mip );
+            subresources[mip].pData = view.m_pixels;
+            subresources[mip].RowPitch = view.m_rowPitch;
+            subresources[mip].SlicePitch = LONG_PTR( view.m_rowPitch ) * view.m_height;
+        }
+
+        // The upload copies into staging memory, the mapping can go once it returns.
+        uploadService.UploadTexture( resource.Get(), 0, subresources.data(), static_cast<uint32_t>( subresources.size() ) );
+        return resource;
+    }
+
     void BaseGameInterface::ThrowIfFailed( HRESULT hr )
     {
         if ( FAILED( hr ) )
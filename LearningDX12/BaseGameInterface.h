@@ -1,10 +1,13 @@
 #pragma once
+#include <filesystem>
 #include <wrl/client.h>
 
 #include "CommandQueue.h"
 
 namespace Olex
 {
+    class UploadService;
+
     struct UpdateEventArgs
     {
         double m_elapsedTime = 0;
@@ -45,14 +48,19 @@ namespace Olex
             D3D12_CPU_DESCRIPTOR_HANDLE dsv,
             FLOAT depth = 1.0f );
 
-        void UpdateBufferResource( Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> commandList,
-            ID3D12Resource** pDestinationResource,
-            ID3D12Resource** pIntermediateResource,
+        // Creates the buffer in the common state and queues the upload of bufferData, if any, on the upload service.
+        void UpdateBufferResource( ID3D12Resource** pDestinationResource,
             size_t numElements,
             size_t elementSize,
             const void* bufferData,
             D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE );
 
+        // Creates a texture with every mip of a baked texture (see TextureCache) and queues their upload
+        // on the upload service. The texture is left in the common state, from which pixel shaders can
+        // read it once the upload completes. Throws if the file is missing or invalid.
+        Microsoft::WRL::ComPtr<ID3D12Resource> LoadBakedTexture( UploadService& uploadService,
+            const std::filesystem::path& texturePath );
+
         void ThrowIfFailed( HRESULT hr );
 
     protected:
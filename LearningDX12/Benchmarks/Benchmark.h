@@ -0,0 +1,36 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+/**
+ * Timing helpers for the benchmark executables. They are built with the headless tree but not
+ * registered with CTest: timings depend on the machine, so they print numbers instead of checking
+ * them. What the numbers rely on being correct is covered by the tests.
+ */
+namespace Olex::Benchmark
+{
+    // Best of repetitions runs of function, in milliseconds. The best run is the least disturbed by the rest of the system.
+    template <typename Function>
+    double MeasureMilliseconds( int repetitions, Function&& function )
+    {
+        double best = 1e30;
+        for ( int repetition = 0; repetition < repetitions; ++repetition )
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min( best, std::chrono::duration<double, std::milli>( end - start ).count() );
+        }
+        return best;
+    }
+
+    // Keeps the optimizer from dropping a result that is otherwise unused.
+    inline void KeepAlive( float value )
+    {
+        static volatile float sink;
+        sink = value;
+        (void)sink;
+    }
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Mesh.h"
+#include "MeshBounds.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+namespace
+{
+    BoundingVolume ScalarBox( const std::vector<Mesh::VertexInfo>& vertices )
+    {
+        BoundingVolume volume;
+        volume.m_min = { FLT_MAX, FLT_MAX, FLT_MAX };
+        volume.m_max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for ( const Mesh::VertexInfo& vertex : vertices )
+        {
+            const DirectX::XMFLOAT3& p = vertex.m_position;
+            volume.m_min = { std::min( volume.m_min.x, p.x ), std::min( volume.m_min.y, p.y ), std::min( volume.m_min.z, p.z ) };
+            volume.m_max = { std::max( volume.m_max.x, p.x ), std::max( volume.m_max.y, p.y ), std::max( volume.m_max.z, p.z ) };
+        }
+        return volume;
+    }
+
+    float Distance( const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b )
+    {
+        return std::sqrt( ( a.x - b.x ) * ( a.x - b.x ) + ( a.y - b.y ) * ( a.y - b.y ) + ( a.z - b.z ) * ( a.z - b.z ) );
+    }
+
+    // Plain Ritter: the farthest point from the first, the farthest from that, then grow one point at a time.
+    float ScalarRitterRadius( const std::vector<Mesh::VertexInfo>& vertices )
+    {
+        const auto farthestFrom = [&vertices]( const DirectX::XMFLOAT3& from )
+        {
+            return std::max_element( vertices.begin(), vertices.end(), [&from]( const Mesh::VertexInfo& lhs, const Mesh::VertexInfo& rhs )
+            {
+                return Distance( lhs.m_position, from ) < Distance( rhs.m_position, from );
+            } )->m_position;
+        };
+        const DirectX::XMFLOAT3 a = farthestFrom( vertices[0].m_position );
+        const DirectX::XMFLOAT3 b = farthestFrom( a );
+
+        DirectX::XMFLOAT3 center = { ( a.x + b.x ) / 2, ( a.y + b.y ) / 2, ( a.z + b.z ) / 2 };
+        float radius = Distance( a, b ) / 2;
+        for ( const Mesh::VertexInfo& vertex : vertices )
+        {
+            const DirectX::XMFLOAT3& p = vertex.m_position;
+            const float distance = Distance( p, center );
+            if ( distance <= radius )
+                continue;
+
+            const float grown = ( radius + distance ) / 2;
+            const float shift = ( grown - radius ) / distance;
+            center = { center.x + ( p.x - center.x ) * shift, center.y + ( p.y - center.y ) * shift, center.z + ( p.z - center.z ) * shift };
+            radius = grown;
+        }
+        return radius;
+    }
+}
+
+int main()
+{
+    // Points on an ellipsoid with semi-axes 3, 1.5 and 0.5, so the optimal sphere has radius 3.
+    Test::Random random( 1 );
+    std::vector<Mesh::VertexInfo> vertices( 1 << 20 );
+    for ( Mesh::VertexInfo& vertex : vertices )
+    {
+        const float z = random.Range( -1.f, 1.f );
+        const float phi = random.Range( 0.f, 2.f * Test::Pi );
+        const float r = std::sqrt( 1.f - z * z );
+        vertex = Test::MakeVertex( 3.f * r * std::cos( phi ) + 1.f, 1.5f * r * std::sin( phi ) - 2.f, 0.5f * z + 4.f, 0, 0, 0, 0, 0 );
+    }
+
+    const DirectX::XMFLOAT3* positions = &vertices[0].m_position;
+    const size_t stride = sizeof( Mesh::VertexInfo );
+#if defined(__AVX2__)
+    const char* path = "AVX2";
+#else
+    const char* path = "SSE";
+#endif
+
+    DirectX::XMFLOAT3 minimum, maximum;
+    BoundingVolume volume;
+    float ritterRadius = 0.f;
+    const double scalarBox = Benchmark::MeasureMilliseconds( 20, [&] { Benchmark::KeepAlive( ScalarBox( vertices ).m_max.x ); } );
+    const double simdBox = Benchmark::MeasureMilliseconds( 20, [&] { ComputeBoundingBox( positions, vertices.size(), stride, minimum, maximum ); } );
+    const double simdVolume = Benchmark::MeasureMilliseconds( 20, [&] { volume = ComputeBounds( positions, vertices.size(), stride ); } );
+    const double scalarRitter = Benchmark::MeasureMilliseconds( 5, [&] { ritterRadius = ScalarRitterRadius( vertices ); } );
+
+    std::printf( "%zu vertices, %zu byte stride, %s build\n", vertices.size(), stride, path );
+    std::printf( "  scalar box                  %8.2f ms\n", scalarBox );
+    std::printf( "  %-4s box                    %8.2f ms\n", path, simdBox );
+    std::printf( "  ComputeBounds (box, sphere) %8.2f ms\n", simdVolume );
+    std::printf( "  scalar Ritter sphere        %8.2f ms\n", scalarRitter );
+    std::printf( "sphere radius %.5f, plain Ritter %.5f, optimum 3\n", volume.m_sphereRadius, ritterRadius );
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+namespace
+{
+    struct Vector
+    {
+        float x, y, z;
+    };
+
+    Vector operator- ( const Vector& a, const Vector& b ) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    Vector operator+ ( const Vector& a, const Vector& b ) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    Vector operator* ( const Vector& a, float s ) { return { a.x * s, a.y * s, a.z * s }; }
+    float Dot( const Vector& a, const Vector& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vector ToVector( const DirectX::XMFLOAT3& p ) { return { p.x, p.y, p.z }; }
+
+    // Closest point on triangle abc to p, Ericson's Real-Time Collision Detection 5.1.5.
+    Vector ClosestPointOnTriangle( const Vector& p, const Vector& a, const Vector& b, const Vector& c )
+    {
+        const Vector ab = b - a, ac = c - a, ap = p - a;
+        const float d1 = Dot( ab, ap ), d2 = Dot( ac, ap );
+        if ( d1 <= 0.f && d2 <= 0.f )
+            return a;
+
+        const Vector bp = p - b;
+        const float d3 = Dot( ab, bp ), d4 = Dot( ac, bp );
+        if ( d3 >= 0.f && d4 <= d3 )
+            return b;
+
+        const float vc = d1 * d4 - d3 * d2;
+        if ( vc <= 0.f && d1 >= 0.f && d3 <= 0.f )
+            return a + ab * ( d1 / ( d1 - d3 ) );
+
+        const Vector cp = p - c;
+        const float d5 = Dot( ab, cp ), d6 = Dot( ac, cp );
+        if ( d6 >= 0.f && d5 <= d6 )
+            return c;
+
+        const float vb = d5 * d2 - d1 * d6;
+        if ( vb <= 0.f && d2 >= 0.f && d6 <= 0.f )
+            return a + ac * ( d2 / ( d2 - d6 ) );
+
+        const float va = d3 * d6 - d5 * d4;
+        if ( va <= 0.f && d4 - d3 >= 0.f && d5 - d6 >= 0.f )
+            return b + ( c - b ) * ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) );
+
+        const float denominator = 1.f / ( va + vb + vc );
+        return a + ab * ( vb * denominator ) + ac * ( vc * denominator );
+    }
+
+    /**
+     * Distance from points to a triangle soup, through a uniform grid of cells that the triangle
+     * boxes are binned into. A query searches rings of cells outward until the ring is farther away
+     * than the closest triangle found.
+     */
+    class SurfaceDistance
+    {
+    public:
+        SurfaceDistance( const Mesh& mesh, const std::vector<DirectX::XMINT3>& triangles, int resolution )
+            : m_mesh( mesh )
+            , m_triangles( triangles )
+            , m_resolution( resolution )
+        {
+            m_minimum = { 1e30f, 1e30f, 1e30f };
+            Vector maximum = { -1e30f, -1e30f, -1e30f };
+            for ( const Mesh::VertexInfo& vertex : mesh.m_vertices )
+            {
+                m_minimum = { std::min( m_minimum.x, vertex.m_position.x ), std::min( m_minimum.y, vertex.m_position.y ), std::min( m_minimum.z, vertex.m_position.z ) };
+                maximum = { std::max( maximum.x, vertex.m_position.x ), std::max( maximum.y, vertex.m_position.y ), std::max( maximum.z, vertex.m_position.z ) };
+            }
+            m_cellSize = std::max( { maximum.x - m_minimum.x, maximum.y - m_minimum.y, maximum.z - m_minimum.z } ) / resolution * 1.0001f;
+
+            m_cells.resize( size_t( resolution ) * resolution * resolution );
+            for ( uint32_t triangle = 0; triangle < triangles.size(); ++triangle )
+            {
+                int low[3] = { resolution, resolution, resolution };
+                int high[3] = { 0, 0, 0 };
+                for ( int32_t vertex : { triangles[triangle].x, triangles[triangle].y, triangles[triangle].z } )
+                {
+                    int cell[3];
+                    ToCell( ToVector( mesh.m_vertices[vertex].m_position ), cell );
+                    for ( int axis = 0; axis < 3; ++axis )
+                    {
+                        low[axis] = std::min( low[axis], cell[axis] );
+                        high[axis] = std::max( high[axis], cell[axis] );
+                    }
+                }
+                for ( int z = low[2]; z <= high[2]; ++z )
+                    for ( int y = low[1]; y <= high[1]; ++y )
+                        for ( int x = low[0]; x <= high[0]; ++x )
+                            m_cells[Index( x, y, z )].push_back( triangle );
+            }
+        }
+
+        float Get( const Vector& p ) const
+        {
+            int center[3];
+            ToCell( p, center );
+
+            float best = 1e30f;
+            for ( int ring = 0; ring < m_resolution; ++ring )
+            {
+                // Everything in this ring or beyond is at least ( ring - 1 ) cells away.
+                if ( ring > 0 && best <= ( ring - 1 ) * m_cellSize )
+                    break;
+
+                for ( int z = center[2] - ring; z <= center[2] + ring; ++z )
+                {
+                    for ( int y = center[1] - ring; y <= center[1] + ring; ++y )
+                    {
+                        for ( int x = center[0] - ring; x <= center[0] + ring; ++x )
+                        {
+                            const bool onRing = std::abs( x - center[0] ) == ring || std::abs( y - center[1] ) == ring || std::abs( z - center[2] ) == ring;
+                            if ( !onRing || x < 0 || y < 0 || z < 0 || x >= m_resolution || y >= m_resolution || z >= m_resolution )
+                                continue;
+
+                            for ( uint32_t triangle : m_cells[Index( x, y, z )] )
+                            {
+                                const DirectX::XMINT3& corners = m_triangles[triangle];
+                                const Vector closest = ClosestPointOnTriangle( p, ToVector( m_mesh.m_vertices[corners.x].m_position ),
+                                    ToVector( m_mesh.m_vertices[corners.y].m_position ), ToVector( m_mesh.m_vertices[corners.z].m_position ) );
+                                const Vector offset = p - closest;
+                                best = std::min( best, std::sqrt( Dot( offset, offset ) ) );
+                            }
+                        }
+                    }
+                }
+            }
+            return best;
+        }
+
+    private:
+        const Mesh& m_mesh;
+        const std::vector<DirectX::XMINT3>& m_triangles;
+        int m_resolution;
+        Vector m_minimum;
+        float m_cellSize;
+        std::vector<std::vector<uint32_t>> m_cells;
+
+        void ToCell( const Vector& p, int ( &cell )[3] ) const
+        {
+            const float coordinates[3] = { p.x - m_minimum.x, p.y - m_minimum.y, p.z - m_minimum.z };
+            for ( int axis = 0; axis < 3; ++axis )
+                cell[axis] = std::clamp( static_cast<int>( coordinates[axis] / m_cellSize ), 0, m_resolution - 1 );
+        }
+
+        size_t Index( int x, int y, int z ) const { return ( size_t( z ) * m_resolution + y ) * m_resolution + x; }
+    };
+
+    // Unit sphere with a bumpy surface, open at the poles and with a uv seam, so borders and seams are exercised.
+    Mesh MakeBumpySphere( uint32_t rings, uint32_t segments )
+    {
+        Mesh mesh = Test::MakeSphereMesh( rings, segments, 0.06f, Test::Pi - 0.06f );
+        for ( Mesh::VertexInfo& vertex : mesh.m_vertices )
+        {
+            const float theta = std::acos( std::clamp( vertex.m_normal.y, -1.f, 1.f ) );
+            const float phi = vertex.m_uv.x * 2.f * Test::Pi;
+            const float radius = 1.f + 0.03f * std::sin( 5.f * phi ) * std::sin( 7.f * theta );
+            vertex.m_position = { vertex.m_normal.x * radius, vertex.m_normal.y * radius, vertex.m_normal.z * radius };
+        }
+        return mesh;
+    }
+}
+
+/**
+ * Quality of the LOD chain: for every level, how far the vertices of the full mesh are from the
+ * simplified surface, against the error the level records. Pass the number of rings, 700 by default
+ * for about a million triangles.
+ */
+int main( int argc, char** argv )
+{
+    const uint32_t rings = argc > 1 ? static_cast<uint32_t>( std::atoi( argv[1] ) ) : 700;
+    const Mesh mesh = MakeBumpySphere( rings, rings );
+    std::printf( "%zu triangles, %zu vertices\n", mesh.m_indices.size(), mesh.m_vertices.size() );
+
+    std::vector<MeshLod> lods;
+    const double milliseconds = Benchmark::MeasureMilliseconds( 1, [&] { lods = BuildLodChain( mesh, 5 ); } );
+    std::printf( "BuildLodChain( 5 levels ) %.0f ms\n", milliseconds );
+
+    std::printf( "  level  triangles  m_error    mean dist  rms dist   max dist   max/m_error\n" );
+    for ( size_t level = 0; level < lods.size(); ++level )
+    {
+        const MeshLod& lod = lods[level];
+        const SurfaceDistance distance( mesh, lod.m_indices, 64 );
+
+        double sum = 0.0, sumSquares = 0.0;
+        float maximum = 0.f;
+        for ( const Mesh::VertexInfo& vertex : mesh.m_vertices )
+        {
+            const float d = distance.Get( ToVector( vertex.m_position ) );
+            sum += d;
+            sumSquares += double( d ) * d;
+            maximum = std::max( maximum, d );
+        }
+        const double count = double( mesh.m_vertices.size() );
+        std::printf( "  %5zu  %9zu  %.6f   %.6f   %.6f   %.6f   %.2f\n", level, lod.m_indices.size(), lod.m_error,
+            sum / count, std::sqrt( sumSquares / count ), maximum, lod.m_error > 0.f ? maximum / lod.m_error : 0.f );
+    }
+    return 0;
+}
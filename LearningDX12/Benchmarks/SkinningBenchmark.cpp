@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.h"
+#include "SkinningKernel.h"
+#include "TestMeshes.h"
+#include "ThreadPool.h"
+
+using namespace Olex;
+
+int main()
+{
+    // A crowd: every character shares the bind pose and has a pose of its own.
+    const size_t characterCount = 100;
+    const size_t vertexCount = 10000;
+    const uint32_t jointCount = 64;
+
+    Test::Random random( 1 );
+    std::vector<Mesh::VertexInfo> vertices;
+    std::vector<VertexSkin> skin;
+    Test::MakeRandomSkinnedVertices( vertexCount, jointCount, random, vertices, skin );
+    const std::vector<DirectX::XMFLOAT4X4> palettes = Test::MakeRandomPalette( characterCount * jointCount, random );
+
+    std::vector<Mesh::VertexInfo> output( characterCount * vertexCount );
+    std::vector<Mesh::VertexInfo> reference( characterCount * vertexCount );
+    std::vector<SkinningJob> jobs( characterCount );
+    std::vector<SkinningJob> referenceJobs( characterCount );
+    for ( size_t character = 0; character < characterCount; ++character )
+    {
+        jobs[character] = { vertices.data(), skin.data(), vertexCount, &palettes[character * jointCount], &output[character * vertexCount] };
+        referenceJobs[character] = jobs[character];
+        referenceJobs[character].m_output = &reference[character * vertexCount];
+    }
+
+#if defined(__AVX2__)
+    const char* path = "AVX2";
+#else
+    const char* path = "SSE2";
+#endif
+
+    // The kernels against each other on one thread, then the SIMD kernel spread over the pool.
+    const double scalar = Benchmark::MeasureMilliseconds( 10, [&] { for ( const SkinningJob& job : referenceJobs ) SkinVerticesReference( job ); } );
+    const double simd = Benchmark::MeasureMilliseconds( 10, [&] { for ( const SkinningJob& job : jobs ) SkinVertices( job ); } );
+    const double threaded = Benchmark::MeasureMilliseconds( 10, [&] { SkinJobs( jobs.data(), jobs.size() ); } );
+
+    float maxDifference = 0.f;
+    for ( size_t i = 0; i < output.size(); ++i )
+    {
+        const Mesh::VertexInfo& a = output[i];
+        const Mesh::VertexInfo& b = reference[i];
+        maxDifference = std::max( { maxDifference,
+            std::fabs( a.m_position.x - b.m_position.x ), std::fabs( a.m_position.y - b.m_position.y ), std::fabs( a.m_position.z - b.m_position.z ),
+            std::fabs( a.m_normal.x - b.m_normal.x ), std::fabs( a.m_normal.y - b.m_normal.y ), std::fabs( a.m_normal.z - b.m_normal.z ) } );
+    }
+
+    const double skinned = double( characterCount * vertexCount );
+    std::printf( "%zu characters x %zu vertices, %u joints, %s build, %u pool threads, %u hardware threads\n", characterCount, vertexCount,
+        jointCount, path, ThreadPool::Get().GetThreadCount(), std::thread::hardware_concurrency() );
+    std::printf( "  scalar, 1 thread     %8.2f ms %8.1f Mvertices/s\n", scalar, skinned / scalar / 1000.0 );
+    std::printf( "  %-4s, 1 thread       %8.2f ms %8.1f Mvertices/s, %.2fx scalar\n", path, simd, skinned / simd / 1000.0, scalar / simd );
+    std::printf( "  %-4s, SkinJobs       %8.2f ms %8.1f Mvertices/s, %.2fx one thread\n", path, threaded, skinned / threaded / 1000.0, simd / threaded );
+    std::printf( "max difference to the scalar kernel %g\n", maxDifference );
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "Benchmark.h"
+#include "TangentGenerator.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+int main()
+{
+    const Mesh source = Test::MakeSphereMesh( 1024, 2048 );
+
+    // Generating appends vertices, so every run starts from a fresh copy that is not timed.
+    double best = 1e30;
+    for ( int run = 0; run < 3; ++run )
+    {
+        Mesh mesh = source;
+        best = std::min( best, Benchmark::MeasureMilliseconds( 1, [&mesh] { GenerateTangents( mesh ); } ) );
+    }
+
+    std::printf( "%zu triangles, %zu vertices, %u hardware threads\n", source.m_indices.size(), source.m_vertices.size(),
+        std::thread::hardware_concurrency() );
+    std::printf( "  GenerateTangents %8.1f ms\n", best );
+    return 0;
+}
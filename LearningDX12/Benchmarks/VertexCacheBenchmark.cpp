@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Benchmark.h"
+#include "TestMeshes.h"
+#include "VertexCacheOptimizer.h"
+
+using namespace Olex;
+
+namespace
+{
+    void Run( const char* name, const std::vector<DirectX::XMINT3>& source, size_t vertexCount )
+    {
+        // Optimizing works in place, so every run starts from a fresh copy that is not timed.
+        std::vector<DirectX::XMINT3> optimized;
+        double best = 1e30;
+        for ( int run = 0; run < 3; ++run )
+        {
+            optimized = source;
+            best = std::min( best, Benchmark::MeasureMilliseconds( 1, [&] { OptimizeVertexCache( optimized, vertexCount ); } ) );
+        }
+
+        const VertexCacheStatistics before = AnalyzeVertexCache( source, vertexCount );
+        const VertexCacheStatistics after = AnalyzeVertexCache( optimized, vertexCount );
+        std::printf( "  %-9s %8.1f ms   ACMR %.3f -> %.3f   ATVR %.3f -> %.3f\n", name, best, before.m_acmr, after.m_acmr, before.m_atvr, after.m_atvr );
+    }
+}
+
+/**
+ * OptimizeVertexCache on a large grid, in the scanline order it is built in and shuffled as the
+ * worst case. Statistics are for a 16 entry FIFO cache. Pass the grid size, 708 by default for
+ * about a million triangles.
+ */
+int main( int argc, char** argv )
+{
+    const uint32_t size = argc > 1 ? static_cast<uint32_t>( std::atoi( argv[1] ) ) : 708;
+    const Mesh grid = Test::MakeGridMesh( size );
+    std::printf( "%zu triangles, %zu vertices\n", grid.m_indices.size(), grid.m_vertices.size() );
+
+    Run( "scanline", grid.m_indices, grid.m_vertices.size() );
+
+    std::vector<DirectX::XMINT3> shuffled = grid.m_indices;
+    Test::ShuffleTriangles( shuffled, 1 );
+    Run( "shuffled", shuffled, grid.m_vertices.size() );
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Mesh.h"
+#include "TestMeshes.h"
+#include "VertexWeld.h"
+
+using namespace Olex;
+
+namespace
+{
+    // Number of distinct corners by sorting their bytes, the plain alternative to hashing.
+    size_t CountDistinctBySorting( const std::vector<Mesh::VertexInfo>& corners )
+    {
+        std::vector<uint32_t> order( corners.size() );
+        std::iota( order.begin(), order.end(), 0u );
+        const auto less = [&corners]( uint32_t a, uint32_t b ) { return std::memcmp( &corners[a], &corners[b], sizeof( Mesh::VertexInfo ) ) < 0; };
+        std::sort( order.begin(), order.end(), less );
+
+        size_t distinct = order.empty() ? 0 : 1;
+        for ( size_t i = 1; i < order.size(); ++i )
+            distinct += less( order[i - 1], order[i] );
+        return distinct;
+    }
+}
+
+/**
+ * Welding the triangle corners of a sphere as ReadMesh gathers them, three per triangle. Every
+ * eighth ring is flat shaded, so hard edges split vertices as in a real model. Pass the number of
+ * rings, 708 by default for about a million triangles.
+ */
+int main( int argc, char** argv )
+{
+    const uint32_t rings = argc > 1 ? static_cast<uint32_t>( std::atoi( argv[1] ) ) : 708;
+    const Mesh sphere = Test::MakeSphereMesh( rings, rings );
+
+    std::vector<Mesh::VertexInfo> corners;
+    std::vector<uint32_t> controlPoints;
+    corners.reserve( sphere.m_indices.size() * 3 );
+    controlPoints.reserve( sphere.m_indices.size() * 3 );
+    for ( size_t triangle = 0; triangle < sphere.m_indices.size(); ++triangle )
+    {
+        const DirectX::XMINT3& indices = sphere.m_indices[triangle];
+        const DirectX::XMFLOAT3& a = sphere.m_vertices[indices.x].m_position;
+        const DirectX::XMFLOAT3& b = sphere.m_vertices[indices.y].m_position;
+        const DirectX::XMFLOAT3& c = sphere.m_vertices[indices.z].m_position;
+        const float e1[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+        const float e2[3] = { c.x - a.x, c.y - a.y, c.z - a.z };
+        float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        const float length = std::sqrt( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+        const bool flat = ( triangle / ( 2 * rings ) ) % 8 == 0 && length > 0.f;
+
+        for ( int32_t index : { indices.x, indices.y, indices.z } )
+        {
+            Mesh::VertexInfo corner = sphere.m_vertices[index];
+            if ( flat )
+                corner.m_normal = { normal[0] / length, normal[1] / length, normal[2] / length };
+            corners.push_back( corner );
+            controlPoints.push_back( static_cast<uint32_t>( index ) );
+        }
+    }
+
+    Mesh welded;
+    Mesh keyed;
+    size_t sorted = 0;
+    const double weld = Benchmark::MeasureMilliseconds( 5, [&] { welded = WeldVertices( corners ); } );
+    const double weldKeyed = Benchmark::MeasureMilliseconds( 5, [&] { keyed = WeldVertices( corners, controlPoints ); } );
+    const double sort = Benchmark::MeasureMilliseconds( 1, [&] { sorted = CountDistinctBySorting( corners ); } );
+
+    std::printf( "%zu triangles, %zu corners, %zu control points\n", sphere.m_indices.size(), corners.size(), sphere.m_vertices.size() );
+    std::printf( "  WeldVertices                  %8.1f ms %8.1f Mcorners/s, %zu vertices\n", weld, corners.size() / weld / 1000.0, welded.m_vertices.size() );
+    std::printf( "  WeldVertices, control points  %8.1f ms %8.1f Mcorners/s, %zu vertices\n", weldKeyed, corners.size() / weldKeyed / 1000.0, keyed.m_vertices.size() );
+    std::printf( "  sort and count                %8.1f ms %8.1f Mcorners/s, %zu vertices\n", sort, corners.size() / sort / 1000.0, sorted );
+    std::printf( "vertex buffer %.1f MB welded, %.1f MB one vertex per corner\n", welded.m_vertices.size() * sizeof( Mesh::VertexInfo ) / 1e6,
+        corners.size() * sizeof( Mesh::VertexInfo ) / 1e6 );
+    return 0;
+}
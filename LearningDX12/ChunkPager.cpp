@@ -0,0 +1,153 @@
+#include "ChunkPager.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Olex
+{
+    StagingPool::StagingPool( uint8_t* memory, size_t capacity )
+        : m_memory( memory )
+        , m_ranges( capacity )
+    {
+    }
+
+    uint64_t StagingPool::Acquire( size_t size )
+    {
+        return m_ranges.Allocate( size, ChunkedMeshFormat::BlobAlignment );
+    }
+
+    void StagingPool::Release( uint64_t offset, size_t size )
+    {
+        m_ranges.Free( offset, size );
+    }
+
+    void HostChunkSink::Upload( uint32_t chunkIndex, const ChunkedMeshChunk& chunk, uint64_t stagingOffset )
+    {
+        const uint8_t* staged = m_staging.data() + stagingOffset;
+        m_chunks[chunkIndex].assign( staged, staged + chunk.m_size );
+    }
+
+    const std::vector<uint8_t>* HostChunkSink::GetChunkData( uint32_t chunkIndex ) const
+    {
+        const auto found = m_chunks.find( chunkIndex );
+        return found != m_chunks.end() ? &found->second : nullptr;
+    }
+
+    ChunkPager::ChunkPager( ChunkedMeshFile& file, ChunkUploadSink& sink, uint64_t residentBudget )
+        : m_file( file )
+        , m_sink( sink )
+        , m_staging( sink.GetStagingMemory(), sink.GetStagingCapacity() )
+        , m_residentBudget( residentBudget )
+        , m_chunks( file.GetChunkCount() )
+    {
+        if ( file.GetLargestChunkSize() > residentBudget )
+        {
+            throw std::invalid_argument( "Chunk pager budget is smaller than the largest chunk" );
+        }
+        if ( file.GetLargestChunkSize() > sink.GetStagingCapacity() )
+        {
+            throw std::invalid_argument( "Chunk pager staging memory is smaller than the largest chunk" );
+        }
+    }
+
+    void ChunkPager::RetireUploads()
+    {
+        auto retire = [this]( uint32_t chunkIndex )
+        {
+            ChunkSlot& slot = m_chunks[chunkIndex];
+            if ( !m_sink.IsComplete( slot.m_ticket ) )
+                return false;
+
+            m_staging.Release( slot.m_stagingOffset, m_file.GetChunk( chunkIndex ).m_size );
+            slot.m_state = ChunkState::Resident;
+            --m_stats.m_uploadingChunks;
+            ++m_stats.m_residentChunks;
+            return true;
+        };
+        m_uploading.erase( std::remove_if( m_uploading.begin(), m_uploading.end(), retire ), m_uploading.end() );
+    }
+
+    bool ChunkPager::EvictOne()
+    {
+        if ( m_evictable.empty() )
+        {
+            // Gathered once per update, oldest last. Nothing requested by this update is ever added.
+            for ( uint32_t chunkIndex = 0; chunkIndex < m_chunks.size(); ++chunkIndex )
+            {
+                if ( m_chunks[chunkIndex].m_state == ChunkState::Resident && m_chunks[chunkIndex].m_lastRequested != m_update )
+                    m_evictable.push_back( chunkIndex );
+            }
+            std::sort( m_evictable.begin(), m_evictable.end(), [this]( uint32_t lhs, uint32_t rhs )
+            {
+                return m_chunks[lhs].m_lastRequested > m_chunks[rhs].m_lastRequested;
+            } );
+
+            if ( m_evictable.empty() )
+                return false;
+        }
+
+        const uint32_t victim = m_evictable.back();
+        m_evictable.pop_back();
+
+        m_sink.Evict( victim );
+        m_chunks[victim].m_state = ChunkState::Absent;
+        m_stats.m_residentBytes -= m_file.GetChunk( victim ).m_size;
+        --m_stats.m_residentChunks;
+        ++m_stats.m_evictions;
+        return true;
+    }
+
+    void ChunkPager::Update( const std::vector<ChunkRequest>& requests )
+    {
+        RetireUploads();
+
+        ++m_update;
+        for ( const ChunkRequest& request : requests )
+            m_chunks.at( request.m_chunk ).m_lastRequested = m_update;
+
+        m_queue.assign( requests.begin(), requests.end() );
+        std::stable_sort( m_queue.begin(), m_queue.end(), []( const ChunkRequest& lhs, const ChunkRequest& rhs ) { return lhs.m_priority < rhs.m_priority; } );
+        m_evictable.clear();
+
+        const uint64_t evictionsBefore = m_stats.m_evictions;
+        const size_t uploadsBefore = m_uploading.size();
+        m_stats.m_waitingChunks = 0;
+        for ( const ChunkRequest& request : m_queue )
+        {
+            ChunkSlot& slot = m_chunks[request.m_chunk];
+            if ( slot.m_state != ChunkState::Absent )
+                continue;
+
+            // Strictly in priority order: once a chunk has to wait, everything after it does too.
+            const uint32_t size = m_file.GetChunk( request.m_chunk ).m_size;
+            bool fits = m_stats.m_waitingChunks == 0;
+            while ( fits && m_stats.m_residentBytes + size > m_residentBudget )
+                fits = EvictOne();
+
+            const uint64_t stagingOffset = fits ? m_staging.Acquire( size ) : RangeAllocator::InvalidOffset;
+            if ( stagingOffset == RangeAllocator::InvalidOffset )
+            {
+                ++m_stats.m_waitingChunks;
+                continue;
+            }
+
+            m_file.ReadChunk( request.m_chunk, m_staging.GetData( stagingOffset ) );
+            m_sink.Upload( request.m_chunk, m_file.GetChunk( request.m_chunk ), stagingOffset );
+
+            slot.m_state = ChunkState::Uploading;
+            slot.m_stagingOffset = stagingOffset;
+            m_uploading.push_back( request.m_chunk );
+            m_stats.m_residentBytes += size;
+            ++m_stats.m_uploadingChunks;
+            ++m_stats.m_loads;
+            m_stats.m_bytesRead += size;
+        }
+
+        if ( m_uploading.size() != uploadsBefore || m_stats.m_evictions != evictionsBefore )
+        {
+            const uint64_t ticket = m_sink.Submit();
+            for ( size_t i = uploadsBefore; i < m_uploading.size(); ++i )
+                m_chunks[m_uploading[i]].m_ticket = ticket;
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ChunkedMesh.h"
+#include "RangeAllocator.h"
+
+namespace Olex
+{
+    /**
+     * Fixed block of memory that chunks are read into on their way to the GPU. It never grows: when
+     * it is full, further loads wait until earlier uploads complete and give their ranges back.
+     */
+    class StagingPool
+    {
+    public:
+        StagingPool( uint8_t* memory, size_t capacity );
+
+        // Offset of size bytes, or RangeAllocator::InvalidOffset while the pool is full.
+        [[nodiscard]] uint64_t Acquire( size_t size );
+        void Release( uint64_t offset, size_t size );
+
+        [[nodiscard]] uint8_t* GetData( uint64_t offset ) const { return m_memory + offset; }
+        [[nodiscard]] size_t GetCapacity() const { return static_cast<size_t>( m_ranges.GetCapacity() ); }
+        [[nodiscard]] size_t GetUsedSize() const { return static_cast<size_t>( m_ranges.GetCapacity() - m_ranges.GetFreeSize() ); }
+
+    private:
+        uint8_t* m_memory;
+        RangeAllocator m_ranges;
+    };
+
+    /**
+     * Where paged chunks go. GpuChunkSink implements it over the geometry arena; tools and tests use
+     * HostChunkSink. The pager only ever calls it from the thread that calls Update.
+     */
+    class ChunkUploadSink
+    {
+    public:
+        virtual ~ChunkUploadSink() = default;
+
+        // GetStagingCapacity bytes the pager reads chunks into, valid for the lifetime of the sink.
+        // A GPU sink hands out a persistently mapped upload buffer, so chunks are copied from where they were read.
+        virtual uint8_t* GetStagingMemory() = 0;
+        [[nodiscard]] virtual size_t GetStagingCapacity() const = 0;
+
+        // Queues the copy of a chunk read to stagingOffset. The staged bytes stay untouched until its ticket completes.
+        virtual void Upload( uint32_t chunkIndex, const ChunkedMeshChunk& chunk, uint64_t stagingOffset ) = 0;
+        // The chunk is no longer resident. Work submitted before the next Submit may still read it.
+        virtual void Evict( uint32_t chunkIndex ) = 0;
+        // Submits the uploads and evictions queued since the last call, returns a ticket that completes with them.
+        virtual uint64_t Submit() = 0;
+        [[nodiscard]] virtual bool IsComplete( uint64_t ticket ) = 0;
+    };
+
+    /**
+     * Headless sink that keeps resident chunks in host memory. Uploads copy at once, so every ticket
+     * is complete as soon as Submit returns it.
+     */
+    class HostChunkSink final : public ChunkUploadSink
+    {
+    public:
+        explicit HostChunkSink( size_t stagingCapacity ) : m_staging( stagingCapacity ) {}
+
+        uint8_t* GetStagingMemory() override { return m_staging.data(); }
+        [[nodiscard]] size_t GetStagingCapacity() const override { return m_staging.size(); }
+        void Upload( uint32_t chunkIndex, const ChunkedMeshChunk& chunk, uint64_t stagingOffset ) override;
+        void Evict( uint32_t chunkIndex ) override { m_chunks.erase( chunkIndex ); }
+        uint64_t Submit() override { return ++m_submitted; }
+        [[nodiscard]] bool IsComplete( uint64_t ticket ) override { return ticket <= m_submitted; }
+
+        // Blob of a resident chunk, null when the chunk is not resident.
+        [[nodiscard]] const std::vector<uint8_t>* GetChunkData( uint32_t chunkIndex ) const;
+
+    private:
+        std::vector<uint8_t> m_staging;
+        std::unordered_map<uint32_t, std::vector<uint8_t>> m_chunks;
+        uint64_t m_submitted = 0;
+    };
+
+    // A chunk wanted this frame; lower priorities load first, e.g. the distance to the camera.
+    struct ChunkRequest
+    {
+        uint32_t m_chunk = 0;
+        float m_priority = 0.f;
+    };
+
+    struct ChunkPagerStats
+    {
+        // Bytes of chunks resident or being uploaded, never above the budget.
+        uint64_t m_residentBytes = 0;
+        uint32_t m_residentChunks = 0;
+        uint32_t m_uploadingChunks = 0;
+        // Chunks requested by the last Update that are still neither resident nor uploading.
+        uint32_t m_waitingChunks = 0;
+        uint64_t m_loads = 0;
+        uint64_t m_evictions = 0;
+        uint64_t m_bytesRead = 0;
+    };
+
+    /**
+     * Pages the chunks of a ChunkedMeshFile in and out under a fixed budget of resident bytes.
+     *
+     * Every Update gets the chunks wanted this frame. Wanted chunks that are not resident are read
+     * in priority order into the sink's staging memory and handed to the sink; room in the budget is
+     * made by evicting the resident chunks that went unrequested the longest. Requested chunks are
+     * never evicted, so when the budget is taken by wanted chunks the rest wait. A full staging pool
+     * also makes the rest wait, which bounds the memory in flight; its ranges come back once the
+     * sink reports the uploads complete.
+     *
+     * Host memory is the staging pool plus a few bytes per chunk, whatever the size of the file.
+     */
+    class ChunkPager
+    {
+    public:
+        // Throws std::invalid_argument when the largest chunk exceeds the budget or the staging memory.
+        ChunkPager( ChunkedMeshFile& file, ChunkUploadSink& sink, uint64_t residentBudget );
+
+        void Update( const std::vector<ChunkRequest>& requests );
+
+        // Uploaded and complete, safe to draw.
+        [[nodiscard]] bool IsResident( uint32_t chunkIndex ) const { return m_chunks.at( chunkIndex ).m_state == ChunkState::Resident; }
+        [[nodiscard]] const ChunkPagerStats& GetStats() const { return m_stats; }
+
+    private:
+        enum class ChunkState : uint8_t
+        {
+            Absent,
+            Uploading,
+            Resident,
+        };
+
+        struct ChunkSlot
+        {
+            ChunkState m_state = ChunkState::Absent;
+            // Update that last requested the chunk.
+            uint64_t m_lastRequested = 0;
+            uint64_t m_stagingOffset = 0;
+            uint64_t m_ticket = 0;
+        };
+
+        ChunkedMeshFile& m_file;
+        ChunkUploadSink& m_sink;
+        StagingPool m_staging;
+        uint64_t m_residentBudget;
+        uint64_t m_update = 0;
+        std::vector<ChunkSlot> m_chunks;
+        std::vector<uint32_t> m_uploading;
+        // Kept between updates to avoid reallocating them every frame.
+        std::vector<ChunkRequest> m_queue;
+        std::vector<uint32_t> m_evictable;
+        ChunkPagerStats m_stats;
+
+        void RetireUploads();
+        // Evicts the least recently requested chunk that was not requested by this update. False when there is none.
+        bool EvictOne();
+    };
+}
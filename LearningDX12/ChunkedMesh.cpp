@@ -0,0 +1,332 @@
+#include "ChunkedMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace Olex
+{
+    using namespace DirectX;
+
+    namespace
+    {
+        constexpr uint32_t UnmappedVertex = ~0u;
+
+        bool IsLittleEndianHost()
+        {
+            const uint16_t value = 1;
+            uint8_t firstByte;
+            std::memcpy( &firstByte, &value, 1 );
+            return firstByte == 1;
+        }
+
+        bool operator< ( const XMINT3& lhs, const XMINT3& rhs )
+        {
+            if ( lhs.x != rhs.x )
+                return lhs.x < rhs.x;
+            if ( lhs.y != rhs.y )
+                return lhs.y < rhs.y;
+            return lhs.z < rhs.z;
+        }
+
+        bool operator!= ( const XMINT3& lhs, const XMINT3& rhs )
+        {
+            return lhs.x != rhs.x || lhs.y != rhs.y || lhs.z != rhs.z;
+        }
+
+        int32_t GetCellCoordinate( float value, float inverseCellSize )
+        {
+            return static_cast<int32_t>( std::floor( value * inverseCellSize ) );
+        }
+
+        float Distance( const XMFLOAT3& lhs, const XMFLOAT3& rhs )
+        {
+            const float x = lhs.x - rhs.x;
+            const float y = lhs.y - rhs.y;
+            const float z = lhs.z - rhs.z;
+            return std::sqrt( x * x + y * y + z * z );
+        }
+
+        // Box around both volumes and a sphere around its center that holds both spheres.
+        BoundingVolume Merge( const BoundingVolume& lhs, const BoundingVolume& rhs )
+        {
+            BoundingVolume result;
+            result.m_min = XMFLOAT3( std::min( lhs.m_min.x, rhs.m_min.x ), std::min( lhs.m_min.y, rhs.m_min.y ), std::min( lhs.m_min.z, rhs.m_min.z ) );
+            result.m_max = XMFLOAT3( std::max( lhs.m_max.x, rhs.m_max.x ), std::max( lhs.m_max.y, rhs.m_max.y ), std::max( lhs.m_max.z, rhs.m_max.z ) );
+            result.m_sphereCenter = XMFLOAT3(
+                ( result.m_min.x + result.m_max.x ) * 0.5f,
+                ( result.m_min.y + result.m_max.y ) * 0.5f,
+                ( result.m_min.z + result.m_max.z ) * 0.5f );
+            result.m_sphereRadius = std::max(
+                Distance( lhs.m_sphereCenter, result.m_sphereCenter ) + lhs.m_sphereRadius,
+                Distance( rhs.m_sphereCenter, result.m_sphereCenter ) + rhs.m_sphereRadius );
+            return result;
+        }
+    }
+
+    void SplitIntoChunks( const Mesh& mesh, float cellSize, const std::function<void( const MeshChunk& chunk )>& emit )
+    {
+        struct CellTriangle
+        {
+            XMINT3 m_cell;
+            uint32_t m_triangle;
+        };
+
+        const float inverseCellSize = cellSize > 0.f ? 1.f / cellSize : 0.f;
+        std::vector<CellTriangle> triangles( mesh.m_indices.size() );
+        for ( uint32_t i = 0; i < triangles.size(); ++i )
+        {
+            const XMINT3& triangle = mesh.m_indices[i];
+            const XMFLOAT3& a = mesh.m_vertices[triangle.x].m_position;
+            const XMFLOAT3& b = mesh.m_vertices[triangle.y].m_position;
+            const XMFLOAT3& c = mesh.m_vertices[triangle.z].m_position;
+
+            triangles[i].m_cell = XMINT3(
+                GetCellCoordinate( ( a.x + b.x + c.x ) * ( 1.f / 3.f ), inverseCellSize ),
+                GetCellCoordinate( ( a.y + b.y + c.y ) * ( 1.f / 3.f ), inverseCellSize ),
+                GetCellCoordinate( ( a.z + b.z + c.z ) * ( 1.f / 3.f ), inverseCellSize ) );
+            triangles[i].m_triangle = i;
+        }
+
+        // Within a cell the triangles keep their order, which the vertex cache optimizer chose.
+        std::stable_sort( triangles.begin(), triangles.end(), []( const CellTriangle& lhs, const CellTriangle& rhs ) { return lhs.m_cell < rhs.m_cell; } );
+
+        // Chunk vertex of every mesh vertex, reset after each chunk through sourceVertices.
+        std::vector<uint32_t> remap( mesh.m_vertices.size(), UnmappedVertex );
+        std::vector<uint32_t> sourceVertices;
+        MeshChunk chunk;
+
+        auto flush = [&]()
+        {
+            if ( !chunk.m_indices.empty() )
+                emit( chunk );
+            for ( const uint32_t vertex : sourceVertices )
+                remap[vertex] = UnmappedVertex;
+            sourceVertices.clear();
+            chunk.m_vertices.clear();
+            chunk.m_indices.clear();
+        };
+
+        for ( const CellTriangle& cellTriangle : triangles )
+        {
+            const XMINT3& triangle = mesh.m_indices[cellTriangle.m_triangle];
+            const uint32_t corners[] = { static_cast<uint32_t>( triangle.x ), static_cast<uint32_t>( triangle.y ), static_cast<uint32_t>( triangle.z ) };
+
+            uint32_t newVertices = 0;
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                const bool repeated = ( corner > 0 && corners[corner] == corners[0] ) || ( corner > 1 && corners[corner] == corners[1] );
+                if ( remap[corners[corner]] == UnmappedVertex && !repeated )
+                    ++newVertices;
+            }
+
+            if ( cellTriangle.m_cell != chunk.m_cell || chunk.m_vertices.size() + newVertices > ChunkedMeshFormat::MaxChunkVertices )
+            {
+                flush();
+                chunk.m_cell = cellTriangle.m_cell;
+            }
+
+            for ( const uint32_t vertex : corners )
+            {
+                if ( remap[vertex] == UnmappedVertex )
+                {
+                    remap[vertex] = static_cast<uint32_t>( chunk.m_vertices.size() );
+                    chunk.m_vertices.push_back( mesh.m_vertices[vertex] );
+                    sourceVertices.push_back( vertex );
+                }
+                chunk.m_indices.push_back( remap[vertex] );
+            }
+        }
+        flush();
+    }
+
+    ChunkedMeshWriter::ChunkedMeshWriter( const std::filesystem::path& cachePath, float cellSize, const SourceStamp& sourceStamp )
+        : m_cachePath( cachePath )
+        , m_temporaryPath( cachePath )
+    {
+        // The format is defined as little-endian and written with plain memory copies.
+        if ( !IsLittleEndianHost() )
+        {
+            throw std::runtime_error( "Chunked mesh can only be written on a little-endian host" );
+        }
+
+        m_temporaryPath += "." + MakeUniqueName() + ".tmp";
+        m_stream.open( m_temporaryPath, std::ios::binary | std::ios::trunc );
+        if ( !m_stream )
+        {
+            throw std::runtime_error( "Unable to create chunked mesh file" );
+        }
+
+        m_header.m_magic = ChunkedMeshFormat::Magic;
+        m_header.m_version = ChunkedMeshFormat::Version;
+        m_header.m_endianTag = ChunkedMeshFormat::EndianTag;
+        m_header.m_vertexStride = sizeof( Mesh::VertexInfo );
+        m_header.m_cellSize = cellSize;
+        m_header.m_sourceSize = sourceStamp.m_size;
+        m_header.m_sourceWriteTime = sourceStamp.m_writeTime;
+
+        // Rewritten by Finish once the chunk table is known.
+        Write( &m_header, sizeof( m_header ) );
+    }
+
+    ChunkedMeshWriter::~ChunkedMeshWriter()
+    {
+        if ( !m_finished )
+        {
+            m_stream.close();
+            std::error_code error;
+            std::filesystem::remove( m_temporaryPath, error );
+        }
+    }
+
+    void ChunkedMeshWriter::Write( const void* data, uint64_t size )
+    {
+        m_stream.write( static_cast<const char*>( data ), static_cast<std::streamsize>( size ) );
+        m_written += size;
+    }
+
+    void ChunkedMeshWriter::Pad()
+    {
+        static const uint8_t zeros[ChunkedMeshFormat::BlobAlignment] = {};
+        Write( zeros, ( ChunkedMeshFormat::BlobAlignment - m_written % ChunkedMeshFormat::BlobAlignment ) % ChunkedMeshFormat::BlobAlignment );
+    }
+
+    void ChunkedMeshWriter::AddChunk( uint32_t mesh, const MeshChunk& chunk )
+    {
+        if ( chunk.m_vertices.size() > ChunkedMeshFormat::MaxChunkVertices )
+        {
+            throw std::invalid_argument( "Chunk has too many vertices for 16-bit indices" );
+        }
+        if ( chunk.m_indices.empty() )
+            return;
+
+        ChunkedMeshChunk entry = {};
+        entry.m_vertexCount = static_cast<uint32_t>( chunk.m_vertices.size() );
+        entry.m_indexCount = static_cast<uint32_t>( chunk.m_indices.size() );
+        entry.m_indexFormat = IndexFormat::UInt16;
+        entry.m_mesh = mesh;
+        entry.m_cell = chunk.m_cell;
+        entry.m_bounds = ComputeBounds( &chunk.m_vertices[0].m_position, chunk.m_vertices.size(), sizeof( Mesh::VertexInfo ) );
+
+        Pad();
+        entry.m_offset = m_written;
+        Write( chunk.m_vertices.data(), sizeof( Mesh::VertexInfo ) * chunk.m_vertices.size() );
+
+        const std::vector<uint16_t> indices( chunk.m_indices.begin(), chunk.m_indices.end() );
+        Pad();
+        entry.m_indexOffset = static_cast<uint32_t>( m_written - entry.m_offset );
+        Write( indices.data(), sizeof( uint16_t ) * indices.size() );
+        entry.m_size = static_cast<uint32_t>( m_written - entry.m_offset );
+
+        m_header.m_bounds = m_chunks.empty() ? entry.m_bounds : Merge( m_header.m_bounds, entry.m_bounds );
+        m_chunks.push_back( entry );
+
+        if ( !m_stream )
+        {
+            throw std::runtime_error( "Failed writing chunked mesh file" );
+        }
+    }
+
+    void ChunkedMeshWriter::Finish()
+    {
+        Pad();
+        m_header.m_chunkTableOffset = m_written;
+        m_header.m_chunkCount = static_cast<uint32_t>( m_chunks.size() );
+        Write( m_chunks.data(), sizeof( ChunkedMeshChunk ) * m_chunks.size() );
+
+        m_stream.seekp( 0 );
+        m_stream.write( reinterpret_cast<const char*>( &m_header ), sizeof( m_header ) );
+        m_stream.close();
+        if ( !m_stream )
+        {
+            throw std::runtime_error( "Failed writing chunked mesh file" );
+        }
+
+        std::filesystem::rename( m_temporaryPath, m_cachePath );
+        m_finished = true;
+    }
+
+    void WriteChunkedMesh( const std::filesystem::path& cachePath, const std::vector<Mesh>& meshes, float cellSize, const SourceStamp& sourceStamp )
+    {
+        ChunkedMeshWriter writer( cachePath, cellSize, sourceStamp );
+        for ( uint32_t mesh = 0; mesh < meshes.size(); ++mesh )
+            SplitIntoChunks( meshes[mesh], cellSize, [&]( const MeshChunk& chunk ) { writer.AddChunk( mesh, chunk ); } );
+        writer.Finish();
+    }
+
+    ChunkedMeshFile::ChunkedMeshFile( const std::filesystem::path& cachePath )
+        : m_stream( cachePath, std::ios::binary )
+    {
+        std::error_code error;
+        const uintmax_t fileSize = std::filesystem::file_size( cachePath, error );
+        if ( !m_stream || error || fileSize < sizeof( ChunkedMeshHeader ) )
+            return;
+
+        m_stream.read( reinterpret_cast<char*>( &m_header ), sizeof( m_header ) );
+        m_valid = m_stream && Validate( static_cast<uint64_t>( fileSize ) );
+        if ( !m_valid )
+            m_chunks.clear();
+    }
+
+    bool ChunkedMeshFile::Validate( uint64_t fileSize )
+    {
+        if ( m_header.m_magic != ChunkedMeshFormat::Magic ||
+            m_header.m_version != ChunkedMeshFormat::Version ||
+            m_header.m_endianTag != ChunkedMeshFormat::EndianTag ||
+            m_header.m_vertexStride != sizeof( Mesh::VertexInfo ) )
+        {
+            return false;
+        }
+
+        const uint64_t tableEnd = m_header.m_chunkTableOffset + sizeof( ChunkedMeshChunk ) * uint64_t( m_header.m_chunkCount );
+        if ( m_header.m_chunkTableOffset < sizeof( ChunkedMeshHeader ) || tableEnd > fileSize )
+            return false;
+
+        m_chunks.resize( m_header.m_chunkCount );
+        m_stream.seekg( static_cast<std::streamoff>( m_header.m_chunkTableOffset ) );
+        m_stream.read( reinterpret_cast<char*>( m_chunks.data() ), static_cast<std::streamsize>( sizeof( ChunkedMeshChunk ) * m_chunks.size() ) );
+        if ( !m_stream )
+            return false;
+
+        for ( const ChunkedMeshChunk& chunk : m_chunks )
+        {
+            const uint64_t vertexEnd = sizeof( Mesh::VertexInfo ) * uint64_t( chunk.m_vertexCount );
+            const uint64_t indexEnd = chunk.m_indexOffset + uint64_t( chunk.m_indexCount ) * static_cast<uint32_t>( chunk.m_indexFormat );
+
+            if ( ( chunk.m_indexFormat != IndexFormat::UInt16 && chunk.m_indexFormat != IndexFormat::UInt32 ) ||
+                chunk.m_offset < sizeof( ChunkedMeshHeader ) || chunk.m_offset + chunk.m_size > m_header.m_chunkTableOffset ||
+                chunk.m_offset % ChunkedMeshFormat::BlobAlignment != 0 ||
+                chunk.m_indexOffset % ChunkedMeshFormat::BlobAlignment != 0 ||
+                vertexEnd > chunk.m_indexOffset || indexEnd > chunk.m_size )
+            {
+                return false;
+            }
+
+            m_largestChunkSize = std::max( m_largestChunkSize, chunk.m_size );
+        }
+
+        return true;
+    }
+
+    bool ChunkedMeshFile::IsUpToDate( const SourceStamp& sourceStamp ) const
+    {
+        return IsValid() &&
+            m_header.m_sourceSize == sourceStamp.m_size &&
+            m_header.m_sourceWriteTime == sourceStamp.m_writeTime;
+    }
+
+    void ChunkedMeshFile::ReadChunk( uint32_t chunkIndex, void* destination )
+    {
+        const ChunkedMeshChunk& chunk = m_chunks.at( chunkIndex );
+
+        m_stream.clear();
+        m_stream.seekg( static_cast<std::streamoff>( chunk.m_offset ) );
+        m_stream.read( static_cast<char*>( destination ), chunk.m_size );
+        if ( !m_stream )
+        {
+            throw std::runtime_error( "Failed reading chunked mesh file" );
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+#include "Mesh.h"
+#include "MeshCache.h"
+
+namespace Olex
+{
+    /**
+     * Baked streaming container for meshes too large to keep in memory. The triangles of every mesh
+     * are cut into chunks along a grid of cells, and each chunk is a self-contained blob of vertices
+     * and 16-bit indices that can be read and uploaded on its own.
+     *
+     *   ChunkedMeshHeader
+     *   per chunk: Mesh::VertexInfo[m_vertexCount], then m_indexCount indices of m_indexFormat at m_indexOffset
+     *   ChunkedMeshChunk[m_chunkCount] at m_chunkTableOffset
+     *
+     * The chunk table comes last so the writer can stream chunks to disk and keep only the table.
+     * Every blob starts on a ChunkedMeshFormat::BlobAlignment boundary. All values are little-endian.
+     */
+    namespace ChunkedMeshFormat
+    {
+        constexpr uint32_t Magic = 0x4B48434F; // "OCHK"
+        constexpr uint16_t Version = 1;
+        constexpr uint16_t EndianTag = 0x0102;
+        constexpr uint64_t BlobAlignment = 16;
+        // Cells with more vertices are split into several chunks, so every chunk fits 16-bit indices.
+        constexpr uint32_t MaxChunkVertices = 65536;
+    }
+
+    struct ChunkedMeshHeader
+    {
+        uint32_t m_magic;
+        uint16_t m_version;
+        uint16_t m_endianTag;
+        uint32_t m_vertexStride;
+        uint32_t m_chunkCount;
+        uint64_t m_chunkTableOffset;
+        float m_cellSize;
+        uint32_t m_padding;
+        // Of every chunk together.
+        BoundingVolume m_bounds;
+        // Identifies the source file the cache was baked from, see SourceStamp.
+        uint64_t m_sourceSize;
+        int64_t m_sourceWriteTime;
+    };
+
+    struct ChunkedMeshChunk
+    {
+        // The blob holds the vertices followed by the indices at m_indexOffset from its start.
+        uint64_t m_offset;
+        uint32_t m_size;
+        uint32_t m_indexOffset;
+        uint32_t m_vertexCount;
+        uint32_t m_indexCount;
+        IndexFormat m_indexFormat;
+        // Mesh of the source file the triangles come from, in its local space.
+        uint32_t m_mesh;
+        DirectX::XMINT3 m_cell;
+        uint32_t m_padding;
+        BoundingVolume m_bounds;
+    };
+
+    static_assert( sizeof( ChunkedMeshHeader ) == 88, "ChunkedMeshHeader layout is part of the file format" );
+    static_assert( sizeof( ChunkedMeshChunk ) == 88, "ChunkedMeshChunk layout is part of the file format" );
+
+    // Triangles of one cell of a mesh, indices local to the chunk vertices.
+    struct MeshChunk
+    {
+        DirectX::XMINT3 m_cell = { 0, 0, 0 };
+        std::vector<Mesh::VertexInfo> m_vertices;
+        std::vector<uint32_t> m_indices;
+    };
+
+    /**
+     * Bins the triangles of the mesh into cubic cells of cellSize by their centroid and calls emit
+     * for every chunk, cell by cell. A cell with more than MaxChunkVertices vertices gives several
+     * chunks. cellSize 0 keeps the whole mesh in one cell. The chunk passed to emit is reused.
+     */
+    void SplitIntoChunks( const Mesh& mesh, float cellSize, const std::function<void( const MeshChunk& chunk )>& emit );
+
+    /**
+     * Writes a chunked mesh one chunk at a time, so only the chunk table stays in memory. Like
+     * WriteMeshCache the file is written under a temporary name and renamed by Finish; a writer
+     * destroyed before Finish removes the temporary file.
+     */
+    class ChunkedMeshWriter
+    {
+    public:
+        ChunkedMeshWriter( const std::filesystem::path& cachePath, float cellSize, const SourceStamp& sourceStamp );
+        ~ChunkedMeshWriter();
+
+        ChunkedMeshWriter( const ChunkedMeshWriter& ) = delete;
+        ChunkedMeshWriter& operator=( const ChunkedMeshWriter& ) = delete;
+
+        // Throws std::invalid_argument when the chunk has more than MaxChunkVertices vertices.
+        void AddChunk( uint32_t mesh, const MeshChunk& chunk );
+        void Finish();
+
+    private:
+        std::filesystem::path m_cachePath;
+        std::filesystem::path m_temporaryPath;
+        std::ofstream m_stream;
+        ChunkedMeshHeader m_header = {};
+        std::vector<ChunkedMeshChunk> m_chunks;
+        uint64_t m_written = 0;
+        bool m_finished = false;
+
+        void Write( const void* data, uint64_t size );
+        void Pad();
+    };
+
+    // Splits every mesh with SplitIntoChunks and writes the chunks, mesh by mesh.
+    void WriteChunkedMesh( const std::filesystem::path& cachePath, const std::vector<Mesh>& meshes, float cellSize, const SourceStamp& sourceStamp );
+
+    /**
+     * Read access to a chunked mesh. Unlike the other caches it is not memory-mapped: chunks are read
+     * with explicit file I/O into memory the caller owns, so what stays resident is exactly what the
+     * caller keeps, see ChunkPager. Only the header and the chunk table are held.
+     */
+    class ChunkedMeshFile
+    {
+    public:
+        explicit ChunkedMeshFile( const std::filesystem::path& cachePath );
+
+        // False if the file is missing, truncated or was written by an incompatible version.
+        [[nodiscard]] bool IsValid() const { return m_valid; }
+        [[nodiscard]] bool IsUpToDate( const SourceStamp& sourceStamp ) const;
+
+        [[nodiscard]] uint32_t GetChunkCount() const { return static_cast<uint32_t>( m_chunks.size() ); }
+        [[nodiscard]] const ChunkedMeshChunk& GetChunk( uint32_t chunkIndex ) const { return m_chunks.at( chunkIndex ); }
+        [[nodiscard]] uint32_t GetLargestChunkSize() const { return m_largestChunkSize; }
+        [[nodiscard]] float GetCellSize() const { return m_header.m_cellSize; }
+        [[nodiscard]] const BoundingVolume& GetBounds() const { return m_header.m_bounds; }
+
+        // Reads the GetChunk( chunkIndex ).m_size bytes of the chunk blob. Throws std::runtime_error on a read error.
+        void ReadChunk( uint32_t chunkIndex, void* destination );
+
+    private:
+        std::ifstream m_stream;
+        ChunkedMeshHeader m_header = {};
+        std::vector<ChunkedMeshChunk> m_chunks;
+        uint32_t m_largestChunkSize = 0;
+        bool m_valid = false;
+
+        bool Validate( uint64_t fileSize );
+    };
+}
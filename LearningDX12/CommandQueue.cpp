@@ -12,7 +12,7 @@ namespace Olex
         : m_app( application )
         , m_CommandListType( type )
     {
-        m_d3d12CommandQueue = m_app.CreateCommandQueue( D3D12_COMMAND_LIST_TYPE_DIRECT );
+        m_d3d12CommandQueue = m_app.CreateCommandQueue( type );
         m_d3d12Fence = m_app.CreateFence( m_FenceValue.Get() );
         m_FenceEvent = m_app.CreateEventHandle();
     }
@@ -32,8 +32,25 @@ namespace Olex
 
     Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> CommandQueue::CreateCommandList()
     {
-        ComPtr<ID3D12CommandAllocator> allocator = m_app.CreateCommandAllocator( m_CommandListType );
-        ComPtr<ID3D12GraphicsCommandList2> commandList = m_app.CreateCommandList2( allocator, m_CommandListType );
+        ComPtr<ID3D12CommandAllocator> allocator;
+        if ( m_commandAllocators.TryAcquire( m_d3d12Fence->GetCompletedValue(), allocator ) )
+        {
+            ThrowIfFailed( allocator->Reset() );
+        }
+        else
+        {
+            allocator = m_app.CreateCommandAllocator( m_CommandListType );
+        }
+
+        ComPtr<ID3D12GraphicsCommandList2> commandList;
+        if ( m_commandListPool.TryAcquire( 0, commandList ) )
+        {
+            ThrowIfFailed( commandList->Reset( allocator.Get(), nullptr ) );
+        }
+        else
+        {
+            commandList = m_app.CreateCommandList2( allocator, m_CommandListType );
+        }
 
         // Associate the command allocator with the command list so that it can be
         // retrieved when the command list is executed.
@@ -44,30 +61,43 @@ namespace Olex
 
     FenceValue CommandQueue::ExecuteCommandList( ComPtr<ID3D12GraphicsCommandList2> commandList )
     {
-        commandList->Close();
+        return ExecuteCommandLists( &commandList, 1 );
+    }
 
-        ID3D12CommandList* const ppCommandLists[] = {
-            commandList.Get()
-        };
+    FenceValue CommandQueue::ExecuteCommandLists( const ComPtr<ID3D12GraphicsCommandList2>* commandLists, size_t count,
+        const std::vector<FenceWait>& waits )
+    {
+        m_batch.clear();
+        for ( size_t i = 0; i < count; ++i )
+        {
+            ThrowIfFailed( commandLists[i]->Close() );
+            m_batch.push_back( commandLists[i].Get() );
+        }
 
-        m_d3d12CommandQueue->ExecuteCommandLists( 1, ppCommandLists );
-        const FenceValue fenceValue = Signal();
+        for ( const FenceWait& wait : waits )
+        {
+            Wait( wait );
+        }
 
-        bool found = false;
-        for (CommandListInFlight& item : m_commandLists)
+        // An empty batch still signals, which gives a fence value covering the waits.
+        if ( !m_batch.empty() )
         {
-            if (item.m_fenceValue.Get() == 0)
-            {
-                item = CommandListInFlight{commandList, fenceValue};
-                found = true;
-                break;
-            }
+            m_d3d12CommandQueue->ExecuteCommandLists( static_cast<UINT>( m_batch.size() ), m_batch.data() );
         }
+        const FenceValue fenceValue = Signal();
 
-        if (found == false)
+        for ( size_t i = 0; i < count; ++i )
         {
-            throw std::exception();
+            // GetPrivateData adds a reference, which the ComPtr takes over.
+            ComPtr<ID3D12CommandAllocator> allocator;
+            UINT dataSize = sizeof( ID3D12CommandAllocator* );
+            ThrowIfFailed( commandLists[i]->GetPrivateData( __uuidof( ID3D12CommandAllocator ), &dataSize, allocator.GetAddressOf() ) );
+            m_commandAllocators.Release( std::move( allocator ), fenceValue.Get() );
+            m_commandListPool.Release( commandLists[i], 0 );
+
+            m_inFlight.push_back( CommandListInFlight{ commandLists[i], fenceValue } );
         }
+        RetireCompleted();
 
         return fenceValue;
     }
@@ -80,6 +110,11 @@ namespace Olex
     }
 
 
+    void CommandQueue::Wait( const FenceWait& wait )
+    {
+        ThrowIfFailed( m_d3d12CommandQueue->Wait( wait.m_fence, wait.m_value.Get() ) );
+    }
+
     void CommandQueue::WaitForFenceValue( FenceValue fenceValue )
     {
         if ( m_d3d12Fence->GetCompletedValue() < fenceValue.Get() )
@@ -88,17 +123,18 @@ namespace Olex
             WaitForSingleObject( m_FenceEvent, 9001 );
         }
 
-        for (CommandListInFlight& item : m_commandLists)
+        RetireCompleted();
+    }
+
+    FenceValue CommandQueue::RetireCompleted()
+    {
+        const FenceValue completed( m_d3d12Fence->GetCompletedValue() );
+        while ( !m_inFlight.empty() && m_inFlight.front().m_fenceValue.Get() <= completed.Get() )
         {
-            if (item.m_fenceValue.Get() != 0)
-            {
-                if (item.m_fenceValue == fenceValue)
-                {
-                    item = {};
-                }
-                break;
-            }
+            m_inFlight.pop_front();
         }
+
+        return completed;
     }
 
     void CommandQueue::Flush()
@@ -6,8 +6,12 @@
 
 #include <d3d12.h>  // For ID3D12CommandQueue, ID3D12Device2, and ID3D12Fence
 #include <wrl.h>    // For Microsoft::WRL::ComPtr
+#include <cstddef>
 #include <cstdint>  // For uint64_t
-#include <array>
+#include <deque>
+#include <vector>
+
+#include "FenceRecycler.h"
 
 namespace Olex
 {
@@ -26,24 +30,51 @@ namespace Olex
 
     inline bool operator== (const FenceValue& lhs, const FenceValue& rhs) { return lhs.Get() == rhs.Get(); }
 
+    // A fence value, usually of another queue, that the GPU must reach before a batch starts.
+    struct FenceWait
+    {
+        ID3D12Fence* m_fence = nullptr;
+        FenceValue m_value{ 0 };
+    };
+
     class CommandQueue final
     {
     public:
         CommandQueue( DX12App& application, D3D12_COMMAND_LIST_TYPE type );
         ~CommandQueue();
 
-        // Get an available command list from the command queue.
+        // Get an available command list from the command queue, ready for recording.
+        // Allocators and lists of earlier submissions are reset and reused once the GPU is done with them.
         Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> CreateCommandList();
 
         // Executes a command list.
         // Returns the fence value to wait for for this command list.
         FenceValue ExecuteCommandList( Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> commandList );
 
+        // Closes and executes the lists in order with a single ExecuteCommandLists call and a single
+        // signal, after making the queue wait on the GPU for every entry of waits.
+        // Returns the fence value to wait for for the whole batch.
+        FenceValue ExecuteCommandLists( const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2>* commandLists, size_t count,
+            const std::vector<FenceWait>& waits = {} );
+
         FenceValue Signal();
+        // Makes the GPU hold back work submitted after this call until the fence is reached. The CPU does not block.
+        void Wait( const FenceWait& wait );
+        // Blocks until the GPU reaches fenceValue, then retires what completed.
         void WaitForFenceValue( FenceValue fenceValue );
         void Flush();
 
+        // Drops the submissions the GPU has finished, oldest first, without blocking.
+        // Returns the completed fence value.
+        FenceValue RetireCompleted();
+        [[nodiscard]] bool IsFenceComplete( FenceValue fenceValue ) const { return m_d3d12Fence->GetCompletedValue() >= fenceValue.Get(); }
+        [[nodiscard]] size_t GetInFlightCount() const { return m_inFlight.size(); }
+
         [[nodiscard]] Microsoft::WRL::ComPtr<ID3D12CommandQueue> GetD3D12CommandQueue() const { return m_d3d12CommandQueue; }
+        // For FenceWait entries of other queues.
+        [[nodiscard]] ID3D12Fence* GetD3D12Fence() const { return m_d3d12Fence.Get(); }
+        [[nodiscard]] const FenceRecyclerStats& GetCommandAllocatorStats() const { return m_commandAllocators.GetStats(); }
+        [[nodiscard]] const FenceRecyclerStats& GetCommandListStats() const { return m_commandListPool.GetStats(); }
 
     private:
         DX12App& m_app;
@@ -60,7 +91,15 @@ namespace Olex
             FenceValue                                          m_fenceValue{0};
         };
 
-        std::array<CommandListInFlight, 4> m_commandLists;
+        // In submission order, so fence values only grow from front to back.
+        std::deque<CommandListInFlight> m_inFlight;
+        // Kept between batches to avoid reallocating it on every submission.
+        std::vector<ID3D12CommandList*> m_batch;
+
+        // Allocators wait for the fence of their last submission. A list may be reset as soon as
+        // it has been submitted, so lists go back with fence value 0.
+        FenceRecycler<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> m_commandAllocators;
+        FenceRecycler<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2>> m_commandListPool;
 
         void ThrowIfFailed( HRESULT hr );
     };
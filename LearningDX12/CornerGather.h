@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Olex
+{
+    // How a layer element (uvs, normals) assigns values to polygon vertices, the FBX mapping modes the direct path handles.
+    enum class LayerMapping
+    {
+        ByControlPoint,
+        ByPolygonVertex,
+        ByPolygon,
+        AllSame,
+    };
+
+    // Where a polygon vertex of a triangle mesh lands in the corner list; triangles are flipped to clockwise winding.
+    inline size_t CornerSlot( int polygonVertex )
+    {
+        static constexpr int cornerOrder[3] = { 0, 2, 1 };
+        return static_cast<size_t>( polygonVertex - polygonVertex % 3 + cornerOrder[polygonVertex % 3] );
+    }
+
+    /**
+     * Resolves which entry of a layer element's direct array every polygon vertex of a triangle mesh
+     * reads, calling store( polygonVertex, directIndex ). indices is the element's index array, or
+     * null when the element references its direct array directly.
+     *
+     * Returns false, having stored nothing or only part, on an index outside the index or direct
+     * array; the caller then falls back to the per-corner SDK calls.
+     */
+    template <typename Store>
+    bool GatherLayerIndices( LayerMapping mapping, const int* polygonVertices, int polygonVertexCount,
+        const int* indices, int indexCount, int directCount, Store store )
+    {
+        for ( int polygonVertex = 0; polygonVertex < polygonVertexCount; ++polygonVertex )
+        {
+            int key;
+            switch ( mapping )
+            {
+            case LayerMapping::ByControlPoint: key = polygonVertices[polygonVertex]; break;
+            case LayerMapping::ByPolygonVertex: key = polygonVertex; break;
+            case LayerMapping::ByPolygon: key = polygonVertex / 3; break;
+            default: key = 0; break;
+            }
+
+            if ( indices )
+            {
+                if ( key < 0 || key >= indexCount )
+                    return false;
+                key = indices[key];
+            }
+
+            if ( key < 0 || key >= directCount )
+                return false;
+
+            store( polygonVertex, key );
+        }
+
+        return true;
+    }
+}
@@ -24,6 +24,7 @@ namespace Olex
                 m_currentGame.reset();
             }
 
+            m_uploadService.reset();
             m_CommandQueue->Flush();
             m_CommandQueue.reset();
         }
@@ -45,6 +46,8 @@ namespace Olex
         m_Device = CreateDevice( dxgiAdapter4 );
 
         m_CommandQueue = std::make_unique<CommandQueue>( *this, D3D12_COMMAND_LIST_TYPE_DIRECT );
+        m_geometryArena = std::make_unique<GeometryArena>( m_Device.Get(), m_geometryVertexCapacity, m_geometryIndexCapacity );
+        m_uploadService = std::make_unique<UploadService>( *this, m_uploadPageSize );
 
         m_SwapChain = CreateSwapChain( m_hWnd, m_CommandQueue->GetD3D12CommandQueue(), m_ClientWidth, m_ClientHeight, m_NumFrames );
         m_CurrentBackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
@@ -59,6 +62,13 @@ namespace Olex
     {
         if ( IsInitialized() )
         {
+            // The previous game hands its geometry back to the shared arena, which the GPU must be done with.
+            if ( m_currentGame )
+            {
+                m_CommandQueue->Flush();
+                m_currentGame->UnloadResources();
+            }
+
             m_currentGame = std::move( game );
             m_currentGame->LoadResources();
         }
@@ -445,6 +455,14 @@ namespace Olex
 
     void DX12App::Render()
     {
+        // Waits only for the frame that last rendered into this back buffer, or for the oldest
+        // frame beyond the latency limit, instead of for every frame.
+        const uint64_t waitValue = m_framePacer.GetWaitValue( m_CurrentBackBufferIndex );
+        if ( waitValue != 0 )
+        {
+            m_CommandQueue->WaitForFenceValue( FenceValue( waitValue ) );
+        }
+
         if ( m_currentGame )
         {
             m_currentGame->Render( {} );
@@ -476,17 +494,17 @@ namespace Olex
                     D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT );
                 commandList->ResourceBarrier( 1, &barrier );
 
-                const FenceValue fenceValueToWaitOn = m_CommandQueue->ExecuteCommandList(commandList);
+                const FenceValue fenceValue = m_CommandQueue->ExecuteCommandList( commandList );
 
-                Present();
-
-                m_CommandQueue->WaitForFenceValue( fenceValueToWaitOn );
+                Present( fenceValue );
             }
         }
     }
 
-    void DX12App::Present()
+    void DX12App::Present( FenceValue frameFenceValue )
     {
+        m_framePacer.OnFrameSubmitted( m_CurrentBackBufferIndex, frameFenceValue.Get() );
+
         const UINT syncInterval = m_VSync ? 1 : 0;
         const UINT presentFlags = m_TearingSupported && !m_VSync ? DXGI_PRESENT_ALLOW_TEARING : 0;
         ThrowIfFailed( m_SwapChain->Present( syncInterval, presentFlags ) );
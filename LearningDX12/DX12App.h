@@ -10,7 +10,10 @@
 
 #include "BaseGameInterface.h"
 #include "CommandQueue.h"
+#include "FramePacer.h"
 #include "framework.h"
+#include "GeometryArena.h"
+#include "UploadService.h"
 
 namespace Olex
 {
@@ -32,7 +35,11 @@ namespace Olex
         void OnKeyEvent( WPARAM wParam );
         void OnResize();
 
-        void Present();
+        // Presents the current back buffer, whose frame completes with frameFenceValue, and moves on to the next one.
+        void Present( FenceValue frameFenceValue );
+
+        // Frames the CPU may queue ahead of the GPU, 1 to the number of back buffers.
+        void SetMaxFrameLatency( uint32_t maxFrameLatency ) { m_framePacer.SetMaxFrameLatency( maxFrameLatency ); }
 
 
         // API for derivative classes
@@ -83,6 +90,10 @@ namespace Olex
         D3D12_CPU_DESCRIPTOR_HANDLE GetCurrentRenderTargetView() const;
 
         CommandQueue& GetCommandQueue() { return *m_CommandQueue; }
+        // Vertex and index buffers shared by every mesh of the current game.
+        GeometryArena& GetGeometryArena() { return *m_geometryArena; }
+        // Uploads on the copy queue, see UploadService.
+        UploadService& GetUploadService() { return *m_uploadService; }
 
     private:
 
@@ -90,6 +101,8 @@ namespace Olex
 
         // The number of swap chain back buffers.
         static constexpr uint8_t m_NumFrames = 4;
+        static constexpr uint32_t m_DefaultMaxFrameLatency = 2;
+        FramePacer m_framePacer{ m_NumFrames, m_DefaultMaxFrameLatency };
         // Use WARP adapter
         bool m_UseWarp = false;
 
@@ -109,6 +122,13 @@ namespace Olex
 
         std::unique_ptr<CommandQueue> m_CommandQueue;
 
+        static constexpr uint32_t m_geometryVertexCapacity = 64 << 20;
+        static constexpr uint32_t m_geometryIndexCapacity = 32 << 20;
+        std::unique_ptr<GeometryArena> m_geometryArena;
+
+        static constexpr uint64_t m_uploadPageSize = 4 << 20;
+        std::unique_ptr<UploadService> m_uploadService;
+
         Microsoft::WRL::ComPtr<IDXGISwapChain4> m_SwapChain;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_BackBuffers[m_NumFrames];
         //Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_CommandList;
@@ -31,29 +31,10 @@ namespace Olex
     {
         Microsoft::WRL::ComPtr<ID3D12Device2> device = m_app.GetDevice();
 
-        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> commandList = m_app.GetCommandQueue().CreateCommandList();
-
-        // Upload vertex buffer data.
-        ComPtr<ID3D12Resource> intermediateVertexBuffer;
-        UpdateBufferResource( commandList.Get(),
-            &m_VertexBuffer, &intermediateVertexBuffer,
-            _countof( m_Vertices ), sizeof( VertexPosColor ), m_Vertices );
-
-        // Create the vertex buffer view.
-        m_VertexBufferView.BufferLocation = m_VertexBuffer->GetGPUVirtualAddress();
-        m_VertexBufferView.SizeInBytes = sizeof( m_Vertices );
-        m_VertexBufferView.StrideInBytes = sizeof( VertexPosColor );
-
-        // Upload index buffer data.
-        ComPtr<ID3D12Resource> intermediateIndexBuffer;
-        UpdateBufferResource( commandList.Get(),
-            &m_IndexBuffer, &intermediateIndexBuffer,
-            _countof( m_Indices ), sizeof( WORD ), m_Indices );
-
-        // Create index buffer view.
-        m_IndexBufferView.BufferLocation = m_IndexBuffer->GetGPUVirtualAddress();
-        m_IndexBufferView.Format = DXGI_FORMAT_R16_UINT;
-        m_IndexBufferView.SizeInBytes = sizeof( m_Indices );
+        // Upload the cube into the shared geometry arena.
+        m_geometry = m_app.GetGeometryArena().Allocate( m_app.GetUploadService(),
+            m_Vertices, _countof( m_Vertices ), sizeof( VertexPosColor ),
+            m_Indices, _countof( m_Indices ), IndexFormat::UInt16 );
 
         // Create the descriptor heap for the depth-stencil view.
         D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc = {};
@@ -136,8 +117,9 @@ namespace Olex
         };
         ThrowIfFailed( device->CreatePipelineState( &pipelineStateStreamDesc, IID_PPV_ARGS( &m_PipelineState ) ) );
 
-        const auto fenceValue = m_app.GetCommandQueue().ExecuteCommandList( commandList );
-        m_app.GetCommandQueue().WaitForFenceValue( fenceValue );
+        // The copies run on the copy queue. The render queue waits for them on the GPU, the CPU goes on.
+        UploadService& uploadService = m_app.GetUploadService();
+        m_app.GetCommandQueue().Wait( uploadService.GetFenceWait( uploadService.Submit() ) );
 
         m_ContentLoaded = true;
 
@@ -150,7 +132,7 @@ namespace Olex
         if ( m_ContentLoaded )
         {
             // Flush any GPU commands that might be referencing the depth buffer.
-            //m_app.Flush();
+            m_app.GetCommandQueue().Flush();
 
             width = std::max( 1, width );
             height = std::max( 1, height );
@@ -198,6 +180,8 @@ namespace Olex
 
     void DemoBoxGame::UnloadResources()
     {
+        m_app.GetGeometryArena().Free( m_geometry );
+        m_geometry = {};
     }
 
     void DemoBoxGame::Update( UpdateEventArgs args )
@@ -264,8 +248,7 @@ namespace Olex
 
         // IA = Input Assembler
         commandList->IASetPrimitiveTopology( D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-        commandList->IASetVertexBuffers( 0, 1, &m_VertexBufferView );
-        commandList->IASetIndexBuffer( &m_IndexBufferView );
+        m_app.GetGeometryArena().Bind( commandList.Get(), sizeof( VertexPosColor ), IndexFormat::UInt16 );
 
         // RS = Rasterizer State
         commandList->RSSetViewports( 1, &m_Viewport );
@@ -280,7 +263,7 @@ namespace Olex
         commandList->SetGraphicsRoot32BitConstants( 0, sizeof( XMMATRIX ) / 4, &mvpMatrix, 0 );
 
         // draw the cube
-        commandList->DrawIndexedInstanced( _countof( m_Indices ), 1, 0, 0, 0 );
+        commandList->DrawIndexedInstanced( m_geometry.m_indexCount, 1, m_geometry.m_startIndex, m_geometry.m_baseVertex, 0 );
 
         // Present
         {
@@ -289,9 +272,7 @@ namespace Olex
 
             const auto fenceValue = m_app.GetCommandQueue().ExecuteCommandList( commandList );
 
-            m_app.Present();
-
-            m_app.GetCommandQueue().WaitForFenceValue( fenceValue );
+            m_app.Present( fenceValue );
         }
     }
 }
@@ -7,6 +7,7 @@
 
 #include "BaseGameInterface.h"
 #include "CommandQueue.h"
+#include "GeometryArena.h"
 
 namespace Olex
 {
@@ -38,12 +39,8 @@ namespace Olex
 
     private:
 
-        // Vertex buffer for the cube.
-        Microsoft::WRL::ComPtr<ID3D12Resource> m_VertexBuffer;
-        D3D12_VERTEX_BUFFER_VIEW m_VertexBufferView;
-        // Index buffer for the cube.
-        Microsoft::WRL::ComPtr<ID3D12Resource> m_IndexBuffer;
-        D3D12_INDEX_BUFFER_VIEW m_IndexBufferView;
+        // Where the cube lives in the shared geometry arena.
+        GeometryAllocation m_geometry;
 
         // Vertex data for a colored cube.
         struct VertexPosColor
@@ -1,10 +1,27 @@
 #include "FbxLoader.h"
 
-#include <WinString.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+
+#include "CornerGather.h"
+#include "MeshBounds.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "OverdrawOptimizer.h"
+#include "ParallelFor.h"
+#include "SubmeshSplitter.h"
+#include "TangentGenerator.h"
+#include "VertexCacheOptimizer.h"
+#include "VertexFetchOptimizer.h"
+#include "VertexWeld.h"
 
 namespace Olex
 {
-    FbxLoader::FbxLoader( const char* pathToFbxFile )
+    FbxLoader::FbxLoader( const char* pathToFbxFile, const MeshImportSettings& settings )
+        : m_settings( settings )
     {
         // Initialize the SDK manager. This object handles memory management.
         FbxManager* lSdkManager = FbxManager::Create();
@@ -19,7 +36,7 @@ namespace Olex
         // Use the first argument as the filename for the importer.
         if ( !lImporter->Initialize( pathToFbxFile, -1, lSdkManager->GetIOSettings() ) )
         {
-            throw std::exception( lImporter->GetStatus().GetErrorString() );
+            throw std::runtime_error( lImporter->GetStatus().GetErrorString() );
         }
 
         // Create a new scene so that it can be populated by the imported file.
@@ -39,31 +56,75 @@ namespace Olex
         {
             for ( int i = 0; i < lRootNode->GetChildCount(); i++ )
             {
-                PrintNode( lRootNode->GetChild( i ) );
+                PrintNode( lRootNode->GetChild( i ), Scene::NoParent );
             }
         }
+
+        if ( m_settings.m_importSkins )
+            BuildSkeleton();
+
+        if ( m_settings.m_importAnimations )
+            BakeAnimations( lScene );
+
+        ReadMeshes();
+        m_scene.UpdateWorldTransforms();
+
         // Destroy the SDK manager and all the other objects it was handling.
         lSdkManager->Destroy();
     }
 
+    // The importer only runs inside the bake tool, so its log goes to the console.
     struct Log
     {
         template <typename ...Args>
         static void Message( const char* format, Args ...args )
         {
             char buffer[1000];
-            sprintf_s( buffer, _countof( buffer ), format, std::forward<Args>( args )... );
-            OutputDebugStringA( buffer );
+            std::snprintf( buffer, sizeof( buffer ), format, args... );
+            Write( buffer );
+        }
+
+        // Formats into a buffer instead, for work running on other threads to be printed in order later.
+        template <typename ...Args>
+        static void Append( std::string& log, const char* format, Args ...args )
+        {
+            char buffer[1000];
+            std::snprintf( buffer, sizeof( buffer ), format, args... );
+            log += buffer;
         }
+
+        static void Write( const char* text ) { std::fputs( text, stdout ); }
     };
 
+    namespace
+    {
+        // FbxAMatrix keeps the translation in its last row like DirectXMath, so the layout carries over as is.
+        DirectX::XMFLOAT4X4 ToFloat4x4( const FbxAMatrix& matrix )
+        {
+            DirectX::XMFLOAT4X4 result;
+            for ( int row = 0; row < 4; ++row )
+            {
+                for ( int column = 0; column < 4; ++column )
+                    result.m[row][column] = static_cast<float>( matrix.Get( row, column ) );
+            }
+            return result;
+        }
+    }
+
     /**
      * Print a node, its attributes, and all its children recursively.
+     * The node is added to the scene after its parent, keeping the scene in depth-first order.
      */
-    void FbxLoader::PrintNode( FbxNode* pNode )
+    void FbxLoader::PrintNode( FbxNode* pNode, int32_t parent )
     {
         PrintTabs();
         const char* nodeName = pNode->GetName();
+
+        // Includes pivots, pre/post rotations and the rotation order, which the raw Lcl properties leave out.
+        const uint32_t node = m_scene.AddNode( nodeName, parent, ToFloat4x4( pNode->EvaluateLocalTransform() ) );
+        m_nodeIndices.emplace( pNode, node );
+        m_fbxNodes.push_back( pNode );
+
         FbxDouble3 translation = pNode->LclTranslation.Get();
         FbxDouble3 rotation = pNode->LclRotation.Get();
         FbxDouble3 scaling = pNode->LclScaling.Get();
@@ -80,11 +141,11 @@ namespace Olex
 
         // Print the node's attributes.
         for ( int i = 0; i < pNode->GetNodeAttributeCount(); i++ )
-            PrintAttribute( pNode->GetNodeAttributeByIndex( i ) );
+            PrintAttribute( pNode->GetNodeAttributeByIndex( i ), node );
 
         // Recursively print the children.
         for ( int j = 0; j < pNode->GetChildCount(); j++ )
-            PrintNode( pNode->GetChild( j ) );
+            PrintNode( pNode->GetChild( j ), static_cast<int32_t>( node ) );
 
         numTabs--;
         PrintTabs();
@@ -97,7 +158,7 @@ namespace Olex
             Log::Message( "\t" );
     }
 
-    void FbxLoader::PrintAttribute( FbxNodeAttribute* pAttribute )
+    void FbxLoader::PrintAttribute( FbxNodeAttribute* pAttribute, uint32_t node )
     {
         if ( !pAttribute ) return;
 
@@ -108,74 +169,475 @@ namespace Olex
         // Note: to retrieve the character array of a FbxString, use its Buffer() method.
         Log::Message( "<attribute type='%s' name='%s'/>\n", typeName.Buffer(), attrName.Buffer() );
 
+        // Only collected here, ReadMeshes extracts them all once the tree is walked.
         if ( pAttribute->GetAttributeType() == FbxNodeAttribute::eMesh )
         {
-            m_meshes.push_back( ReadMesh( pAttribute ) );
+            auto* fbxMesh = static_cast<FbxMesh*>( pAttribute );
+            const auto [entry, inserted] = m_meshIndices.emplace( fbxMesh, static_cast<uint32_t>( m_fbxMeshes.size() ) );
+            if ( inserted )
+            {
+                m_fbxMeshes.push_back( fbxMesh );
+            }
+
+            FbxNode* fbxNode = pAttribute->GetNode();
+            const FbxAMatrix geometryTransform(
+                fbxNode->GetGeometricTranslation( FbxNode::eSourcePivot ),
+                fbxNode->GetGeometricRotation( FbxNode::eSourcePivot ),
+                fbxNode->GetGeometricScaling( FbxNode::eSourcePivot ) );
+
+            MeshInstance instance;
+            instance.m_mesh = entry->second;
+            instance.m_node = node;
+            instance.m_geometryTransform = ToFloat4x4( geometryTransform );
+            // Meshes are not split per material, the node's first one covers the whole mesh.
+            if ( fbxNode->GetMaterialCount() > 0 )
+                instance.m_material = ReadMaterial( fbxNode->GetMaterial( 0 ) );
+            m_scene.AddMeshInstance( instance );
+        }
+    }
+
+    namespace
+    {
+        /**
+         * Reads a layer element straight from its direct and index arrays, calling store( polygonVertex, value )
+         * for every polygon vertex of a triangle mesh. The mapping and reference modes are resolved once,
+         * instead of once per corner as GetPolygonVertexUV / GetPolygonVertexNormal do.
+         *
+         * Returns false, having stored nothing or only part, for a missing element, eByEdge mapping or
+         * an out of range index; the caller then falls back to the per-corner SDK calls.
+         */
+        template <typename T, typename Store>
+        bool GatherLayerElement( const FbxLayerElementTemplate<T>* element, const int* polygonVertices, int polygonVertexCount, Store store )
+        {
+            if ( !element )
+                return false;
+
+            LayerMapping mapping;
+            switch ( element->GetMappingMode() )
+            {
+            case FbxLayerElement::eByControlPoint: mapping = LayerMapping::ByControlPoint; break;
+            case FbxLayerElement::eByPolygonVertex: mapping = LayerMapping::ByPolygonVertex; break;
+            case FbxLayerElement::eByPolygon: mapping = LayerMapping::ByPolygon; break;
+            case FbxLayerElement::eAllSame: mapping = LayerMapping::AllSame; break;
+            default: return false;
+            }
+
+            FbxLayerElementArrayTemplate<T>& directArray = element->GetDirectArray();
+            const FbxLayerElementArrayReadLock<T> directLock( directArray );
+            const T* direct = directLock.GetData();
+            const int directCount = directArray.GetCount();
+            if ( !direct )
+                return false;
+
+            // eIndex is the pre-7.0 spelling of eIndexToDirect.
+            const bool indexed = element->GetReferenceMode() != FbxLayerElement::eDirect;
+            FbxLayerElementArrayTemplate<int>& indexArray = element->GetIndexArray();
+            const FbxLayerElementArrayReadLock<int> indexLock( indexArray );
+            const int* indices = indexed ? indexLock.GetData() : nullptr;
+            const int indexCount = indexed ? indexArray.GetCount() : 0;
+            if ( indexed && !indices )
+                return false;
+
+            return GatherLayerIndices( mapping, polygonVertices, polygonVertexCount, indices, indexCount, directCount,
+                [&]( int polygonVertex, int directIndex ) { store( polygonVertex, direct[directIndex] ); } );
+        }
+    }
+
+    void FbxLoader::ReadMeshes()
+    {
+        // Meshes are independent, each one writes only its own slot, so the order of
+        // m_meshes and of the log stays the scene order whatever the scheduling.
+        m_meshes.resize( m_fbxMeshes.size() );
+        std::vector<std::string> logs( m_fbxMeshes.size() );
+
+        ParallelFor( m_fbxMeshes.size(), [this, &logs]( size_t i )
+            {
+                m_meshes[i] = ReadMesh( m_fbxMeshes[i], logs[i] );
+            } );
+
+        for ( size_t i = 0; i < logs.size(); ++i )
+        {
+            const FbxNode* fbxNode = m_fbxMeshes[i]->GetNode();
+            Log::Message( "<meshImport index='%zu' name='%s'>\n", i, fbxNode ? fbxNode->GetName() : "" );
+            Log::Write( logs[i].c_str() );
+            Log::Message( "</meshImport>\n" );
         }
+
+        m_fbxMeshes.clear();
+        m_meshIndices.clear();
+        m_nodeIndices.clear();
+        m_fbxNodes.clear();
     }
 
-    FbxLoader::Mesh FbxLoader::ReadMesh( FbxNodeAttribute* pAttribute )
+    void FbxLoader::BuildSkeleton()
     {
-        Mesh mesh;
+        // Ordered by node, which is scene order, so parents come before their children.
+        std::map<uint32_t, DirectX::XMFLOAT4X4> bindPoses;
+        for ( FbxMesh* fbxMesh : m_fbxMeshes )
+        {
+            if ( fbxMesh->GetDeformerCount( FbxDeformer::eSkin ) == 0 )
+                continue;
+
+            auto* fbxSkin = static_cast<FbxSkin*>( fbxMesh->GetDeformer( 0, FbxDeformer::eSkin ) );
+            for ( int i = 0; i < fbxSkin->GetClusterCount(); ++i )
+            {
+                FbxCluster* cluster = fbxSkin->GetCluster( i );
+                const auto node = m_nodeIndices.find( cluster->GetLink() );
+                if ( node == m_nodeIndices.end() )
+                    continue;
+
+                FbxAMatrix linkBind;
+                cluster->GetTransformLinkMatrix( linkBind );
+                bindPoses.emplace( node->second, ToFloat4x4( linkBind ) );
+            }
+        }
 
-        if ( FbxMesh* fbxMesh = pAttribute->GetNode()->GetMesh() )
+        std::unordered_map<uint32_t, int32_t> jointOfNode;
+        const std::vector<int32_t>& parents = m_scene.GetParents();
+        for ( const auto& [node, bindPose] : bindPoses )
         {
+            int32_t parentJoint = Skeleton::NoParent;
+            for ( int32_t ancestor = parents[node]; ancestor != Scene::NoParent && parentJoint == Skeleton::NoParent; ancestor = parents[ancestor] )
             {
-                const FbxVector4* vertexBuffer = fbxMesh->GetControlPoints();
-                const int vertexCount = fbxMesh->GetControlPointsCount();
-                mesh.m_vertices.resize( vertexCount );
+                const auto joint = jointOfNode.find( static_cast<uint32_t>( ancestor ) );
+                if ( joint != jointOfNode.end() )
+                    parentJoint = joint->second;
+            }
 
-                for ( int vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex )
+            jointOfNode.emplace( node, static_cast<int32_t>( m_skeleton.m_nodes.size() ) );
+            m_skeleton.m_nodes.push_back( node );
+            m_skeleton.m_parents.push_back( parentJoint );
+            m_skeleton.m_bindPose.push_back( bindPose );
+        }
+
+        Log::Message( "<skeleton joints='%zu'/>\n", m_skeleton.m_nodes.size() );
+    }
+
+    uint32_t FbxLoader::ReadMaterial( FbxSurfaceMaterial* fbxMaterial )
+    {
+        const auto known = m_materialIndices.find( fbxMaterial );
+        if ( known != m_materialIndices.end() )
+            return known->second;
+
+        Material material;
+        material.m_name = fbxMaterial->GetName();
+
+        const FbxProperty diffuse = fbxMaterial->FindProperty( FbxSurfaceMaterial::sDiffuse );
+        if ( diffuse.IsValid() )
+        {
+            const FbxDouble3 color = diffuse.Get<FbxDouble3>();
+            const FbxProperty diffuseFactor = fbxMaterial->FindProperty( FbxSurfaceMaterial::sDiffuseFactor );
+            const double factor = diffuseFactor.IsValid() ? diffuseFactor.Get<FbxDouble>() : 1.0;
+            material.m_baseColor = { float( color[0] * factor ), float( color[1] * factor ), float( color[2] * factor ), 1.f };
+
+            if ( const FbxFileTexture* texture = diffuse.GetSrcObject<FbxFileTexture>( 0 ) )
+                material.m_baseColorTexture = texture->GetRelativeFileName();
+        }
+
+        const uint32_t index = m_scene.AddMaterial( material );
+        m_materialIndices.emplace( fbxMaterial, index );
+
+        PrintTabs();
+        Log::Message( "<material name='%s' texture='%s'/>\n", material.m_name.c_str(), material.m_baseColorTexture.c_str() );
+        return index;
+    }
+
+    void FbxLoader::BakeAnimations( FbxScene* fbxScene )
+    {
+        const float sampleRate = m_settings.m_animationSampleRate;
+        const std::vector<DirectX::XMFLOAT4X4>& sceneTransforms = m_scene.GetLocalTransforms();
+
+        for ( int i = 0; i < fbxScene->GetSrcObjectCount<FbxAnimStack>(); ++i )
+        {
+            FbxAnimStack* stack = fbxScene->GetSrcObject<FbxAnimStack>( i );
+            fbxScene->SetCurrentAnimationStack( stack );
+
+            const FbxTimeSpan span = stack->GetLocalTimeSpan();
+            const double start = span.GetStart().GetSecondDouble();
+            const double stop = std::max( span.GetStop().GetSecondDouble(), start );
+            // The last sample lands on the stop time, or just past it for a duration that is no whole number of frames.
+            const uint32_t frameCount = static_cast<uint32_t>( std::ceil( ( stop - start ) * sampleRate - 1e-4 ) ) + 1;
+
+            BakedClip baked;
+            baked.m_name = stack->GetName();
+            baked.m_sampleRate = sampleRate;
+            baked.m_frameCount = frameCount;
+
+            std::vector<DirectX::XMFLOAT4X4> localTransforms( frameCount );
+            for ( uint32_t node = 0; node < m_fbxNodes.size(); ++node )
+            {
+                bool animated = false;
+                for ( uint32_t frame = 0; frame < frameCount; ++frame )
                 {
-                    const double* buffer = vertexBuffer[vertexIndex].Buffer();
-                    const DirectX::XMFLOAT3 vertex = { static_cast<float>( buffer[0] ), static_cast<float>( buffer[1] ), static_cast<float>( buffer[2] ) };
-                    mesh.m_vertices[vertexIndex].m_position = vertex;
+                    FbxTime time;
+                    time.SetSecondDouble( std::min( start + frame / double( sampleRate ), stop ) );
+                    localTransforms[frame] = ToFloat4x4( m_fbxNodes[node]->EvaluateLocalTransform( time ) );
+
+                    const float* sample = &localTransforms[frame].m[0][0];
+                    const float* sceneTransform = &sceneTransforms[node].m[0][0];
+                    for ( int element = 0; element < 16 && !animated; ++element )
+                        animated = std::fabs( sample[element] - sceneTransform[element] ) > 1e-6f;
                 }
+                if ( !animated )
+                    continue;
+
+                baked.m_nodes.push_back( node );
+                for ( const DirectX::XMFLOAT4X4& localTransform : localTransforms )
+                    baked.m_samples.push_back( DecomposeTransform( localTransform ) );
             }
 
-            const bool check = fbxMesh->IsTriangleMesh();
-            if ( check == false )
+            AnimationClip clip = CompressClip( baked, m_settings.m_animationCompression );
+            const AnimationError error = MeasureClipError( baked, clip );
+            Log::Message( "<animation name='%s' frames='%u' tracks='%zu' keys='%zu' bytes='%zu' bakedBytes='%zu' maxTranslationError='%f' maxRotationError='%f' maxScaleError='%f'/>\n",
+                clip.m_name.c_str(), clip.m_frameCount, clip.m_tracks.size(), clip.m_keyFrames.size(), clip.GetByteSize(),
+                baked.m_samples.size() * sizeof( TransformSample ),
+                error.m_maxTranslationError, error.m_maxRotationError, error.m_maxScaleError );
+
+            m_animations.push_back( std::move( clip ) );
+        }
+    }
+
+    MeshSkin FbxLoader::ReadSkin( FbxSkin* fbxSkin, const std::vector<int>& vertexControlPoints, int controlPointCount ) const
+    {
+        const int clusterCount = fbxSkin->GetClusterCount();
+        if ( clusterCount > static_cast<int>( MaxSkinJoints ) )
+        {
+            throw std::runtime_error( "Skinned mesh uses more than 256 joints!" );
+        }
+
+        // Influences grouped per control point: counted first, then filled in place.
+        std::vector<uint32_t> influenceStart( static_cast<size_t>( controlPointCount ) + 1, 0 );
+        for ( int i = 0; i < clusterCount; ++i )
+        {
+            FbxCluster* cluster = fbxSkin->GetCluster( i );
+            const int* controlPoints = cluster->GetControlPointIndices();
+            for ( int k = 0; k < cluster->GetControlPointIndicesCount(); ++k )
+            {
+                if ( controlPoints[k] >= 0 && controlPoints[k] < controlPointCount )
+                    ++influenceStart[controlPoints[k] + 1];
+            }
+        }
+        for ( int controlPoint = 0; controlPoint < controlPointCount; ++controlPoint )
+            influenceStart[controlPoint + 1] += influenceStart[controlPoint];
+
+        std::vector<uint32_t> joints( influenceStart.back() );
+        std::vector<float> weights( influenceStart.back() );
+        std::vector<uint32_t> cursor( influenceStart.begin(), influenceStart.end() - 1 );
+
+        MeshSkin skin;
+        for ( int i = 0; i < clusterCount; ++i )
+        {
+            FbxCluster* cluster = fbxSkin->GetCluster( i );
+            const auto node = m_nodeIndices.find( cluster->GetLink() );
+            if ( node == m_nodeIndices.end() )
             {
-                throw std::exception( "Only supported triangles in fbx mesh!" );
+                throw std::runtime_error( "Skin cluster is not linked to a scene node!" );
             }
 
-            const bool hasUV = fbxMesh->GetElementUVCount() > 0;
+            // Mesh space at bind time -> world -> joint space.
+            FbxAMatrix meshBind;
+            FbxAMatrix linkBind;
+            cluster->GetTransformMatrix( meshBind );
+            cluster->GetTransformLinkMatrix( linkBind );
+            skin.m_jointNodes.push_back( node->second );
+            skin.m_inverseBindMatrices.push_back( ToFloat4x4( linkBind.Inverse() * meshBind ) );
+
+            const int* controlPoints = cluster->GetControlPointIndices();
+            const double* controlPointWeights = cluster->GetControlPointWeights();
+            for ( int k = 0; k < cluster->GetControlPointIndicesCount(); ++k )
+            {
+                if ( controlPoints[k] < 0 || controlPoints[k] >= controlPointCount )
+                    continue;
 
-            FbxStringList lUVNames;
-            fbxMesh->GetUVSetNames( lUVNames );
-            const auto uvCount = lUVNames.GetCount();
-            const char* uvName = lUVNames[0]; ///
+                const uint32_t slot = cursor[controlPoints[k]]++;
+                joints[slot] = static_cast<uint32_t>( i );
+                weights[slot] = static_cast<float>( controlPointWeights[k] );
+            }
+        }
+
+        skin.m_vertices.resize( vertexControlPoints.size() );
+        for ( size_t vertex = 0; vertex < vertexControlPoints.size(); ++vertex )
+        {
+            const uint32_t start = influenceStart[vertexControlPoints[vertex]];
+            const uint32_t end = influenceStart[vertexControlPoints[vertex] + 1];
+            skin.m_vertices[vertex] = PackInfluences( joints.data() + start, weights.data() + start, end - start );
+        }
+
+        return skin;
+    }
+
+    FbxLoader::Mesh FbxLoader::ReadMesh( FbxMesh* fbxMesh, std::string& log ) const
+    {
+        const bool check = fbxMesh->IsTriangleMesh();
+        if ( check == false )
+        {
+            throw std::runtime_error( "Only supported triangles in fbx mesh!" );
+        }
 
-            const int polygonCount = fbxMesh->GetPolygonCount();
-            mesh.m_indices.reserve( polygonCount );
+        FbxStringList lUVNames;
+        fbxMesh->GetUVSetNames( lUVNames );
+        const char* uvName = lUVNames.GetCount() > 0 ? lUVNames[0] : nullptr;
 
-            for ( int polygonIndex = 0; polygonIndex < polygonCount; ++polygonIndex )
+        // Gather every triangle corner with its own uv and normal, the same control point
+        // can carry different attributes on different polygons (uv seams, hard edges).
+        const int polygonCount = fbxMesh->GetPolygonCount();
+        std::vector<Mesh::VertexInfo> corners( static_cast<size_t>( polygonCount ) * 3 );
+
+        const FbxVector4* controlPoints = fbxMesh->GetControlPoints();
+        const int* polygonVertices = fbxMesh->GetPolygonVertices();
+        const int polygonVertexCount = polygonCount * 3;
+        for ( int polygonVertex = 0; polygonVertex < polygonVertexCount; ++polygonVertex )
+        {
+            const double* position = controlPoints[polygonVertices[polygonVertex]].Buffer();
+            corners[CornerSlot( polygonVertex )].m_position = { static_cast<float>( position[0] ), static_cast<float>( position[1] ), static_cast<float>( position[2] ) };
+        }
+
+        const bool uvsGathered = !uvName || GatherLayerElement( fbxMesh->GetElementUV( uvName ), polygonVertices, polygonVertexCount,
+            [&corners]( int polygonVertex, const FbxVector2& uv )
             {
-                const int vertexIndex0 = fbxMesh->GetPolygonVertex( polygonIndex, 0 );
-                const int vertexIndex1 = fbxMesh->GetPolygonVertex( polygonIndex, 1 );
-                const int vertexIndex2 = fbxMesh->GetPolygonVertex( polygonIndex, 2 );
+                corners[CornerSlot( polygonVertex )].m_uv = { static_cast<float>( uv.Buffer()[0] ), static_cast<float>( uv.Buffer()[1] ) };
+            } );
 
-                mesh.m_indices.emplace_back( vertexIndex0, vertexIndex2, vertexIndex1 );
+        const bool normalsGathered = GatherLayerElement( fbxMesh->GetElementNormal(), polygonVertices, polygonVertexCount,
+            [&corners]( int polygonVertex, const FbxVector4& normal )
+            {
+                corners[CornerSlot( polygonVertex )].m_normal = { static_cast<float>( normal.Buffer()[0] ), static_cast<float>( normal.Buffer()[1] ), static_cast<float>( normal.Buffer()[2] ) };
+            } );
+
+        // Mapping modes the direct path does not handle go through the SDK one corner at a time.
+        if ( !uvsGathered || !normalsGathered )
+        {
+            Log::Append( log, "\t<slowPath uv='%d' normal='%d'/>\n", !uvsGathered, !normalsGathered );
+
+            for ( int polygonVertex = 0; polygonVertex < polygonVertexCount; ++polygonVertex )
+            {
+                const int polygonIndex = polygonVertex / 3;
+                const int positionInPolygon = polygonVertex % 3;
+                Mesh::VertexInfo& vertex = corners[CornerSlot( polygonVertex )];
 
-                bool unmapped;
-                FbxVector2 uv;
-                bool result = fbxMesh->GetPolygonVertexUV( polygonIndex, 0, uvName, uv, unmapped );
-                mesh.m_vertices[vertexIndex0].m_uv = { static_cast<float>( uv.Buffer()[0] ), static_cast<float>( uv.Buffer()[1] ) };
-                result = fbxMesh->GetPolygonVertexUV( polygonIndex, 1, uvName, uv, unmapped );
-                mesh.m_vertices[vertexIndex1].m_uv = { static_cast<float>( uv.Buffer()[0] ), static_cast<float>( uv.Buffer()[1] ) };
-                result = fbxMesh->GetPolygonVertexUV( polygonIndex, 2, uvName, uv, unmapped );
-                mesh.m_vertices[vertexIndex2].m_uv = { static_cast<float>( uv.Buffer()[0] ), static_cast<float>( uv.Buffer()[1] ) };
+                if ( !uvsGathered )
+                {
+                    FbxVector2 uv( 0, 0 );
+                    bool unmapped;
+                    fbxMesh->GetPolygonVertexUV( polygonIndex, positionInPolygon, uvName, uv, unmapped );
+                    vertex.m_uv = { static_cast<float>( uv.Buffer()[0] ), static_cast<float>( uv.Buffer()[1] ) };
+                }
 
-                FbxVector4 normal;
-                result = fbxMesh->GetPolygonVertexNormal( polygonIndex, 0, normal );
-                mesh.m_vertices[vertexIndex0].m_normal = { static_cast<float>( normal.Buffer()[0] ), static_cast<float>( normal.Buffer()[1] ), static_cast<float>( normal.Buffer()[2] ) };
-                result = fbxMesh->GetPolygonVertexNormal( polygonIndex, 1, normal );
-                mesh.m_vertices[vertexIndex1].m_normal = { static_cast<float>( normal.Buffer()[0] ), static_cast<float>( normal.Buffer()[1] ), static_cast<float>( normal.Buffer()[2] ) };
-                result = fbxMesh->GetPolygonVertexNormal( polygonIndex, 2, normal );
-                mesh.m_vertices[vertexIndex2].m_normal = { static_cast<float>( normal.Buffer()[0] ), static_cast<float>( normal.Buffer()[1] ), static_cast<float>( normal.Buffer()[2] ) };
+                if ( !normalsGathered )
+                {
+                    FbxVector4 normal( 0, 0, 0 );
+                    fbxMesh->GetPolygonVertexNormal( polygonIndex, positionInPolygon, normal );
+                    vertex.m_normal = { static_cast<float>( normal.Buffer()[0] ), static_cast<float>( normal.Buffer()[1] ), static_cast<float>( normal.Buffer()[2] ) };
+                }
             }
         }
 
+        // Skin weights belong to control points, which the attributes do not show: coincident control
+        // points with the same uv and normal may still be bound differently, so they must not weld.
+        const bool importSkin = m_settings.m_importSkins && fbxMesh->GetDeformerCount( FbxDeformer::eSkin ) > 0;
+        std::vector<uint32_t> cornerControlPoints;
+        if ( importSkin )
+        {
+            cornerControlPoints.resize( corners.size() );
+            for ( int polygonVertex = 0; polygonVertex < polygonVertexCount; ++polygonVertex )
+                cornerControlPoints[CornerSlot( polygonVertex )] = static_cast<uint32_t>( polygonVertices[polygonVertex] );
+        }
+
+        Mesh mesh = WeldVertices( corners, cornerControlPoints );
+
+        Log::Append( log, "\t<mesh triangles='%d' controlPoints='%d' vertices='%zu'/>\n",
+            polygonCount, fbxMesh->GetControlPointsCount(), mesh.m_vertices.size() );
+
+        if ( importSkin )
+        {
+            // Welding keeps the corner order, so the index buffer tells which vertex each corner became.
+            // Corners were only welded within one control point, so every vertex has exactly one.
+            std::vector<int> vertexControlPoints( mesh.m_vertices.size(), 0 );
+            const auto* cornerVertices = reinterpret_cast<const uint32_t*>( mesh.m_indices.data() );
+            for ( size_t corner = 0; corner < cornerControlPoints.size(); ++corner )
+                vertexControlPoints[cornerVertices[corner]] = static_cast<int>( cornerControlPoints[corner] );
+
+            mesh.m_skin = ReadSkin( static_cast<FbxSkin*>( fbxMesh->GetDeformer( 0, FbxDeformer::eSkin ) ),
+                vertexControlPoints, fbxMesh->GetControlPointsCount() );
+
+            Log::Append( log, "\t<skin joints='%zu'/>\n", mesh.m_skin.m_jointNodes.size() );
+        }
+
+        // Before the reordering stages, as it may split vertices.
+        if ( m_settings.m_generateTangents )
+        {
+            const TangentStatistics statistics = GenerateTangents( mesh );
+
+            Log::Append( log, "\t<tangents splitVertices='%u' degenerateTriangles='%u' fallbackVertices='%u'/>\n",
+                statistics.m_splitVertices, statistics.m_degenerateTriangles, statistics.m_fallbackVertices );
+        }
+
+        if ( m_settings.m_optimizeVertexCache )
+        {
+            const VertexCacheStatistics before = AnalyzeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+            OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+            const VertexCacheStatistics after = AnalyzeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+
+            Log::Append( log, "\t<vertexCache acmr='%.3f -> %.3f' atvr='%.3f -> %.3f'/>\n",
+                before.m_acmr, after.m_acmr, before.m_atvr, after.m_atvr );
+
+            if ( m_settings.m_optimizeOverdraw )
+            {
+                const OverdrawStatistics overdrawBefore = AnalyzeOverdraw( mesh );
+                OptimizeOverdraw( mesh, m_settings.m_overdrawThreshold );
+                const OverdrawStatistics overdrawAfter = AnalyzeOverdraw( mesh );
+                const VertexCacheStatistics cacheAfter = AnalyzeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+
+                Log::Append( log, "\t<overdraw overdraw='%.3f -> %.3f' acmr='%.3f'/>\n",
+                    overdrawBefore.m_overdraw, overdrawAfter.m_overdraw, cacheAfter.m_acmr );
+            }
+        }
+
+        if ( m_settings.m_optimizeVertexFetch )
+        {
+            const VertexFetchStatistics before = AnalyzeVertexFetch( mesh );
+            OptimizeVertexFetch( mesh );
+            const VertexFetchStatistics after = AnalyzeVertexFetch( mesh );
+
+            Log::Append( log, "\t<vertexFetch overfetch='%.3f -> %.3f' bytesPerVertex='%.1f -> %.1f'/>\n",
+                before.m_overfetch, after.m_overfetch, before.m_bytesPerVertex, after.m_bytesPerVertex );
+        }
+
+        // After the reordering stages, so a split follows the optimized triangle order.
+        mesh.m_submeshes = SplitSubmeshes( mesh );
+        mesh.m_indexFormat = SelectIndexFormat( mesh.m_submeshes );
+
+        Log::Append( log, "\t<indices format='%s' submeshes='%zu' vertices='%zu'/>\n",
+            mesh.m_indexFormat == IndexFormat::UInt16 ? "16-bit" : "32-bit", mesh.m_submeshes.size(), mesh.m_vertices.size() );
+
+        if ( m_settings.m_lodCount > 0 )
+        {
+            mesh.m_lods = BuildLodChain( mesh, m_settings.m_lodCount, m_settings.m_lodReduction );
+
+            for ( MeshLod& lod : mesh.m_lods )
+            {
+                if ( m_settings.m_optimizeVertexCache )
+                    OptimizeVertexCache( lod.m_indices, mesh.m_vertices.size() );
+
+                Log::Append( log, "\t<lod triangles='%zu' error='%f'/>\n", lod.m_indices.size(), lod.m_error );
+            }
+        }
+
+        ComputeMeshBounds( mesh );
+
+        Log::Append( log, "\t<bounds min='%f %f %f' max='%f %f %f' radius='%f'/>\n",
+            mesh.m_bounds.m_min.x, mesh.m_bounds.m_min.y, mesh.m_bounds.m_min.z,
+            mesh.m_bounds.m_max.x, mesh.m_bounds.m_max.y, mesh.m_bounds.m_max.z, mesh.m_bounds.m_sphereRadius );
+
+        if ( m_settings.m_buildMeshlets )
+        {
+            mesh.m_meshlets = BuildMeshlets( mesh );
+            const MeshletStatistics statistics = AnalyzeMeshlets( mesh.m_meshlets );
+
+            Log::Append( log, "\t<meshlets count='%u' vertexFill='%.3f' triangleFill='%.3f'/>\n",
+                statistics.m_meshletCount, statistics.m_vertexFill, statistics.m_triangleFill );
+        }
+
         return mesh;
     }
 
@@ -2,40 +2,95 @@
 
 #include <DirectXMath.h>
 #include <fbxsdk.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "AnimationClip.h"
+#include "Mesh.h"
+#include "Scene.h"
+
 namespace Olex
 {
+    /**
+     * Optional processing stages applied to every mesh after it is read from the fbx file.
+     */
+    struct MeshImportSettings
+    {
+        // Reorder triangles for post-transform vertex cache reuse.
+        bool m_optimizeVertexCache = true;
+        // Reorder triangle clusters to reduce overdraw, runs after the vertex cache stage only.
+        bool m_optimizeOverdraw = true;
+        // How much worse the vertex cache ACMR may get for less overdraw, 1.05 allows 5%.
+        float m_overdrawThreshold = 1.05f;
+        // Renumber vertices in first-use order once the triangle order is final.
+        bool m_optimizeVertexFetch = true;
+        // Read FbxSkin joint influences of skinned meshes and build the bind-pose skeleton.
+        bool m_importSkins = true;
+        // Bake every animation stack to fixed-rate node samples and compress them into clips.
+        bool m_importAnimations = true;
+        // Samples per second of the baked animation.
+        float m_animationSampleRate = 30.f;
+        AnimationCompressionSettings m_animationCompression;
+        // Generate MikkTSpace tangent frames for normal mapping.
+        bool m_generateTangents = false;
+        // Split the final index buffer into meshlets with culling bounds.
+        bool m_buildMeshlets = false;
+        // Simplified index buffers to build, 0 disables the stage.
+        uint32_t m_lodCount = 0;
+        // Triangles of each level relative to the level before it.
+        float m_lodReduction = 0.5f;
+    };
+
     class FbxLoader
     {
     public:
-        explicit FbxLoader( const char* pathToFbxFile );
-
-        struct Mesh
-        {
-            struct VertexInfo
-            {
-                DirectX::XMFLOAT3 m_position;
-                DirectX::XMFLOAT2 m_uv;
-                DirectX::XMFLOAT3 m_normal;
-            };
+        explicit FbxLoader( const char* pathToFbxFile, const MeshImportSettings& settings = {} );
 
-            std::vector<VertexInfo> m_vertices;
-            std::vector<DirectX::XMINT3> m_indices;
-        };
+        using Mesh = Olex::Mesh;
 
         [[nodiscard]] const std::vector<Mesh>& GetMeshes() const { return m_meshes; }
+        // Node hierarchy with world transforms up to date; its mesh instances index GetMeshes().
+        [[nodiscard]] const Scene& GetScene() const { return m_scene; }
+        // Joints of every skinned mesh; MeshSkin::m_jointNodes index the scene nodes.
+        [[nodiscard]] const Skeleton& GetSkeleton() const { return m_skeleton; }
+        // One clip per animation stack; tracks animate scene nodes, see ClipSampler::Apply.
+        [[nodiscard]] const std::vector<AnimationClip>& GetAnimations() const { return m_animations; }
 
     private:
+        MeshImportSettings m_settings;
         std::vector<Mesh> m_meshes;
-        Mesh ReadMesh( FbxNodeAttribute* pAttribute );
+        Scene m_scene;
+        Skeleton m_skeleton;
+        std::vector<AnimationClip> m_animations;
+        // Source node of every scene node, by scene node index.
+        std::vector<FbxNode*> m_fbxNodes;
+        std::unordered_map<const FbxNode*, uint32_t> m_nodeIndices;
+        // Meshes found while walking the scene, in scene order. A mesh shared by several
+        // nodes is read once and instanced, m_meshIndices maps it to its index in m_meshes.
+        std::vector<FbxMesh*> m_fbxMeshes;
+        std::unordered_map<FbxMesh*, uint32_t> m_meshIndices;
+        std::unordered_map<FbxSurfaceMaterial*, uint32_t> m_materialIndices;
+
+        // Extracts every collected mesh in parallel, see ParallelFor.
+        void ReadMeshes();
+        // Thread safe as long as each call gets its own mesh; log receives the messages.
+        Mesh ReadMesh( FbxMesh* fbxMesh, std::string& log ) const;
+        // Joint influences per vertex; vertexControlPoints gives the control point each welded vertex came from.
+        MeshSkin ReadSkin( FbxSkin* fbxSkin, const std::vector<int>& vertexControlPoints, int controlPointCount ) const;
+        // Gathers the joints and bind poses of every skin cluster, once all nodes are in the scene.
+        void BuildSkeleton();
+        // Adds the material to the scene the first time it is seen; returns its scene index.
+        uint32_t ReadMaterial( FbxSurfaceMaterial* fbxMaterial );
+        // Samples the local transform of every node over each animation stack; nodes that keep their scene transform get no track.
+        void BakeAnimations( FbxScene* fbxScene );
 
         /* Tab character ("\t") counter */
         int numTabs = 0;
 
-        void PrintNode( FbxNode* pNode );
+        void PrintNode( FbxNode* pNode, int32_t parent );
         void PrintTabs();
-        void PrintAttribute( FbxNodeAttribute* pAttribute );
+        void PrintAttribute( FbxNodeAttribute* pAttribute, uint32_t node );
         FbxString GetAttributeTypeName( FbxNodeAttribute::EType type );
     };
 }
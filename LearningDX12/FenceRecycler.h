@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+namespace Olex
+{
+    struct FenceRecyclerStats
+    {
+        // Acquires served from the pool and acquires that found nothing the GPU was done with.
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+    };
+
+    /**
+     * Pool of objects the GPU may still be using, each tagged with the fence value of the submission
+     * that last used it. An object is handed out again only once the fence has completed.
+     *
+     * Objects must be released in non-decreasing fence order, as they are when the values come from
+     * one queue, so only the oldest entry ever needs checking. The completed fence value is passed in
+     * rather than read from a fence, which keeps the recycler free of D3D12 and testable on its own.
+     */
+    template <typename T>
+    class FenceRecycler
+    {
+    public:
+        // Moves the oldest object into object if its fence has completed. False counts as a miss.
+        bool TryAcquire( uint64_t completedFenceValue, T& object )
+        {
+            if ( m_entries.empty() || m_entries.front().first > completedFenceValue )
+            {
+                ++m_stats.m_misses;
+                return false;
+            }
+
+            object = std::move( m_entries.front().second );
+            m_entries.pop_front();
+            ++m_stats.m_hits;
+            return true;
+        }
+
+        // Fence value 0 makes the object available to the next acquire.
+        void Release( T object, uint64_t fenceValue )
+        {
+            m_entries.emplace_back( fenceValue, std::move( object ) );
+        }
+
+        [[nodiscard]] size_t GetPooledCount() const { return m_entries.size(); }
+        [[nodiscard]] const FenceRecyclerStats& GetStats() const { return m_stats; }
+
+    private:
+        std::deque<std::pair<uint64_t, T>> m_entries;
+        FenceRecyclerStats m_stats;
+    };
+}
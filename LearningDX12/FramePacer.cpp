@@ -0,0 +1,35 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+
+namespace Olex
+{
+    FramePacer::FramePacer( uint32_t bufferCount, uint32_t maxFrameLatency )
+        : m_bufferFences( std::max( bufferCount, 1u ), 0 )
+        , m_maxFrameLatency( 1 )
+    {
+        SetMaxFrameLatency( maxFrameLatency );
+    }
+
+    uint64_t FramePacer::GetWaitValue( uint32_t bufferIndex ) const
+    {
+        // The frame maxFrameLatency frames back has to complete before another one is recorded.
+        const uint64_t latencyFence = m_frameFences.size() >= m_maxFrameLatency ? m_frameFences.front() : 0;
+        return std::max( m_bufferFences.at( bufferIndex ), latencyFence );
+    }
+
+    void FramePacer::OnFrameSubmitted( uint32_t bufferIndex, uint64_t fenceValue )
+    {
+        m_bufferFences.at( bufferIndex ) = fenceValue;
+        m_frameFences.push_back( fenceValue );
+        while ( m_frameFences.size() > m_maxFrameLatency )
+            m_frameFences.pop_front();
+    }
+
+    void FramePacer::SetMaxFrameLatency( uint32_t maxFrameLatency )
+    {
+        m_maxFrameLatency = std::clamp( maxFrameLatency, 1u, static_cast<uint32_t>( m_bufferFences.size() ) );
+        while ( m_frameFences.size() > m_maxFrameLatency )
+            m_frameFences.pop_front();
+    }
+}
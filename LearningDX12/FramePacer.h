@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace Olex
+{
+    /**
+     * Decides how long the CPU has to wait before recording a frame, so it can run ahead of the GPU
+     * instead of waiting for every frame to finish.
+     *
+     * Two things bound the wait: the back buffer about to be rendered must no longer be used by the
+     * frame that last rendered into it, and at most maxFrameLatency frames may be queued on the GPU.
+     * Frames are identified by the fence value signaled after their last command list. The pacer
+     * only does the bookkeeping; the caller waits, which keeps it testable against a simulated
+     * GPU timeline.
+     */
+    class FramePacer
+    {
+    public:
+        // maxFrameLatency is clamped to [1, bufferCount].
+        FramePacer( uint32_t bufferCount, uint32_t maxFrameLatency );
+
+        // Fence value to wait for before recording into the back buffer, 0 when nothing has to be waited for.
+        [[nodiscard]] uint64_t GetWaitValue( uint32_t bufferIndex ) const;
+        // The frame rendered into bufferIndex was submitted and completes with fenceValue.
+        void OnFrameSubmitted( uint32_t bufferIndex, uint64_t fenceValue );
+
+        void SetMaxFrameLatency( uint32_t maxFrameLatency );
+        [[nodiscard]] uint32_t GetMaxFrameLatency() const { return m_maxFrameLatency; }
+
+    private:
+        // Fence of the last frame rendered into each back buffer.
+        std::vector<uint64_t> m_bufferFences;
+        // Fences of the most recent frames, oldest first, at most m_maxFrameLatency of them.
+        std::deque<uint64_t> m_frameFences;
+        uint32_t m_maxFrameLatency;
+    };
+}
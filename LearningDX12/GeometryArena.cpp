@@ -0,0 +1,130 @@
+#include "GeometryArena.h"
+
+#include <exception>
+#include <stdexcept>
+
+#include "d3dx12.h"
+
+namespace Olex
+{
+    GeometryArena::GeometryArena( ID3D12Device* device, uint32_t vertexCapacity, uint32_t indexCapacity )
+        : m_device( device )
+        , m_vertexRanges( vertexCapacity )
+        , m_indexRanges( indexCapacity )
+    {
+        ThrowIfFailed( m_device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES( D3D12_HEAP_TYPE_DEFAULT ),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer( vertexCapacity ),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS( &m_vertexBuffer ) ) );
+
+        ThrowIfFailed( m_device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES( D3D12_HEAP_TYPE_DEFAULT ),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer( indexCapacity ),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS( &m_indexBuffer ) ) );
+    }
+
+    GeometryAllocation GeometryArena::Allocate( UploadService& uploadService,
+        const void* vertices, uint32_t vertexCount, uint32_t vertexStride,
+        const void* indices, uint32_t indexCount, IndexFormat indexFormat )
+    {
+        GeometryAllocation allocation;
+        if ( !TryReserve( vertexCount, vertexStride, indexCount, indexFormat, allocation ) )
+            throw std::runtime_error( "Geometry arena is out of space" );
+
+        try
+        {
+            uploadService.UploadBuffer( m_vertexBuffer.Get(), allocation.m_vertexOffset, vertices, uint64_t( vertexCount ) * vertexStride );
+            uploadService.UploadBuffer( m_indexBuffer.Get(), allocation.m_indexOffset, indices, uint64_t( indexCount ) * static_cast<uint32_t>( indexFormat ) );
+        }
+        catch ( ... )
+        {
+            Free( allocation );
+            throw;
+        }
+
+        return allocation;
+    }
+
+    bool GeometryArena::TryReserve( uint32_t vertexCount, uint32_t vertexStride, uint32_t indexCount, IndexFormat indexFormat,
+        GeometryAllocation& allocation )
+    {
+        GeometryAllocation reserved;
+        reserved.m_vertexCount = vertexCount;
+        reserved.m_vertexStride = vertexStride;
+        reserved.m_indexCount = indexCount;
+        reserved.m_indexFormat = indexFormat;
+
+        const uint64_t vertexBytes = uint64_t( vertexCount ) * vertexStride;
+        const uint64_t indexBytes = uint64_t( indexCount ) * static_cast<uint32_t>( indexFormat );
+
+        if ( vertexBytes > 0 )
+        {
+            reserved.m_vertexOffset = m_vertexRanges.Allocate( vertexBytes, vertexStride );
+            if ( reserved.m_vertexOffset == RangeAllocator::InvalidOffset )
+                return false;
+            reserved.m_baseVertex = static_cast<int32_t>( reserved.m_vertexOffset / vertexStride );
+        }
+        if ( indexBytes > 0 )
+        {
+            reserved.m_indexOffset = m_indexRanges.Allocate( indexBytes, static_cast<uint32_t>( indexFormat ) );
+            if ( reserved.m_indexOffset == RangeAllocator::InvalidOffset )
+            {
+                if ( vertexBytes > 0 )
+                    m_vertexRanges.Free( reserved.m_vertexOffset, vertexBytes );
+                return false;
+            }
+            reserved.m_startIndex = static_cast<uint32_t>( reserved.m_indexOffset / static_cast<uint32_t>( indexFormat ) );
+        }
+
+        allocation = reserved;
+        return true;
+    }
+
+    void GeometryArena::Free( const GeometryAllocation& allocation )
+    {
+        if ( allocation.m_vertexCount > 0 )
+            m_vertexRanges.Free( allocation.m_vertexOffset, uint64_t( allocation.m_vertexCount ) * allocation.m_vertexStride );
+        if ( allocation.m_indexCount > 0 )
+            m_indexRanges.Free( allocation.m_indexOffset, uint64_t( allocation.m_indexCount ) * static_cast<uint32_t>( allocation.m_indexFormat ) );
+    }
+
+    D3D12_VERTEX_BUFFER_VIEW GeometryArena::GetVertexBufferView( uint32_t vertexStride ) const
+    {
+        D3D12_VERTEX_BUFFER_VIEW view;
+        view.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress();
+        view.SizeInBytes = static_cast<UINT>( m_vertexRanges.GetCapacity() );
+        view.StrideInBytes = vertexStride;
+        return view;
+    }
+
+    D3D12_INDEX_BUFFER_VIEW GeometryArena::GetIndexBufferView( IndexFormat indexFormat ) const
+    {
+        D3D12_INDEX_BUFFER_VIEW view;
+        view.BufferLocation = m_indexBuffer->GetGPUVirtualAddress();
+        view.SizeInBytes = static_cast<UINT>( m_indexRanges.GetCapacity() );
+        view.Format = indexFormat == IndexFormat::UInt16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+        return view;
+    }
+
+    void GeometryArena::Bind( ID3D12GraphicsCommandList* commandList, uint32_t vertexStride, IndexFormat indexFormat ) const
+    {
+        const D3D12_VERTEX_BUFFER_VIEW vertexBufferView = GetVertexBufferView( vertexStride );
+        const D3D12_INDEX_BUFFER_VIEW indexBufferView = GetIndexBufferView( indexFormat );
+        commandList->IASetVertexBuffers( 0, 1, &vertexBufferView );
+        commandList->IASetIndexBuffer( &indexBufferView );
+    }
+
+    void GeometryArena::ThrowIfFailed( HRESULT hr )
+    {
+        if ( FAILED( hr ) )
+        {
+            throw std::exception();
+        }
+    }
+}
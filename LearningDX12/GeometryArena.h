@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include "RangeAllocator.h"
+#include "SubmeshSplitter.h"
+#include "UploadService.h"
+
+namespace Olex
+{
+    /**
+     * Where a mesh landed in the geometry arena. Draw it with the arena bound for m_vertexStride
+     * and m_indexFormat, adding m_startIndex and m_baseVertex to the submesh ranges.
+     */
+    struct GeometryAllocation
+    {
+        uint64_t m_vertexOffset = 0;
+        uint32_t m_vertexCount = 0;
+        uint32_t m_vertexStride = 0;
+        uint64_t m_indexOffset = 0;
+        uint32_t m_indexCount = 0;
+        IndexFormat m_indexFormat = IndexFormat::UInt16;
+
+        // Arguments of DrawIndexedInstanced, relative to the views of the whole arena.
+        int32_t m_baseVertex = 0;
+        uint32_t m_startIndex = 0;
+    };
+
+    /**
+     * One large vertex buffer and one large index buffer that every mesh is packed into, so a frame
+     * binds them once per vertex layout instead of once per mesh, and meshes do not each pay for a
+     * committed resource.
+     *
+     * Vertex ranges are aligned to their stride and index ranges to their index size: a view of the
+     * whole buffer with that stride or format then reaches every mesh through BaseVertexLocation
+     * and StartIndexLocation. 16-bit indices relative to a submesh base vertex work at any offset.
+     *
+     * Both buffers stay in the common state. Copies promote them to COPY_DEST and draws to the
+     * vertex and index states, which buffers allow implicitly, and they decay back to common once a
+     * command list completes. Data is uploaded on the copy queue of the UploadService, the render
+     * queue must wait for the token of that upload before drawing the allocation. Draws of other
+     * allocations may overlap the copy, they read different ranges of the buffers.
+     */
+    class GeometryArena
+    {
+    public:
+        GeometryArena( ID3D12Device* device, uint32_t vertexCapacity, uint32_t indexCapacity );
+
+        /**
+         * Sub-allocates the mesh and queues the upload of its data on uploadService. Either part may
+         * be empty, levels of detail for example only add indices for vertices already in the arena.
+         * Throws std::runtime_error when the arena has no room left.
+         */
+        GeometryAllocation Allocate( UploadService& uploadService,
+            const void* vertices, uint32_t vertexCount, uint32_t vertexStride,
+            const void* indices, uint32_t indexCount, IndexFormat indexFormat );
+
+        /**
+         * Sub-allocates room for the mesh without uploading anything, for callers that record their
+         * own copies into GetVertexBuffer and GetIndexBuffer. False, allocating nothing, when the
+         * arena has no room left.
+         */
+        bool TryReserve( uint32_t vertexCount, uint32_t vertexStride, uint32_t indexCount, IndexFormat indexFormat,
+            GeometryAllocation& allocation );
+
+        // The GPU must be done with every draw that reads the allocation.
+        void Free( const GeometryAllocation& allocation );
+
+        [[nodiscard]] ID3D12Resource* GetVertexBuffer() const { return m_vertexBuffer.Get(); }
+        [[nodiscard]] ID3D12Resource* GetIndexBuffer() const { return m_indexBuffer.Get(); }
+
+        // Views of the whole arena.
+        [[nodiscard]] D3D12_VERTEX_BUFFER_VIEW GetVertexBufferView( uint32_t vertexStride ) const;
+        [[nodiscard]] D3D12_INDEX_BUFFER_VIEW GetIndexBufferView( IndexFormat indexFormat ) const;
+        void Bind( ID3D12GraphicsCommandList* commandList, uint32_t vertexStride, IndexFormat indexFormat ) const;
+
+        [[nodiscard]] uint64_t GetVertexBytesFree() const { return m_vertexRanges.GetFreeSize(); }
+        [[nodiscard]] uint64_t GetIndexBytesFree() const { return m_indexRanges.GetFreeSize(); }
+
+    private:
+        Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+        Microsoft::WRL::ComPtr<ID3D12Resource> m_vertexBuffer;
+        Microsoft::WRL::ComPtr<ID3D12Resource> m_indexBuffer;
+        RangeAllocator m_vertexRanges;
+        RangeAllocator m_indexRanges;
+
+        void ThrowIfFailed( HRESULT hr );
+    };
+}
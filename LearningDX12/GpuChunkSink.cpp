@@ -0,0 +1,127 @@
+#include "GpuChunkSink.h"
+
+#include <exception>
+#include <stdexcept>
+
+#include "d3dx12.h"
+#include "DX12App.h"
+
+namespace Olex
+{
+    GpuChunkSink::GpuChunkSink( DX12App& app, GeometryArena& arena, CommandQueue& renderQueue, size_t stagingCapacity )
+        : m_app( app )
+        , m_arena( arena )
+        , m_renderQueue( renderQueue )
+        , m_queue( app, D3D12_COMMAND_LIST_TYPE_COPY )
+        , m_stagingCapacity( stagingCapacity )
+    {
+        ThrowIfFailed( m_app.GetDevice()->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES( D3D12_HEAP_TYPE_UPLOAD ),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer( stagingCapacity ),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS( &m_staging ) ) );
+
+        const CD3DX12_RANGE noRead( 0, 0 );
+        ThrowIfFailed( m_staging->Map( 0, &noRead, reinterpret_cast<void**>( &m_stagingData ) ) );
+    }
+
+    GpuChunkSink::~GpuChunkSink()
+    {
+        m_queue.WaitForFenceValue( Submit() );
+        m_renderQueue.Flush();
+
+        FreeEvictions();
+        for ( const auto& [chunkIndex, allocation] : m_allocations )
+            m_arena.Free( allocation );
+    }
+
+    void GpuChunkSink::Upload( uint32_t chunkIndex, const ChunkedMeshChunk& chunk, uint64_t stagingOffset )
+    {
+        FreeEvictions();
+        GeometryAllocation allocation;
+        while ( !m_arena.TryReserve( chunk.m_vertexCount, sizeof( Mesh::VertexInfo ), chunk.m_indexCount, chunk.m_indexFormat, allocation ) )
+        {
+            // Chunks evicted by this update are in m_evicted, the render queue may not have drawn them yet.
+            if ( m_evictedInFlight.empty() )
+                QueueEvictions();
+            if ( m_evictedInFlight.empty() )
+                throw std::runtime_error( "Geometry arena is too small for the chunk pager budget" );
+
+            m_renderQueue.WaitForFenceValue( m_evictedInFlight.front().first );
+            FreeEvictions();
+        }
+
+        if ( !m_commandList )
+            m_commandList = m_queue.CreateCommandList();
+
+        const uint64_t vertexBytes = uint64_t( chunk.m_vertexCount ) * sizeof( Mesh::VertexInfo );
+        const uint64_t indexBytes = uint64_t( chunk.m_indexCount ) * static_cast<uint32_t>( chunk.m_indexFormat );
+        m_commandList->CopyBufferRegion( m_arena.GetVertexBuffer(), allocation.m_vertexOffset,
+            m_staging.Get(), stagingOffset, vertexBytes );
+        m_commandList->CopyBufferRegion( m_arena.GetIndexBuffer(), allocation.m_indexOffset,
+            m_staging.Get(), stagingOffset + chunk.m_indexOffset, indexBytes );
+
+        m_allocations[chunkIndex] = allocation;
+    }
+
+    void GpuChunkSink::Evict( uint32_t chunkIndex )
+    {
+        const auto found = m_allocations.find( chunkIndex );
+        if ( found == m_allocations.end() )
+            return;
+
+        m_evicted.push_back( found->second );
+        m_allocations.erase( found );
+    }
+
+    uint64_t GpuChunkSink::Submit()
+    {
+        QueueEvictions();
+        FreeEvictions();
+
+        if ( m_commandList )
+        {
+            m_lastTicket = m_queue.ExecuteCommandList( m_commandList );
+            m_commandList.Reset();
+        }
+
+        m_queue.RetireCompleted();
+        return m_lastTicket.Get();
+    }
+
+    const GeometryAllocation* GpuChunkSink::GetAllocation( uint32_t chunkIndex ) const
+    {
+        const auto found = m_allocations.find( chunkIndex );
+        return found != m_allocations.end() ? &found->second : nullptr;
+    }
+
+    void GpuChunkSink::QueueEvictions()
+    {
+        if ( m_evicted.empty() )
+            return;
+
+        const FenceValue renderFence = m_renderQueue.Signal();
+        for ( const GeometryAllocation& allocation : m_evicted )
+            m_evictedInFlight.emplace_back( renderFence, allocation );
+        m_evicted.clear();
+    }
+
+    void GpuChunkSink::FreeEvictions()
+    {
+        while ( !m_evictedInFlight.empty() && m_renderQueue.IsFenceComplete( m_evictedInFlight.front().first ) )
+        {
+            m_arena.Free( m_evictedInFlight.front().second );
+            m_evictedInFlight.pop_front();
+        }
+    }
+
+    void GpuChunkSink::ThrowIfFailed( HRESULT hr )
+    {
+        if ( FAILED( hr ) )
+        {
+            throw std::exception();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <d3d12.h>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <wrl/client.h>
+
+#include "ChunkPager.h"
+#include "CommandQueue.h"
+#include "GeometryArena.h"
+
+namespace Olex
+{
+    class DX12App;
+
+    /**
+     * Chunk sink that pages chunks into the geometry arena. The pager reads chunks straight into a
+     * persistently mapped upload buffer, and the sink copies vertices and indices from there into the
+     * arena on a copy queue of its own; a ticket is that queue's fence value. Resident chunks are
+     * drawn with GetAllocation and the arena bound for Mesh::VertexInfo.
+     *
+     * Evicted ranges stay allocated until renderQueue has finished every command list submitted
+     * before the Submit that follows the eviction, then go back to the arena. Size the arena above
+     * the pager budget by what a few frames evict; when an upload finds no room, the sink waits on
+     * the CPU for the oldest eviction to clear the render queue, and throws std::runtime_error when
+     * nothing is left to wait for.
+     */
+    class GpuChunkSink final : public ChunkUploadSink
+    {
+    public:
+        GpuChunkSink( DX12App& app, GeometryArena& arena, CommandQueue& renderQueue, size_t stagingCapacity );
+        // Waits for both queues, then gives every range back to the arena.
+        ~GpuChunkSink() override;
+
+        GpuChunkSink( const GpuChunkSink& ) = delete;
+        GpuChunkSink& operator=( const GpuChunkSink& ) = delete;
+
+        uint8_t* GetStagingMemory() override { return m_stagingData; }
+        [[nodiscard]] size_t GetStagingCapacity() const override { return m_stagingCapacity; }
+        void Upload( uint32_t chunkIndex, const ChunkedMeshChunk& chunk, uint64_t stagingOffset ) override;
+        void Evict( uint32_t chunkIndex ) override;
+        uint64_t Submit() override;
+        [[nodiscard]] bool IsComplete( uint64_t ticket ) override { return m_queue.IsFenceComplete( FenceValue( ticket ) ); }
+
+        // Where the chunk is in the arena, null when it was never uploaded or has been evicted.
+        // Only draw it once the pager reports the chunk resident.
+        [[nodiscard]] const GeometryAllocation* GetAllocation( uint32_t chunkIndex ) const;
+
+    private:
+        DX12App& m_app;
+        GeometryArena& m_arena;
+        CommandQueue& m_renderQueue;
+        CommandQueue m_queue;
+
+        Microsoft::WRL::ComPtr<ID3D12Resource> m_staging;
+        // Upload heap memory stays mapped for the lifetime of the resource.
+        uint8_t* m_stagingData = nullptr;
+        size_t m_stagingCapacity;
+
+        // Copies recorded since the last Submit, null until the first one.
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> m_commandList;
+        FenceValue m_lastTicket{ 0 };
+
+        std::unordered_map<uint32_t, GeometryAllocation> m_allocations;
+        // Evicted since the last Submit, the render queue may still have draws of them to submit.
+        std::vector<GeometryAllocation> m_evicted;
+        // Evicted and submitted, oldest first, with the render queue fence that has to pass before the ranges are reused.
+        std::deque<std::pair<FenceValue, GeometryAllocation>> m_evictedInFlight;
+
+        // Tags the evictions since the last Submit with a new render queue fence.
+        void QueueEvictions();
+        // Frees the evicted ranges the render queue is done with, without blocking.
+        void FreeEvictions();
+
+        void ThrowIfFailed( HRESULT hr );
+    };
+}
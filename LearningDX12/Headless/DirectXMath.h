@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Stand-in for <DirectXMath.h> in headless builds on machines that lack the real header, see
+ * CMakeLists.txt. It covers what the portable asset code uses: the storage types and the few matrix
+ * functions the scene and skin code call, with the same row-vector conventions. Nothing in it is
+ * vectorized; the Windows build always uses the real library.
+ */
+namespace DirectX
+{
+    struct XMFLOAT2
+    {
+        float x, y;
+        XMFLOAT2() = default;
+        constexpr XMFLOAT2( float _x, float _y ) : x( _x ), y( _y ) {}
+    };
+
+    struct XMFLOAT3
+    {
+        float x, y, z;
+        XMFLOAT3() = default;
+        constexpr XMFLOAT3( float _x, float _y, float _z ) : x( _x ), y( _y ), z( _z ) {}
+    };
+
+    struct XMFLOAT4
+    {
+        float x, y, z, w;
+        XMFLOAT4() = default;
+        constexpr XMFLOAT4( float _x, float _y, float _z, float _w ) : x( _x ), y( _y ), z( _z ), w( _w ) {}
+    };
+
+    struct XMINT3
+    {
+        int32_t x, y, z;
+        XMINT3() = default;
+        constexpr XMINT3( int32_t _x, int32_t _y, int32_t _z ) : x( _x ), y( _y ), z( _z ) {}
+    };
+
+    struct XMUINT4
+    {
+        uint32_t x, y, z, w;
+    };
+
+    struct XMFLOAT4X4
+    {
+        float m[4][4];
+    };
+
+    struct XMMATRIX
+    {
+        float m[4][4];
+    };
+
+    inline XMMATRIX XMLoadFloat4x4( const XMFLOAT4X4* source )
+    {
+        XMMATRIX result;
+        for ( int row = 0; row < 4; ++row )
+            for ( int column = 0; column < 4; ++column )
+                result.m[row][column] = source->m[row][column];
+        return result;
+    }
+
+    inline void XMStoreFloat4x4( XMFLOAT4X4* destination, const XMMATRIX& matrix )
+    {
+        for ( int row = 0; row < 4; ++row )
+            for ( int column = 0; column < 4; ++column )
+                destination->m[row][column] = matrix.m[row][column];
+    }
+
+    inline XMMATRIX XMMatrixMultiply( const XMMATRIX& a, const XMMATRIX& b )
+    {
+        XMMATRIX result;
+        for ( int row = 0; row < 4; ++row )
+        {
+            for ( int column = 0; column < 4; ++column )
+            {
+                float sum = 0.f;
+                for ( int k = 0; k < 4; ++k )
+                    sum += a.m[row][k] * b.m[k][column];
+                result.m[row][column] = sum;
+            }
+        }
+        return result;
+    }
+
+    inline XMMATRIX XMMatrixIdentity()
+    {
+        XMMATRIX result = {};
+        for ( int i = 0; i < 4; ++i )
+            result.m[i][i] = 1.f;
+        return result;
+    }
+}
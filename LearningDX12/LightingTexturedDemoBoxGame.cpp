@@ -4,15 +4,14 @@
 #include <d3dcompiler.h>
 #include <wrl/client.h>
 #include <filesystem>
-#include <WICTextureLoader.h>
-#include <ResourceUploadBatch.h>
+#include <stdexcept>
 
 #include "d3dx12.h"
 #include "DX12App.h"
 #include "wrl/wrappers/corewrappers.h"
 #include <pix.h>
 
-#include "FbxLoader.h"
+#include "MeshCache.h"
 
 namespace Olex
 {
@@ -50,31 +49,8 @@ namespace Olex
 
         m_DSVHeap = m_app.CreateDescriptorHeap( D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 1 );
 
-#if (_WIN32_WINNT >= 0x0A00 /*_WIN32_WINNT_WIN10*/)
-        Microsoft::WRL::Wrappers::RoInitializeWrapper initialize( RO_INIT_MULTITHREADED );
-        if ( FAILED( initialize ) )
-            // error
-#else
-        HRESULT hr = CoInitializeEx( nullptr, COINITBASE_MULTITHREADED );
-        if ( FAILED( hr ) )
-            // error
-#endif
-
-            Microsoft::WRL::ComPtr<ID3D12Resource> texture;
-
-        using namespace std::filesystem;
-        DirectX::ResourceUploadBatch uploadBatch( m_app.GetDevice().Get() );
-        uploadBatch.Begin();
-
-        ThrowIfFailed( DirectX::CreateWICTextureFromFile(
-            m_app.GetDevice().Get(),
-            uploadBatch,
-            L"texture.jpg",
-            &m_texture,
-            true ) );
-
-        const std::future<void> uploadTask = uploadBatch.End( m_app.GetCommandQueue().GetD3D12CommandQueue().Get() );
-        uploadTask.wait();
+        // Baked with its mip chain by the asset baker, see TextureCache.
+        m_texture = LoadBakedTexture( m_app.GetUploadService(), "texture.tex" );
 
         {
             D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -82,7 +58,7 @@ namespace Olex
             srvDesc.Format = /*DXGI_FORMAT_R8G8B8A8_UNORM*/ m_texture->GetDesc().Format;
             srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // The resource is a 2D texture.
             srvDesc.Texture2D.MostDetailedMip = 0; // so the first in memory is the largest mipmap level
-            srvDesc.Texture2D.MipLevels = 1;
+            srvDesc.Texture2D.MipLevels = m_texture->GetDesc().MipLevels;
             srvDesc.Texture2D.ResourceMinLODClamp = 0.0f; // A value to clamp sample LOD values to.
 
             device->CreateShaderResourceView( m_texture.Get(), &srvDesc, m_SrvHeap->GetCPUDescriptorHandleForHeapStart() );
@@ -121,35 +97,21 @@ namespace Olex
         psoDesc.SampleDesc.Count = 1;
         ThrowIfFailed( m_app.GetDevice()->CreateGraphicsPipelineState( &psoDesc, IID_PPV_ARGS( m_PipelineState.ReleaseAndGetAddressOf() ) ) );
 
-        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> commandList = m_app.GetCommandQueue().CreateCommandList();
-
-        m_fbxLoader = std::make_unique<FbxLoader>( "model.fbx" );
-        const FbxLoader::Mesh& mesh = m_fbxLoader->GetMeshes()[0];
-
-        // Upload vertex buffer data.
-        ComPtr<ID3D12Resource> intermediateVertexBuffer;
-        UpdateBufferResource( commandList.Get(),
-            &m_VertexBuffer, &intermediateVertexBuffer,
-            mesh.m_vertices.size(), sizeof( FbxLoader::Mesh::VertexInfo ), mesh.m_vertices.data() );
-
-        // Create the vertex buffer view.
-        m_VertexBufferView.BufferLocation = m_VertexBuffer->GetGPUVirtualAddress();
-        m_VertexBufferView.SizeInBytes = static_cast<UINT>( mesh.m_vertices.size() * sizeof( FbxLoader::Mesh::VertexInfo ) );
-        m_VertexBufferView.StrideInBytes = sizeof( FbxLoader::Mesh::VertexInfo );
-
-        // Upload index buffer data.
-        ComPtr<ID3D12Resource> intermediateIndexBuffer;
-        UpdateBufferResource( commandList.Get(),
-            &m_IndexBuffer, &intermediateIndexBuffer,
-            mesh.m_indices.size(), sizeof( DirectX::XMINT3 ), mesh.m_indices.data() );
+        m_meshCache = std::make_unique<MappedMeshCache>( "model.mesh" );
+        if ( !m_meshCache->IsValid() )
+        {
+            throw std::runtime_error( "model.mesh is missing or was baked by an older version, run the asset baker" );
+        }
+        const MeshView mesh = m_meshCache->GetMesh( 0 );
 
-        // Create index buffer view.
-        m_IndexBufferView.BufferLocation = m_IndexBuffer->GetGPUVirtualAddress();
-        m_IndexBufferView.Format = DXGI_FORMAT_R32_UINT;
-        m_IndexBufferView.SizeInBytes = static_cast<UINT>( mesh.m_indices.size() * sizeof( DirectX::XMINT3 ) );
+        // Upload the model into the shared geometry arena, 16-bit indices whenever every submesh fits.
+        m_geometry = m_app.GetGeometryArena().Allocate( m_app.GetUploadService(),
+            mesh.m_vertices, mesh.m_vertexCount, sizeof( Mesh::VertexInfo ),
+            mesh.m_indices, mesh.m_indexCount, mesh.m_indexFormat );
 
-        const FenceValue fenceValue = m_app.GetCommandQueue().ExecuteCommandList( commandList );
-        m_app.GetCommandQueue().WaitForFenceValue( fenceValue );
+        // The copies run on the copy queue. The render queue waits for them on the GPU, the CPU goes on.
+        UploadService& uploadService = m_app.GetUploadService();
+        m_app.GetCommandQueue().Wait( uploadService.GetFenceWait( uploadService.Submit() ) );
 
         m_ContentLoaded = true;
 
@@ -226,7 +188,7 @@ namespace Olex
         if ( m_ContentLoaded )
         {
             // Flush any GPU commands that might be referencing the depth buffer.
-            //m_app.Flush();
+            m_app.GetCommandQueue().WaitForFenceValue( m_lastFenceValue );
 
             width = std::max( 1, width );
             height = std::max( 1, height );
@@ -280,18 +242,11 @@ namespace Olex
         const path texturePath( fileName );
         if ( exists( texturePath ) == true )
         {
-            DirectX::ResourceUploadBatch uploadBatch( m_app.GetDevice().Get() );
-            uploadBatch.Begin();
-
-            ThrowIfFailed( DirectX::CreateWICTextureFromFile(
-                m_app.GetDevice().Get(),
-                uploadBatch,
-                fileName,
-                textureResource.ReleaseAndGetAddressOf(),
-                false ) );
-
-            const std::future<void> uploadTask = uploadBatch.End( m_app.GetCommandQueue().GetD3D12CommandQueue().Get() );
-            uploadTask.wait();
+            UploadService& uploadService = m_app.GetUploadService();
+            textureResource = LoadBakedTexture( uploadService, texturePath );
+
+            // Work submitted to the render queue from now on waits on the GPU for the upload.
+            m_app.GetCommandQueue().Wait( uploadService.GetFenceWait( uploadService.Submit() ) );
         }
 
         return textureResource;
@@ -299,6 +254,8 @@ namespace Olex
 
     void LightingTexturedDemoBoxGame::UnloadResources()
     {
+        m_app.GetGeometryArena().Free( m_geometry );
+        m_geometry = {};
     }
 
     void LightingTexturedDemoBoxGame::Update( UpdateEventArgs args )
@@ -390,8 +347,7 @@ namespace Olex
 
         // IA = Input Assembler
         commandList->IASetPrimitiveTopology( D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-        commandList->IASetVertexBuffers( 0, 1, &m_VertexBufferView );
-        commandList->IASetIndexBuffer( &m_IndexBufferView );
+        m_app.GetGeometryArena().Bind( commandList.Get(), m_geometry.m_vertexStride, m_geometry.m_indexFormat );
 
         // RS = Rasterizer State
         commandList->RSSetViewports( 1, &m_Viewport );
@@ -400,9 +356,14 @@ namespace Olex
         // OM = Output Merger
         commandList->OMSetRenderTargets( 1, &rtv, FALSE, &dsv );
 
-        // draw the model
-        static const UINT indexCount = static_cast<UINT>( m_fbxLoader->GetMeshes()[0].m_indices.size() * 3 );
-        commandList->DrawIndexedInstanced( indexCount, 1, 0, 0, 0 );
+        // draw the model, one call per submesh
+        const MeshView mesh = m_meshCache->GetMesh( 0 );
+        for ( uint32_t i = 0; i < mesh.m_submeshCount; ++i )
+        {
+            const Submesh& submesh = mesh.m_submeshes[i];
+            commandList->DrawIndexedInstanced( submesh.m_indexCount, 1, m_geometry.m_startIndex + submesh.m_startIndex,
+                m_geometry.m_baseVertex + static_cast<INT>( submesh.m_baseVertex ), 0 );
+        }
 
         PIXEndEvent();
         PIXBeginEvent( PIX_COLOR_DEFAULT, L"Present" );
@@ -414,9 +375,8 @@ namespace Olex
 
             m_lastFenceValue = m_app.GetCommandQueue().ExecuteCommandList( commandList );
 
-            m_app.Present();
+            m_app.Present( m_lastFenceValue );
         }
-        m_app.GetCommandQueue().WaitForFenceValue( m_lastFenceValue );
 
         PIXEndEvent();
     }
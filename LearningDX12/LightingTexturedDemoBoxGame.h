@@ -7,7 +7,8 @@
 
 #include "BaseGameInterface.h"
 #include "CommandQueue.h"
-#include "FbxLoader.h"
+#include "GeometryArena.h"
+#include "MeshCache.h"
 
 namespace Olex
 {
@@ -55,12 +56,8 @@ namespace Olex
 
         Microsoft::WRL::ComPtr<ID3D12Resource> LoadTextureFromFile( const wchar_t* fileName );
 
-        // Vertex buffer for the cube.
-        Microsoft::WRL::ComPtr<ID3D12Resource> m_VertexBuffer;
-        D3D12_VERTEX_BUFFER_VIEW m_VertexBufferView;
-        // Index buffer for the cube.
-        Microsoft::WRL::ComPtr<ID3D12Resource> m_IndexBuffer;
-        D3D12_INDEX_BUFFER_VIEW m_IndexBufferView;
+        // Where the model lives in the shared geometry arena.
+        GeometryAllocation m_geometry;
 
         // Depth buffer.
         Microsoft::WRL::ComPtr<ID3D12Resource> m_DepthBuffer;
@@ -98,6 +95,6 @@ namespace Olex
 
         FenceValue m_lastFenceValue{ 0 };
 
-        std::unique_ptr<FbxLoader> m_fbxLoader;
+        std::unique_ptr<MappedMeshCache> m_meshCache;
     };
 }
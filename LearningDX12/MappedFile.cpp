@@ -0,0 +1,137 @@
+#include "MappedFile.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <random>
+#include <utility>
+
+#if defined(_WIN32)
+#include "framework.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Olex
+{
+    MappedFile::MappedFile( const std::filesystem::path& path )
+    {
+#if defined(_WIN32)
+        HANDLE file = ::CreateFileW( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+        if ( file == INVALID_HANDLE_VALUE )
+            return;
+
+        LARGE_INTEGER fileSize = {};
+        if ( !::GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart == 0 )
+        {
+            ::CloseHandle( file );
+            return;
+        }
+
+        HANDLE mapping = ::CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        if ( !mapping )
+        {
+            ::CloseHandle( file );
+            return;
+        }
+
+        const void* view = ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+        if ( !view )
+        {
+            ::CloseHandle( mapping );
+            ::CloseHandle( file );
+            return;
+        }
+
+        m_fileHandle = file;
+        m_mappingHandle = mapping;
+        m_data = static_cast<const uint8_t*>( view );
+        m_size = static_cast<size_t>( fileSize.QuadPart );
+#else
+        const int fileDescriptor = ::open( path.c_str(), O_RDONLY );
+        if ( fileDescriptor < 0 )
+            return;
+
+        struct stat fileStat = {};
+        if ( ::fstat( fileDescriptor, &fileStat ) != 0 || fileStat.st_size == 0 )
+        {
+            ::close( fileDescriptor );
+            return;
+        }
+
+        void* view = ::mmap( nullptr, static_cast<size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+        if ( view == MAP_FAILED )
+        {
+            ::close( fileDescriptor );
+            return;
+        }
+
+        m_fileDescriptor = fileDescriptor;
+        m_data = static_cast<const uint8_t*>( view );
+        m_size = static_cast<size_t>( fileStat.st_size );
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    MappedFile::MappedFile( MappedFile&& other ) noexcept
+    {
+        *this = std::move( other );
+    }
+
+    MappedFile& MappedFile::operator=( MappedFile&& other ) noexcept
+    {
+        if ( this != &other )
+        {
+            Close();
+
+            std::swap( m_data, other.m_data );
+            std::swap( m_size, other.m_size );
+#if defined(_WIN32)
+            std::swap( m_fileHandle, other.m_fileHandle );
+            std::swap( m_mappingHandle, other.m_mappingHandle );
+#else
+            std::swap( m_fileDescriptor, other.m_fileDescriptor );
+#endif
+        }
+        return *this;
+    }
+
+    void MappedFile::Close()
+    {
+#if defined(_WIN32)
+        if ( m_data )
+            ::UnmapViewOfFile( m_data );
+        if ( m_mappingHandle )
+            ::CloseHandle( m_mappingHandle );
+        if ( m_fileHandle )
+            ::CloseHandle( m_fileHandle );
+        m_fileHandle = nullptr;
+        m_mappingHandle = nullptr;
+#else
+        if ( m_data )
+            ::munmap( const_cast<uint8_t*>( m_data ), m_size );
+        if ( m_fileDescriptor >= 0 )
+            ::close( m_fileDescriptor );
+        m_fileDescriptor = -1;
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    std::string MakeUniqueName()
+    {
+        static const uint64_t processId = ( uint64_t( std::random_device{}() ) << 32 ) | std::random_device{}();
+        static std::atomic<uint64_t> counter{ 0 };
+        char name[40];
+        std::snprintf( name, sizeof( name ), "%016" PRIx64 "-%" PRIu64, processId, counter++ );
+        return name;
+    }
+}
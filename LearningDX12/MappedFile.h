@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace Olex
+{
+    /**
+     * Read-only memory mapping of a whole file.
+     * The mapping stays valid for the lifetime of the object.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        explicit MappedFile( const std::filesystem::path& path );
+        ~MappedFile();
+
+        MappedFile( const MappedFile& ) = delete;
+        MappedFile& operator=( const MappedFile& ) = delete;
+        MappedFile( MappedFile&& other ) noexcept;
+        MappedFile& operator=( MappedFile&& other ) noexcept;
+
+        [[nodiscard]] bool IsOpen() const { return m_data != nullptr; }
+        [[nodiscard]] const uint8_t* GetData() const { return m_data; }
+        [[nodiscard]] size_t GetSize() const { return m_size; }
+
+    private:
+        void Close();
+
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+
+#if defined(_WIN32)
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+#else
+        int m_fileDescriptor = -1;
+#endif
+    };
+
+    // Unique per process and call, for staging directories and temporary files that are renamed into place.
+    std::string MakeUniqueName();
+}
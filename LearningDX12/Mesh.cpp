@@ -0,0 +1,26 @@
+#include "Mesh.h"
+
+namespace Olex
+{
+    namespace
+    {
+        template <typename T>
+        void RemapStream( std::vector<T>& stream, const std::vector<uint32_t>& source )
+        {
+            if ( stream.empty() )
+                return;
+
+            std::vector<T> remapped;
+            remapped.reserve( source.size() );
+            for ( const uint32_t vertex : source )
+                remapped.push_back( stream[vertex] );
+            stream.swap( remapped );
+        }
+    }
+
+    void RemapVertexAttributes( Mesh& mesh, const std::vector<uint32_t>& source )
+    {
+        RemapStream( mesh.m_tangents, source );
+        RemapStream( mesh.m_skin.m_vertices, source );
+    }
+}
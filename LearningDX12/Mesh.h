@@ -0,0 +1,59 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+#include "MeshBounds.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "Skin.h"
+#include "SubmeshSplitter.h"
+
+namespace Olex
+{
+    /**
+     * CPU side geometry of a single imported mesh.
+     * Kept free of any FBX SDK types so it can be produced by the importer
+     * and consumed by the baked mesh cache independently.
+     */
+    struct Mesh
+    {
+        struct VertexInfo
+        {
+            DirectX::XMFLOAT3 m_position;
+            DirectX::XMFLOAT2 m_uv;
+            DirectX::XMFLOAT3 m_normal;
+        };
+
+        std::vector<VertexInfo> m_vertices;
+        std::vector<DirectX::XMINT3> m_indices;
+
+        // One per vertex when the tangent stage is enabled: xyz the unit tangent,
+        // w the bitangent sign, bitangent = w * cross( normal, tangent ).
+        std::vector<DirectX::XMFLOAT4> m_tangents;
+
+        // Only filled for meshes bound to a skeleton.
+        MeshSkin m_skin;
+
+        // Draw ranges, each small enough for m_indexFormat. Indices above stay absolute.
+        std::vector<Submesh> m_submeshes;
+        IndexFormat m_indexFormat = IndexFormat::UInt32;
+
+        // Filled by ComputeMeshBounds, one volume per submesh.
+        BoundingVolume m_bounds;
+        std::vector<BoundingVolume> m_submeshBounds;
+
+        // Only filled when the LOD import stage is enabled, coarser levels last.
+        std::vector<MeshLod> m_lods;
+
+        // Only filled when the meshlet import stage is enabled.
+        MeshletData m_meshlets;
+    };
+
+    /**
+     * Rebuilds the per-vertex streams that follow m_vertices (tangents, skin) after a stage
+     * renumbered or duplicated vertices: new vertex i takes the attributes of old vertex source[i].
+     * Streams that are empty stay empty.
+     */
+    void RemapVertexAttributes( Mesh& mesh, const std::vector<uint32_t>& source );
+}
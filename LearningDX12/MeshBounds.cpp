@@ -0,0 +1,374 @@
+#include "MeshBounds.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <emmintrin.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    namespace
+    {
+        /**
+         * Position access for the kernels: either every vertex in a strided range or the vertices
+         * an index list points at. Wide loads read 16 bytes, which needs a stride of at least 16
+         * so that the last position does not read past the end of the buffer.
+         */
+        class StridedPositions
+        {
+        public:
+            StridedPositions( const DirectX::XMFLOAT3* positions, size_t strideInBytes, const uint32_t* indices, size_t count )
+                : m_base( reinterpret_cast<const uint8_t*>( positions ) )
+                , m_stride( strideInBytes )
+                , m_indices( indices )
+                , m_count( count )
+                , m_wideLoads( strideInBytes >= 16 )
+            {
+            }
+
+            size_t GetCount() const { return m_count; }
+
+            const DirectX::XMFLOAT3& Get( size_t i ) const
+            {
+                const size_t vertex = m_indices ? m_indices[i] : i;
+                return *reinterpret_cast<const DirectX::XMFLOAT3*>( m_base + vertex * m_stride );
+            }
+
+            // x, y, z and an unspecified w.
+            __m128 Load( size_t i ) const
+            {
+                const DirectX::XMFLOAT3& p = Get( i );
+                return m_wideLoads ? _mm_loadu_ps( &p.x ) : _mm_setr_ps( p.x, p.y, p.z, 0.f );
+            }
+
+        private:
+            const uint8_t* m_base;
+            size_t m_stride;
+            const uint32_t* m_indices;
+            size_t m_count;
+            bool m_wideLoads;
+        };
+
+        void ComputeBox( const StridedPositions& positions, DirectX::XMFLOAT3& minimum, DirectX::XMFLOAT3& maximum )
+        {
+            const size_t count = positions.GetCount();
+            __m128 min0 = _mm_set1_ps( FLT_MAX ), min1 = min0;
+            __m128 max0 = _mm_set1_ps( -FLT_MAX ), max1 = max0;
+            size_t i = 0;
+
+#if defined(__AVX2__)
+            // Two positions per register, four in flight per iteration.
+            __m256 wideMin0 = _mm256_set1_ps( FLT_MAX ), wideMin1 = wideMin0;
+            __m256 wideMax0 = _mm256_set1_ps( -FLT_MAX ), wideMax1 = wideMax0;
+            for ( ; i + 4 <= count; i += 4 )
+            {
+                const __m256 p01 = _mm256_insertf128_ps( _mm256_castps128_ps256( positions.Load( i + 0 ) ), positions.Load( i + 1 ), 1 );
+                const __m256 p23 = _mm256_insertf128_ps( _mm256_castps128_ps256( positions.Load( i + 2 ) ), positions.Load( i + 3 ), 1 );
+                wideMin0 = _mm256_min_ps( wideMin0, p01 );
+                wideMax0 = _mm256_max_ps( wideMax0, p01 );
+                wideMin1 = _mm256_min_ps( wideMin1, p23 );
+                wideMax1 = _mm256_max_ps( wideMax1, p23 );
+            }
+            const __m256 wideMin = _mm256_min_ps( wideMin0, wideMin1 );
+            const __m256 wideMax = _mm256_max_ps( wideMax0, wideMax1 );
+            min0 = _mm_min_ps( _mm256_castps256_ps128( wideMin ), _mm256_extractf128_ps( wideMin, 1 ) );
+            max0 = _mm_max_ps( _mm256_castps256_ps128( wideMax ), _mm256_extractf128_ps( wideMax, 1 ) );
+#else
+            // Two independent accumulator pairs hide the min/max latency.
+            for ( ; i + 2 <= count; i += 2 )
+            {
+                const __m128 p0 = positions.Load( i + 0 );
+                const __m128 p1 = positions.Load( i + 1 );
+                min0 = _mm_min_ps( min0, p0 );
+                max0 = _mm_max_ps( max0, p0 );
+                min1 = _mm_min_ps( min1, p1 );
+                max1 = _mm_max_ps( max1, p1 );
+            }
+#endif
+            for ( ; i < count; ++i )
+            {
+                const __m128 p = positions.Load( i );
+                min0 = _mm_min_ps( min0, p );
+                max0 = _mm_max_ps( max0, p );
+            }
+
+            alignas( 16 ) float lower[4];
+            alignas( 16 ) float upper[4];
+            _mm_store_ps( lower, _mm_min_ps( min0, min1 ) );
+            _mm_store_ps( upper, _mm_max_ps( max0, max1 ) );
+            minimum = { lower[0], lower[1], lower[2] };
+            maximum = { upper[0], upper[1], upper[2] };
+        }
+
+        float DistanceSquared( const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b )
+        {
+            const float dx = a.x - b.x;
+            const float dy = a.y - b.y;
+            const float dz = a.z - b.z;
+            return dx * dx + dy * dy + dz * dz;
+        }
+
+        // Squared distances of positions i..i+3 to the center.
+        __m128 DistancesSquared4( const StridedPositions& positions, size_t i, const DirectX::XMFLOAT3& center )
+        {
+            __m128 x = positions.Load( i + 0 );
+            __m128 y = positions.Load( i + 1 );
+            __m128 z = positions.Load( i + 2 );
+            __m128 w = positions.Load( i + 3 );
+            _MM_TRANSPOSE4_PS( x, y, z, w );
+
+            const __m128 dx = _mm_sub_ps( x, _mm_set1_ps( center.x ) );
+            const __m128 dy = _mm_sub_ps( y, _mm_set1_ps( center.y ) );
+            const __m128 dz = _mm_sub_ps( z, _mm_set1_ps( center.z ) );
+            return _mm_add_ps( _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) ), _mm_mul_ps( dz, dz ) );
+        }
+
+        // Largest squared distance from center to any position.
+        float MaxDistanceSquared( const StridedPositions& positions, const DirectX::XMFLOAT3& center )
+        {
+            const size_t count = positions.GetCount();
+            __m128 farthest = _mm_setzero_ps();
+            size_t i = 0;
+            for ( ; i + 4 <= count; i += 4 )
+                farthest = _mm_max_ps( farthest, DistancesSquared4( positions, i, center ) );
+
+            alignas( 16 ) float lanes[4];
+            _mm_store_ps( lanes, farthest );
+            float result = std::max( std::max( lanes[0], lanes[1] ), std::max( lanes[2], lanes[3] ) );
+            for ( ; i < count; ++i )
+                result = std::max( result, DistanceSquared( positions.Get( i ), center ) );
+            return result;
+        }
+
+        void ComputeSphere( const StridedPositions& positions, DirectX::XMFLOAT3& center, float& radius )
+        {
+            const size_t count = positions.GetCount();
+
+            // Extreme points along the axes and the four cube diagonals, tracked per lane four points at a time.
+            constexpr int DirectionCount = 7;
+            static constexpr float directions[DirectionCount][3] = {
+                { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 },
+                { 1, 1, 1 }, { 1, 1, -1 }, { 1, -1, 1 }, { 1, -1, -1 },
+            };
+            __m128 lowestValues[DirectionCount];
+            __m128 highestValues[DirectionCount];
+            __m128i lowestIndices[DirectionCount];
+            __m128i highestIndices[DirectionCount];
+            for ( int direction = 0; direction < DirectionCount; ++direction )
+            {
+                lowestValues[direction] = _mm_set1_ps( FLT_MAX );
+                highestValues[direction] = _mm_set1_ps( -FLT_MAX );
+                lowestIndices[direction] = _mm_setzero_si128();
+                highestIndices[direction] = _mm_setzero_si128();
+            }
+
+            auto select = []( __m128i mask, __m128i a, __m128i b ) { return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) ); };
+
+            size_t i = 0;
+            __m128i laneIndices = _mm_setr_epi32( 0, 1, 2, 3 );
+            for ( ; i + 4 <= count; i += 4 )
+            {
+                __m128 x = positions.Load( i + 0 );
+                __m128 y = positions.Load( i + 1 );
+                __m128 z = positions.Load( i + 2 );
+                __m128 w = positions.Load( i + 3 );
+                _MM_TRANSPOSE4_PS( x, y, z, w );
+
+                const __m128 xPlusY = _mm_add_ps( x, y );
+                const __m128 xMinusY = _mm_sub_ps( x, y );
+                const __m128 projections[DirectionCount] = {
+                    x, y, z,
+                    _mm_add_ps( xPlusY, z ), _mm_sub_ps( xPlusY, z ), _mm_add_ps( xMinusY, z ), _mm_sub_ps( xMinusY, z ),
+                };
+
+                for ( int direction = 0; direction < DirectionCount; ++direction )
+                {
+                    const __m128i lower = _mm_castps_si128( _mm_cmplt_ps( projections[direction], lowestValues[direction] ) );
+                    const __m128i higher = _mm_castps_si128( _mm_cmpgt_ps( projections[direction], highestValues[direction] ) );
+                    lowestValues[direction] = _mm_min_ps( projections[direction], lowestValues[direction] );
+                    highestValues[direction] = _mm_max_ps( projections[direction], highestValues[direction] );
+                    lowestIndices[direction] = select( lower, laneIndices, lowestIndices[direction] );
+                    highestIndices[direction] = select( higher, laneIndices, highestIndices[direction] );
+                }
+
+                laneIndices = _mm_add_epi32( laneIndices, _mm_set1_epi32( 4 ) );
+            }
+
+            size_t lowest[DirectionCount] = {};
+            size_t highest[DirectionCount] = {};
+            float lowestValue[DirectionCount];
+            float highestValue[DirectionCount];
+            for ( int direction = 0; direction < DirectionCount; ++direction )
+            {
+                alignas( 16 ) float lowValues[4];
+                alignas( 16 ) float highValues[4];
+                alignas( 16 ) uint32_t lowIndices[4];
+                alignas( 16 ) uint32_t highIndices[4];
+                _mm_store_ps( lowValues, lowestValues[direction] );
+                _mm_store_ps( highValues, highestValues[direction] );
+                _mm_store_si128( reinterpret_cast<__m128i*>( lowIndices ), lowestIndices[direction] );
+                _mm_store_si128( reinterpret_cast<__m128i*>( highIndices ), highestIndices[direction] );
+
+                lowestValue[direction] = FLT_MAX;
+                highestValue[direction] = -FLT_MAX;
+                for ( int lane = 0; lane < 4; ++lane )
+                {
+                    if ( lowValues[lane] < lowestValue[direction] )
+                    {
+                        lowestValue[direction] = lowValues[lane];
+                        lowest[direction] = lowIndices[lane];
+                    }
+                    if ( highValues[lane] > highestValue[direction] )
+                    {
+                        highestValue[direction] = highValues[lane];
+                        highest[direction] = highIndices[lane];
+                    }
+                }
+            }
+
+            for ( ; i < count; ++i )
+            {
+                const DirectX::XMFLOAT3& p = positions.Get( i );
+                for ( int direction = 0; direction < DirectionCount; ++direction )
+                {
+                    const float projection = p.x * directions[direction][0] + p.y * directions[direction][1] + p.z * directions[direction][2];
+                    if ( projection < lowestValue[direction] )
+                    {
+                        lowestValue[direction] = projection;
+                        lowest[direction] = i;
+                    }
+                    if ( projection > highestValue[direction] )
+                    {
+                        highestValue[direction] = projection;
+                        highest[direction] = i;
+                    }
+                }
+            }
+
+            int widest = 0;
+            float widestDistance = -1.f;
+            for ( int direction = 0; direction < DirectionCount; ++direction )
+            {
+                const float distance = DistanceSquared( positions.Get( lowest[direction] ), positions.Get( highest[direction] ) );
+                if ( distance > widestDistance )
+                {
+                    widestDistance = distance;
+                    widest = direction;
+                }
+            }
+
+            const DirectX::XMFLOAT3& a = positions.Get( lowest[widest] );
+            const DirectX::XMFLOAT3& b = positions.Get( highest[widest] );
+            float cx = ( a.x + b.x ) * 0.5f;
+            float cy = ( a.y + b.y ) * 0.5f;
+            float cz = ( a.z + b.z ) * 0.5f;
+            float r = std::sqrt( widestDistance ) * 0.5f;
+
+            // Grow to enclose every point; almost all are inside already, so test four at a time.
+            i = 0;
+            while ( i < count )
+            {
+                if ( i + 4 <= count )
+                {
+                    const __m128 distance = DistancesSquared4( positions, i, { cx, cy, cz } );
+                    if ( _mm_movemask_ps( _mm_cmpgt_ps( distance, _mm_set1_ps( r * r ) ) ) == 0 )
+                    {
+                        i += 4;
+                        continue;
+                    }
+                }
+
+                const size_t end = std::min( i + 4, count );
+                for ( ; i < end; ++i )
+                {
+                    const DirectX::XMFLOAT3& p = positions.Get( i );
+                    const float dx = p.x - cx;
+                    const float dy = p.y - cy;
+                    const float dz = p.z - cz;
+                    const float distanceSquared = dx * dx + dy * dy + dz * dz;
+                    if ( distanceSquared <= r * r )
+                        continue;
+
+                    // Move the center toward the point just enough to touch it from the far side.
+                    const float distance = std::sqrt( distanceSquared );
+                    const float grownRadius = ( r + distance ) * 0.5f;
+                    const float shift = ( grownRadius - r ) / distance;
+                    cx += dx * shift;
+                    cy += dy * shift;
+                    cz += dz * shift;
+                    r = grownRadius;
+                }
+            }
+
+            center = { cx, cy, cz };
+            radius = r;
+        }
+
+        BoundingVolume ComputeBounds( const StridedPositions& positions )
+        {
+            BoundingVolume bounds;
+            if ( positions.GetCount() == 0 )
+                return bounds;
+
+            ComputeBox( positions, bounds.m_min, bounds.m_max );
+            ComputeSphere( positions, bounds.m_sphereCenter, bounds.m_sphereRadius );
+
+            const DirectX::XMFLOAT3 boxCenter = {
+                ( bounds.m_min.x + bounds.m_max.x ) * 0.5f,
+                ( bounds.m_min.y + bounds.m_max.y ) * 0.5f,
+                ( bounds.m_min.z + bounds.m_max.z ) * 0.5f };
+            const float boxRadius = std::sqrt( MaxDistanceSquared( positions, boxCenter ) );
+            if ( boxRadius < bounds.m_sphereRadius )
+            {
+                bounds.m_sphereCenter = boxCenter;
+                bounds.m_sphereRadius = boxRadius;
+            }
+
+            // Absorb the rounding of the incremental updates.
+            bounds.m_sphereRadius *= 1.f + 1e-6f;
+            return bounds;
+        }
+    }
+
+    BoundingVolume ComputeBounds( const DirectX::XMFLOAT3* positions, size_t count, size_t strideInBytes )
+    {
+        return ComputeBounds( StridedPositions( positions, strideInBytes, nullptr, count ) );
+    }
+
+    BoundingVolume ComputeBounds( const DirectX::XMFLOAT3* positions, size_t strideInBytes, const uint32_t* indices, size_t indexCount )
+    {
+        return ComputeBounds( StridedPositions( positions, strideInBytes, indices, indexCount ) );
+    }
+
+    void ComputeBoundingBox( const DirectX::XMFLOAT3* positions, size_t count, size_t strideInBytes,
+        DirectX::XMFLOAT3& minimum, DirectX::XMFLOAT3& maximum )
+    {
+        if ( count == 0 )
+        {
+            minimum = maximum = { 0.f, 0.f, 0.f };
+            return;
+        }
+        ComputeBox( StridedPositions( positions, strideInBytes, nullptr, count ), minimum, maximum );
+    }
+
+    void ComputeMeshBounds( Mesh& mesh )
+    {
+        const DirectX::XMFLOAT3* positions = mesh.m_vertices.empty() ? nullptr : &mesh.m_vertices[0].m_position;
+        constexpr size_t stride = sizeof( Mesh::VertexInfo );
+
+        mesh.m_bounds = ComputeBounds( positions, mesh.m_vertices.size(), stride );
+
+        mesh.m_submeshBounds.clear();
+        for ( const Submesh& submesh : mesh.m_submeshes )
+            mesh.m_submeshBounds.push_back( ComputeBounds( positions ? &mesh.m_vertices[submesh.m_baseVertex].m_position : nullptr, submesh.m_vertexCount, stride ) );
+
+        for ( MeshLod& lod : mesh.m_lods )
+            lod.m_bounds = ComputeBounds( positions, stride, reinterpret_cast<const uint32_t*>( lod.m_indices.data() ), lod.m_indices.size() * 3 );
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace Olex
+{
+    struct Mesh;
+
+    struct BoundingVolume
+    {
+        DirectX::XMFLOAT3 m_min = { 0.f, 0.f, 0.f };
+        DirectX::XMFLOAT3 m_max = { 0.f, 0.f, 0.f };
+        DirectX::XMFLOAT3 m_sphereCenter = { 0.f, 0.f, 0.f };
+        float m_sphereRadius = 0.f;
+    };
+
+    /**
+     * Axis-aligned box and bounding sphere of positions laid out strideInBytes apart.
+     *
+     * The box comes from SSE min/max reductions (AVX2 when the build targets it). The sphere starts
+     * from the farthest pair of extreme points along 7 directions and grows to fit the rest (Ritter),
+     * testing four points at a time; the sphere around the box center is used instead when smaller.
+     * An empty range gives a zero-sized volume at the origin.
+     */
+    BoundingVolume ComputeBounds( const DirectX::XMFLOAT3* positions, size_t count, size_t strideInBytes );
+
+    // Same, over the positions referenced by indices only (e.g. a simplified level of detail).
+    BoundingVolume ComputeBounds( const DirectX::XMFLOAT3* positions, size_t strideInBytes, const uint32_t* indices, size_t indexCount );
+
+    // The box part of ComputeBounds alone, for callers that do not need the sphere.
+    void ComputeBoundingBox( const DirectX::XMFLOAT3* positions, size_t count, size_t strideInBytes,
+        DirectX::XMFLOAT3& minimum, DirectX::XMFLOAT3& maximum );
+
+    // Fills the bounds of the mesh, of each of its submeshes and of each level of detail.
+    void ComputeMeshBounds( Mesh& mesh );
+}
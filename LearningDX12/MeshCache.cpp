@@ -0,0 +1,362 @@
+#include "MeshCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Olex
+{
+    namespace
+    {
+        bool IsLittleEndianHost()
+        {
+            const uint16_t value = 1;
+            uint8_t firstByte;
+            std::memcpy( &firstByte, &value, 1 );
+            return firstByte == 1;
+        }
+
+        uint64_t AlignUp( uint64_t value, uint64_t alignment )
+        {
+            return ( value + alignment - 1 ) & ~( alignment - 1 );
+        }
+    }
+
+    SourceStamp SourceStamp::FromFile( const std::filesystem::path& sourcePath )
+    {
+        std::error_code error;
+        SourceStamp stamp;
+
+        const uintmax_t size = std::filesystem::file_size( sourcePath, error );
+        if ( error )
+            return stamp;
+
+        const auto writeTime = std::filesystem::last_write_time( sourcePath, error );
+        if ( error )
+            return stamp;
+
+        stamp.m_size = static_cast<uint64_t>( size );
+        stamp.m_writeTime = static_cast<int64_t>( writeTime.time_since_epoch().count() );
+        return stamp;
+    }
+
+    void WriteMeshCache( const std::filesystem::path& cachePath, const std::vector<Mesh>& meshes, const SourceStamp& sourceStamp )
+    {
+        // The file is mapped straight into native structs, so it is only ever produced in little-endian.
+        if ( !IsLittleEndianHost() )
+        {
+            throw std::runtime_error( "Mesh cache can only be written on a little-endian host" );
+        }
+
+        MeshCacheHeader header = {};
+        header.m_magic = MeshCacheFormat::Magic;
+        header.m_version = MeshCacheFormat::Version;
+        header.m_endianTag = MeshCacheFormat::EndianTag;
+        header.m_vertexStride = sizeof( Mesh::VertexInfo );
+        header.m_meshCount = static_cast<uint32_t>( meshes.size() );
+        header.m_sourceSize = sourceStamp.m_size;
+        header.m_sourceWriteTime = sourceStamp.m_writeTime;
+
+        std::vector<MeshCacheEntry> entries( meshes.size() );
+        std::vector<std::vector<uint8_t>> indexBlobs( meshes.size() );
+        std::vector<std::vector<PackedTangent>> tangentBlobs( meshes.size() );
+        std::vector<std::vector<MeshCacheJoint>> jointTables( meshes.size() );
+        std::vector<std::vector<MeshCacheLod>> lodTables( meshes.size() );
+        std::vector<std::vector<std::vector<uint8_t>>> lodBlobs( meshes.size() );
+        uint64_t offset = sizeof( MeshCacheHeader ) + sizeof( MeshCacheEntry ) * entries.size();
+        for ( size_t i = 0; i < meshes.size(); ++i )
+        {
+            const Mesh& mesh = meshes[i];
+            if ( mesh.m_submeshBounds.size() != mesh.m_submeshes.size() )
+            {
+                throw std::invalid_argument( "Mesh bounds must be computed before writing the cache" );
+            }
+            if ( !mesh.m_tangents.empty() && mesh.m_tangents.size() != mesh.m_vertices.size() )
+            {
+                throw std::invalid_argument( "Mesh tangents must match its vertices" );
+            }
+            if ( mesh.m_skin.IsSkinned() && ( mesh.m_skin.m_vertices.size() != mesh.m_vertices.size() ||
+                mesh.m_skin.m_jointNodes.empty() || mesh.m_skin.m_jointNodes.size() != mesh.m_skin.m_inverseBindMatrices.size() ) )
+            {
+                throw std::invalid_argument( "Mesh skin must match its vertices and joint palette" );
+            }
+
+            indexBlobs[i] = PackIndices( mesh.m_indices, mesh.m_submeshes, mesh.m_indexFormat );
+
+            MeshCacheEntry& entry = entries[i];
+            entry.m_vertexCount = static_cast<uint32_t>( mesh.m_vertices.size() );
+            entry.m_indexCount = static_cast<uint32_t>( mesh.m_indices.size() * 3 );
+            entry.m_submeshCount = static_cast<uint32_t>( mesh.m_submeshes.size() );
+            entry.m_indexFormat = mesh.m_indexFormat;
+
+            offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+            entry.m_vertexOffset = offset;
+            offset += sizeof( Mesh::VertexInfo ) * entry.m_vertexCount;
+
+            tangentBlobs[i].reserve( mesh.m_tangents.size() );
+            for ( const DirectX::XMFLOAT4& tangent : mesh.m_tangents )
+                tangentBlobs[i].push_back( PackTangent( tangent ) );
+
+            entry.m_tangentCount = static_cast<uint32_t>( tangentBlobs[i].size() );
+            offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+            entry.m_tangentOffset = offset;
+            offset += sizeof( PackedTangent ) * entry.m_tangentCount;
+
+            entry.m_jointCount = mesh.m_skin.IsSkinned() ? static_cast<uint32_t>( mesh.m_skin.m_jointNodes.size() ) : 0;
+            for ( uint32_t joint = 0; joint < entry.m_jointCount; ++joint )
+            {
+                MeshCacheJoint jointEntry = {};
+                jointEntry.m_inverseBindMatrix = mesh.m_skin.m_inverseBindMatrices[joint];
+                jointEntry.m_node = mesh.m_skin.m_jointNodes[joint];
+                jointTables[i].push_back( jointEntry );
+            }
+
+            offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+            entry.m_skinOffset = offset;
+            offset += entry.m_jointCount != 0 ? sizeof( VertexSkin ) * entry.m_vertexCount : 0;
+
+            offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+            entry.m_jointOffset = offset;
+            offset += sizeof( MeshCacheJoint ) * entry.m_jointCount;
+
+            offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+            entry.m_indexOffset = offset;
+            offset += indexBlobs[i].size();
+
+            offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+            entry.m_submeshOffset = offset;
+            offset += sizeof( Submesh ) * entry.m_submeshCount;
+
+            offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+            entry.m_submeshBoundsOffset = offset;
+            offset += sizeof( BoundingVolume ) * entry.m_submeshCount;
+            entry.m_bounds = mesh.m_bounds;
+
+            entry.m_lodCount = static_cast<uint32_t>( mesh.m_lods.size() );
+            offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+            entry.m_lodOffset = offset;
+            offset += sizeof( MeshCacheLod ) * entry.m_lodCount;
+
+            // Levels share the vertices, so they can only use 16-bit indices when the whole mesh does.
+            const IndexFormat lodFormat = mesh.m_submeshes.size() == 1 ? mesh.m_indexFormat : IndexFormat::UInt32;
+            for ( const MeshLod& lod : mesh.m_lods )
+            {
+                Submesh whole;
+                whole.m_indexCount = static_cast<uint32_t>( lod.m_indices.size() * 3 );
+                whole.m_vertexCount = entry.m_vertexCount;
+                lodBlobs[i].push_back( PackIndices( lod.m_indices, { whole }, lodFormat ) );
+
+                MeshCacheLod lodEntry = {};
+                lodEntry.m_indexCount = whole.m_indexCount;
+                lodEntry.m_indexFormat = lodFormat;
+                lodEntry.m_error = lod.m_error;
+                lodEntry.m_bounds = lod.m_bounds;
+
+                offset = AlignUp( offset, MeshCacheFormat::BlobAlignment );
+                lodEntry.m_indexOffset = offset;
+                offset += lodBlobs[i].back().size();
+
+                lodTables[i].push_back( lodEntry );
+            }
+        }
+
+        // Unique, as bakers sharing the output directory may write the same cache at once.
+        std::filesystem::path temporaryPath = cachePath;
+        temporaryPath += "." + MakeUniqueName() + ".tmp";
+
+        {
+            std::ofstream stream( temporaryPath, std::ios::binary | std::ios::trunc );
+            if ( !stream )
+            {
+                throw std::runtime_error( "Unable to create mesh cache file" );
+            }
+
+            uint64_t written = 0;
+            auto write = [&stream, &written]( const void* data, uint64_t size )
+            {
+                stream.write( static_cast<const char*>( data ), static_cast<std::streamsize>( size ) );
+                written += size;
+            };
+            auto pad = [&write, &written]( uint64_t position )
+            {
+                static const uint8_t zeros[MeshCacheFormat::BlobAlignment] = {};
+                write( zeros, position - written );
+            };
+
+            write( &header, sizeof( header ) );
+            write( entries.data(), sizeof( MeshCacheEntry ) * entries.size() );
+
+            for ( size_t i = 0; i < meshes.size(); ++i )
+            {
+                pad( entries[i].m_vertexOffset );
+                write( meshes[i].m_vertices.data(), sizeof( Mesh::VertexInfo ) * entries[i].m_vertexCount );
+                pad( entries[i].m_tangentOffset );
+                write( tangentBlobs[i].data(), sizeof( PackedTangent ) * entries[i].m_tangentCount );
+                pad( entries[i].m_skinOffset );
+                write( meshes[i].m_skin.m_vertices.data(), entries[i].m_jointCount != 0 ? sizeof( VertexSkin ) * entries[i].m_vertexCount : 0 );
+                pad( entries[i].m_jointOffset );
+                write( jointTables[i].data(), sizeof( MeshCacheJoint ) * entries[i].m_jointCount );
+                pad( entries[i].m_indexOffset );
+                write( indexBlobs[i].data(), indexBlobs[i].size() );
+                pad( entries[i].m_submeshOffset );
+                write( meshes[i].m_submeshes.data(), sizeof( Submesh ) * entries[i].m_submeshCount );
+                pad( entries[i].m_submeshBoundsOffset );
+                write( meshes[i].m_submeshBounds.data(), sizeof( BoundingVolume ) * entries[i].m_submeshCount );
+                pad( entries[i].m_lodOffset );
+                write( lodTables[i].data(), sizeof( MeshCacheLod ) * entries[i].m_lodCount );
+                for ( size_t lod = 0; lod < lodTables[i].size(); ++lod )
+                {
+                    pad( lodTables[i][lod].m_indexOffset );
+                    write( lodBlobs[i][lod].data(), lodBlobs[i][lod].size() );
+                }
+            }
+
+            if ( !stream )
+            {
+                throw std::runtime_error( "Failed writing mesh cache file" );
+            }
+        }
+
+        std::filesystem::rename( temporaryPath, cachePath );
+    }
+
+    MappedMeshCache::MappedMeshCache( const std::filesystem::path& cachePath )
+        : m_file( cachePath )
+    {
+        if ( m_file.IsOpen() && m_file.GetSize() >= sizeof( MeshCacheHeader ) )
+        {
+            m_header = reinterpret_cast<const MeshCacheHeader*>( m_file.GetData() );
+            m_entries = reinterpret_cast<const MeshCacheEntry*>( m_file.GetData() + sizeof( MeshCacheHeader ) );
+
+            if ( !Validate() )
+            {
+                m_header = nullptr;
+                m_entries = nullptr;
+            }
+        }
+    }
+
+    bool MappedMeshCache::Validate() const
+    {
+        if ( m_header->m_magic != MeshCacheFormat::Magic ||
+            m_header->m_version != MeshCacheFormat::Version ||
+            m_header->m_endianTag != MeshCacheFormat::EndianTag ||
+            m_header->m_vertexStride != sizeof( Mesh::VertexInfo ) )
+        {
+            return false;
+        }
+
+        const uint64_t fileSize = m_file.GetSize();
+        const uint64_t tableEnd = sizeof( MeshCacheHeader ) + sizeof( MeshCacheEntry ) * uint64_t( m_header->m_meshCount );
+        if ( tableEnd > fileSize )
+            return false;
+
+        // Written so that no offset, however large, can wrap the sum around to a small value.
+        auto isInFile = [tableEnd, fileSize]( uint64_t offset, uint64_t size )
+        {
+            return offset >= tableEnd && offset % MeshCacheFormat::BlobAlignment == 0 && offset <= fileSize && size <= fileSize - offset;
+        };
+        auto isIndexFormat = []( IndexFormat format ) { return format == IndexFormat::UInt16 || format == IndexFormat::UInt32; };
+
+        for ( uint32_t i = 0; i < m_header->m_meshCount; ++i )
+        {
+            const MeshCacheEntry& entry = m_entries[i];
+            if ( !isIndexFormat( entry.m_indexFormat ) ||
+                ( entry.m_tangentCount != 0 && entry.m_tangentCount != entry.m_vertexCount ) ||
+                entry.m_jointCount > MaxSkinJoints ||
+                !isInFile( entry.m_vertexOffset, sizeof( Mesh::VertexInfo ) * uint64_t( entry.m_vertexCount ) ) ||
+                !isInFile( entry.m_tangentOffset, sizeof( PackedTangent ) * uint64_t( entry.m_tangentCount ) ) ||
+                !isInFile( entry.m_skinOffset, entry.m_jointCount != 0 ? sizeof( VertexSkin ) * uint64_t( entry.m_vertexCount ) : 0 ) ||
+                !isInFile( entry.m_jointOffset, sizeof( MeshCacheJoint ) * uint64_t( entry.m_jointCount ) ) ||
+                !isInFile( entry.m_indexOffset, uint64_t( entry.m_indexCount ) * static_cast<uint32_t>( entry.m_indexFormat ) ) ||
+                !isInFile( entry.m_submeshOffset, sizeof( Submesh ) * uint64_t( entry.m_submeshCount ) ) ||
+                !isInFile( entry.m_submeshBoundsOffset, sizeof( BoundingVolume ) * uint64_t( entry.m_submeshCount ) ) ||
+                !isInFile( entry.m_lodOffset, sizeof( MeshCacheLod ) * uint64_t( entry.m_lodCount ) ) )
+            {
+                return false;
+            }
+
+            // Submeshes are drawn straight from the view, so each has to stay inside the index and vertex buffers.
+            const auto* submeshes = reinterpret_cast<const Submesh*>( m_file.GetData() + entry.m_submeshOffset );
+            for ( uint32_t submesh = 0; submesh < entry.m_submeshCount; ++submesh )
+            {
+                const Submesh& range = submeshes[submesh];
+                if ( uint64_t( range.m_startIndex ) + range.m_indexCount > entry.m_indexCount ||
+                    uint64_t( range.m_baseVertex ) + range.m_vertexCount > entry.m_vertexCount )
+                {
+                    return false;
+                }
+            }
+
+            const auto* lods = reinterpret_cast<const MeshCacheLod*>( m_file.GetData() + entry.m_lodOffset );
+            for ( uint32_t lod = 0; lod < entry.m_lodCount; ++lod )
+            {
+                const MeshCacheLod& lodEntry = lods[lod];
+                if ( !isIndexFormat( lodEntry.m_indexFormat ) ||
+                    !isInFile( lodEntry.m_indexOffset, uint64_t( lodEntry.m_indexCount ) * static_cast<uint32_t>( lodEntry.m_indexFormat ) ) )
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool MappedMeshCache::IsUpToDate( const SourceStamp& sourceStamp ) const
+    {
+        return IsValid() &&
+            m_header->m_sourceSize == sourceStamp.m_size &&
+            m_header->m_sourceWriteTime == sourceStamp.m_writeTime;
+    }
+
+    MeshView MappedMeshCache::GetMesh( uint32_t meshIndex ) const
+    {
+        if ( meshIndex >= GetMeshCount() )
+        {
+            throw std::out_of_range( "Mesh index out of range" );
+        }
+
+        const MeshCacheEntry& entry = m_entries[meshIndex];
+
+        MeshView view;
+        view.m_vertices = reinterpret_cast<const Mesh::VertexInfo*>( m_file.GetData() + entry.m_vertexOffset );
+        view.m_vertexCount = entry.m_vertexCount;
+        if ( entry.m_tangentCount != 0 )
+            view.m_tangents = reinterpret_cast<const PackedTangent*>( m_file.GetData() + entry.m_tangentOffset );
+        if ( entry.m_jointCount != 0 )
+        {
+            view.m_skin = reinterpret_cast<const VertexSkin*>( m_file.GetData() + entry.m_skinOffset );
+            view.m_joints = reinterpret_cast<const MeshCacheJoint*>( m_file.GetData() + entry.m_jointOffset );
+            view.m_jointCount = entry.m_jointCount;
+        }
+        view.m_indices = m_file.GetData() + entry.m_indexOffset;
+        view.m_indexCount = entry.m_indexCount;
+        view.m_indexFormat = entry.m_indexFormat;
+        view.m_submeshes = reinterpret_cast<const Submesh*>( m_file.GetData() + entry.m_submeshOffset );
+        view.m_submeshBounds = reinterpret_cast<const BoundingVolume*>( m_file.GetData() + entry.m_submeshBoundsOffset );
+        view.m_submeshCount = entry.m_submeshCount;
+        view.m_lodCount = entry.m_lodCount;
+        view.m_bounds = entry.m_bounds;
+        return view;
+    }
+
+    MeshLodView MappedMeshCache::GetLod( uint32_t meshIndex, uint32_t lodIndex ) const
+    {
+        if ( meshIndex >= GetMeshCount() || lodIndex >= m_entries[meshIndex].m_lodCount )
+        {
+            throw std::out_of_range( "Level of detail index out of range" );
+        }
+
+        const auto* lods = reinterpret_cast<const MeshCacheLod*>( m_file.GetData() + m_entries[meshIndex].m_lodOffset );
+        const MeshCacheLod& lod = lods[lodIndex];
+
+        MeshLodView view;
+        view.m_indices = m_file.GetData() + lod.m_indexOffset;
+        view.m_indexCount = lod.m_indexCount;
+        view.m_indexFormat = lod.m_indexFormat;
+        view.m_error = lod.m_error;
+        view.m_bounds = lod.m_bounds;
+        return view;
+    }
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "QuantizedVertex.h"
+
+namespace Olex
+{
+    /**
+     * Baked binary mesh container.
+     *
+     * The file is written once by the importer and memory-mapped on later runs, so loading
+     * costs little more than the page faults of the touched data. All values are little-endian.
+     *
+     *   MeshCacheHeader
+     *   MeshCacheEntry[m_meshCount]
+     *   per mesh: Mesh::VertexInfo[m_vertexCount], PackedTangent[m_tangentCount], VertexSkin[m_vertexCount]
+     *             and MeshCacheJoint[m_jointCount] when skinned, m_indexCount indices of m_indexFormat relative
+     *             to their submesh base vertex, Submesh[m_submeshCount], BoundingVolume[m_submeshCount],
+     *             MeshCacheLod[m_lodCount], then the indices of every level of detail
+     *
+     * Every blob starts on a MeshCacheFormat::BlobAlignment boundary.
+     */
+    namespace MeshCacheFormat
+    {
+        constexpr uint32_t Magic = 0x48534D4F; // "OMSH"
+        // Also bumped whenever the importer output changes, so stale bakes get rebuilt.
+        // 2: vertices welded per corner instead of one per control point.
+        // 3: triangles reordered for the post-transform vertex cache.
+        // 4: triangle clusters reordered to reduce overdraw.
+        // 5: vertices renumbered in first-use order.
+        // 6: 16-bit indices and submeshes.
+        // 7: levels of detail.
+        // 8: bounding volumes per mesh, submesh and level of detail.
+        // 9: packed tangent stream.
+        // 10: skin influences and joint palette.
+        constexpr uint16_t Version = 10;
+        constexpr uint16_t EndianTag = 0x0102;
+        constexpr uint64_t BlobAlignment = 16;
+    }
+
+    struct MeshCacheHeader
+    {
+        uint32_t m_magic;
+        uint16_t m_version;
+        uint16_t m_endianTag;
+        uint32_t m_vertexStride;
+        uint32_t m_meshCount;
+        // Identifies the source file the cache was baked from.
+        uint64_t m_sourceSize;
+        int64_t m_sourceWriteTime;
+    };
+
+    struct MeshCacheEntry
+    {
+        uint64_t m_vertexOffset;
+        uint64_t m_indexOffset;
+        uint64_t m_submeshOffset;
+        uint32_t m_vertexCount;
+        uint32_t m_indexCount;
+        uint32_t m_submeshCount;
+        IndexFormat m_indexFormat;
+        uint64_t m_lodOffset;
+        uint32_t m_lodCount;
+        uint32_t m_padding;
+        uint64_t m_submeshBoundsOffset;
+        BoundingVolume m_bounds;
+        uint64_t m_tangentOffset;
+        // Either 0 or m_vertexCount.
+        uint32_t m_tangentCount;
+        // 0 for rigid meshes, which have no skin blob either.
+        uint32_t m_jointCount;
+        uint64_t m_skinOffset;
+        uint64_t m_jointOffset;
+    };
+
+    // One entry of the joint palette of a skinned mesh, see MeshSkin.
+    struct MeshCacheJoint
+    {
+        DirectX::XMFLOAT4X4 m_inverseBindMatrix;
+        uint32_t m_node;
+        uint32_t m_padding[3];
+    };
+
+    struct MeshCacheLod
+    {
+        uint64_t m_indexOffset;
+        uint32_t m_indexCount;
+        IndexFormat m_indexFormat;
+        float m_error;
+        uint32_t m_padding;
+        BoundingVolume m_bounds;
+    };
+
+    static_assert( sizeof( MeshCacheHeader ) == 32, "MeshCacheHeader layout is part of the file format" );
+    static_assert( sizeof( MeshCacheEntry ) == 136, "MeshCacheEntry layout is part of the file format" );
+    static_assert( sizeof( MeshCacheLod ) == 64, "MeshCacheLod layout is part of the file format" );
+    static_assert( sizeof( MeshCacheJoint ) == 80, "MeshCacheJoint layout is part of the file format" );
+    static_assert( sizeof( BoundingVolume ) == 40, "BoundingVolume layout is part of the file format" );
+    static_assert( sizeof( Submesh ) == 16, "Submesh layout is part of the file format" );
+    static_assert( sizeof( Mesh::VertexInfo ) == 32, "Mesh::VertexInfo layout is part of the file format" );
+
+    /**
+     * Size and modification time of the file a cache was baked from.
+     * A cache whose stamp differs from the source on disk is stale.
+     */
+    struct SourceStamp
+    {
+        uint64_t m_size = 0;
+        int64_t m_writeTime = 0;
+
+        static SourceStamp FromFile( const std::filesystem::path& sourcePath );
+    };
+
+    inline bool operator== ( const SourceStamp& lhs, const SourceStamp& rhs ) { return lhs.m_size == rhs.m_size && lhs.m_writeTime == rhs.m_writeTime; }
+
+    /**
+     * Non-owning view of one mesh inside a mapped cache.
+     */
+    struct MeshView
+    {
+        const Mesh::VertexInfo* m_vertices = nullptr;
+        uint32_t m_vertexCount = 0;
+        // One per vertex, or null when the mesh was imported without tangents.
+        const PackedTangent* m_tangents = nullptr;
+        // One per vertex and the joint palette, null and 0 for rigid meshes.
+        const VertexSkin* m_skin = nullptr;
+        const MeshCacheJoint* m_joints = nullptr;
+        uint32_t m_jointCount = 0;
+        // m_indexCount indices of m_indexFormat, each relative to the base vertex of its submesh.
+        const void* m_indices = nullptr;
+        uint32_t m_indexCount = 0;
+        IndexFormat m_indexFormat = IndexFormat::UInt32;
+        const Submesh* m_submeshes = nullptr;
+        // One per submesh.
+        const BoundingVolume* m_submeshBounds = nullptr;
+        uint32_t m_submeshCount = 0;
+        uint32_t m_lodCount = 0;
+        BoundingVolume m_bounds;
+
+        [[nodiscard]] uint64_t GetIndexBufferSize() const { return uint64_t( m_indexCount ) * static_cast<uint32_t>( m_indexFormat ); }
+    };
+
+    /**
+     * Non-owning view of one level of detail inside a mapped cache. The indices are
+     * absolute into the vertices of the mesh, drawn with a base vertex of 0.
+     */
+    struct MeshLodView
+    {
+        const void* m_indices = nullptr;
+        uint32_t m_indexCount = 0;
+        IndexFormat m_indexFormat = IndexFormat::UInt32;
+        float m_error = 0.f;
+        BoundingVolume m_bounds;
+
+        [[nodiscard]] uint64_t GetIndexBufferSize() const { return uint64_t( m_indexCount ) * static_cast<uint32_t>( m_indexFormat ); }
+    };
+
+    // Writes the meshes to a cache file. The file is written under a temporary
+    // name and then renamed, so readers never observe a partially written cache.
+    void WriteMeshCache( const std::filesystem::path& cachePath, const std::vector<Mesh>& meshes, const SourceStamp& sourceStamp );
+
+    /**
+     * Memory-mapped read access to a baked mesh cache.
+     */
+    class MappedMeshCache
+    {
+    public:
+        explicit MappedMeshCache( const std::filesystem::path& cachePath );
+
+        // False if the file is missing, truncated or was written by an incompatible version.
+        [[nodiscard]] bool IsValid() const { return m_header != nullptr; }
+        [[nodiscard]] bool IsUpToDate( const SourceStamp& sourceStamp ) const;
+
+        [[nodiscard]] uint32_t GetMeshCount() const { return m_header ? m_header->m_meshCount : 0; }
+        [[nodiscard]] MeshView GetMesh( uint32_t meshIndex ) const;
+        [[nodiscard]] MeshLodView GetLod( uint32_t meshIndex, uint32_t lodIndex ) const;
+
+    private:
+        MappedFile m_file;
+        const MeshCacheHeader* m_header = nullptr;
+        const MeshCacheEntry* m_entries = nullptr;
+
+        bool Validate() const;
+    };
+}
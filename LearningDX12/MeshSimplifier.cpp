@@ -0,0 +1,506 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    namespace
+    {
+        // Extra weight of the planes that hold open borders in place.
+        constexpr float BorderWeight = 10.f;
+
+        struct Float3
+        {
+            float x, y, z;
+        };
+
+        Float3 operator- ( const Float3& a, const Float3& b ) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+        float Dot( const Float3& a, const Float3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        Float3 Cross( const Float3& a, const Float3& b ) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+        float Length( const Float3& a ) { return std::sqrt( Dot( a, a ) ); }
+
+        Float3 ToFloat3( const DirectX::XMFLOAT3& v ) { return { v.x, v.y, v.z }; }
+
+        /**
+         * Weighted sum of squared distances to a set of planes, with the total weight
+         * so that Evaluate returns a mean squared distance.
+         */
+        struct Quadric
+        {
+            double a00 = 0, a11 = 0, a22 = 0, a10 = 0, a20 = 0, a21 = 0;
+            double b0 = 0, b1 = 0, b2 = 0;
+            double c = 0;
+            double w = 0;
+
+            static Quadric FromPlane( const Float3& normal, float distance, float weight )
+            {
+                Quadric q;
+                q.a00 = weight * normal.x * normal.x;
+                q.a11 = weight * normal.y * normal.y;
+                q.a22 = weight * normal.z * normal.z;
+                q.a10 = weight * normal.y * normal.x;
+                q.a20 = weight * normal.z * normal.x;
+                q.a21 = weight * normal.z * normal.y;
+                q.b0 = weight * normal.x * distance;
+                q.b1 = weight * normal.y * distance;
+                q.b2 = weight * normal.z * distance;
+                q.c = weight * distance * distance;
+                q.w = weight;
+                return q;
+            }
+
+            Quadric& operator+= ( const Quadric& other )
+            {
+                a00 += other.a00; a11 += other.a11; a22 += other.a22;
+                a10 += other.a10; a20 += other.a20; a21 += other.a21;
+                b0 += other.b0; b1 += other.b1; b2 += other.b2;
+                c += other.c;
+                w += other.w;
+                return *this;
+            }
+
+            double Evaluate( const Float3& p ) const
+            {
+                const double rx = a00 * p.x + a10 * p.y + a20 * p.z + 2 * b0;
+                const double ry = a10 * p.x + a11 * p.y + a21 * p.z + 2 * b1;
+                const double rz = a20 * p.x + a21 * p.y + a22 * p.z + 2 * b2;
+                const double error = rx * p.x + ry * p.y + rz * p.z + c;
+                return w > 0 ? std::max( error, 0.0 ) / w : 0.0;
+            }
+        };
+
+        enum class VertexKind : uint8_t
+        {
+            Manifold,
+            Border,
+            Locked,
+        };
+
+        struct PositionHash
+        {
+            size_t operator() ( const DirectX::XMFLOAT3& p ) const
+            {
+                uint32_t bits[3];
+                std::memcpy( bits, &p, sizeof( bits ) );
+                return ( bits[0] * 73856093u ) ^ ( bits[1] * 19349663u ) ^ ( bits[2] * 83492791u );
+            }
+        };
+
+        struct PositionEqual
+        {
+            bool operator() ( const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b ) const
+            {
+                return std::memcmp( &a, &b, sizeof( a ) ) == 0;
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t m_from;
+            uint32_t m_to;
+            float m_cost;
+        };
+
+        class Simplifier
+        {
+        public:
+            Simplifier( const Mesh& mesh, const std::vector<DirectX::XMINT3>& triangles )
+                : m_vertices( mesh.m_vertices )
+                , m_indices( reinterpret_cast<const uint32_t*>( triangles.data() ), reinterpret_cast<const uint32_t*>( triangles.data() ) + triangles.size() * 3 )
+            {
+                FindPositions();
+                ClassifyVertices();
+                ComputeQuadrics();
+            }
+
+            size_t GetTriangleCount() const { return m_indices.size() / 3; }
+
+            // Runs one pass of independent collapses, returns false when none was possible.
+            bool Pass( size_t targetTriangleCount, double maxCost, double& reachedCost );
+
+            std::vector<DirectX::XMINT3> GetTriangles() const
+            {
+                std::vector<DirectX::XMINT3> triangles( m_indices.size() / 3 );
+                std::memcpy( triangles.data(), m_indices.data(), m_indices.size() * sizeof( uint32_t ) );
+                return triangles;
+            }
+
+        private:
+            const std::vector<Mesh::VertexInfo>& m_vertices;
+            std::vector<uint32_t> m_indices;
+            // Lowest vertex index sharing the position of each vertex.
+            std::vector<uint32_t> m_position;
+            std::vector<VertexKind> m_kind;
+            // Per position, indexed by m_position.
+            std::vector<Quadric> m_quadrics;
+            // Directed edges between positions, the targets of each position as offsets into one flat array.
+            std::vector<uint32_t> m_edgeOffsets;
+            std::vector<uint32_t> m_edgeTargets;
+
+            Float3 GetPosition( uint32_t vertex ) const { return ToFloat3( m_vertices[vertex].m_position ); }
+
+            uint32_t CountEdges( uint32_t fromPosition, uint32_t toPosition ) const
+            {
+                return static_cast<uint32_t>( std::count( m_edgeTargets.begin() + m_edgeOffsets[fromPosition],
+                    m_edgeTargets.begin() + m_edgeOffsets[fromPosition + 1], toPosition ) );
+            }
+
+            bool IsBorderEdge( uint32_t a, uint32_t b ) const
+            {
+                const uint32_t pa = m_position[a];
+                const uint32_t pb = m_position[b];
+                return CountEdges( pa, pb ) == 0 || CountEdges( pb, pa ) == 0;
+            }
+
+            void FindPositions();
+            void ClassifyVertices();
+            void ComputeQuadrics();
+            bool CanCollapse( uint32_t from, uint32_t to ) const;
+            bool FlipsTriangle( uint32_t from, uint32_t to, const std::vector<uint32_t>& triangleOffsets, const std::vector<uint32_t>& vertexTriangles ) const;
+        };
+
+        void Simplifier::FindPositions()
+        {
+            m_position.resize( m_vertices.size() );
+
+            std::unordered_map<DirectX::XMFLOAT3, uint32_t, PositionHash, PositionEqual> firstAtPosition;
+            firstAtPosition.reserve( m_vertices.size() );
+            for ( uint32_t vertex = 0; vertex < m_vertices.size(); ++vertex )
+                m_position[vertex] = firstAtPosition.emplace( m_vertices[vertex].m_position, vertex ).first->second;
+        }
+
+        void Simplifier::ClassifyVertices()
+        {
+            m_kind.assign( m_vertices.size(), VertexKind::Manifold );
+
+            // Several vertices at one position means an attribute seam; keep those in place.
+            std::vector<uint32_t> verticesAtPosition( m_vertices.size(), 0 );
+            for ( uint32_t vertex = 0; vertex < m_vertices.size(); ++vertex )
+                ++verticesAtPosition[m_position[vertex]];
+
+            m_edgeOffsets.assign( m_vertices.size() + 1, 0 );
+            for ( size_t i = 0; i < m_indices.size(); ++i )
+                ++m_edgeOffsets[m_position[m_indices[i]] + 1];
+            for ( size_t position = 0; position < m_vertices.size(); ++position )
+                m_edgeOffsets[position + 1] += m_edgeOffsets[position];
+
+            m_edgeTargets.resize( m_indices.size() );
+            {
+                std::vector<uint32_t> fill( m_edgeOffsets.begin(), m_edgeOffsets.end() - 1 );
+                for ( size_t i = 0; i < m_indices.size(); i += 3 )
+                {
+                    for ( int corner = 0; corner < 3; ++corner )
+                    {
+                        const uint32_t from = m_position[m_indices[i + corner]];
+                        m_edgeTargets[fill[from]++] = m_position[m_indices[i + ( corner + 1 ) % 3]];
+                    }
+                }
+            }
+
+            for ( uint32_t from = 0; from < m_vertices.size(); ++from )
+            {
+                for ( uint32_t edge = m_edgeOffsets[from]; edge < m_edgeOffsets[from + 1]; ++edge )
+                {
+                    const uint32_t to = m_edgeTargets[edge];
+                    const uint32_t count = CountEdges( from, to );
+                    const bool twinFound = CountEdges( to, from ) != 0;
+
+                    for ( const uint32_t position : { from, to } )
+                    {
+                        if ( count > 1 )
+                            m_kind[position] = VertexKind::Locked;
+                        else if ( !twinFound && m_kind[position] == VertexKind::Manifold )
+                            m_kind[position] = VertexKind::Border;
+                    }
+                }
+            }
+
+            for ( uint32_t vertex = 0; vertex < m_vertices.size(); ++vertex )
+            {
+                const uint32_t position = m_position[vertex];
+                m_kind[vertex] = verticesAtPosition[position] > 1 ? VertexKind::Locked : m_kind[position];
+            }
+        }
+
+        void Simplifier::ComputeQuadrics()
+        {
+            m_quadrics.assign( m_vertices.size(), Quadric() );
+
+            for ( size_t i = 0; i < m_indices.size(); i += 3 )
+            {
+                const Float3 p0 = GetPosition( m_indices[i + 0] );
+                const Float3 p1 = GetPosition( m_indices[i + 1] );
+                const Float3 p2 = GetPosition( m_indices[i + 2] );
+
+                const Float3 normal = Cross( p1 - p0, p2 - p0 );
+                const float doubleArea = Length( normal );
+                if ( doubleArea == 0.f )
+                    continue;
+
+                const Float3 unitNormal = { normal.x / doubleArea, normal.y / doubleArea, normal.z / doubleArea };
+                const Quadric plane = Quadric::FromPlane( unitNormal, -Dot( unitNormal, p0 ), doubleArea * 0.5f );
+                for ( int corner = 0; corner < 3; ++corner )
+                    m_quadrics[m_position[m_indices[i + corner]]] += plane;
+
+                // A plane through each open edge, perpendicular to the triangle, keeps the border from shrinking.
+                for ( int corner = 0; corner < 3; ++corner )
+                {
+                    const uint32_t a = m_indices[i + corner];
+                    const uint32_t b = m_indices[i + ( corner + 1 ) % 3];
+                    if ( !IsBorderEdge( a, b ) )
+                        continue;
+
+                    const Float3 edge = GetPosition( b ) - GetPosition( a );
+                    const float edgeLength = Length( edge );
+                    if ( edgeLength == 0.f )
+                        continue;
+
+                    Float3 borderNormal = Cross( edge, unitNormal );
+                    const float borderLength = Length( borderNormal );
+                    borderNormal = { borderNormal.x / borderLength, borderNormal.y / borderLength, borderNormal.z / borderLength };
+
+                    const Quadric border = Quadric::FromPlane( borderNormal, -Dot( borderNormal, GetPosition( a ) ), edgeLength * edgeLength * BorderWeight );
+                    m_quadrics[m_position[a]] += border;
+                    m_quadrics[m_position[b]] += border;
+                }
+            }
+        }
+
+        bool Simplifier::CanCollapse( uint32_t from, uint32_t to ) const
+        {
+            switch ( m_kind[from] )
+            {
+            case VertexKind::Manifold:
+                return true;
+            case VertexKind::Border:
+                // Slide along the border only, onto a vertex that is also on it.
+                return m_kind[to] != VertexKind::Manifold && IsBorderEdge( from, to );
+            default:
+                return false;
+            }
+        }
+
+        bool Simplifier::FlipsTriangle( uint32_t from, uint32_t to, const std::vector<uint32_t>& triangleOffsets, const std::vector<uint32_t>& vertexTriangles ) const
+        {
+            const Float3 target = GetPosition( to );
+
+            for ( uint32_t i = triangleOffsets[from]; i < triangleOffsets[from + 1]; ++i )
+            {
+                const uint32_t* corners = &m_indices[size_t( vertexTriangles[i] ) * 3];
+                if ( corners[0] == to || corners[1] == to || corners[2] == to )
+                    continue;
+
+                Float3 before[3];
+                Float3 after[3];
+                for ( int corner = 0; corner < 3; ++corner )
+                {
+                    before[corner] = GetPosition( corners[corner] );
+                    after[corner] = corners[corner] == from ? target : before[corner];
+                }
+
+                const Float3 normalBefore = Cross( before[1] - before[0], before[2] - before[0] );
+                const Float3 normalAfter = Cross( after[1] - after[0], after[2] - after[0] );
+                // Rejects flips and triangles turning by more than about 75 degrees.
+                if ( Dot( normalBefore, normalAfter ) <= 0.25f * Length( normalBefore ) * Length( normalAfter ) )
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool Simplifier::Pass( size_t targetTriangleCount, double maxCost, double& reachedCost )
+        {
+            const size_t triangleCount = m_indices.size() / 3;
+            const size_t vertexCount = m_vertices.size();
+
+            // Triangles around each vertex, as offsets into one flat array.
+            std::vector<uint32_t> triangleOffsets( vertexCount + 1, 0 );
+            for ( const uint32_t index : m_indices )
+                ++triangleOffsets[index + 1];
+            for ( size_t vertex = 0; vertex < vertexCount; ++vertex )
+                triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+
+            std::vector<uint32_t> vertexTriangles( m_indices.size() );
+            {
+                std::vector<uint32_t> fill( triangleOffsets.begin(), triangleOffsets.end() - 1 );
+                for ( size_t i = 0; i < m_indices.size(); ++i )
+                    vertexTriangles[fill[m_indices[i]]++] = static_cast<uint32_t>( i / 3 );
+            }
+
+            // Cheapest collapse of every vertex. Each interior edge shows up in both directions across
+            // its two triangles; border edges only once, so they are tried both ways.
+            std::vector<Collapse> best( vertexCount, Collapse{ 0, 0, FLT_MAX } );
+            for ( size_t i = 0; i < m_indices.size(); i += 3 )
+            {
+                for ( int corner = 0; corner < 3; ++corner )
+                {
+                    const uint32_t a = m_indices[i + corner];
+                    const uint32_t b = m_indices[i + ( corner + 1 ) % 3];
+                    const bool border = m_kind[a] != VertexKind::Manifold && m_kind[b] != VertexKind::Manifold && IsBorderEdge( a, b );
+
+                    for ( const auto& [from, to] : { std::make_pair( a, b ), std::make_pair( b, a ) } )
+                    {
+                        if ( ( from != a && !border ) || !CanCollapse( from, to ) )
+                            continue;
+
+                        Quadric quadric = m_quadrics[m_position[from]];
+                        quadric += m_quadrics[m_position[to]];
+                        const auto cost = static_cast<float>( quadric.Evaluate( GetPosition( to ) ) );
+                        if ( cost < best[from].m_cost || ( cost == best[from].m_cost && to < best[from].m_to ) )
+                            best[from] = { from, to, cost };
+                    }
+                }
+            }
+
+            std::vector<Collapse> collapses;
+            for ( const Collapse& collapse : best )
+            {
+                if ( collapse.m_cost != FLT_MAX )
+                    collapses.push_back( collapse );
+            }
+
+            if ( collapses.empty() )
+                return false;
+
+            // Ties resolved by vertex index so the result does not depend on the sort implementation.
+            std::sort( collapses.begin(), collapses.end(), []( const Collapse& lhs, const Collapse& rhs )
+                {
+                    if ( lhs.m_cost != rhs.m_cost )
+                        return lhs.m_cost < rhs.m_cost;
+                    if ( lhs.m_from != rhs.m_from )
+                        return lhs.m_from < rhs.m_from;
+                    return lhs.m_to < rhs.m_to;
+                } );
+
+            std::vector<uint32_t> remap( vertexCount );
+            for ( uint32_t vertex = 0; vertex < vertexCount; ++vertex )
+                remap[vertex] = vertex;
+
+            // Vertices whose surroundings changed this pass, their triangles are no longer valid for flip checks.
+            std::vector<bool> touched( vertexCount, false );
+
+            // Collapsing an interior edge removes two triangles, collapsing a border edge one.
+            const size_t wanted = triangleCount > targetTriangleCount ? triangleCount - targetTriangleCount : 0;
+            size_t removed = 0;
+            size_t applied = 0;
+
+            // Collapses blocked by their neighbors would otherwise be replaced with ever costlier ones.
+            // Stay below the cost of the cheapest collapses that could reach the target, later passes pick up the rest.
+            const double passCost = std::min( maxCost, static_cast<double>( collapses[std::min( wanted, collapses.size() - 1 )].m_cost ) );
+
+            for ( const Collapse& collapse : collapses )
+            {
+                if ( removed >= wanted || collapse.m_cost > passCost )
+                    break;
+
+                if ( touched[collapse.m_from] || touched[collapse.m_to] )
+                    continue;
+
+                if ( FlipsTriangle( collapse.m_from, collapse.m_to, triangleOffsets, vertexTriangles ) )
+                    continue;
+
+                remap[collapse.m_from] = collapse.m_to;
+                m_quadrics[m_position[collapse.m_to]] += m_quadrics[m_position[collapse.m_from]];
+                reachedCost = std::max( reachedCost, static_cast<double>( collapse.m_cost ) );
+                ++applied;
+
+                for ( uint32_t i = triangleOffsets[collapse.m_from]; i < triangleOffsets[collapse.m_from + 1]; ++i )
+                {
+                    const uint32_t* corners = &m_indices[size_t( vertexTriangles[i] ) * 3];
+                    if ( corners[0] == collapse.m_to || corners[1] == collapse.m_to || corners[2] == collapse.m_to )
+                        ++removed;
+
+                    for ( int corner = 0; corner < 3; ++corner )
+                        touched[corners[corner]] = true;
+                }
+            }
+
+            if ( applied == 0 )
+                return false;
+
+            size_t write = 0;
+            for ( size_t i = 0; i < m_indices.size(); i += 3 )
+            {
+                const uint32_t a = remap[m_indices[i + 0]];
+                const uint32_t b = remap[m_indices[i + 1]];
+                const uint32_t c = remap[m_indices[i + 2]];
+                if ( m_position[a] == m_position[b] || m_position[b] == m_position[c] || m_position[a] == m_position[c] )
+                    continue;
+
+                m_indices[write++] = a;
+                m_indices[write++] = b;
+                m_indices[write++] = c;
+            }
+            m_indices.resize( write );
+
+            return true;
+        }
+    }
+
+    std::vector<DirectX::XMINT3> SimplifyMesh( const Mesh& mesh, const std::vector<DirectX::XMINT3>& triangles,
+        size_t targetTriangleCount, float maxError, float* resultError )
+    {
+        Simplifier simplifier( mesh, triangles );
+
+        const double maxCost = double( maxError ) * maxError;
+        double reachedCost = 0.0;
+        while ( simplifier.GetTriangleCount() > targetTriangleCount )
+        {
+            if ( !simplifier.Pass( targetTriangleCount, maxCost, reachedCost ) )
+                break;
+        }
+
+        if ( resultError )
+            *resultError = static_cast<float>( std::sqrt( reachedCost ) );
+
+        return simplifier.GetTriangles();
+    }
+
+    std::vector<MeshLod> BuildLodChain( const Mesh& mesh, uint32_t lodCount, float reduction, float maxRelativeError )
+    {
+        std::vector<MeshLod> lods;
+        if ( mesh.m_indices.empty() || lodCount == 0 )
+            return lods;
+
+        Float3 minimum = { FLT_MAX, FLT_MAX, FLT_MAX };
+        Float3 maximum = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for ( const Mesh::VertexInfo& vertex : mesh.m_vertices )
+        {
+            minimum = { std::min( minimum.x, vertex.m_position.x ), std::min( minimum.y, vertex.m_position.y ), std::min( minimum.z, vertex.m_position.z ) };
+            maximum = { std::max( maximum.x, vertex.m_position.x ), std::max( maximum.y, vertex.m_position.y ), std::max( maximum.z, vertex.m_position.z ) };
+        }
+        const float maxError = Length( maximum - minimum ) * maxRelativeError;
+
+        lods.reserve( lodCount );
+
+        const std::vector<DirectX::XMINT3>* source = &mesh.m_indices;
+        float error = 0.f;
+        for ( uint32_t level = 0; level < lodCount; ++level )
+        {
+            const auto target = static_cast<size_t>( source->size() * reduction );
+
+            // Errors of consecutive levels add up, so each level only gets what is left of the budget.
+            float levelError = 0.f;
+            std::vector<DirectX::XMINT3> simplified = SimplifyMesh( mesh, *source, target, maxError - error, &levelError );
+
+            if ( simplified.empty() || simplified.size() > source->size() * 95 / 100 )
+                break;
+
+            error += levelError;
+
+            MeshLod lod;
+            lod.m_indices = std::move( simplified );
+            lod.m_error = error;
+            lods.push_back( std::move( lod ) );
+            source = &lods.back().m_indices;
+        }
+
+        return lods;
+    }
+}
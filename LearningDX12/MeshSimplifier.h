@@ -0,0 +1,50 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MeshBounds.h"
+
+namespace Olex
+{
+    struct Mesh;
+
+    /**
+     * One simplified level of detail. Its triangles index the vertices of the full mesh,
+     * so all levels share one vertex buffer and only the index buffer changes.
+     */
+    struct MeshLod
+    {
+        std::vector<DirectX::XMINT3> m_indices;
+        // Estimated distance, in mesh units, between this level and the full mesh surface: the root of the
+        // largest collapse cost, an area-weighted mean squared distance to the planes of the merged triangles,
+        // summed over the levels before it. Not a bound, parts of the surface may be farther off.
+        float m_error = 0.f;
+        BoundingVolume m_bounds;
+    };
+
+    /**
+     * Simplifies triangles (indexing mesh.m_vertices) toward targetTriangleCount with
+     * quadric-error edge collapses.
+     *
+     * Vertices only ever collapse onto a neighbor, so no new vertices are made. Vertices on
+     * attribute seams (several vertices at one position) and on non-manifold edges stay put;
+     * vertices on open borders only slide along the border. Collapses that would flip a
+     * triangle are rejected. Stops early when the next collapse would exceed maxError.
+     *
+     * Returns the simplified triangles and stores the error reached, an estimate like MeshLod::m_error,
+     * in resultError if given.
+     */
+    std::vector<DirectX::XMINT3> SimplifyMesh( const Mesh& mesh, const std::vector<DirectX::XMINT3>& triangles,
+        size_t targetTriangleCount, float maxError, float* resultError = nullptr );
+
+    /**
+     * Builds up to lodCount levels, each with about reduction times the triangles of the one before.
+     * Each level is simplified from the previous one and its error includes the errors before it.
+     * The chain ends early once a level would not drop at least 5% of the triangles.
+     * maxRelativeError is the largest error estimate a level may reach, relative to the mesh extent.
+     */
+    std::vector<MeshLod> BuildLodChain( const Mesh& mesh, uint32_t lodCount, float reduction = 0.5f, float maxRelativeError = 0.05f );
+}
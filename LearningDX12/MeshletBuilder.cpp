@@ -0,0 +1,263 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    namespace
+    {
+        constexpr uint8_t NotInMeshlet = 0xff;
+
+        struct Float3
+        {
+            float x, y, z;
+        };
+
+        Float3 operator- ( const Float3& a, const Float3& b ) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+        Float3 operator+ ( const Float3& a, const Float3& b ) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+        Float3 operator* ( const Float3& a, float s ) { return { a.x * s, a.y * s, a.z * s }; }
+        float Dot( const Float3& a, const Float3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        Float3 Cross( const Float3& a, const Float3& b ) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+        float Length( const Float3& a ) { return std::sqrt( Dot( a, a ) ); }
+        Float3 Normalize( const Float3& a ) { const float length = Length( a ); return length > 0.f ? a * ( 1.f / length ) : Float3{ 0, 0, 0 }; }
+
+        Float3 ToFloat3( const DirectX::XMFLOAT3& v ) { return { v.x, v.y, v.z }; }
+        DirectX::XMFLOAT3 ToXMFLOAT3( const Float3& v ) { return { v.x, v.y, v.z }; }
+
+        MeshletBounds ComputeBounds( const Mesh& mesh, const MeshletData& data, const Meshlet& meshlet )
+        {
+            MeshletBounds bounds = {};
+
+            // Sphere around the center of the bounding box.
+            Float3 minimum = { FLT_MAX, FLT_MAX, FLT_MAX };
+            Float3 maximum = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            for ( uint32_t i = 0; i < meshlet.m_vertexCount; ++i )
+            {
+                const Float3 p = ToFloat3( mesh.m_vertices[data.m_vertices[meshlet.m_vertexOffset + i]].m_position );
+                minimum = { std::min( minimum.x, p.x ), std::min( minimum.y, p.y ), std::min( minimum.z, p.z ) };
+                maximum = { std::max( maximum.x, p.x ), std::max( maximum.y, p.y ), std::max( maximum.z, p.z ) };
+            }
+
+            const Float3 center = ( minimum + maximum ) * 0.5f;
+            float radius = 0.f;
+            for ( uint32_t i = 0; i < meshlet.m_vertexCount; ++i )
+            {
+                const Float3 p = ToFloat3( mesh.m_vertices[data.m_vertices[meshlet.m_vertexOffset + i]].m_position );
+                radius = std::max( radius, Length( p - center ) );
+            }
+
+            bounds.m_center = ToXMFLOAT3( center );
+            bounds.m_radius = radius;
+
+            // Normal cone over the face normals. Front faces are clockwise, in the left-handed
+            // space the demos render in that makes cross( b - a, c - a ) point outwards.
+            std::vector<Float3> normals;
+            std::vector<Float3> centroids;
+            normals.reserve( meshlet.m_triangleCount );
+            centroids.reserve( meshlet.m_triangleCount );
+
+            Float3 axis = { 0, 0, 0 };
+            for ( uint32_t triangle = 0; triangle < meshlet.m_triangleCount; ++triangle )
+            {
+                const uint8_t* local = &data.m_triangles[meshlet.m_triangleOffset + triangle * 3];
+                const Float3 a = ToFloat3( mesh.m_vertices[data.m_vertices[meshlet.m_vertexOffset + local[0]]].m_position );
+                const Float3 b = ToFloat3( mesh.m_vertices[data.m_vertices[meshlet.m_vertexOffset + local[1]]].m_position );
+                const Float3 c = ToFloat3( mesh.m_vertices[data.m_vertices[meshlet.m_vertexOffset + local[2]]].m_position );
+
+                const Float3 normal = Normalize( Cross( b - a, c - a ) );
+                if ( Dot( normal, normal ) == 0.f )
+                    continue; // degenerate triangles do not constrain the cone
+
+                normals.push_back( normal );
+                centroids.push_back( ( a + b + c ) * ( 1.f / 3.f ) );
+                axis = axis + normal;
+            }
+
+            axis = Normalize( axis );
+            bounds.m_coneAxis = ToXMFLOAT3( axis );
+            bounds.m_coneApex = bounds.m_center;
+            bounds.m_coneCutoff = 1.f;
+
+            float minimumDot = 1.f;
+            for ( const Float3& normal : normals )
+                minimumDot = std::min( minimumDot, Dot( axis, normal ) );
+
+            // Cone wider than a hemisphere, back-face culling the whole meshlet is never possible.
+            if ( normals.empty() || minimumDot <= 0.1f )
+                return bounds;
+
+            // Move the apex back along the axis until it lies behind every triangle plane.
+            float maximumT = 0.f;
+            for ( size_t i = 0; i < normals.size(); ++i )
+            {
+                const float t = Dot( center - centroids[i], normals[i] ) / Dot( axis, normals[i] );
+                maximumT = std::max( maximumT, t );
+            }
+
+            bounds.m_coneApex = ToXMFLOAT3( center - axis * maximumT );
+            bounds.m_coneCutoff = std::sqrt( 1.f - minimumDot * minimumDot );
+            return bounds;
+        }
+    }
+
+    MeshletData BuildMeshlets( const Mesh& mesh, uint32_t maxVertices, uint32_t maxTriangles )
+    {
+        if ( maxVertices < 3 || maxVertices > 255 || maxTriangles < 1 )
+        {
+            throw std::invalid_argument( "Meshlet limits must allow a triangle and fit 8-bit local indices" );
+        }
+
+        MeshletData data;
+        const size_t triangleCount = mesh.m_indices.size();
+        const size_t vertexCount = mesh.m_vertices.size();
+        if ( triangleCount == 0 )
+            return data;
+
+        const auto* indices = reinterpret_cast<const uint32_t*>( mesh.m_indices.data() );
+
+        // Vertex -> triangle adjacency. Only unassigned triangles are kept in the live part of each list.
+        std::vector<uint32_t> liveTriangles( vertexCount, 0 );
+        for ( size_t i = 0; i < triangleCount * 3; ++i )
+            ++liveTriangles[indices[i]];
+
+        std::vector<uint32_t> adjacencyOffsets( vertexCount + 1, 0 );
+        for ( size_t vertex = 0; vertex < vertexCount; ++vertex )
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangles[vertex];
+
+        std::vector<uint32_t> adjacency( triangleCount * 3 );
+        {
+            std::vector<uint32_t> fill( adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 );
+            for ( size_t i = 0; i < triangleCount * 3; ++i )
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>( i / 3 );
+        }
+
+        auto retireTriangle = [&]( uint32_t triangle )
+        {
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                const uint32_t vertex = indices[triangle * 3 + corner];
+                uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+                uint32_t* end = begin + liveTriangles[vertex];
+                *std::find( begin, end, triangle ) = *( end - 1 );
+                --liveTriangles[vertex];
+            }
+        };
+
+        std::vector<bool> assigned( triangleCount, false );
+        std::vector<uint8_t> localIndex( vertexCount, NotInMeshlet );
+        size_t scanCursor = 0;
+
+        Meshlet meshlet;
+
+        auto finishMeshlet = [&]()
+        {
+            for ( uint32_t i = 0; i < meshlet.m_vertexCount; ++i )
+                localIndex[data.m_vertices[meshlet.m_vertexOffset + i]] = NotInMeshlet;
+
+            data.m_meshlets.push_back( meshlet );
+
+            meshlet = {};
+            meshlet.m_vertexOffset = static_cast<uint32_t>( data.m_vertices.size() );
+            meshlet.m_triangleOffset = static_cast<uint32_t>( data.m_triangles.size() );
+        };
+
+        auto newVertexCount = [&]( uint32_t triangle )
+        {
+            uint32_t count = 0;
+            for ( int corner = 0; corner < 3; ++corner )
+                count += localIndex[indices[triangle * 3 + corner]] == NotInMeshlet ? 1 : 0;
+            return count;
+        };
+
+        for ( size_t emitted = 0; emitted < triangleCount; ++emitted )
+        {
+            // Best unassigned neighbour of the current meshlet: fewest new vertices, then lowest index.
+            uint32_t best = ~0u;
+            uint32_t bestNewVertices = 4;
+            for ( uint32_t i = 0; i < meshlet.m_vertexCount && bestNewVertices > 0; ++i )
+            {
+                const uint32_t vertex = data.m_vertices[meshlet.m_vertexOffset + i];
+                const uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+                for ( uint32_t a = 0; a < liveTriangles[vertex]; ++a )
+                {
+                    const uint32_t candidate = begin[a];
+                    const uint32_t extra = newVertexCount( candidate );
+                    if ( extra < bestNewVertices || ( extra == bestNewVertices && candidate < best ) )
+                    {
+                        best = candidate;
+                        bestNewVertices = extra;
+                    }
+                }
+            }
+
+            if ( best == ~0u )
+            {
+                // Nothing connected is left, continue with the next triangle in index order.
+                while ( assigned[scanCursor] )
+                    ++scanCursor;
+                best = static_cast<uint32_t>( scanCursor );
+                bestNewVertices = newVertexCount( best );
+            }
+
+            if ( meshlet.m_vertexCount + bestNewVertices > maxVertices || meshlet.m_triangleCount + 1 > maxTriangles )
+            {
+                finishMeshlet();
+                bestNewVertices = 3;
+
+                // Start the new meshlet from the lowest unassigned triangle to keep following the index order.
+                while ( assigned[scanCursor] )
+                    ++scanCursor;
+                best = static_cast<uint32_t>( scanCursor );
+            }
+
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                const uint32_t vertex = indices[best * 3 + corner];
+                if ( localIndex[vertex] == NotInMeshlet )
+                {
+                    localIndex[vertex] = static_cast<uint8_t>( meshlet.m_vertexCount++ );
+                    data.m_vertices.push_back( vertex );
+                }
+                data.m_triangles.push_back( localIndex[vertex] );
+            }
+            ++meshlet.m_triangleCount;
+
+            assigned[best] = true;
+            retireTriangle( best );
+        }
+
+        if ( meshlet.m_triangleCount > 0 )
+            finishMeshlet();
+
+        data.m_bounds.reserve( data.m_meshlets.size() );
+        for ( const Meshlet& m : data.m_meshlets )
+            data.m_bounds.push_back( ComputeBounds( mesh, data, m ) );
+
+        return data;
+    }
+
+    MeshletStatistics AnalyzeMeshlets( const MeshletData& meshlets, uint32_t maxVertices, uint32_t maxTriangles )
+    {
+        MeshletStatistics statistics;
+        statistics.m_meshletCount = static_cast<uint32_t>( meshlets.m_meshlets.size() );
+        if ( statistics.m_meshletCount == 0 )
+            return statistics;
+
+        double vertexFill = 0.0;
+        double triangleFill = 0.0;
+        for ( const Meshlet& meshlet : meshlets.m_meshlets )
+        {
+            vertexFill += static_cast<double>( meshlet.m_vertexCount ) / maxVertices;
+            triangleFill += static_cast<double>( meshlet.m_triangleCount ) / maxTriangles;
+        }
+
+        statistics.m_vertexFill = static_cast<float>( vertexFill / statistics.m_meshletCount );
+        statistics.m_triangleFill = static_cast<float>( triangleFill / statistics.m_meshletCount );
+        return statistics;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+namespace Olex
+{
+    struct Mesh;
+
+    /**
+     * A small cluster of triangles with its own local vertex list,
+     * sized for mesh shader thread groups and per-cluster culling.
+     */
+    struct Meshlet
+    {
+        // First entry in MeshletData::m_vertices, holds indices into Mesh::m_vertices.
+        uint32_t m_vertexOffset = 0;
+        uint32_t m_vertexCount = 0;
+        // First entry in MeshletData::m_triangles, three local 8-bit vertex indices per triangle.
+        uint32_t m_triangleOffset = 0;
+        uint32_t m_triangleCount = 0;
+    };
+
+    struct MeshletBounds
+    {
+        DirectX::XMFLOAT3 m_center;
+        float m_radius;
+
+        // Normal cone: the whole meshlet is back-facing when
+        // dot( normalize( m_coneApex - cameraPosition ), m_coneAxis ) >= m_coneCutoff.
+        // A cutoff of 1 disables cone culling for meshlets whose normals spread too wide.
+        DirectX::XMFLOAT3 m_coneApex;
+        DirectX::XMFLOAT3 m_coneAxis;
+        float m_coneCutoff;
+    };
+
+    struct MeshletData
+    {
+        std::vector<Meshlet> m_meshlets;
+        std::vector<MeshletBounds> m_bounds;
+        std::vector<uint32_t> m_vertices;
+        std::vector<uint8_t> m_triangles;
+    };
+
+    struct MeshletStatistics
+    {
+        uint32_t m_meshletCount = 0;
+        // Average share of the vertex and triangle limits actually used, 1 means every meshlet is full.
+        float m_vertexFill = 0.f;
+        float m_triangleFill = 0.f;
+    };
+
+    constexpr uint32_t MaxMeshletVertices = 64;
+    constexpr uint32_t MaxMeshletTriangles = 124;
+
+    /**
+     * Splits the mesh into meshlets of at most maxVertices vertices and maxTriangles triangles.
+     *
+     * Meshlets are grown greedily: the next triangle is the one sharing the most vertices with
+     * the current meshlet, ties broken by index order, so the result is deterministic and follows
+     * the existing triangle order (run it after the vertex cache stage for best locality).
+     */
+    MeshletData BuildMeshlets( const Mesh& mesh, uint32_t maxVertices = MaxMeshletVertices, uint32_t maxTriangles = MaxMeshletTriangles );
+
+    MeshletStatistics AnalyzeMeshlets( const MeshletData& meshlets, uint32_t maxVertices = MaxMeshletVertices, uint32_t maxTriangles = MaxMeshletTriangles );
+}
@@ -4,15 +4,14 @@
 #include <d3dcompiler.h>
 #include <wrl/client.h>
 #include <filesystem>
-#include <WICTextureLoader.h>
-#include <ResourceUploadBatch.h>
+#include <stdexcept>
 
 #include "d3dx12.h"
 #include "DX12App.h"
 #include "wrl/wrappers/corewrappers.h"
 #include <pix.h>
 
-#include "FbxLoader.h"
+#include "MeshCache.h"
 
 namespace Olex
 {
@@ -50,31 +49,8 @@ namespace Olex
 
         m_DSVHeap = m_app.CreateDescriptorHeap( D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 1 );
 
-#if (_WIN32_WINNT >= 0x0A00 /*_WIN32_WINNT_WIN10*/)
-        Microsoft::WRL::Wrappers::RoInitializeWrapper initialize( RO_INIT_MULTITHREADED );
-        if ( FAILED( initialize ) )
-            // error
-#else
-        HRESULT hr = CoInitializeEx( nullptr, COINITBASE_MULTITHREADED );
-        if ( FAILED( hr ) )
-            // error
-#endif
-
-            Microsoft::WRL::ComPtr<ID3D12Resource> texture;
-
-        using namespace std::filesystem;
-        DirectX::ResourceUploadBatch uploadBatch( m_app.GetDevice().Get() );
-        uploadBatch.Begin();
-
-        ThrowIfFailed( DirectX::CreateWICTextureFromFile(
-            m_app.GetDevice().Get(),
-            uploadBatch,
-            L"texture.jpg",
-            &m_texture,
-            true ) );
-
-        const std::future<void> uploadTask = uploadBatch.End( m_app.GetCommandQueue().GetD3D12CommandQueue().Get() );
-        uploadTask.wait();
+        // Baked with its mip chain by the asset baker, see TextureCache.
+        m_texture = LoadBakedTexture( m_app.GetUploadService(), "texture.tex" );
 
         {
             D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -82,23 +58,23 @@ namespace Olex
             srvDesc.Format = /*DXGI_FORMAT_R8G8B8A8_UNORM*/ m_texture->GetDesc().Format;
             srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // The resource is a 2D texture.
             srvDesc.Texture2D.MostDetailedMip = 0; // so the first in memory is the largest mipmap level
-            srvDesc.Texture2D.MipLevels = 1;
+            srvDesc.Texture2D.MipLevels = m_texture->GetDesc().MipLevels;
             srvDesc.Texture2D.ResourceMinLODClamp = 0.0f; // A value to clamp sample LOD values to.
 
             device->CreateShaderResourceView( m_texture.Get(), &srvDesc, m_SrvHeap->GetCPUDescriptorHandleForHeapStart() );
         }
 
 
-        // Create the vertex input layout
+        // Create the vertex input layout, see PackedVertex
         D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12 + 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "NORMAL", 0, DXGI_FORMAT_R8G8_SNORM, 0, 8 + 4, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
         };
 
         // Load the vertex shader.
         ComPtr<ID3DBlob> vertexShaderBlob;
-        ThrowIfFailed( D3DReadFileToBlob( L"VertexShader_Textured_Light.cso", &vertexShaderBlob ) );
+        ThrowIfFailed( D3DReadFileToBlob( L"VertexShader_Textured_Light_Packed.cso", &vertexShaderBlob ) );
 
         // Load the pixel shader.
         ComPtr<ID3DBlob> pixelShaderBlob;
@@ -123,35 +99,37 @@ namespace Olex
         psoDesc.SampleDesc.Count = 1;
         ThrowIfFailed( m_app.GetDevice()->CreateGraphicsPipelineState( &psoDesc, IID_PPV_ARGS( m_PipelineState.ReleaseAndGetAddressOf() ) ) );
 
-        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> commandList = m_app.GetCommandQueue().CreateCommandList();
-
-        m_fbxLoader = std::make_unique<FbxLoader>( "model.fbx" );
-        const FbxLoader::Mesh& mesh = m_fbxLoader->GetMeshes()[0];
-
-        // Upload vertex buffer data.
-        ComPtr<ID3D12Resource> intermediateVertexBuffer;
-        UpdateBufferResource( commandList.Get(),
-            &m_VertexBuffer, &intermediateVertexBuffer,
-            mesh.m_vertices.size(), sizeof( FbxLoader::Mesh::VertexInfo ), mesh.m_vertices.data() );
+        // Baked by the asset baker with levels of detail, see the model.fbx build step.
+        m_meshCache = std::make_unique<MappedMeshCache>( "model.mesh" );
+        if ( !m_meshCache->IsValid() )
+        {
+            throw std::runtime_error( "model.mesh is missing or was baked by an older version, run the asset baker" );
+        }
+        const MeshView mesh = m_meshCache->GetMesh( 0 );
 
-        // Create the vertex buffer view.
-        m_VertexBufferView.BufferLocation = m_VertexBuffer->GetGPUVirtualAddress();
-        m_VertexBufferView.SizeInBytes = static_cast<UINT>( mesh.m_vertices.size() * sizeof( FbxLoader::Mesh::VertexInfo ) );
-        m_VertexBufferView.StrideInBytes = sizeof( FbxLoader::Mesh::VertexInfo );
+        // Half the bytes of Mesh::VertexInfo, the shader dequantizes with m_quantization.
+        const PackedVertices packed = EncodeVertices( mesh.m_vertices, mesh.m_vertexCount );
+        m_quantization = packed.m_quantization;
 
-        // Upload index buffer data.
-        ComPtr<ID3D12Resource> intermediateIndexBuffer;
-        UpdateBufferResource( commandList.Get(),
-            &m_IndexBuffer, &intermediateIndexBuffer,
-            mesh.m_indices.size(), sizeof( DirectX::XMINT3 ), mesh.m_indices.data() );
+        // Upload the model into the shared geometry arena, 16-bit indices whenever every submesh fits.
+        GeometryArena& geometryArena = m_app.GetGeometryArena();
+        m_geometry = geometryArena.Allocate( m_app.GetUploadService(),
+            packed.m_vertices.data(), static_cast<uint32_t>( packed.m_vertices.size() ), sizeof( PackedVertex ),
+            mesh.m_indices, mesh.m_indexCount, mesh.m_indexFormat );
 
-        // Create index buffer view.
-        m_IndexBufferView.BufferLocation = m_IndexBuffer->GetGPUVirtualAddress();
-        m_IndexBufferView.Format = DXGI_FORMAT_R32_UINT;
-        m_IndexBufferView.SizeInBytes = static_cast<UINT>( mesh.m_indices.size() * sizeof( DirectX::XMINT3 ) );
+        // The levels of detail only add indices, they index the vertices uploaded above.
+        m_lodGeometry.resize( mesh.m_lodCount );
+        for ( uint32_t lodIndex = 0; lodIndex < mesh.m_lodCount; ++lodIndex )
+        {
+            const MeshLodView lod = m_meshCache->GetLod( 0, lodIndex );
+            m_lodGeometry[lodIndex] = geometryArena.Allocate( m_app.GetUploadService(),
+                nullptr, 0, sizeof( PackedVertex ),
+                lod.m_indices, lod.m_indexCount, lod.m_indexFormat );
+        }
 
-        const FenceValue fenceValue = m_app.GetCommandQueue().ExecuteCommandList( commandList );
-        m_app.GetCommandQueue().WaitForFenceValue( fenceValue );
+        // The copies run on the copy queue. The render queue waits for them on the GPU, the CPU goes on.
+        UploadService& uploadService = m_app.GetUploadService();
+        m_app.GetCommandQueue().Wait( uploadService.GetFenceWait( uploadService.Submit() ) );
 
         m_ContentLoaded = true;
 
@@ -223,12 +201,28 @@ namespace Olex
             rootSignatureBlob->GetBufferSize(), IID_PPV_ARGS( &m_RootSignature ) ) );
     }
 
+    uint32_t MultipleObjectsDemo::SelectLod( float distance ) const
+    {
+        // World units covered by one pixel at that distance.
+        const float pixelSize = 2.f * distance * std::tan( DirectX::XMConvertToRadians( m_FoV ) * 0.5f ) / static_cast<float>( GetClientHeight() );
+
+        const MeshView mesh = m_meshCache->GetMesh( 0 );
+        uint32_t selected = 0;
+        for ( uint32_t lodIndex = 0; lodIndex < mesh.m_lodCount; ++lodIndex )
+        {
+            if ( m_meshCache->GetLod( 0, lodIndex ).m_error > pixelSize )
+                break;
+
+            selected = lodIndex + 1;
+        }
+        return selected;
+    }
+
     void MultipleObjectsDemo::ResizeDepthBuffer( int width, int height )
     {
         if ( m_ContentLoaded )
         {
             // Flush any GPU commands that might be referencing the depth buffer.
-            //m_app.Flush();
             m_app.GetCommandQueue().WaitForFenceValue( m_lastFenceValue );
 
             width = std::max( 1, width );
@@ -283,18 +277,11 @@ namespace Olex
         const path texturePath( fileName );
         if ( exists( texturePath ) == true )
         {
-            DirectX::ResourceUploadBatch uploadBatch( m_app.GetDevice().Get() );
-            uploadBatch.Begin();
-
-            ThrowIfFailed( DirectX::CreateWICTextureFromFile(
-                m_app.GetDevice().Get(),
-                uploadBatch,
-                fileName,
-                textureResource.ReleaseAndGetAddressOf(),
-                false ) );
-
-            const std::future<void> uploadTask = uploadBatch.End( m_app.GetCommandQueue().GetD3D12CommandQueue().Get() );
-            uploadTask.wait();
+            UploadService& uploadService = m_app.GetUploadService();
+            textureResource = LoadBakedTexture( uploadService, texturePath );
+
+            // Work submitted to the render queue from now on waits on the GPU for the upload.
+            m_app.GetCommandQueue().Wait( uploadService.GetFenceWait( uploadService.Submit() ) );
         }
 
         return textureResource;
@@ -302,6 +289,12 @@ namespace Olex
 
     void MultipleObjectsDemo::UnloadResources()
     {
+        GeometryArena& geometryArena = m_app.GetGeometryArena();
+        for ( const GeometryAllocation& lodGeometry : m_lodGeometry )
+            geometryArena.Free( lodGeometry );
+        m_lodGeometry.clear();
+        geometryArena.Free( m_geometry );
+        m_geometry = {};
     }
 
     void MultipleObjectsDemo::Update( UpdateEventArgs args )
@@ -388,8 +381,10 @@ namespace Olex
 
         // IA = Input Assembler
         commandList->IASetPrimitiveTopology( D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-        commandList->IASetVertexBuffers( 0, 1, &m_VertexBufferView );
-        commandList->IASetIndexBuffer( &m_IndexBufferView );
+        // Every copy and level of detail draws from the arena, only a level of another index size rebinds.
+        const GeometryArena& geometryArena = m_app.GetGeometryArena();
+        geometryArena.Bind( commandList.Get(), sizeof( PackedVertex ), m_geometry.m_indexFormat );
+        IndexFormat boundIndexFormat = m_geometry.m_indexFormat;
 
         // RS = Rasterizer State
         commandList->RSSetViewports( 1, &m_Viewport );
@@ -398,6 +393,8 @@ namespace Olex
         // OM = Output Merger
         commandList->OMSetRenderTargets( 1, &rtv, FALSE, &dsv );
 
+        const MeshView mesh = m_meshCache->GetMesh( 0 );
+        const XMVECTOR eyePosition = XMVectorSet( -100, 0, 0, 1 ); // TODO share with Update
         for ( int i = 0; i < 20; ++i )
         {
             // Update the MVP matrix
@@ -407,13 +404,34 @@ namespace Olex
             XMMATRIX mvpMatrix = XMMatrixMultiply( thisModelMatrix, m_ViewMatrix );
             mvpMatrix = XMMatrixMultiply( mvpMatrix, m_ProjectionMatrix );
 
-            ObjectInfo info{ mvpMatrix };
+            ObjectInfo info{ mvpMatrix, m_quantization };
 
             commandList->SetGraphicsRoot32BitConstants( 0, sizeof( ObjectInfo ) / 4, &info, 0 );
 
-            // draw the model
-            static const UINT indexCount = static_cast<UINT>( m_fbxLoader->GetMeshes()[0].m_indices.size() * 3 );
-            commandList->DrawIndexedInstanced( indexCount, 1, 0, 0, 0 );
+            // draw the model, distant copies with a simplified index buffer
+            const float distance = XMVectorGetX( XMVector3Length( XMVectorSubtract( position.r[3], eyePosition ) ) );
+            const uint32_t lodIndex = SelectLod( distance );
+            const GeometryAllocation& indices = lodIndex == 0 ? m_geometry : m_lodGeometry[lodIndex - 1];
+            if ( indices.m_indexFormat != boundIndexFormat )
+            {
+                const D3D12_INDEX_BUFFER_VIEW indexBufferView = geometryArena.GetIndexBufferView( indices.m_indexFormat );
+                commandList->IASetIndexBuffer( &indexBufferView );
+                boundIndexFormat = indices.m_indexFormat;
+            }
+
+            if ( lodIndex == 0 )
+            {
+                for ( uint32_t submeshIndex = 0; submeshIndex < mesh.m_submeshCount; ++submeshIndex )
+                {
+                    const Submesh& submesh = mesh.m_submeshes[submeshIndex];
+                    commandList->DrawIndexedInstanced( submesh.m_indexCount, 1, m_geometry.m_startIndex + submesh.m_startIndex,
+                        m_geometry.m_baseVertex + static_cast<INT>( submesh.m_baseVertex ), 0 );
+                }
+            }
+            else
+            {
+                commandList->DrawIndexedInstanced( indices.m_indexCount, 1, indices.m_startIndex, m_geometry.m_baseVertex, 0 );
+            }
         }
 
         PIXEndEvent();
@@ -426,9 +444,8 @@ namespace Olex
 
             m_lastFenceValue = m_app.GetCommandQueue().ExecuteCommandList( commandList );
 
-            m_app.Present();
+            m_app.Present( m_lastFenceValue );
         }
-        m_app.GetCommandQueue().WaitForFenceValue( m_lastFenceValue );
 
         PIXEndEvent();
     }
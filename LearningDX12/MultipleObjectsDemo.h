@@ -3,12 +3,15 @@
 #include <d3d12.h>
 #include <DirectXMath.h>
 #include <string>
+#include <vector>
 #include <wrl/client.h>
 
 
 #include "BaseGameInterface.h"
 #include "CommandQueue.h"
-#include "FbxLoader.h"
+#include "GeometryArena.h"
+#include "MeshCache.h"
+#include "QuantizedVertex.h"
 
 namespace Olex
 {
@@ -42,12 +45,10 @@ namespace Olex
 
         Microsoft::WRL::ComPtr<ID3D12Resource> LoadTextureFromFile( const wchar_t* fileName );
 
-        // Vertex buffer for the cube.
-        Microsoft::WRL::ComPtr<ID3D12Resource> m_VertexBuffer;
-        D3D12_VERTEX_BUFFER_VIEW m_VertexBufferView;
-        // Index buffer for the cube.
-        Microsoft::WRL::ComPtr<ID3D12Resource> m_IndexBuffer;
-        D3D12_INDEX_BUFFER_VIEW m_IndexBufferView;
+        // Where the model lives in the shared geometry arena.
+        GeometryAllocation m_geometry;
+        // Simplified index ranges, drawn with the vertices of m_geometry.
+        std::vector<GeometryAllocation> m_lodGeometry;
 
         // Depth buffer.
         Microsoft::WRL::ComPtr<ID3D12Resource> m_DepthBuffer;
@@ -90,6 +91,7 @@ namespace Olex
         struct ObjectInfo
         {
             DirectX::XMMATRIX m_ProjectionMatrix;
+            PositionQuantization m_quantization;
         };
 
         bool m_ContentLoaded;
@@ -99,11 +101,16 @@ namespace Olex
 
         void CreateRootSignature();
 
+        // Coarsest level of detail whose error estimate stays under a pixel at the given distance, 0 is the full mesh.
+        // The estimate is not a bound, so a level may still be off by somewhat more than a pixel in places.
+        uint32_t SelectLod( float distance ) const;
+
         UINT m_frameCount = 0;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_texture;
 
         FenceValue m_lastFenceValue{ 0 };
 
-        std::unique_ptr<FbxLoader> m_fbxLoader;
+        std::unique_ptr<MappedMeshCache> m_meshCache;
+        PositionQuantization m_quantization;
     };
 }
@@ -0,0 +1,310 @@
+#include "OverdrawOptimizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+namespace Olex
+{
+    namespace
+    {
+        constexpr uint32_t SimulatedCacheSize = 16;
+
+        struct Float3
+        {
+            float x, y, z;
+        };
+
+        Float3 operator- ( const Float3& a, const Float3& b ) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+        Float3 operator+ ( const Float3& a, const Float3& b ) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+        Float3 operator* ( const Float3& a, float s ) { return { a.x * s, a.y * s, a.z * s }; }
+        float Dot( const Float3& a, const Float3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        Float3 Cross( const Float3& a, const Float3& b ) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+        float Length( const Float3& a ) { return std::sqrt( Dot( a, a ) ); }
+
+        Float3 ToFloat3( const DirectX::XMFLOAT3& v ) { return { v.x, v.y, v.z }; }
+
+        const uint32_t* AsIndices( const std::vector<DirectX::XMINT3>& triangles )
+        {
+            return reinterpret_cast<const uint32_t*>( triangles.data() );
+        }
+
+        /**
+         * FIFO post-transform cache simulation, same model as AnalyzeVertexCache.
+         */
+        class CacheSimulation
+        {
+        public:
+            explicit CacheSimulation( size_t vertexCount ) : m_insertedAt( vertexCount, 0 ) {}
+
+            void Reset() { m_missCounter += SimulatedCacheSize + 1; }
+
+            uint32_t Triangle( const uint32_t* corners )
+            {
+                uint32_t misses = 0;
+                for ( int corner = 0; corner < 3; ++corner )
+                {
+                    uint32_t& insertedAt = m_insertedAt[corners[corner]];
+                    if ( m_missCounter - insertedAt > SimulatedCacheSize )
+                    {
+                        insertedAt = m_missCounter++;
+                        ++misses;
+                    }
+                }
+                return misses;
+            }
+
+        private:
+            std::vector<uint32_t> m_insertedAt;
+            uint32_t m_missCounter = SimulatedCacheSize + 1;
+        };
+
+        // Cluster starts where the cache restarts, i.e. a triangle misses on all three vertices.
+        // The first triangle always starts one, even a degenerate one that misses fewer times,
+        // since the clusters have to cover every triangle.
+        std::vector<uint32_t> FindHardBoundaries( const std::vector<DirectX::XMINT3>& triangles, size_t vertexCount )
+        {
+            const uint32_t* indices = AsIndices( triangles );
+            CacheSimulation cache( vertexCount );
+
+            std::vector<uint32_t> boundaries;
+            for ( uint32_t triangle = 0; triangle < triangles.size(); ++triangle )
+            {
+                const uint32_t misses = cache.Triangle( indices + triangle * 3 );
+                if ( triangle == 0 || misses == 3 )
+                    boundaries.push_back( triangle );
+            }
+            return boundaries;
+        }
+
+        // Splits every hard cluster further, each piece may be at most threshold times less cache efficient.
+        std::vector<uint32_t> FindSoftBoundaries( const std::vector<DirectX::XMINT3>& triangles, size_t vertexCount,
+            const std::vector<uint32_t>& hardBoundaries, float threshold )
+        {
+            const uint32_t* indices = AsIndices( triangles );
+            const auto triangleCount = static_cast<uint32_t>( triangles.size() );
+            CacheSimulation cache( vertexCount );
+
+            std::vector<uint32_t> boundaries;
+            for ( size_t cluster = 0; cluster < hardBoundaries.size(); ++cluster )
+            {
+                const uint32_t start = hardBoundaries[cluster];
+                const uint32_t end = cluster + 1 < hardBoundaries.size() ? hardBoundaries[cluster + 1] : triangleCount;
+
+                cache.Reset();
+                uint32_t clusterMisses = 0;
+                for ( uint32_t triangle = start; triangle < end; ++triangle )
+                    clusterMisses += cache.Triangle( indices + triangle * 3 );
+
+                const float clusterThreshold = threshold * static_cast<float>( clusterMisses ) / static_cast<float>( end - start );
+
+                cache.Reset();
+                uint32_t pieceStart = start;
+                uint32_t pieceMisses = 0;
+                boundaries.push_back( start );
+
+                for ( uint32_t triangle = start; triangle < end; ++triangle )
+                {
+                    pieceMisses += cache.Triangle( indices + triangle * 3 );
+
+                    // Close the piece as soon as its ACMR is good enough, the next one starts on a cold cache.
+                    const bool pieceIsEfficient = static_cast<float>( pieceMisses ) <= clusterThreshold * static_cast<float>( triangle + 1 - pieceStart );
+                    if ( pieceIsEfficient && triangle + 1 < end )
+                    {
+                        boundaries.push_back( triangle + 1 );
+                        pieceStart = triangle + 1;
+                        pieceMisses = 0;
+                        cache.Reset();
+                    }
+                }
+            }
+            return boundaries;
+        }
+
+        struct DepthTarget
+        {
+            uint32_t m_size;
+            std::vector<float> m_depth;
+
+            explicit DepthTarget( uint32_t size ) : m_size( size ), m_depth( size_t( size ) * size, FLT_MAX ) {}
+        };
+
+        // Rasterizes a triangle given in target space (x right, y up, in pixels, z smaller is closer).
+        // Front faces are clockwise, like the default rasterizer state of the demos.
+        void Rasterize( DepthTarget& target, const Float3& a, const Float3& b, const Float3& c, OverdrawStatistics& statistics )
+        {
+            const float area = ( b.x - a.x ) * ( c.y - a.y ) - ( b.y - a.y ) * ( c.x - a.x );
+            if ( area >= 0.f )
+                return;
+
+            const float invArea = 1.f / area;
+            const int size = static_cast<int>( target.m_size );
+            const int minX = std::max( 0, static_cast<int>( std::floor( std::min( { a.x, b.x, c.x } ) ) ) );
+            const int maxX = std::min( size - 1, static_cast<int>( std::ceil( std::max( { a.x, b.x, c.x } ) ) ) );
+            const int minY = std::max( 0, static_cast<int>( std::floor( std::min( { a.y, b.y, c.y } ) ) ) );
+            const int maxY = std::min( size - 1, static_cast<int>( std::ceil( std::max( { a.y, b.y, c.y } ) ) ) );
+
+            for ( int y = minY; y <= maxY; ++y )
+            {
+                const float py = y + 0.5f;
+                for ( int x = minX; x <= maxX; ++x )
+                {
+                    const float px = x + 0.5f;
+                    const float w0 = ( c.x - b.x ) * ( py - b.y ) - ( c.y - b.y ) * ( px - b.x );
+                    const float w1 = ( a.x - c.x ) * ( py - c.y ) - ( a.y - c.y ) * ( px - c.x );
+                    const float w2 = ( b.x - a.x ) * ( py - a.y ) - ( b.y - a.y ) * ( px - a.x );
+                    if ( w0 > 0.f || w1 > 0.f || w2 > 0.f )
+                        continue;
+
+                    const float depth = ( w0 * a.z + w1 * b.z + w2 * c.z ) * invArea;
+                    float& stored = target.m_depth[size_t( y ) * target.m_size + x];
+
+                    if ( stored == FLT_MAX )
+                        ++statistics.m_pixelsCovered;
+
+                    if ( depth < stored )
+                    {
+                        stored = depth;
+                        ++statistics.m_pixelsShaded;
+                    }
+                }
+            }
+        }
+    }
+
+    OverdrawStatistics AnalyzeOverdraw( const Mesh& mesh, uint32_t gridSize )
+    {
+        OverdrawStatistics statistics;
+        if ( mesh.m_indices.empty() || gridSize == 0 )
+            return statistics;
+
+        Float3 minimum = { FLT_MAX, FLT_MAX, FLT_MAX };
+        Float3 maximum = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for ( const Mesh::VertexInfo& vertex : mesh.m_vertices )
+        {
+            minimum = { std::min( minimum.x, vertex.m_position.x ), std::min( minimum.y, vertex.m_position.y ), std::min( minimum.z, vertex.m_position.z ) };
+            maximum = { std::max( maximum.x, vertex.m_position.x ), std::max( maximum.y, vertex.m_position.y ), std::max( maximum.z, vertex.m_position.z ) };
+        }
+
+        const float extent = std::max( { maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z } );
+        const float scale = extent > 0.f ? static_cast<float>( gridSize ) / extent : 0.f;
+
+        const uint32_t* indices = AsIndices( mesh.m_indices );
+        const size_t triangleCount = mesh.m_indices.size();
+
+        // Three axes, each looked at from both sides. Viewing from the opposite side mirrors
+        // the image and inverts depth, which also flips which triangles are back-facing.
+        for ( int axis = 0; axis < 3; ++axis )
+        {
+            for ( int side = 0; side < 2; ++side )
+            {
+                DepthTarget target( gridSize );
+
+                auto project = [&]( uint32_t index )
+                {
+                    const Float3 p = ( ToFloat3( mesh.m_vertices[index].m_position ) - minimum ) * scale;
+                    const float coordinates[3] = { p.x, p.y, p.z };
+                    const float u = coordinates[( axis + 1 ) % 3];
+                    const float v = coordinates[( axis + 2 ) % 3];
+                    const float depth = coordinates[axis];
+                    return side == 0 ? Float3{ u, v, depth } : Float3{ static_cast<float>( gridSize ) - u, v, -depth };
+                };
+
+                for ( size_t triangle = 0; triangle < triangleCount; ++triangle )
+                {
+                    Rasterize( target,
+                        project( indices[triangle * 3 + 0] ),
+                        project( indices[triangle * 3 + 1] ),
+                        project( indices[triangle * 3 + 2] ),
+                        statistics );
+                }
+            }
+        }
+
+        statistics.m_overdraw = statistics.m_pixelsCovered > 0
+            ? static_cast<float>( statistics.m_pixelsShaded ) / static_cast<float>( statistics.m_pixelsCovered )
+            : 0.f;
+        return statistics;
+    }
+
+    void OptimizeOverdraw( Mesh& mesh, float threshold )
+    {
+        const size_t triangleCount = mesh.m_indices.size();
+        if ( triangleCount == 0 )
+            return;
+
+        const std::vector<uint32_t> hardBoundaries = FindHardBoundaries( mesh.m_indices, mesh.m_vertices.size() );
+        const std::vector<uint32_t> clusters = FindSoftBoundaries( mesh.m_indices, mesh.m_vertices.size(), hardBoundaries, threshold );
+        const size_t clusterCount = clusters.size();
+
+        const uint32_t* indices = AsIndices( mesh.m_indices );
+
+        // Area weighted centroid and normal of every cluster, plus the centroid of the whole mesh.
+        std::vector<Float3> clusterCentroids( clusterCount, Float3{ 0, 0, 0 } );
+        std::vector<Float3> clusterNormals( clusterCount, Float3{ 0, 0, 0 } );
+        std::vector<float> clusterAreas( clusterCount, 0.f );
+        Float3 meshCentroid = { 0, 0, 0 };
+        float meshArea = 0.f;
+
+        for ( size_t cluster = 0; cluster < clusterCount; ++cluster )
+        {
+            const uint32_t start = clusters[cluster];
+            const uint32_t end = cluster + 1 < clusterCount ? clusters[cluster + 1] : static_cast<uint32_t>( triangleCount );
+
+            for ( uint32_t triangle = start; triangle < end; ++triangle )
+            {
+                const Mesh::VertexInfo& v0 = mesh.m_vertices[indices[triangle * 3 + 0]];
+                const Mesh::VertexInfo& v1 = mesh.m_vertices[indices[triangle * 3 + 1]];
+                const Mesh::VertexInfo& v2 = mesh.m_vertices[indices[triangle * 3 + 2]];
+
+                const Float3 p0 = ToFloat3( v0.m_position );
+                const Float3 p1 = ToFloat3( v1.m_position );
+                const Float3 p2 = ToFloat3( v2.m_position );
+                const float area = 0.5f * Length( Cross( p1 - p0, p2 - p0 ) );
+
+                // Vertex normals instead of the geometric normal, so the result
+                // does not depend on the winding convention of the index buffer.
+                const Float3 normal = ToFloat3( v0.m_normal ) + ToFloat3( v1.m_normal ) + ToFloat3( v2.m_normal );
+
+                clusterCentroids[cluster] = clusterCentroids[cluster] + ( p0 + p1 + p2 ) * ( area / 3.f );
+                clusterNormals[cluster] = clusterNormals[cluster] + normal * area;
+                clusterAreas[cluster] += area;
+            }
+
+            meshCentroid = meshCentroid + clusterCentroids[cluster];
+            meshArea += clusterAreas[cluster];
+        }
+
+        if ( meshArea > 0.f )
+            meshCentroid = meshCentroid * ( 1.f / meshArea );
+
+        // Occlusion potential: how far the cluster sits out along its own normal.
+        std::vector<float> sortKeys( clusterCount, 0.f );
+        for ( size_t cluster = 0; cluster < clusterCount; ++cluster )
+        {
+            if ( clusterAreas[cluster] <= 0.f )
+                continue;
+
+            const Float3 centroid = clusterCentroids[cluster] * ( 1.f / clusterAreas[cluster] );
+            const float normalLength = Length( clusterNormals[cluster] );
+            if ( normalLength > 0.f )
+                sortKeys[cluster] = Dot( centroid - meshCentroid, clusterNormals[cluster] * ( 1.f / normalLength ) );
+        }
+
+        std::vector<uint32_t> order( clusterCount );
+        std::iota( order.begin(), order.end(), 0u );
+        std::stable_sort( order.begin(), order.end(), [&sortKeys]( uint32_t lhs, uint32_t rhs ) { return sortKeys[lhs] > sortKeys[rhs]; } );
+
+        std::vector<DirectX::XMINT3> result;
+        result.reserve( triangleCount );
+        for ( const uint32_t cluster : order )
+        {
+            const uint32_t start = clusters[cluster];
+            const uint32_t end = cluster + 1 < clusterCount ? clusters[cluster + 1] : static_cast<uint32_t>( triangleCount );
+            result.insert( result.end(), mesh.m_indices.begin() + start, mesh.m_indices.begin() + end );
+        }
+
+        mesh.m_indices.swap( result );
+    }
+}
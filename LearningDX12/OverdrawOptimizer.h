@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    struct OverdrawStatistics
+    {
+        // Pixels covered by the mesh, summed over all simulated views.
+        uint32_t m_pixelsCovered = 0;
+        // Fragments that passed the depth test, i.e. were actually shaded.
+        uint32_t m_pixelsShaded = 0;
+        // Shaded / covered, 1 means no overdraw at all.
+        float m_overdraw = 0.f;
+    };
+
+    /**
+     * Estimates overdraw with a small software rasterizer.
+     *
+     * The mesh is drawn in index order, with an early depth test and back-face culling,
+     * orthographically from the six axis-aligned directions into a gridSize x gridSize target.
+     * Only depth is rasterized, so the estimate runs without a GPU.
+     */
+    OverdrawStatistics AnalyzeOverdraw( const Mesh& mesh, uint32_t gridSize = 256 );
+
+    /**
+     * Reorders triangles to reduce overdraw while keeping most of the vertex cache efficiency.
+     *
+     * Expects triangles already optimized for the vertex cache. The index buffer is cut into
+     * clusters where the cache restarts; clusters are subdivided as long as each piece's ACMR stays
+     * within threshold times the ACMR of the whole cluster (1.05 trades at most 5% of cache
+     * efficiency). Clusters are then sorted so the ones facing away from the mesh center, which
+     * tend to occlude the rest, are drawn first.
+     */
+    void OptimizeOverdraw( Mesh& mesh, float threshold = 1.05f );
+}
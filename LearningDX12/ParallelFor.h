@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "ThreadPool.h"
+
+namespace Olex
+{
+    /**
+     * Calls body( i ) for every i in [0, count) on the shared ThreadPool and returns once all calls are done.
+     *
+     * Items are handed out one at a time from a shared counter, so uneven items (a few large meshes
+     * among many small ones) still spread across the cores. Each call owns its own output slot,
+     * which keeps the results in index order whatever the scheduling. The first exception thrown by
+     * body stops handing out new items and is rethrown on the calling thread.
+     *
+     * threadCount limits the threads used, 0 uses the whole pool; the calling thread works as one
+     * of them. Bodies may call ParallelFor again, the nested loop shares the same workers.
+     */
+    template <typename Body>
+    void ParallelFor( size_t count, Body&& body, unsigned threadCount = 0 )
+    {
+        using BodyType = std::remove_reference_t<Body>;
+        ThreadPool::Get().Run( count, []( void* context, size_t i ) { ( *static_cast<BodyType*>( context ) )( i ); },
+            const_cast<void*>( static_cast<const void*>( &body ) ), threadCount );
+    }
+}
@@ -0,0 +1,417 @@
+#include "QuantizedVertex.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#if defined(__F16C__) || defined(__AVX2__)
+#include <immintrin.h>
+#define OLEX_HAS_F16C 1
+#endif
+
+namespace Olex
+{
+    namespace
+    {
+        constexpr float UnormScale = 65535.f;
+        constexpr float SnormScale = 127.f;
+
+        static_assert( offsetof( Mesh::VertexInfo, m_uv ) == 12 && offsetof( Mesh::VertexInfo, m_normal ) == 20,
+            "Vertex kernels load VertexInfo as [px py pz u] [v nx ny nz]" );
+
+        uint16_t QuantizeUnorm16( float value )
+        {
+            return static_cast<uint16_t>( std::min( std::max( value, 0.f ), 1.f ) * UnormScale + 0.5f );
+        }
+
+        int8_t QuantizeSnorm8( float value )
+        {
+            return static_cast<int8_t>( std::lrint( std::min( std::max( value, -1.f ), 1.f ) * SnormScale ) );
+        }
+
+        float SignNotZero( float value )
+        {
+            return value >= 0.f ? 1.f : -1.f;
+        }
+
+        void OctahedralEncode( const DirectX::XMFLOAT3& normal, int8_t ( &encoded )[2] )
+        {
+            const float l1 = std::fabs( normal.x ) + std::fabs( normal.y ) + std::fabs( normal.z );
+            const float invL1 = l1 > 0.f ? 1.f / l1 : 0.f;
+            float x = normal.x * invL1;
+            float y = normal.y * invL1;
+
+            // Fold the lower hemisphere over the diagonals.
+            if ( normal.z < 0.f )
+            {
+                const float foldedX = ( 1.f - std::fabs( y ) ) * SignNotZero( x );
+                const float foldedY = ( 1.f - std::fabs( x ) ) * SignNotZero( y );
+                x = foldedX;
+                y = foldedY;
+            }
+
+            encoded[0] = QuantizeSnorm8( x );
+            encoded[1] = QuantizeSnorm8( y );
+        }
+
+        DirectX::XMFLOAT3 OctahedralDecode( const int8_t ( &encoded )[2] )
+        {
+            // SNORM conversion as done by the input assembler, -128 clamps to -1.
+            const float x = std::max( encoded[0] / SnormScale, -1.f );
+            const float y = std::max( encoded[1] / SnormScale, -1.f );
+            float nx = x;
+            float ny = y;
+            const float nz = 1.f - std::fabs( x ) - std::fabs( y );
+            const float t = std::max( -nz, 0.f );
+            nx += nx >= 0.f ? -t : t;
+            ny += ny >= 0.f ? -t : t;
+
+            const float length = std::sqrt( nx * nx + ny * ny + nz * nz );
+            const float invLength = length > 0.f ? 1.f / length : 0.f;
+            return { nx * invLength, ny * invLength, nz * invLength };
+        }
+
+        void EncodeScalar( const Mesh::VertexInfo& vertex, const PositionQuantization& quantization, const float ( &invScale )[3], PackedVertex& packed )
+        {
+            packed.m_position[0] = QuantizeUnorm16( ( vertex.m_position.x - quantization.m_offset.x ) * invScale[0] );
+            packed.m_position[1] = QuantizeUnorm16( ( vertex.m_position.y - quantization.m_offset.y ) * invScale[1] );
+            packed.m_position[2] = QuantizeUnorm16( ( vertex.m_position.z - quantization.m_offset.z ) * invScale[2] );
+            packed.m_position[3] = 0;
+            packed.m_uv[0] = FloatToHalf( vertex.m_uv.x );
+            packed.m_uv[1] = FloatToHalf( vertex.m_uv.y );
+            OctahedralEncode( vertex.m_normal, packed.m_normal );
+            packed.m_padding = 0;
+        }
+
+        void DecodeScalar( const PackedVertex& packed, const PositionQuantization& quantization, Mesh::VertexInfo& vertex )
+        {
+            vertex.m_position.x = quantization.m_offset.x + packed.m_position[0] / UnormScale * quantization.m_scale.x;
+            vertex.m_position.y = quantization.m_offset.y + packed.m_position[1] / UnormScale * quantization.m_scale.y;
+            vertex.m_position.z = quantization.m_offset.z + packed.m_position[2] / UnormScale * quantization.m_scale.z;
+            vertex.m_uv = { HalfToFloat( packed.m_uv[0] ), HalfToFloat( packed.m_uv[1] ) };
+            vertex.m_normal = OctahedralDecode( packed.m_normal );
+        }
+
+        // Loads four vertices and transposes them into component registers.
+        struct VertexBlock
+        {
+            __m128 px, py, pz, u, v, nx, ny, nz;
+
+            explicit VertexBlock( const Mesh::VertexInfo* vertices )
+            {
+                const float* base = &vertices[0].m_position.x;
+                px = _mm_loadu_ps( base + 0 );
+                py = _mm_loadu_ps( base + 8 );
+                pz = _mm_loadu_ps( base + 16 );
+                u = _mm_loadu_ps( base + 24 );
+                _MM_TRANSPOSE4_PS( px, py, pz, u );
+
+                v = _mm_loadu_ps( base + 4 );
+                nx = _mm_loadu_ps( base + 12 );
+                ny = _mm_loadu_ps( base + 20 );
+                nz = _mm_loadu_ps( base + 28 );
+                _MM_TRANSPOSE4_PS( v, nx, ny, nz );
+            }
+        };
+
+        __m128i QuantizeUnorm16x4( __m128 value, __m128 offset, __m128 invScale )
+        {
+            __m128 normalized = _mm_mul_ps( _mm_sub_ps( value, offset ), invScale );
+            normalized = _mm_min_ps( _mm_max_ps( normalized, _mm_setzero_ps() ), _mm_set1_ps( 1.f ) );
+            return _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( normalized, _mm_set1_ps( UnormScale ) ), _mm_set1_ps( 0.5f ) ) );
+        }
+
+        __m128 Abs( __m128 value )
+        {
+            return _mm_andnot_ps( _mm_set1_ps( -0.f ), value );
+        }
+
+        // +1 or -1 with the sign of value, +1 for zero.
+        __m128 SignNotZero( __m128 value )
+        {
+            const __m128 negative = _mm_cmplt_ps( value, _mm_setzero_ps() );
+            return _mm_or_ps( _mm_and_ps( negative, _mm_set1_ps( -1.f ) ), _mm_andnot_ps( negative, _mm_set1_ps( 1.f ) ) );
+        }
+
+        __m128i QuantizeSnorm8x4( __m128 value )
+        {
+            value = _mm_min_ps( _mm_max_ps( value, _mm_set1_ps( -1.f ) ), _mm_set1_ps( 1.f ) );
+            return _mm_cvtps_epi32( _mm_mul_ps( value, _mm_set1_ps( SnormScale ) ) );
+        }
+
+        void EncodeBlock( const Mesh::VertexInfo* vertices, const __m128 ( &offset )[3], const __m128 ( &invScale )[3], PackedVertex* packed )
+        {
+            const VertexBlock block( vertices );
+
+            alignas( 16 ) int32_t qx[4], qy[4], qz[4], ox[4], oy[4];
+            _mm_store_si128( reinterpret_cast<__m128i*>( qx ), QuantizeUnorm16x4( block.px, offset[0], invScale[0] ) );
+            _mm_store_si128( reinterpret_cast<__m128i*>( qy ), QuantizeUnorm16x4( block.py, offset[1], invScale[1] ) );
+            _mm_store_si128( reinterpret_cast<__m128i*>( qz ), QuantizeUnorm16x4( block.pz, offset[2], invScale[2] ) );
+
+            // Octahedral projection, lower hemisphere folded over the diagonals.
+            const __m128 l1 = _mm_add_ps( _mm_add_ps( Abs( block.nx ), Abs( block.ny ) ), Abs( block.nz ) );
+            const __m128 nonZero = _mm_cmpgt_ps( l1, _mm_setzero_ps() );
+            const __m128 invL1 = _mm_and_ps( nonZero, _mm_div_ps( _mm_set1_ps( 1.f ), l1 ) );
+            const __m128 x = _mm_mul_ps( block.nx, invL1 );
+            const __m128 y = _mm_mul_ps( block.ny, invL1 );
+            const __m128 foldedX = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( 1.f ), Abs( y ) ), SignNotZero( x ) );
+            const __m128 foldedY = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( 1.f ), Abs( x ) ), SignNotZero( y ) );
+            const __m128 lower = _mm_cmplt_ps( block.nz, _mm_setzero_ps() );
+            const __m128 octX = _mm_or_ps( _mm_and_ps( lower, foldedX ), _mm_andnot_ps( lower, x ) );
+            const __m128 octY = _mm_or_ps( _mm_and_ps( lower, foldedY ), _mm_andnot_ps( lower, y ) );
+            _mm_store_si128( reinterpret_cast<__m128i*>( ox ), QuantizeSnorm8x4( octX ) );
+            _mm_store_si128( reinterpret_cast<__m128i*>( oy ), QuantizeSnorm8x4( octY ) );
+
+            alignas( 16 ) uint16_t halfU[8], halfV[8];
+#if defined(OLEX_HAS_F16C)
+            _mm_store_si128( reinterpret_cast<__m128i*>( halfU ), _mm_cvtps_ph( block.u, _MM_FROUND_TO_NEAREST_INT ) );
+            _mm_store_si128( reinterpret_cast<__m128i*>( halfV ), _mm_cvtps_ph( block.v, _MM_FROUND_TO_NEAREST_INT ) );
+#else
+            for ( int lane = 0; lane < 4; ++lane )
+            {
+                halfU[lane] = FloatToHalf( vertices[lane].m_uv.x );
+                halfV[lane] = FloatToHalf( vertices[lane].m_uv.y );
+            }
+#endif
+
+            for ( int lane = 0; lane < 4; ++lane )
+            {
+                PackedVertex& out = packed[lane];
+                out.m_position[0] = static_cast<uint16_t>( qx[lane] );
+                out.m_position[1] = static_cast<uint16_t>( qy[lane] );
+                out.m_position[2] = static_cast<uint16_t>( qz[lane] );
+                out.m_position[3] = 0;
+                out.m_uv[0] = halfU[lane];
+                out.m_uv[1] = halfV[lane];
+                out.m_normal[0] = static_cast<int8_t>( ox[lane] );
+                out.m_normal[1] = static_cast<int8_t>( oy[lane] );
+                out.m_padding = 0;
+            }
+        }
+
+        void DecodeBlock( const PackedVertex* packed, const __m128 ( &offset )[3], const __m128 ( &scale )[3], Mesh::VertexInfo* vertices )
+        {
+            alignas( 16 ) int32_t qx[4], qy[4], qz[4], ox[4], oy[4];
+            alignas( 16 ) uint16_t halfU[8] = {}, halfV[8] = {};
+            for ( int lane = 0; lane < 4; ++lane )
+            {
+                qx[lane] = packed[lane].m_position[0];
+                qy[lane] = packed[lane].m_position[1];
+                qz[lane] = packed[lane].m_position[2];
+                ox[lane] = packed[lane].m_normal[0];
+                oy[lane] = packed[lane].m_normal[1];
+                halfU[lane] = packed[lane].m_uv[0];
+                halfV[lane] = packed[lane].m_uv[1];
+            }
+
+            const __m128 invUnorm = _mm_set1_ps( 1.f / UnormScale );
+            auto dequantize = [&invUnorm]( const int32_t* q, __m128 offset, __m128 scale )
+            {
+                const __m128 unorm = _mm_mul_ps( _mm_cvtepi32_ps( _mm_load_si128( reinterpret_cast<const __m128i*>( q ) ) ), invUnorm );
+                return _mm_add_ps( offset, _mm_mul_ps( unorm, scale ) );
+            };
+
+            __m128 px = dequantize( qx, offset[0], scale[0] );
+            __m128 py = dequantize( qy, offset[1], scale[1] );
+            __m128 pz = dequantize( qz, offset[2], scale[2] );
+
+            __m128 u, v;
+#if defined(OLEX_HAS_F16C)
+            u = _mm_cvtph_ps( _mm_load_si128( reinterpret_cast<const __m128i*>( halfU ) ) );
+            v = _mm_cvtph_ps( _mm_load_si128( reinterpret_cast<const __m128i*>( halfV ) ) );
+#else
+            u = _mm_setr_ps( HalfToFloat( halfU[0] ), HalfToFloat( halfU[1] ), HalfToFloat( halfU[2] ), HalfToFloat( halfU[3] ) );
+            v = _mm_setr_ps( HalfToFloat( halfV[0] ), HalfToFloat( halfV[1] ), HalfToFloat( halfV[2] ), HalfToFloat( halfV[3] ) );
+#endif
+
+            // Octahedral unfold, then normalize.
+            const __m128 invSnorm = _mm_set1_ps( 1.f / SnormScale );
+            __m128 nx = _mm_max_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_load_si128( reinterpret_cast<const __m128i*>( ox ) ) ), invSnorm ), _mm_set1_ps( -1.f ) );
+            __m128 ny = _mm_max_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_load_si128( reinterpret_cast<const __m128i*>( oy ) ) ), invSnorm ), _mm_set1_ps( -1.f ) );
+            __m128 nz = _mm_sub_ps( _mm_sub_ps( _mm_set1_ps( 1.f ), Abs( nx ) ), Abs( ny ) );
+            const __m128 t = _mm_max_ps( _mm_sub_ps( _mm_setzero_ps(), nz ), _mm_setzero_ps() );
+            nx = _mm_sub_ps( nx, _mm_mul_ps( t, SignNotZero( nx ) ) );
+            ny = _mm_sub_ps( ny, _mm_mul_ps( t, SignNotZero( ny ) ) );
+
+            const __m128 lengthSquared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, nx ), _mm_mul_ps( ny, ny ) ), _mm_mul_ps( nz, nz ) );
+            const __m128 nonZero = _mm_cmpgt_ps( lengthSquared, _mm_setzero_ps() );
+            const __m128 invLength = _mm_and_ps( nonZero, _mm_div_ps( _mm_set1_ps( 1.f ), _mm_sqrt_ps( lengthSquared ) ) );
+            nx = _mm_mul_ps( nx, invLength );
+            ny = _mm_mul_ps( ny, invLength );
+            nz = _mm_mul_ps( nz, invLength );
+
+            // Back to [px py pz u] [v nx ny nz] per vertex.
+            _MM_TRANSPOSE4_PS( px, py, pz, u );
+            _MM_TRANSPOSE4_PS( v, nx, ny, nz );
+
+            float* base = &vertices[0].m_position.x;
+            _mm_storeu_ps( base + 0, px );
+            _mm_storeu_ps( base + 4, v );
+            _mm_storeu_ps( base + 8, py );
+            _mm_storeu_ps( base + 12, nx );
+            _mm_storeu_ps( base + 16, pz );
+            _mm_storeu_ps( base + 20, ny );
+            _mm_storeu_ps( base + 24, u );
+            _mm_storeu_ps( base + 28, nz );
+        }
+
+        float AngleDegrees( const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b )
+        {
+            const float lengthA = std::sqrt( a.x * a.x + a.y * a.y + a.z * a.z );
+            const float lengthB = std::sqrt( b.x * b.x + b.y * b.y + b.z * b.z );
+            if ( lengthA == 0.f || lengthB == 0.f )
+                return 0.f;
+
+            const float cosine = ( a.x * b.x + a.y * b.y + a.z * b.z ) / ( lengthA * lengthB );
+            return std::acos( std::min( std::max( cosine, -1.f ), 1.f ) ) * 57.2957795f;
+        }
+    }
+
+    uint16_t FloatToHalf( float value )
+    {
+        uint32_t bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+
+        const auto sign = static_cast<uint16_t>( ( bits >> 16 ) & 0x8000u );
+        uint32_t magnitude = bits & 0x7fffffffu;
+
+        // Too large for a half (including inf), or nan.
+        if ( magnitude >= 0x47800000u )
+            return sign | ( magnitude > 0x7f800000u ? 0x7e00u : 0x7c00u );
+
+        // Below the smallest normal half, denormals are steps of 2^-24.
+        if ( magnitude < 0x38800000u )
+        {
+            float absolute;
+            std::memcpy( &absolute, &magnitude, sizeof( absolute ) );
+            return sign | static_cast<uint16_t>( std::lrint( absolute * 16777216.f ) );
+        }
+
+        // Rebias the exponent from 127 to 15 and round the mantissa to nearest even.
+        magnitude -= 112u << 23;
+        magnitude += 0x0fffu + ( ( magnitude >> 13 ) & 1u );
+        return sign | static_cast<uint16_t>( magnitude >> 13 );
+    }
+
+    float HalfToFloat( uint16_t value )
+    {
+        const uint32_t sign = static_cast<uint32_t>( value & 0x8000u ) << 16;
+        const uint32_t exponent = ( value >> 10 ) & 0x1fu;
+        const uint32_t mantissa = value & 0x3ffu;
+
+        if ( exponent == 0 )
+        {
+            const float denormal = mantissa * ( 1.f / 16777216.f );
+            return sign ? -denormal : denormal;
+        }
+
+        const uint32_t bits = exponent == 31
+            ? sign | 0x7f800000u | ( mantissa << 13 )
+            : sign | ( ( exponent + 112u ) << 23 ) | ( mantissa << 13 );
+
+        float result;
+        std::memcpy( &result, &bits, sizeof( result ) );
+        return result;
+    }
+
+    PackedVertices EncodeVertices( const Mesh::VertexInfo* vertices, size_t vertexCount )
+    {
+        PackedVertices packed;
+        packed.m_vertices.resize( vertexCount );
+
+        float minimum[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float maximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for ( size_t i = 0; i < vertexCount; ++i )
+        {
+            const float position[3] = { vertices[i].m_position.x, vertices[i].m_position.y, vertices[i].m_position.z };
+            for ( int axis = 0; axis < 3; ++axis )
+            {
+                minimum[axis] = std::min( minimum[axis], position[axis] );
+                maximum[axis] = std::max( maximum[axis], position[axis] );
+            }
+        }
+
+        float scale[3] = { 0.f, 0.f, 0.f };
+        float invScale[3] = { 0.f, 0.f, 0.f };
+        for ( int axis = 0; axis < 3 && vertexCount > 0; ++axis )
+        {
+            scale[axis] = maximum[axis] - minimum[axis];
+            invScale[axis] = scale[axis] > 0.f ? 1.f / scale[axis] : 0.f;
+        }
+
+        if ( vertexCount == 0 )
+            minimum[0] = minimum[1] = minimum[2] = 0.f;
+
+        packed.m_quantization.m_offset = { minimum[0], minimum[1], minimum[2], 0.f };
+        packed.m_quantization.m_scale = { scale[0], scale[1], scale[2], 0.f };
+
+        const __m128 offsets[3] = { _mm_set1_ps( minimum[0] ), _mm_set1_ps( minimum[1] ), _mm_set1_ps( minimum[2] ) };
+        const __m128 invScales[3] = { _mm_set1_ps( invScale[0] ), _mm_set1_ps( invScale[1] ), _mm_set1_ps( invScale[2] ) };
+
+        size_t i = 0;
+        for ( ; i + 4 <= vertexCount; i += 4 )
+            EncodeBlock( vertices + i, offsets, invScales, &packed.m_vertices[i] );
+
+        for ( ; i < vertexCount; ++i )
+            EncodeScalar( vertices[i], packed.m_quantization, invScale, packed.m_vertices[i] );
+
+        return packed;
+    }
+
+    void DecodeVertices( const PackedVertices& packed, Mesh::VertexInfo* vertices )
+    {
+        const PositionQuantization& quantization = packed.m_quantization;
+        const __m128 offsets[3] = { _mm_set1_ps( quantization.m_offset.x ), _mm_set1_ps( quantization.m_offset.y ), _mm_set1_ps( quantization.m_offset.z ) };
+        const __m128 scales[3] = { _mm_set1_ps( quantization.m_scale.x ), _mm_set1_ps( quantization.m_scale.y ), _mm_set1_ps( quantization.m_scale.z ) };
+
+        const size_t vertexCount = packed.m_vertices.size();
+        size_t i = 0;
+        for ( ; i + 4 <= vertexCount; i += 4 )
+            DecodeBlock( &packed.m_vertices[i], offsets, scales, vertices + i );
+
+        for ( ; i < vertexCount; ++i )
+            DecodeScalar( packed.m_vertices[i], quantization, vertices[i] );
+    }
+
+    PackedTangent PackTangent( const DirectX::XMFLOAT4& tangent )
+    {
+        PackedTangent packed;
+        OctahedralEncode( { tangent.x, tangent.y, tangent.z }, packed.m_tangent );
+        packed.m_unused = 0;
+        packed.m_sign = tangent.w < 0.f ? -127 : 127;
+        return packed;
+    }
+
+    DirectX::XMFLOAT4 UnpackTangent( const PackedTangent& packed )
+    {
+        const DirectX::XMFLOAT3 tangent = OctahedralDecode( packed.m_tangent );
+        return { tangent.x, tangent.y, tangent.z, packed.m_sign < 0 ? -1.f : 1.f };
+    }
+
+    QuantizationError MeasureQuantizationError( const Mesh::VertexInfo* vertices, const PackedVertices& packed )
+    {
+        QuantizationError error;
+
+        std::vector<Mesh::VertexInfo> decoded( packed.m_vertices.size() );
+        DecodeVertices( packed, decoded.data() );
+
+        for ( size_t i = 0; i < decoded.size(); ++i )
+        {
+            const Mesh::VertexInfo& original = vertices[i];
+            const Mesh::VertexInfo& roundTrip = decoded[i];
+
+            error.m_maxPositionError = std::max( { error.m_maxPositionError,
+                std::fabs( original.m_position.x - roundTrip.m_position.x ),
+                std::fabs( original.m_position.y - roundTrip.m_position.y ),
+                std::fabs( original.m_position.z - roundTrip.m_position.z ) } );
+            error.m_maxUVError = std::max( { error.m_maxUVError,
+                std::fabs( original.m_uv.x - roundTrip.m_uv.x ),
+                std::fabs( original.m_uv.y - roundTrip.m_uv.y ) } );
+            error.m_maxNormalErrorDegrees = std::max( error.m_maxNormalErrorDegrees, AngleDegrees( original.m_normal, roundTrip.m_normal ) );
+        }
+
+        return error;
+    }
+}
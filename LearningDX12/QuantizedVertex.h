@@ -0,0 +1,86 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    /**
+     * Compact 16-byte alternative to Mesh::VertexInfo (32 bytes).
+     *
+     * Input layout (see VertexShader_Textured_Light_Packed.hlsl):
+     *   POSITION  DXGI_FORMAT_R16G16B16A16_UNORM  offset 0   relative to the mesh bounding box, w unused
+     *   TEXCOORD  DXGI_FORMAT_R16G16_FLOAT        offset 8
+     *   NORMAL    DXGI_FORMAT_R8G8_SNORM          offset 12  octahedral encoding
+     *
+     * Error bounds:
+     *   position  half a step, extent / 65535 / 2 per axis (plus float rounding)
+     *   uv        half float, relative error 2^-11, absolute error at most 2^-12 inside [0, 1]
+     *   normal    under 1 degree (0.95 over random unit vectors), MeasureQuantizationError gives the figure of a mesh
+     */
+    struct PackedVertex
+    {
+        uint16_t m_position[4];
+        uint16_t m_uv[2];
+        int8_t m_normal[2];
+        uint16_t m_padding;
+    };
+
+    static_assert( sizeof( PackedVertex ) == 16, "PackedVertex must match the packed input layout" );
+
+    /**
+     * Dequantization of PackedVertex::m_position: position = m_offset + unorm * m_scale,
+     * where unorm is the value the input assembler produces for R16G16B16A16_UNORM.
+     */
+    struct PositionQuantization
+    {
+        DirectX::XMFLOAT4 m_offset;
+        DirectX::XMFLOAT4 m_scale;
+    };
+
+    struct PackedVertices
+    {
+        PositionQuantization m_quantization;
+        std::vector<PackedVertex> m_vertices;
+    };
+
+    struct QuantizationError
+    {
+        float m_maxPositionError = 0.f;
+        float m_maxUVError = 0.f;
+        float m_maxNormalErrorDegrees = 0.f;
+    };
+
+    // Encodes the vertices, four at a time with SSE2 (and F16C for the uvs when the build targets it).
+    PackedVertices EncodeVertices( const Mesh::VertexInfo* vertices, size_t vertexCount );
+
+    // Decodes back to full floats, normals come out normalized.
+    void DecodeVertices( const PackedVertices& packed, Mesh::VertexInfo* vertices );
+
+    // Largest per-component deviation between the original vertices and their decoded encoding.
+    QuantizationError MeasureQuantizationError( const Mesh::VertexInfo* vertices, const PackedVertices& packed );
+
+    /**
+     * Tangent stream element, DXGI_FORMAT_R8G8B8A8_SNORM: xy the octahedral tangent, z unused and w the
+     * bitangent sign, bitangent = sign * cross( normal, tangent ). Same angular error as the packed normal.
+     */
+    struct PackedTangent
+    {
+        int8_t m_tangent[2];
+        int8_t m_unused;
+        int8_t m_sign;
+    };
+
+    static_assert( sizeof( PackedTangent ) == 4, "PackedTangent must match the packed input layout" );
+
+    // xyz the unit tangent, w the bitangent sign (see Mesh::m_tangents).
+    PackedTangent PackTangent( const DirectX::XMFLOAT4& tangent );
+    DirectX::XMFLOAT4 UnpackTangent( const PackedTangent& packed );
+
+    uint16_t FloatToHalf( float value );
+    float HalfToFloat( uint16_t value );
+}
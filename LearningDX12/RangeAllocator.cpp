@@ -0,0 +1,73 @@
+#include "RangeAllocator.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace Olex
+{
+    RangeAllocator::RangeAllocator( uint64_t capacity )
+        : m_capacity( capacity )
+        , m_freeSize( capacity )
+    {
+        if ( capacity > 0 )
+            m_freeRanges.emplace( 0, capacity );
+    }
+
+    uint64_t RangeAllocator::Allocate( uint64_t size, uint64_t alignment )
+    {
+        if ( size == 0 || alignment == 0 )
+            throw std::invalid_argument( "RangeAllocator needs a size and an alignment" );
+
+        for ( auto range = m_freeRanges.begin(); range != m_freeRanges.end(); ++range )
+        {
+            const uint64_t rangeStart = range->first;
+            const uint64_t rangeEnd = range->first + range->second;
+            const uint64_t offset = ( rangeStart + alignment - 1 ) / alignment * alignment;
+            if ( offset >= rangeEnd || rangeEnd - offset < size )
+                continue;
+
+            // Whatever is left on either side of the allocation stays free.
+            m_freeRanges.erase( range );
+            if ( offset > rangeStart )
+                m_freeRanges.emplace( rangeStart, offset - rangeStart );
+            if ( offset + size < rangeEnd )
+                m_freeRanges.emplace( offset + size, rangeEnd - offset - size );
+            m_freeSize -= size;
+            return offset;
+        }
+        return InvalidOffset;
+    }
+
+    void RangeAllocator::Free( uint64_t offset, uint64_t size )
+    {
+        if ( size == 0 || offset > m_capacity || m_capacity - offset < size )
+            throw std::invalid_argument( "RangeAllocator::Free got a range outside of the allocator" );
+
+        auto next = m_freeRanges.lower_bound( offset );
+        if ( next != m_freeRanges.end() && next->first < offset + size )
+            throw std::invalid_argument( "RangeAllocator::Free got a range that is already free" );
+
+        uint64_t start = offset;
+        uint64_t end = offset + size;
+        if ( next != m_freeRanges.begin() )
+        {
+            const auto previous = std::prev( next );
+            const uint64_t previousEnd = previous->first + previous->second;
+            if ( previousEnd > offset )
+                throw std::invalid_argument( "RangeAllocator::Free got a range that is already free" );
+            if ( previousEnd == offset )
+            {
+                start = previous->first;
+                m_freeRanges.erase( previous );
+            }
+        }
+        if ( next != m_freeRanges.end() && next->first == end )
+        {
+            end += next->second;
+            m_freeRanges.erase( next );
+        }
+
+        m_freeRanges.emplace( start, end - start );
+        m_freeSize += size;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace Olex
+{
+    /**
+     * First-fit allocator of ranges in [0, capacity), for sub-allocating large GPU buffers.
+     *
+     * Free ranges are kept sorted by offset and merged with their neighbours when returned, so
+     * memory freed in any order coalesces back into one range. Alignments need not be powers of
+     * two, which lets vertices of any stride be addressed with a base vertex.
+     */
+    class RangeAllocator
+    {
+    public:
+        static constexpr uint64_t InvalidOffset = ~0ull;
+
+        explicit RangeAllocator( uint64_t capacity );
+
+        // Offset of the new range, or InvalidOffset when no free range is large enough.
+        [[nodiscard]] uint64_t Allocate( uint64_t size, uint64_t alignment = 1 );
+        // Size must be the one the range was allocated with. Throws std::invalid_argument on a range that is not allocated.
+        void Free( uint64_t offset, uint64_t size );
+
+        [[nodiscard]] uint64_t GetCapacity() const { return m_capacity; }
+        [[nodiscard]] uint64_t GetFreeSize() const { return m_freeSize; }
+        // Free ranges, a rough measure of fragmentation.
+        [[nodiscard]] size_t GetFreeRangeCount() const { return m_freeRanges.size(); }
+
+    private:
+        uint64_t m_capacity;
+        uint64_t m_freeSize;
+        // Offset to size.
+        std::map<uint64_t, uint64_t> m_freeRanges;
+    };
+}
@@ -0,0 +1,52 @@
+#include "Scene.h"
+
+#include <stdexcept>
+
+namespace Olex
+{
+    using namespace DirectX;
+
+    uint32_t Scene::AddNode( const std::string& name, int32_t parent, const XMFLOAT4X4& localTransform )
+    {
+        if ( parent != NoParent && ( parent < 0 || static_cast<size_t>( parent ) >= m_parents.size() ) )
+        {
+            throw std::out_of_range( "Scene node parent must be added before its children" );
+        }
+
+        m_parents.push_back( parent );
+        m_names.push_back( name );
+        m_localTransforms.push_back( localTransform );
+        m_worldTransforms.push_back( localTransform );
+        return static_cast<uint32_t>( m_parents.size() - 1 );
+    }
+
+    uint32_t Scene::AddMaterial( const Material& material )
+    {
+        m_materials.push_back( material );
+        return static_cast<uint32_t>( m_materials.size() - 1 );
+    }
+
+    void Scene::UpdateWorldTransforms()
+    {
+        const size_t nodeCount = m_parents.size();
+        for ( size_t node = 0; node < nodeCount; ++node )
+        {
+            const int32_t parent = m_parents[node];
+            if ( parent == NoParent )
+            {
+                m_worldTransforms[node] = m_localTransforms[node];
+                continue;
+            }
+
+            // The parent sits earlier in the arrays, so its world transform is already up to date.
+            const XMMATRIX local = XMLoadFloat4x4( &m_localTransforms[node] );
+            const XMMATRIX parentWorld = XMLoadFloat4x4( &m_worldTransforms[parent] );
+            XMStoreFloat4x4( &m_worldTransforms[node], XMMatrixMultiply( local, parentWorld ) );
+        }
+    }
+
+    XMMATRIX Scene::GetInstanceTransform( const MeshInstance& instance ) const
+    {
+        return XMMatrixMultiply( XMLoadFloat4x4( &instance.m_geometryTransform ), XMLoadFloat4x4( &m_worldTransforms[instance.m_node] ) );
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Olex
+{
+    // Surface description shared by the mesh instances that use it.
+    struct Material
+    {
+        std::string m_name;
+        // Linear RGBA, multiplied with the base color texture when there is one.
+        DirectX::XMFLOAT4 m_baseColor = { 1.f, 1.f, 1.f, 1.f };
+        // Source texture file relative to the scene file, empty when untextured. The asset baker
+        // writes the baked texture under the same relative path with a .tex extension.
+        std::string m_baseColorTexture;
+    };
+
+    // A mesh placed at a scene node.
+    struct MeshInstance
+    {
+        static constexpr uint32_t NoMaterial = ~0u;
+
+        // Index into the imported meshes.
+        uint32_t m_mesh = 0;
+        // Index into the scene nodes.
+        uint32_t m_node = 0;
+        // Index into the scene materials.
+        uint32_t m_material = NoMaterial;
+        // Offset of the mesh relative to its node, applied before the node transform (FBX geometric transform).
+        DirectX::XMFLOAT4X4 m_geometryTransform;
+    };
+
+    /**
+     * Flattened node hierarchy, stored as structure of arrays.
+     *
+     * Nodes are kept in depth-first order, so every parent comes before its children and
+     * UpdateWorldTransforms is a single forward sweep over contiguous matrices. Matrices follow
+     * the DirectXMath row-vector convention: world = local * parent world.
+     */
+    class Scene
+    {
+    public:
+        static constexpr int32_t NoParent = -1;
+
+        // Appends a node; parent must already be in the scene (or NoParent).
+        uint32_t AddNode( const std::string& name, int32_t parent, const DirectX::XMFLOAT4X4& localTransform );
+        void AddMeshInstance( const MeshInstance& instance ) { m_meshInstances.push_back( instance ); }
+        uint32_t AddMaterial( const Material& material );
+
+        void SetLocalTransform( uint32_t node, const DirectX::XMFLOAT4X4& localTransform ) { m_localTransforms[node] = localTransform; }
+        void SetMaterial( uint32_t material, const Material& value ) { m_materials.at( material ) = value; }
+
+        // Recomputes every world transform from the local ones.
+        void UpdateWorldTransforms();
+
+        [[nodiscard]] size_t GetNodeCount() const { return m_parents.size(); }
+        [[nodiscard]] const std::vector<int32_t>& GetParents() const { return m_parents; }
+        [[nodiscard]] const std::vector<std::string>& GetNames() const { return m_names; }
+        [[nodiscard]] const std::vector<DirectX::XMFLOAT4X4>& GetLocalTransforms() const { return m_localTransforms; }
+        [[nodiscard]] const std::vector<DirectX::XMFLOAT4X4>& GetWorldTransforms() const { return m_worldTransforms; }
+        [[nodiscard]] const std::vector<MeshInstance>& GetMeshInstances() const { return m_meshInstances; }
+        [[nodiscard]] const std::vector<Material>& GetMaterials() const { return m_materials; }
+
+        // World transform of the instance's mesh, geometry transform included.
+        [[nodiscard]] DirectX::XMMATRIX GetInstanceTransform( const MeshInstance& instance ) const;
+
+    private:
+        std::vector<int32_t> m_parents;
+        std::vector<std::string> m_names;
+        std::vector<DirectX::XMFLOAT4X4> m_localTransforms;
+        std::vector<DirectX::XMFLOAT4X4> m_worldTransforms;
+
+        std::vector<MeshInstance> m_meshInstances;
+        std::vector<Material> m_materials;
+    };
+}
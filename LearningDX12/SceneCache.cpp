@@ -0,0 +1,384 @@
+#include "SceneCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Olex
+{
+    namespace
+    {
+        bool IsLittleEndianHost()
+        {
+            const uint16_t value = 1;
+            uint8_t firstByte;
+            std::memcpy( &firstByte, &value, 1 );
+            return firstByte == 1;
+        }
+
+        // The whole file is assembled in memory; scenes are small enough for that.
+        class BlobWriter
+        {
+        public:
+            // Appends size bytes on a fresh BlobAlignment boundary and returns their offset.
+            uint64_t Append( const void* data, size_t size )
+            {
+                m_bytes.resize( ( m_bytes.size() + SceneCacheFormat::BlobAlignment - 1 ) & ~( SceneCacheFormat::BlobAlignment - 1 ) );
+                const uint64_t offset = m_bytes.size();
+                m_bytes.insert( m_bytes.end(), static_cast<const uint8_t*>( data ), static_cast<const uint8_t*>( data ) + size );
+                return offset;
+            }
+
+            template <typename T>
+            uint64_t Append( const std::vector<T>& values ) { return Append( values.data(), sizeof( T ) * values.size() ); }
+
+            template <typename T>
+            void Overwrite( uint64_t offset, const T& value ) { std::memcpy( m_bytes.data() + offset, &value, sizeof( T ) ); }
+
+            const std::vector<uint8_t>& GetBytes() const { return m_bytes; }
+
+        private:
+            std::vector<uint8_t> m_bytes;
+        };
+
+        class StringTable
+        {
+        public:
+            SceneCacheString Add( const std::string& value )
+            {
+                const SceneCacheString string = { static_cast<uint32_t>( m_blob.size() ), static_cast<uint32_t>( value.size() ) };
+                m_blob.insert( m_blob.end(), value.begin(), value.end() );
+                return string;
+            }
+
+            const std::vector<char>& GetBlob() const { return m_blob; }
+
+        private:
+            std::vector<char> m_blob;
+        };
+    }
+
+    void WriteSceneCache( const std::filesystem::path& cachePath, const Scene& scene, const Skeleton& skeleton,
+        const std::vector<AnimationClip>& animations, const SourceStamp& sourceStamp )
+    {
+        // The file is mapped straight into native structs, so it is only ever produced in little-endian.
+        if ( !IsLittleEndianHost() )
+        {
+            throw std::runtime_error( "Scene cache can only be written on a little-endian host" );
+        }
+
+        StringTable strings;
+
+        std::vector<SceneCacheNode> nodes( scene.GetNodeCount() );
+        for ( size_t i = 0; i < nodes.size(); ++i )
+        {
+            nodes[i] = {};
+            nodes[i].m_localTransform = scene.GetLocalTransforms()[i];
+            nodes[i].m_parent = scene.GetParents()[i];
+            nodes[i].m_name = strings.Add( scene.GetNames()[i] );
+        }
+
+        std::vector<SceneCacheInstance> instances;
+        for ( const MeshInstance& instance : scene.GetMeshInstances() )
+        {
+            SceneCacheInstance entry = {};
+            entry.m_geometryTransform = instance.m_geometryTransform;
+            entry.m_mesh = instance.m_mesh;
+            entry.m_node = instance.m_node;
+            entry.m_material = instance.m_material;
+            instances.push_back( entry );
+        }
+
+        std::vector<SceneCacheMaterial> materials;
+        for ( const Material& material : scene.GetMaterials() )
+        {
+            SceneCacheMaterial entry = {};
+            entry.m_baseColor = material.m_baseColor;
+            entry.m_name = strings.Add( material.m_name );
+            entry.m_baseColorTexture = strings.Add( material.m_baseColorTexture );
+            materials.push_back( entry );
+        }
+
+        std::vector<SceneCacheJoint> joints( skeleton.m_nodes.size() );
+        for ( size_t i = 0; i < joints.size(); ++i )
+        {
+            joints[i] = {};
+            joints[i].m_bindPose = skeleton.m_bindPose[i];
+            joints[i].m_node = skeleton.m_nodes[i];
+            joints[i].m_parent = skeleton.m_parents[i];
+        }
+
+        SceneCacheHeader header = {};
+        header.m_magic = SceneCacheFormat::Magic;
+        header.m_version = SceneCacheFormat::Version;
+        header.m_endianTag = SceneCacheFormat::EndianTag;
+        header.m_nodeCount = static_cast<uint32_t>( nodes.size() );
+        header.m_instanceCount = static_cast<uint32_t>( instances.size() );
+        header.m_materialCount = static_cast<uint32_t>( materials.size() );
+        header.m_jointCount = static_cast<uint32_t>( joints.size() );
+        header.m_clipCount = static_cast<uint32_t>( animations.size() );
+        header.m_sourceSize = sourceStamp.m_size;
+        header.m_sourceWriteTime = sourceStamp.m_writeTime;
+
+        // Clip names go into the string table before it is written, the clip table itself is patched in afterwards.
+        std::vector<SceneCacheClip> clips( animations.size() );
+        for ( size_t i = 0; i < clips.size(); ++i )
+        {
+            const AnimationClip& clip = animations[i];
+            clips[i] = {};
+            clips[i].m_name = strings.Add( clip.m_name );
+            clips[i].m_sampleRate = clip.m_sampleRate;
+            clips[i].m_frameCount = clip.m_frameCount;
+            clips[i].m_trackCount = static_cast<uint32_t>( clip.m_tracks.size() );
+            clips[i].m_keyCount = static_cast<uint32_t>( clip.m_keyFrames.size() );
+            clips[i].m_translationCount = static_cast<uint32_t>( clip.m_translations.size() / 3 );
+            clips[i].m_rotationCount = static_cast<uint32_t>( clip.m_rotations.size() );
+            clips[i].m_scaleCount = static_cast<uint32_t>( clip.m_scales.size() / 3 );
+            clips[i].m_floatTranslationCount = static_cast<uint32_t>( clip.m_floatTranslations.size() / 3 );
+            clips[i].m_floatScaleCount = static_cast<uint32_t>( clip.m_floatScales.size() / 3 );
+        }
+
+        BlobWriter writer;
+        writer.Append( &header, sizeof( header ) );
+        header.m_nodeOffset = writer.Append( nodes );
+        header.m_instanceOffset = writer.Append( instances );
+        header.m_materialOffset = writer.Append( materials );
+        header.m_jointOffset = writer.Append( joints );
+        header.m_clipOffset = writer.Append( clips );
+        for ( size_t i = 0; i < clips.size(); ++i )
+        {
+            const AnimationClip& clip = animations[i];
+            clips[i].m_trackOffset = writer.Append( clip.m_tracks );
+            clips[i].m_keyFrameOffset = writer.Append( clip.m_keyFrames );
+            clips[i].m_translationOffset = writer.Append( clip.m_translations );
+            clips[i].m_rotationOffset = writer.Append( clip.m_rotations );
+            clips[i].m_scaleOffset = writer.Append( clip.m_scales );
+            clips[i].m_floatTranslationOffset = writer.Append( clip.m_floatTranslations );
+            clips[i].m_floatScaleOffset = writer.Append( clip.m_floatScales );
+            writer.Overwrite( header.m_clipOffset + sizeof( SceneCacheClip ) * i, clips[i] );
+        }
+        header.m_stringOffset = writer.Append( strings.GetBlob() );
+        header.m_stringSize = strings.GetBlob().size();
+        writer.Overwrite( 0, header );
+
+        std::filesystem::path temporaryPath = cachePath;
+        temporaryPath += "." + MakeUniqueName() + ".tmp";
+
+        {
+            std::ofstream stream( temporaryPath, std::ios::binary | std::ios::trunc );
+            if ( !stream )
+            {
+                throw std::runtime_error( "Unable to create scene cache file" );
+            }
+
+            stream.write( reinterpret_cast<const char*>( writer.GetBytes().data() ), static_cast<std::streamsize>( writer.GetBytes().size() ) );
+            if ( !stream )
+            {
+                throw std::runtime_error( "Failed writing scene cache file" );
+            }
+        }
+
+        std::filesystem::rename( temporaryPath, cachePath );
+    }
+
+    MappedSceneCache::MappedSceneCache( const std::filesystem::path& cachePath )
+        : m_file( cachePath )
+    {
+        if ( m_file.IsOpen() && m_file.GetSize() >= sizeof( SceneCacheHeader ) )
+        {
+            m_header = reinterpret_cast<const SceneCacheHeader*>( m_file.GetData() );
+            if ( !Validate() )
+                m_header = nullptr;
+        }
+    }
+
+    bool MappedSceneCache::IsInFile( uint64_t offset, uint64_t size ) const
+    {
+        return offset >= sizeof( SceneCacheHeader ) && offset % SceneCacheFormat::BlobAlignment == 0 &&
+            offset <= m_file.GetSize() && size <= m_file.GetSize() - offset;
+    }
+
+    bool MappedSceneCache::Validate() const
+    {
+        const SceneCacheHeader& header = *m_header;
+        if ( header.m_magic != SceneCacheFormat::Magic ||
+            header.m_version != SceneCacheFormat::Version ||
+            header.m_endianTag != SceneCacheFormat::EndianTag )
+        {
+            return false;
+        }
+
+        if ( !IsInFile( header.m_nodeOffset, sizeof( SceneCacheNode ) * uint64_t( header.m_nodeCount ) ) ||
+            !IsInFile( header.m_instanceOffset, sizeof( SceneCacheInstance ) * uint64_t( header.m_instanceCount ) ) ||
+            !IsInFile( header.m_materialOffset, sizeof( SceneCacheMaterial ) * uint64_t( header.m_materialCount ) ) ||
+            !IsInFile( header.m_jointOffset, sizeof( SceneCacheJoint ) * uint64_t( header.m_jointCount ) ) ||
+            !IsInFile( header.m_clipOffset, sizeof( SceneCacheClip ) * uint64_t( header.m_clipCount ) ) ||
+            !IsInFile( header.m_stringOffset, header.m_stringSize ) )
+        {
+            return false;
+        }
+
+        auto isString = [&header]( const SceneCacheString& string ) { return uint64_t( string.m_offset ) + string.m_length <= header.m_stringSize; };
+
+        const auto* nodes = reinterpret_cast<const SceneCacheNode*>( m_file.GetData() + header.m_nodeOffset );
+        for ( uint32_t i = 0; i < header.m_nodeCount; ++i )
+        {
+            // Parents come first, which Scene::AddNode relies on.
+            if ( nodes[i].m_parent < Scene::NoParent || nodes[i].m_parent >= int64_t( i ) || !isString( nodes[i].m_name ) )
+                return false;
+        }
+
+        const auto* instances = reinterpret_cast<const SceneCacheInstance*>( m_file.GetData() + header.m_instanceOffset );
+        for ( uint32_t i = 0; i < header.m_instanceCount; ++i )
+        {
+            if ( instances[i].m_node >= header.m_nodeCount ||
+                ( instances[i].m_material != MeshInstance::NoMaterial && instances[i].m_material >= header.m_materialCount ) )
+            {
+                return false;
+            }
+        }
+
+        const auto* materials = reinterpret_cast<const SceneCacheMaterial*>( m_file.GetData() + header.m_materialOffset );
+        for ( uint32_t i = 0; i < header.m_materialCount; ++i )
+        {
+            if ( !isString( materials[i].m_name ) || !isString( materials[i].m_baseColorTexture ) )
+                return false;
+        }
+
+        const auto* joints = reinterpret_cast<const SceneCacheJoint*>( m_file.GetData() + header.m_jointOffset );
+        for ( uint32_t i = 0; i < header.m_jointCount; ++i )
+        {
+            if ( joints[i].m_node >= header.m_nodeCount || joints[i].m_parent < Skeleton::NoParent || joints[i].m_parent >= int64_t( i ) )
+                return false;
+        }
+
+        const auto* clips = reinterpret_cast<const SceneCacheClip*>( m_file.GetData() + header.m_clipOffset );
+        for ( uint32_t i = 0; i < header.m_clipCount; ++i )
+        {
+            const SceneCacheClip& clip = clips[i];
+            if ( !isString( clip.m_name ) || !( clip.m_sampleRate > 0.f ) ||
+                !IsInFile( clip.m_trackOffset, sizeof( AnimationTrack ) * uint64_t( clip.m_trackCount ) ) ||
+                !IsInFile( clip.m_keyFrameOffset, sizeof( uint16_t ) * uint64_t( clip.m_keyCount ) ) ||
+                !IsInFile( clip.m_translationOffset, sizeof( uint16_t ) * 3 * uint64_t( clip.m_translationCount ) ) ||
+                !IsInFile( clip.m_rotationOffset, sizeof( QuantizedQuaternion ) * uint64_t( clip.m_rotationCount ) ) ||
+                !IsInFile( clip.m_scaleOffset, sizeof( uint16_t ) * 3 * uint64_t( clip.m_scaleCount ) ) ||
+                !IsInFile( clip.m_floatTranslationOffset, sizeof( float ) * 3 * uint64_t( clip.m_floatTranslationCount ) ) ||
+                !IsInFile( clip.m_floatScaleOffset, sizeof( float ) * 3 * uint64_t( clip.m_floatScaleCount ) ) )
+            {
+                return false;
+            }
+
+            // The sampler trusts the channels, so every one of them has to stay inside its arrays.
+            const auto* tracks = reinterpret_cast<const AnimationTrack*>( m_file.GetData() + clip.m_trackOffset );
+            for ( uint32_t track = 0; track < clip.m_trackCount; ++track )
+            {
+                auto isChannel = [&clip]( const AnimationChannel& channel, uint32_t valueCount )
+                {
+                    return channel.m_keyCount != 0 &&
+                        uint64_t( channel.m_firstKey ) + channel.m_keyCount <= clip.m_keyCount &&
+                        uint64_t( channel.m_firstValue ) + channel.m_keyCount <= valueCount;
+                };
+
+                const uint32_t floatChannels = tracks[track].m_floatChannels;
+                const uint32_t translationCount = floatChannels & AnimationTrack::FloatTranslations ? clip.m_floatTranslationCount : clip.m_translationCount;
+                const uint32_t scaleCount = floatChannels & AnimationTrack::FloatScales ? clip.m_floatScaleCount : clip.m_scaleCount;
+                if ( tracks[track].m_node >= header.m_nodeCount ||
+                    ( floatChannels & ~( AnimationTrack::FloatTranslations | AnimationTrack::FloatScales ) ) != 0 ||
+                    !isChannel( tracks[track].m_translation, translationCount ) ||
+                    !isChannel( tracks[track].m_rotation, clip.m_rotationCount ) ||
+                    !isChannel( tracks[track].m_scale, scaleCount ) )
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool MappedSceneCache::IsUpToDate( const SourceStamp& sourceStamp ) const
+    {
+        return IsValid() &&
+            m_header->m_sourceSize == sourceStamp.m_size &&
+            m_header->m_sourceWriteTime == sourceStamp.m_writeTime;
+    }
+
+    std::string MappedSceneCache::GetString( const SceneCacheString& string ) const
+    {
+        const char* blob = reinterpret_cast<const char*>( m_file.GetData() + m_header->m_stringOffset );
+        return std::string( blob + string.m_offset, string.m_length );
+    }
+
+    BakedScene MappedSceneCache::Load() const
+    {
+        if ( !IsValid() )
+        {
+            throw std::runtime_error( "Scene cache is missing or invalid" );
+        }
+
+        const uint8_t* data = m_file.GetData();
+        BakedScene baked;
+
+        const auto* nodes = reinterpret_cast<const SceneCacheNode*>( data + m_header->m_nodeOffset );
+        for ( uint32_t i = 0; i < m_header->m_nodeCount; ++i )
+            baked.m_scene.AddNode( GetString( nodes[i].m_name ), nodes[i].m_parent, nodes[i].m_localTransform );
+
+        const auto* materials = reinterpret_cast<const SceneCacheMaterial*>( data + m_header->m_materialOffset );
+        for ( uint32_t i = 0; i < m_header->m_materialCount; ++i )
+        {
+            Material material;
+            material.m_name = GetString( materials[i].m_name );
+            material.m_baseColor = materials[i].m_baseColor;
+            material.m_baseColorTexture = GetString( materials[i].m_baseColorTexture );
+            baked.m_scene.AddMaterial( material );
+        }
+
+        const auto* instances = reinterpret_cast<const SceneCacheInstance*>( data + m_header->m_instanceOffset );
+        for ( uint32_t i = 0; i < m_header->m_instanceCount; ++i )
+        {
+            MeshInstance instance;
+            instance.m_mesh = instances[i].m_mesh;
+            instance.m_node = instances[i].m_node;
+            instance.m_material = instances[i].m_material;
+            instance.m_geometryTransform = instances[i].m_geometryTransform;
+            baked.m_scene.AddMeshInstance( instance );
+        }
+        baked.m_scene.UpdateWorldTransforms();
+
+        const auto* joints = reinterpret_cast<const SceneCacheJoint*>( data + m_header->m_jointOffset );
+        for ( uint32_t i = 0; i < m_header->m_jointCount; ++i )
+        {
+            baked.m_skeleton.m_nodes.push_back( joints[i].m_node );
+            baked.m_skeleton.m_parents.push_back( joints[i].m_parent );
+            baked.m_skeleton.m_bindPose.push_back( joints[i].m_bindPose );
+        }
+
+        const auto* clips = reinterpret_cast<const SceneCacheClip*>( data + m_header->m_clipOffset );
+        for ( uint32_t i = 0; i < m_header->m_clipCount; ++i )
+        {
+            const SceneCacheClip& entry = clips[i];
+            AnimationClip clip;
+            clip.m_name = GetString( entry.m_name );
+            clip.m_sampleRate = entry.m_sampleRate;
+            clip.m_frameCount = entry.m_frameCount;
+
+            const auto* tracks = reinterpret_cast<const AnimationTrack*>( data + entry.m_trackOffset );
+            const auto* keyFrames = reinterpret_cast<const uint16_t*>( data + entry.m_keyFrameOffset );
+            const auto* translations = reinterpret_cast<const uint16_t*>( data + entry.m_translationOffset );
+            const auto* rotations = reinterpret_cast<const QuantizedQuaternion*>( data + entry.m_rotationOffset );
+            const auto* scales = reinterpret_cast<const uint16_t*>( data + entry.m_scaleOffset );
+            const auto* floatTranslations = reinterpret_cast<const float*>( data + entry.m_floatTranslationOffset );
+            const auto* floatScales = reinterpret_cast<const float*>( data + entry.m_floatScaleOffset );
+            clip.m_tracks.assign( tracks, tracks + entry.m_trackCount );
+            clip.m_keyFrames.assign( keyFrames, keyFrames + entry.m_keyCount );
+            clip.m_translations.assign( translations, translations + size_t( entry.m_translationCount ) * 3 );
+            clip.m_rotations.assign( rotations, rotations + entry.m_rotationCount );
+            clip.m_scales.assign( scales, scales + size_t( entry.m_scaleCount ) * 3 );
+            clip.m_floatTranslations.assign( floatTranslations, floatTranslations + size_t( entry.m_floatTranslationCount ) * 3 );
+            clip.m_floatScales.assign( floatScales, floatScales + size_t( entry.m_floatScaleCount ) * 3 );
+            baked.m_animations.push_back( std::move( clip ) );
+        }
+
+        return baked;
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "AnimationClip.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "Scene.h"
+#include "Skin.h"
+
+namespace Olex
+{
+    /**
+     * Baked scene container, the counterpart of the mesh cache for everything that is not
+     * geometry: node hierarchy, mesh instances, materials, skeleton and animation clips.
+     * Mesh instances index the meshes of the mesh cache baked from the same source.
+     *
+     *   SceneCacheHeader
+     *   SceneCacheNode[m_nodeCount], SceneCacheInstance[m_instanceCount], SceneCacheMaterial[m_materialCount],
+     *   SceneCacheJoint[m_jointCount], SceneCacheClip[m_clipCount], per clip its AnimationTrack[m_trackCount],
+     *   key frames and key values, then the string blob that names point into
+     *
+     * Every blob starts on a SceneCacheFormat::BlobAlignment boundary. All values are little-endian.
+     */
+    namespace SceneCacheFormat
+    {
+        constexpr uint32_t Magic = 0x4E43534F; // "OSCN"
+        constexpr uint16_t Version = 2;
+        constexpr uint16_t EndianTag = 0x0102;
+        constexpr uint64_t BlobAlignment = 16;
+    }
+
+    // Byte range of a string in the string blob.
+    struct SceneCacheString
+    {
+        uint32_t m_offset;
+        uint32_t m_length;
+    };
+
+    struct SceneCacheHeader
+    {
+        uint32_t m_magic;
+        uint16_t m_version;
+        uint16_t m_endianTag;
+        uint32_t m_nodeCount;
+        uint32_t m_instanceCount;
+        uint32_t m_materialCount;
+        uint32_t m_jointCount;
+        uint32_t m_clipCount;
+        uint32_t m_padding;
+        uint64_t m_nodeOffset;
+        uint64_t m_instanceOffset;
+        uint64_t m_materialOffset;
+        uint64_t m_jointOffset;
+        uint64_t m_clipOffset;
+        uint64_t m_stringOffset;
+        uint64_t m_stringSize;
+        // Identifies the source file the cache was baked from, see SourceStamp.
+        uint64_t m_sourceSize;
+        int64_t m_sourceWriteTime;
+    };
+
+    struct SceneCacheNode
+    {
+        DirectX::XMFLOAT4X4 m_localTransform;
+        int32_t m_parent;
+        uint32_t m_padding;
+        SceneCacheString m_name;
+    };
+
+    struct SceneCacheInstance
+    {
+        DirectX::XMFLOAT4X4 m_geometryTransform;
+        uint32_t m_mesh;
+        uint32_t m_node;
+        uint32_t m_material;
+        uint32_t m_padding;
+    };
+
+    struct SceneCacheMaterial
+    {
+        DirectX::XMFLOAT4 m_baseColor;
+        SceneCacheString m_name;
+        SceneCacheString m_baseColorTexture;
+    };
+
+    struct SceneCacheJoint
+    {
+        DirectX::XMFLOAT4X4 m_bindPose;
+        uint32_t m_node;
+        int32_t m_parent;
+        uint32_t m_padding[2];
+    };
+
+    struct SceneCacheClip
+    {
+        SceneCacheString m_name;
+        float m_sampleRate;
+        uint32_t m_frameCount;
+        uint32_t m_trackCount;
+        uint32_t m_keyCount;
+        // In keys, each one 3 uint16_t values for translations and scales, 3 floats for float keys.
+        uint32_t m_translationCount;
+        uint32_t m_rotationCount;
+        uint32_t m_scaleCount;
+        uint32_t m_floatTranslationCount;
+        uint32_t m_floatScaleCount;
+        uint32_t m_padding;
+        uint64_t m_trackOffset;
+        uint64_t m_keyFrameOffset;
+        uint64_t m_translationOffset;
+        uint64_t m_rotationOffset;
+        uint64_t m_scaleOffset;
+        uint64_t m_floatTranslationOffset;
+        uint64_t m_floatScaleOffset;
+    };
+
+    static_assert( sizeof( SceneCacheHeader ) == 104, "SceneCacheHeader layout is part of the file format" );
+    static_assert( sizeof( SceneCacheNode ) == 80, "SceneCacheNode layout is part of the file format" );
+    static_assert( sizeof( SceneCacheInstance ) == 80, "SceneCacheInstance layout is part of the file format" );
+    static_assert( sizeof( SceneCacheMaterial ) == 32, "SceneCacheMaterial layout is part of the file format" );
+    static_assert( sizeof( SceneCacheJoint ) == 80, "SceneCacheJoint layout is part of the file format" );
+    static_assert( sizeof( SceneCacheClip ) == 104, "SceneCacheClip layout is part of the file format" );
+    static_assert( sizeof( AnimationTrack ) == 92, "AnimationTrack layout is part of the file format" );
+    static_assert( sizeof( QuantizedQuaternion ) == 6, "QuantizedQuaternion layout is part of the file format" );
+
+    // Everything a scene cache holds, unpacked into the runtime types.
+    struct BakedScene
+    {
+        Scene m_scene;
+        Skeleton m_skeleton;
+        std::vector<AnimationClip> m_animations;
+    };
+
+    // Written under a temporary name and then renamed, like WriteMeshCache.
+    void WriteSceneCache( const std::filesystem::path& cachePath, const Scene& scene, const Skeleton& skeleton,
+        const std::vector<AnimationClip>& animations, const SourceStamp& sourceStamp );
+
+    /**
+     * Memory-mapped read access to a baked scene cache. Scenes are small next to their meshes,
+     * so Load copies everything out into a BakedScene instead of handing out views.
+     */
+    class MappedSceneCache
+    {
+    public:
+        explicit MappedSceneCache( const std::filesystem::path& cachePath );
+
+        // False if the file is missing, truncated or was written by an incompatible version.
+        [[nodiscard]] bool IsValid() const { return m_header != nullptr; }
+        [[nodiscard]] bool IsUpToDate( const SourceStamp& sourceStamp ) const;
+
+        // World transforms are up to date. Throws std::runtime_error when the cache is not valid.
+        [[nodiscard]] BakedScene Load() const;
+
+    private:
+        MappedFile m_file;
+        const SceneCacheHeader* m_header = nullptr;
+
+        bool Validate() const;
+        bool IsInFile( uint64_t offset, uint64_t size ) const;
+        std::string GetString( const SceneCacheString& string ) const;
+    };
+}
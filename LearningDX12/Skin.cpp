@@ -0,0 +1,69 @@
+#include "Skin.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Olex
+{
+    using namespace DirectX;
+
+    VertexSkin PackInfluences( const uint32_t* joints, const float* weights, size_t count )
+    {
+        struct Influence
+        {
+            uint32_t m_joint;
+            float m_weight;
+        };
+
+        Influence top[MaxSkinInfluences] = {};
+        size_t kept = 0;
+        for ( size_t i = 0; i < count; ++i )
+        {
+            if ( !( weights[i] > 0.f ) )
+                continue;
+
+            // Insertion into the sorted top list, dropping the smallest once it is full.
+            size_t slot = std::min<size_t>( kept, MaxSkinInfluences - 1 );
+            if ( kept == MaxSkinInfluences && weights[i] <= top[slot].m_weight )
+                continue;
+            while ( slot > 0 && top[slot - 1].m_weight < weights[i] )
+            {
+                top[slot] = top[slot - 1];
+                --slot;
+            }
+            top[slot] = { joints[i], weights[i] };
+            kept = std::min<size_t>( kept + 1, MaxSkinInfluences );
+        }
+
+        VertexSkin skin = {};
+        if ( kept == 0 )
+        {
+            skin.m_weights[0] = 255;
+            return skin;
+        }
+
+        float total = 0.f;
+        for ( size_t i = 0; i < kept; ++i )
+            total += top[i].m_weight;
+
+        int sum = 0;
+        for ( size_t i = 0; i < kept; ++i )
+        {
+            skin.m_joints[i] = static_cast<uint8_t>( top[i].m_joint );
+            skin.m_weights[i] = static_cast<uint8_t>( std::lrint( top[i].m_weight / total * 255.f ) );
+            sum += skin.m_weights[i];
+        }
+        skin.m_weights[0] = static_cast<uint8_t>( skin.m_weights[0] + 255 - sum );
+        return skin;
+    }
+
+    void BuildSkinningPalette( const MeshSkin& skin, const std::vector<XMFLOAT4X4>& nodeWorldTransforms, XMFLOAT4X4* palette )
+    {
+        for ( size_t joint = 0; joint < skin.m_jointNodes.size(); ++joint )
+        {
+            const XMMATRIX inverseBind = XMLoadFloat4x4( &skin.m_inverseBindMatrices[joint] );
+            const XMMATRIX world = XMLoadFloat4x4( &nodeWorldTransforms[skin.m_jointNodes[joint]] );
+            XMStoreFloat4x4( &palette[joint], XMMatrixMultiply( inverseBind, world ) );
+        }
+    }
+}
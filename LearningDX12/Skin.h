@@ -0,0 +1,69 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Olex
+{
+    constexpr uint32_t MaxSkinInfluences = 4;
+    // Palette entries addressable by the 8-bit joint indices of VertexSkin.
+    constexpr uint32_t MaxSkinJoints = 256;
+
+    /**
+     * Joint influences of one vertex.
+     *
+     * Input layout: BLENDINDICES DXGI_FORMAT_R8G8B8A8_UINT, BLENDWEIGHT DXGI_FORMAT_R8G8B8A8_UNORM.
+     * Joints index MeshSkin::m_jointNodes. Influences come strongest first and the weights sum to exactly 255.
+     */
+    struct VertexSkin
+    {
+        uint8_t m_joints[MaxSkinInfluences];
+        uint8_t m_weights[MaxSkinInfluences];
+    };
+
+    static_assert( sizeof( VertexSkin ) == 8, "VertexSkin must match the skinned input layout" );
+
+    /**
+     * Skinning data of one mesh, empty for rigid meshes.
+     */
+    struct MeshSkin
+    {
+        // One per vertex, parallel to Mesh::m_vertices.
+        std::vector<VertexSkin> m_vertices;
+        // Joint palette: the scene node driving each entry.
+        std::vector<uint32_t> m_jointNodes;
+        // Per palette entry, from the mesh space at bind time to the space of the joint.
+        std::vector<DirectX::XMFLOAT4X4> m_inverseBindMatrices;
+
+        [[nodiscard]] bool IsSkinned() const { return !m_vertices.empty(); }
+    };
+
+    /**
+     * Every scene node used as a joint by any mesh, in scene order so parents come first.
+     */
+    struct Skeleton
+    {
+        static constexpr int32_t NoParent = -1;
+
+        std::vector<uint32_t> m_nodes;
+        // Closest ancestor that is itself a joint, or NoParent.
+        std::vector<int32_t> m_parents;
+        // World transform of each joint in the bind pose.
+        std::vector<DirectX::XMFLOAT4X4> m_bindPose;
+    };
+
+    /**
+     * Keeps the 4 largest of count influences, renormalizes them and quantizes the weights
+     * to 8 bits. The rounding remainder goes to the largest weight, so the sum stays exactly 255.
+     * A vertex without influences is bound fully to palette entry 0.
+     */
+    VertexSkin PackInfluences( const uint32_t* joints, const float* weights, size_t count );
+
+    /**
+     * Skinning matrices of a mesh for the current pose: inverse bind matrix times the world
+     * transform of the joint node, so skinned vertices come out in world space.
+     */
+    void BuildSkinningPalette( const MeshSkin& skin, const std::vector<DirectX::XMFLOAT4X4>& nodeWorldTransforms, DirectX::XMFLOAT4X4* palette );
+}
@@ -0,0 +1,179 @@
+#include "SkinningKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "ParallelFor.h"
+
+namespace Olex
+{
+    namespace
+    {
+        // Vertices per SkinJobs work item, enough to amortize the scheduling.
+        constexpr size_t ChunkSize = 4096;
+        constexpr float WeightScale = 1.f / 255.f;
+
+        static_assert( offsetof( Mesh::VertexInfo, m_uv ) == 12 && offsetof( Mesh::VertexInfo, m_normal ) == 20,
+            "Skinning stores positions 4 floats wide before writing the uvs" );
+
+        // Stores xyz of value to destination without touching the float after it.
+        void StoreFloat3( float* destination, __m128 value )
+        {
+            _mm_storel_pi( reinterpret_cast<__m64*>( destination ), value );
+            _mm_store_ss( destination + 2, _mm_shuffle_ps( value, value, _MM_SHUFFLE( 2, 2, 2, 2 ) ) );
+        }
+
+        __m128 NormalizeFloat3( __m128 value )
+        {
+            const __m128 squared = _mm_mul_ps( value, value );
+            const __m128 yy = _mm_shuffle_ps( squared, squared, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+            const __m128 zz = _mm_shuffle_ps( squared, squared, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+            const __m128 lengthSquared = _mm_add_ss( _mm_add_ss( squared, yy ), zz );
+            const __m128 length = _mm_sqrt_ps( _mm_shuffle_ps( lengthSquared, lengthSquared, 0 ) );
+            return _mm_div_ps( value, _mm_max_ps( length, _mm_set1_ps( 1e-20f ) ) );
+        }
+
+        void WriteVertex( const Mesh::VertexInfo& input, __m128 position, __m128 normal, Mesh::VertexInfo& output )
+        {
+            // The wide store spills into m_uv, which is written right after; read it first in case output is input.
+            const DirectX::XMFLOAT2 uv = input.m_uv;
+            _mm_storeu_ps( &output.m_position.x, position );
+            output.m_uv = uv;
+            StoreFloat3( &output.m_normal.x, NormalizeFloat3( normal ) );
+        }
+
+        void SkinRange( const SkinningJob& job, size_t begin, size_t end )
+        {
+            const float* palette = &job.m_palette[0].m[0][0];
+
+            for ( size_t i = begin; i < end; ++i )
+            {
+                const Mesh::VertexInfo& vertex = job.m_vertices[i];
+                const VertexSkin& skin = job.m_skin[i];
+
+#if defined(__AVX2__)
+                // Rows 0|1 and 2|3 of the blended matrix, two rows per register.
+                __m256 rows01 = _mm256_setzero_ps();
+                __m256 rows23 = _mm256_setzero_ps();
+                for ( uint32_t influence = 0; influence < MaxSkinInfluences; ++influence )
+                {
+                    const __m256 weight = _mm256_set1_ps( skin.m_weights[influence] * WeightScale );
+                    const float* matrix = palette + skin.m_joints[influence] * 16;
+                    rows01 = _mm256_fmadd_ps( weight, _mm256_loadu_ps( matrix + 0 ), rows01 );
+                    rows23 = _mm256_fmadd_ps( weight, _mm256_loadu_ps( matrix + 8 ), rows23 );
+                }
+
+                // [x * r0 | y * r1] + [z * r2 | 1 * r3], then the two halves summed.
+                const __m256 xy = _mm256_setr_m128( _mm_set1_ps( vertex.m_position.x ), _mm_set1_ps( vertex.m_position.y ) );
+                const __m256 z1 = _mm256_setr_m128( _mm_set1_ps( vertex.m_position.z ), _mm_set1_ps( 1.f ) );
+                const __m256 p = _mm256_fmadd_ps( xy, rows01, _mm256_mul_ps( z1, rows23 ) );
+                const __m128 position = _mm_add_ps( _mm256_castps256_ps128( p ), _mm256_extractf128_ps( p, 1 ) );
+
+                const __m256 nxy = _mm256_setr_m128( _mm_set1_ps( vertex.m_normal.x ), _mm_set1_ps( vertex.m_normal.y ) );
+                const __m256 nz0 = _mm256_setr_m128( _mm_set1_ps( vertex.m_normal.z ), _mm_setzero_ps() );
+                const __m256 n = _mm256_fmadd_ps( nxy, rows01, _mm256_mul_ps( nz0, rows23 ) );
+                const __m128 normal = _mm_add_ps( _mm256_castps256_ps128( n ), _mm256_extractf128_ps( n, 1 ) );
+#else
+                __m128 row0 = _mm_setzero_ps();
+                __m128 row1 = _mm_setzero_ps();
+                __m128 row2 = _mm_setzero_ps();
+                __m128 row3 = _mm_setzero_ps();
+                for ( uint32_t influence = 0; influence < MaxSkinInfluences; ++influence )
+                {
+                    const __m128 weight = _mm_set1_ps( skin.m_weights[influence] * WeightScale );
+                    const float* matrix = palette + skin.m_joints[influence] * 16;
+                    row0 = _mm_add_ps( row0, _mm_mul_ps( weight, _mm_loadu_ps( matrix + 0 ) ) );
+                    row1 = _mm_add_ps( row1, _mm_mul_ps( weight, _mm_loadu_ps( matrix + 4 ) ) );
+                    row2 = _mm_add_ps( row2, _mm_mul_ps( weight, _mm_loadu_ps( matrix + 8 ) ) );
+                    row3 = _mm_add_ps( row3, _mm_mul_ps( weight, _mm_loadu_ps( matrix + 12 ) ) );
+                }
+
+                const __m128 position = _mm_add_ps(
+                    _mm_add_ps( _mm_mul_ps( _mm_set1_ps( vertex.m_position.x ), row0 ), _mm_mul_ps( _mm_set1_ps( vertex.m_position.y ), row1 ) ),
+                    _mm_add_ps( _mm_mul_ps( _mm_set1_ps( vertex.m_position.z ), row2 ), row3 ) );
+                const __m128 normal = _mm_add_ps(
+                    _mm_add_ps( _mm_mul_ps( _mm_set1_ps( vertex.m_normal.x ), row0 ), _mm_mul_ps( _mm_set1_ps( vertex.m_normal.y ), row1 ) ),
+                    _mm_mul_ps( _mm_set1_ps( vertex.m_normal.z ), row2 ) );
+#endif
+
+                WriteVertex( vertex, position, normal, job.m_output[i] );
+            }
+        }
+    }
+
+    void SkinVertices( const SkinningJob& job )
+    {
+        SkinRange( job, 0, job.m_vertexCount );
+    }
+
+    void SkinVerticesReference( const SkinningJob& job )
+    {
+        for ( size_t i = 0; i < job.m_vertexCount; ++i )
+        {
+            const Mesh::VertexInfo& vertex = job.m_vertices[i];
+            const VertexSkin& skin = job.m_skin[i];
+
+            float blended[4][4] = {};
+            for ( uint32_t influence = 0; influence < MaxSkinInfluences; ++influence )
+            {
+                const float weight = skin.m_weights[influence] * WeightScale;
+                const DirectX::XMFLOAT4X4& matrix = job.m_palette[skin.m_joints[influence]];
+                for ( int row = 0; row < 4; ++row )
+                {
+                    for ( int column = 0; column < 4; ++column )
+                        blended[row][column] += weight * matrix.m[row][column];
+                }
+            }
+
+            const DirectX::XMFLOAT3& p = vertex.m_position;
+            const DirectX::XMFLOAT3& n = vertex.m_normal;
+            float position[3];
+            float normal[3];
+            for ( int column = 0; column < 3; ++column )
+            {
+                position[column] = p.x * blended[0][column] + p.y * blended[1][column] + p.z * blended[2][column] + blended[3][column];
+                normal[column] = n.x * blended[0][column] + n.y * blended[1][column] + n.z * blended[2][column];
+            }
+
+            const float length = std::sqrt( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+            const float invLength = 1.f / std::max( length, 1e-20f );
+
+            Mesh::VertexInfo& output = job.m_output[i];
+            output.m_position = { position[0], position[1], position[2] };
+            output.m_uv = vertex.m_uv;
+            output.m_normal = { normal[0] * invLength, normal[1] * invLength, normal[2] * invLength };
+        }
+    }
+
+    void SkinJobs( const SkinningJob* jobs, size_t jobCount )
+    {
+        struct Chunk
+        {
+            const SkinningJob* m_job;
+            size_t m_begin;
+            size_t m_end;
+        };
+
+        // Called every frame: the chunk list keeps its capacity and the work goes to the persistent
+        // pool, so a call allocates nothing and starts no thread.
+        thread_local std::vector<Chunk> chunks;
+        chunks.clear();
+        for ( size_t job = 0; job < jobCount; ++job )
+        {
+            for ( size_t begin = 0; begin < jobs[job].m_vertexCount; begin += ChunkSize )
+                chunks.push_back( { &jobs[job], begin, std::min( begin + ChunkSize, jobs[job].m_vertexCount ) } );
+        }
+
+        const std::vector<Chunk>& work = chunks;
+        ParallelFor( work.size(), [&work]( size_t i )
+        {
+            SkinRange( *work[i].m_job, work[i].m_begin, work[i].m_end );
+        } );
+    }
+}
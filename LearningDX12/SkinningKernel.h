@@ -0,0 +1,33 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    /**
+     * One mesh instance to deform: bind-pose vertices in, skinned vertices out.
+     * Positions and normals are blended by linear blend skinning, uvs are copied.
+     */
+    struct SkinningJob
+    {
+        const Mesh::VertexInfo* m_vertices = nullptr;
+        const VertexSkin* m_skin = nullptr;
+        size_t m_vertexCount = 0;
+        // Affine matrices from BuildSkinningPalette, indexed by VertexSkin::m_joints.
+        const DirectX::XMFLOAT4X4* m_palette = nullptr;
+        Mesh::VertexInfo* m_output = nullptr;
+    };
+
+    // Vectorized kernel: blends the 4x4 rows with SSE2, or two rows per register with AVX2 and FMA when the build targets it.
+    void SkinVertices( const SkinningJob& job );
+
+    // Plain scalar version of the same math, the reference the SIMD kernel is checked against.
+    void SkinVerticesReference( const SkinningJob& job );
+
+    // Runs every job through SkinVertices in chunks of a few thousand vertices, on the shared ThreadPool.
+    void SkinJobs( const SkinningJob* jobs, size_t jobCount );
+}
@@ -0,0 +1,138 @@
+#include "SubmeshSplitter.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    std::vector<Submesh> SplitSubmeshes( Mesh& mesh, size_t maxVertices )
+    {
+        if ( maxVertices < 3 )
+        {
+            throw std::invalid_argument( "A submesh needs room for at least one triangle" );
+        }
+
+        std::vector<Submesh> submeshes;
+        const size_t triangleCount = mesh.m_indices.size();
+        if ( triangleCount == 0 )
+            return submeshes;
+
+        if ( mesh.m_vertices.size() <= maxVertices )
+        {
+            Submesh submesh;
+            submesh.m_indexCount = static_cast<uint32_t>( triangleCount * 3 );
+            submesh.m_vertexCount = static_cast<uint32_t>( mesh.m_vertices.size() );
+            submeshes.push_back( submesh );
+            return submeshes;
+        }
+
+        constexpr uint32_t Unassigned = ~0u;
+
+        // Maps an original vertex to its copy in the current submesh; vertexSubmesh tells
+        // which submesh the mapping belongs to, so nothing needs clearing between submeshes.
+        std::vector<uint32_t> remap( mesh.m_vertices.size(), Unassigned );
+        std::vector<uint32_t> vertexSubmesh( mesh.m_vertices.size(), Unassigned );
+
+        std::vector<Mesh::VertexInfo> vertices;
+        vertices.reserve( mesh.m_vertices.size() + mesh.m_vertices.size() / 16 );
+        std::vector<uint32_t> source;
+        source.reserve( vertices.capacity() );
+
+        auto* indices = reinterpret_cast<uint32_t*>( mesh.m_indices.data() );
+
+        Submesh current;
+        for ( size_t triangle = 0; triangle < triangleCount; ++triangle )
+        {
+            const uint32_t* corners = indices + triangle * 3;
+            const auto submeshIndex = static_cast<uint32_t>( submeshes.size() );
+
+            uint32_t newVertices = 0;
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                // Count a vertex repeated within the triangle only once.
+                const bool repeated = ( corner > 0 && corners[corner] == corners[0] ) || ( corner > 1 && corners[corner] == corners[1] );
+                if ( !repeated && vertexSubmesh[corners[corner]] != submeshIndex )
+                    ++newVertices;
+            }
+
+            if ( current.m_vertexCount + newVertices > maxVertices )
+            {
+                submeshes.push_back( current );
+
+                current = Submesh();
+                current.m_startIndex = static_cast<uint32_t>( triangle * 3 );
+                current.m_baseVertex = static_cast<uint32_t>( vertices.size() );
+            }
+
+            const auto currentIndex = static_cast<uint32_t>( submeshes.size() );
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                const uint32_t original = corners[corner];
+                if ( vertexSubmesh[original] != currentIndex )
+                {
+                    vertexSubmesh[original] = currentIndex;
+                    remap[original] = static_cast<uint32_t>( vertices.size() );
+                    vertices.push_back( mesh.m_vertices[original] );
+                    source.push_back( original );
+                    ++current.m_vertexCount;
+                }
+            }
+
+            for ( int corner = 0; corner < 3; ++corner )
+                indices[triangle * 3 + corner] = remap[corners[corner]];
+
+            current.m_indexCount += 3;
+        }
+
+        submeshes.push_back( current );
+        mesh.m_vertices.swap( vertices );
+        RemapVertexAttributes( mesh, source );
+        return submeshes;
+    }
+
+    IndexFormat SelectIndexFormat( const std::vector<Submesh>& submeshes )
+    {
+        for ( const Submesh& submesh : submeshes )
+        {
+            if ( submesh.m_vertexCount > MaxIndex16Vertices )
+                return IndexFormat::UInt32;
+        }
+
+        return IndexFormat::UInt16;
+    }
+
+    std::vector<uint8_t> PackIndices( const std::vector<DirectX::XMINT3>& triangles, const std::vector<Submesh>& submeshes, IndexFormat format )
+    {
+        const auto* indices = reinterpret_cast<const uint32_t*>( triangles.data() );
+        const size_t indexCount = triangles.size() * 3;
+        const size_t indexSize = static_cast<size_t>( format );
+
+        std::vector<uint8_t> packed( indexCount * indexSize );
+
+        for ( const Submesh& submesh : submeshes )
+        {
+            for ( uint32_t i = submesh.m_startIndex; i < submesh.m_startIndex + submesh.m_indexCount; ++i )
+            {
+                const uint32_t local = indices[i] - submesh.m_baseVertex;
+                if ( local >= submesh.m_vertexCount )
+                {
+                    throw std::out_of_range( "Index outside of its submesh" );
+                }
+
+                if ( format == IndexFormat::UInt16 )
+                {
+                    const auto value = static_cast<uint16_t>( local );
+                    std::memcpy( packed.data() + i * indexSize, &value, sizeof( value ) );
+                }
+                else
+                {
+                    std::memcpy( packed.data() + i * indexSize, &local, sizeof( local ) );
+                }
+            }
+        }
+
+        return packed;
+    }
+}
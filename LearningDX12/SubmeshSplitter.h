@@ -0,0 +1,51 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Olex
+{
+    struct Mesh;
+
+    // Width of the indices a mesh is uploaded with; the value is the size of one index in bytes.
+    enum class IndexFormat : uint32_t
+    {
+        UInt16 = 2,
+        UInt32 = 4,
+    };
+
+    // Vertices a submesh may reference so that its indices, relative to m_baseVertex, fit 16 bits.
+    constexpr size_t MaxIndex16Vertices = 65536;
+
+    /**
+     * A range of a mesh drawn with a single DrawIndexedInstanced, using m_startIndex as
+     * StartIndexLocation and m_baseVertex as BaseVertexLocation. Every index of the range
+     * lies in [m_baseVertex, m_baseVertex + m_vertexCount) of Mesh::m_vertices.
+     */
+    struct Submesh
+    {
+        uint32_t m_startIndex = 0;
+        uint32_t m_indexCount = 0;
+        uint32_t m_baseVertex = 0;
+        uint32_t m_vertexCount = 0;
+    };
+
+    /**
+     * Splits the mesh into submeshes referencing at most maxVertices vertices each and returns them.
+     *
+     * A mesh that already fits comes back as a single submesh and is left untouched. Otherwise
+     * triangles are taken in order and the vertex buffer is rebuilt so that every submesh owns a
+     * contiguous window of it, duplicating the vertices shared across a split. Indices in
+     * Mesh::m_indices stay absolute, so the later import stages need not know about submeshes.
+     */
+    std::vector<Submesh> SplitSubmeshes( Mesh& mesh, size_t maxVertices = MaxIndex16Vertices );
+
+    // UInt16 when every submesh fits a 16-bit index range.
+    IndexFormat SelectIndexFormat( const std::vector<Submesh>& submeshes );
+
+    // Writes the indices of each submesh relative to its base vertex, in the given format.
+    // The result is the index buffer ready for upload, sized indexCount * format bytes.
+    std::vector<uint8_t> PackIndices( const std::vector<DirectX::XMINT3>& triangles, const std::vector<Submesh>& submeshes, IndexFormat format );
+}
@@ -0,0 +1,246 @@
+#include "TangentGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ParallelFor.h"
+
+namespace Olex
+{
+    namespace
+    {
+        // Triangles or vertices per parallel work item; smaller meshes run on the calling thread.
+        constexpr size_t ChunkSize = 16384;
+
+        struct Float3
+        {
+            float x, y, z;
+        };
+
+        Float3 operator+ ( const Float3& a, const Float3& b ) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+        Float3 operator- ( const Float3& a, const Float3& b ) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+        Float3 operator* ( const Float3& a, float s ) { return { a.x * s, a.y * s, a.z * s }; }
+        float Dot( const Float3& a, const Float3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        Float3 Cross( const Float3& a, const Float3& b ) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+        Float3 ToFloat3( const DirectX::XMFLOAT3& v ) { return { v.x, v.y, v.z }; }
+
+        // Same threshold as MikkTSpace's NotZero.
+        bool NotZero( float value ) { return std::fabs( value ) > 1e-20f; }
+
+        // Normalizes v, leaving it zero when it has no length.
+        Float3 Normalize( const Float3& v )
+        {
+            const float length = std::sqrt( Dot( v, v ) );
+            return NotZero( length ) ? v * ( 1.f / length ) : Float3{ 0.f, 0.f, 0.f };
+        }
+
+        // Removes the component of v along the unit normal n.
+        Float3 ProjectOnPlane( const Float3& v, const Float3& n )
+        {
+            return Normalize( v - n * Dot( n, v ) );
+        }
+
+        enum class UVOrientation : uint8_t
+        {
+            Degenerate,
+            Preserving,
+            Mirrored,
+        };
+
+        struct TriangleFrame
+        {
+            // Unit direction of increasing u in object space, zero if the uvs or the triangle are degenerate.
+            Float3 m_tangent;
+            UVOrientation m_orientation;
+        };
+
+        TriangleFrame ComputeTriangleFrame( const Mesh& mesh, const DirectX::XMINT3& triangle )
+        {
+            const Mesh::VertexInfo& v0 = mesh.m_vertices[triangle.x];
+            const Mesh::VertexInfo& v1 = mesh.m_vertices[triangle.y];
+            const Mesh::VertexInfo& v2 = mesh.m_vertices[triangle.z];
+
+            const Float3 d1 = ToFloat3( v1.m_position ) - ToFloat3( v0.m_position );
+            const Float3 d2 = ToFloat3( v2.m_position ) - ToFloat3( v0.m_position );
+            const float t21x = v1.m_uv.x - v0.m_uv.x;
+            const float t21y = v1.m_uv.y - v0.m_uv.y;
+            const float t31x = v2.m_uv.x - v0.m_uv.x;
+            const float t31y = v2.m_uv.y - v0.m_uv.y;
+
+            TriangleFrame frame = { { 0.f, 0.f, 0.f }, UVOrientation::Degenerate };
+            const float signedAreaUV = t21x * t31y - t21y * t31x;
+            if ( !NotZero( signedAreaUV ) )
+                return frame;
+
+            // The tangent does not depend on the corner order, but the orientation does: MikkTSpace
+            // is fed the counter-clockwise source order, the reverse of the clockwise triangles here.
+            frame.m_orientation = signedAreaUV < 0.f ? UVOrientation::Preserving : UVOrientation::Mirrored;
+            const float sign = signedAreaUV > 0.f ? 1.f : -1.f;
+            frame.m_tangent = Normalize( d1 * t31y - d2 * t21y ) * sign;
+            return frame;
+        }
+
+        /**
+         * Gives every vertex used by both uv orientations a copy for its mirrored triangles,
+         * as the two sides need opposite bitangent signs. Degenerate triangles follow either side.
+         */
+        uint32_t SplitMirroredVertices( Mesh& mesh, const std::vector<TriangleFrame>& frames )
+        {
+            constexpr uint8_t UsedPreserving = 1;
+            constexpr uint8_t UsedMirrored = 2;
+
+            std::vector<uint8_t> usage( mesh.m_vertices.size(), 0 );
+            for ( size_t triangle = 0; triangle < mesh.m_indices.size(); ++triangle )
+            {
+                if ( frames[triangle].m_orientation == UVOrientation::Degenerate )
+                    continue;
+
+                const uint8_t flag = frames[triangle].m_orientation == UVOrientation::Preserving ? UsedPreserving : UsedMirrored;
+                const DirectX::XMINT3& t = mesh.m_indices[triangle];
+                usage[t.x] |= flag;
+                usage[t.y] |= flag;
+                usage[t.z] |= flag;
+            }
+
+            constexpr uint32_t NoCopy = ~0u;
+            std::vector<uint32_t> mirroredCopy( mesh.m_vertices.size(), NoCopy );
+            std::vector<uint32_t> source( mesh.m_vertices.size() );
+            for ( size_t vertex = 0; vertex < source.size(); ++vertex )
+                source[vertex] = static_cast<uint32_t>( vertex );
+
+            for ( size_t vertex = 0; vertex < usage.size(); ++vertex )
+            {
+                if ( usage[vertex] == ( UsedPreserving | UsedMirrored ) )
+                {
+                    mirroredCopy[vertex] = static_cast<uint32_t>( mesh.m_vertices.size() );
+                    mesh.m_vertices.push_back( mesh.m_vertices[vertex] );
+                    source.push_back( static_cast<uint32_t>( vertex ) );
+                }
+            }
+
+            const auto splitCount = static_cast<uint32_t>( source.size() - usage.size() );
+            if ( splitCount == 0 )
+                return 0;
+
+            RemapVertexAttributes( mesh, source );
+
+            for ( size_t triangle = 0; triangle < mesh.m_indices.size(); ++triangle )
+            {
+                if ( frames[triangle].m_orientation != UVOrientation::Mirrored )
+                    continue;
+
+                DirectX::XMINT3& t = mesh.m_indices[triangle];
+                for ( int32_t* index : { &t.x, &t.y, &t.z } )
+                {
+                    if ( mirroredCopy[*index] != NoCopy )
+                        *index = static_cast<int32_t>( mirroredCopy[*index] );
+                }
+            }
+
+            return splitCount;
+        }
+
+        // Any unit vector perpendicular to n.
+        Float3 Perpendicular( const Float3& n )
+        {
+            const Float3 axis = std::fabs( n.x ) < 0.9f ? Float3{ 1.f, 0.f, 0.f } : Float3{ 0.f, 1.f, 0.f };
+            return Normalize( Cross( Cross( n, axis ), n ) );
+        }
+    }
+
+    TangentStatistics GenerateTangents( Mesh& mesh )
+    {
+        TangentStatistics statistics;
+        const size_t triangleCount = mesh.m_indices.size();
+
+        std::vector<TriangleFrame> frames( triangleCount );
+        ParallelFor( ( triangleCount + ChunkSize - 1 ) / ChunkSize, [&mesh, &frames, triangleCount]( size_t chunk )
+        {
+            const size_t end = std::min( ( chunk + 1 ) * ChunkSize, triangleCount );
+            for ( size_t triangle = chunk * ChunkSize; triangle < end; ++triangle )
+                frames[triangle] = ComputeTriangleFrame( mesh, mesh.m_indices[triangle] );
+        } );
+
+        statistics.m_degenerateTriangles = static_cast<uint32_t>( std::count_if( frames.begin(), frames.end(),
+            []( const TriangleFrame& frame ) { return frame.m_orientation == UVOrientation::Degenerate; } ) );
+        statistics.m_splitVertices = SplitMirroredVertices( mesh, frames );
+
+        // Corners grouped per vertex, so each vertex gathers its sum without sharing writes.
+        const size_t vertexCount = mesh.m_vertices.size();
+        std::vector<uint32_t> cornerStart( vertexCount + 1, 0 );
+        for ( const DirectX::XMINT3& t : mesh.m_indices )
+        {
+            ++cornerStart[t.x + 1];
+            ++cornerStart[t.y + 1];
+            ++cornerStart[t.z + 1];
+        }
+        for ( size_t vertex = 0; vertex < vertexCount; ++vertex )
+            cornerStart[vertex + 1] += cornerStart[vertex];
+
+        // Each entry is triangle * 3 + position of the vertex in the triangle.
+        std::vector<uint32_t> corners( cornerStart[vertexCount] );
+        {
+            std::vector<uint32_t> cursor( cornerStart.begin(), cornerStart.end() - 1 );
+            for ( size_t triangle = 0; triangle < triangleCount; ++triangle )
+            {
+                const DirectX::XMINT3& t = mesh.m_indices[triangle];
+                corners[cursor[t.x]++] = static_cast<uint32_t>( triangle * 3 + 0 );
+                corners[cursor[t.y]++] = static_cast<uint32_t>( triangle * 3 + 1 );
+                corners[cursor[t.z]++] = static_cast<uint32_t>( triangle * 3 + 2 );
+            }
+        }
+
+        mesh.m_tangents.resize( vertexCount );
+        std::vector<uint8_t> fallback( vertexCount, 0 );
+        ParallelFor( ( vertexCount + ChunkSize - 1 ) / ChunkSize, [&]( size_t chunk )
+        {
+            const size_t end = std::min( ( chunk + 1 ) * ChunkSize, vertexCount );
+            for ( size_t vertex = chunk * ChunkSize; vertex < end; ++vertex )
+            {
+                const Float3 n = Normalize( ToFloat3( mesh.m_vertices[vertex].m_normal ) );
+                const Float3 p0 = ToFloat3( mesh.m_vertices[vertex].m_position );
+                Float3 sum = { 0.f, 0.f, 0.f };
+                float sign = 1.f;
+
+                for ( uint32_t c = cornerStart[vertex]; c < cornerStart[vertex + 1]; ++c )
+                {
+                    const uint32_t triangle = corners[c] / 3;
+                    const TriangleFrame& frame = frames[triangle];
+                    if ( frame.m_orientation == UVOrientation::Degenerate )
+                        continue;
+
+                    sign = frame.m_orientation == UVOrientation::Preserving ? 1.f : -1.f;
+
+                    const Float3 tangent = ProjectOnPlane( frame.m_tangent, n );
+                    if ( !NotZero( Dot( tangent, tangent ) ) )
+                        continue;
+
+                    // Angle of the corner, measured between its edges projected onto the normal plane.
+                    const DirectX::XMINT3& t = mesh.m_indices[triangle];
+                    const int32_t indices[3] = { t.x, t.y, t.z };
+                    const uint32_t position = corners[c] % 3;
+                    const Float3 p1 = ToFloat3( mesh.m_vertices[indices[( position + 1 ) % 3]].m_position );
+                    const Float3 p2 = ToFloat3( mesh.m_vertices[indices[( position + 2 ) % 3]].m_position );
+                    const Float3 e1 = ProjectOnPlane( p1 - p0, n );
+                    const Float3 e2 = ProjectOnPlane( p2 - p0, n );
+                    const float angle = std::acos( std::min( std::max( Dot( e1, e2 ), -1.f ), 1.f ) );
+
+                    sum = sum + tangent * angle;
+                }
+
+                Float3 tangent = Normalize( sum );
+                if ( !NotZero( Dot( tangent, tangent ) ) )
+                {
+                    tangent = Perpendicular( n );
+                    fallback[vertex] = 1;
+                }
+
+                mesh.m_tangents[vertex] = { tangent.x, tangent.y, tangent.z, sign };
+            }
+        } );
+
+        statistics.m_fallbackVertices = static_cast<uint32_t>( std::count( fallback.begin(), fallback.end(), uint8_t( 1 ) ) );
+        return statistics;
+    }
+}
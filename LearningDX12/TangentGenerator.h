@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    struct TangentStatistics
+    {
+        // Vertices duplicated because mirrored and unmirrored triangles share them.
+        uint32_t m_splitVertices = 0;
+        // Triangles whose uvs cover no area, they give no direction to their corners.
+        uint32_t m_degenerateTriangles = 0;
+        // Vertices with no usable uv direction, given an arbitrary tangent perpendicular to the normal.
+        uint32_t m_fallbackVertices = 0;
+    };
+
+    /**
+     * Fills mesh.m_tangents with the tangent frames MikkTSpace produces, so normal maps baked
+     * against MikkTSpace shade without seams:
+     *   - the tangent of a triangle is its direction of increasing u, flipped where the uvs are mirrored;
+     *   - every corner projects it onto the plane of its vertex normal and weights it by the corner angle;
+     *   - the bitangent sign is the uv orientation, a vertex used by both orientations is split in two.
+     * MikkTSpace groups the corners of a vertex per edge-connected fan, here they are grouped per
+     * welded vertex; the two agree wherever the fans around a vertex are connected.
+     *
+     * Run it right after welding, as it may append vertices; the later stages carry m_tangents along.
+     * Meshes above a few ten thousand triangles are processed in chunks across threads.
+     */
+    TangentStatistics GenerateTangents( Mesh& mesh );
+}
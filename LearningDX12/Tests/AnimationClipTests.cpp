@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "AnimationClip.h"
+#include "SceneCache.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+using namespace Olex::Test;
+using DirectX::XMFLOAT3;
+using DirectX::XMFLOAT4;
+
+namespace
+{
+    float Dot( const XMFLOAT4& a, const XMFLOAT4& b ) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+    // Angle between two rotations, from the vector part of their relative rotation for precision near zero.
+    float RotationAngle( const XMFLOAT4& a, const XMFLOAT4& b )
+    {
+        const float x = a.w * b.x - b.w * a.x - ( a.y * b.z - a.z * b.y );
+        const float y = a.w * b.y - b.w * a.y - ( a.z * b.x - a.x * b.z );
+        const float z = a.w * b.z - b.w * a.z - ( a.x * b.y - a.y * b.x );
+        return 2.f * std::atan2( std::sqrt( x * x + y * y + z * z ), std::fabs( Dot( a, b ) ) );
+    }
+
+    XMFLOAT4 AxisAngle( XMFLOAT3 axis, float angle )
+    {
+        const float length = std::sqrt( axis.x * axis.x + axis.y * axis.y + axis.z * axis.z );
+        const float s = std::sin( angle * 0.5f ) / length;
+        return { axis.x * s, axis.y * s, axis.z * s, std::cos( angle * 0.5f ) };
+    }
+
+    XMFLOAT4 RandomRotation( Random& random )
+    {
+        return AxisAngle( { random.Range( -1.f, 1.f ), random.Range( -1.f, 1.f ), random.Range( -1.f, 1.f ) + 0.01f }, random.Range( -Pi, Pi ) );
+    }
+
+    /**
+     * trackCount tracks of smooth motion over frameCount frames: translations over about
+     * translationRange units, rotations around a fixed axis per track, scales around 1. The last
+     * track holds still.
+     */
+    BakedClip MakeClip( uint32_t trackCount, uint32_t frameCount, float translationRange = 2.f )
+    {
+        BakedClip baked;
+        baked.m_name = "Synthetic";
+        baked.m_frameCount = frameCount;
+        Random random( trackCount * 31 + frameCount );
+        for ( uint32_t track = 0; track < trackCount; ++track )
+        {
+            baked.m_nodes.push_back( track );
+            const bool still = track + 1 == trackCount;
+            const XMFLOAT3 axis = { random.Range( -1.f, 1.f ), random.Range( 0.1f, 1.f ), random.Range( -1.f, 1.f ) };
+            const float speed = random.Range( 0.5f, 2.f );
+            for ( uint32_t frame = 0; frame < frameCount; ++frame )
+            {
+                const float time = still ? 0.f : frame / 30.f;
+                TransformSample sample;
+                sample.m_translation = { translationRange * 0.5f * std::sin( time * speed ), translationRange * 0.25f * time * time / 4.f, 0.3f * std::cos( time * 3.f ) };
+                sample.m_rotation = AxisAngle( axis, time * speed * 2.f );
+                sample.m_scale = { 1.f + 0.2f * std::sin( time ), 1.f, 1.f - 0.1f * std::sin( time * 2.f ) };
+                baked.m_samples.push_back( sample );
+            }
+        }
+        return baked;
+    }
+
+    // Scalar decode of key index key of a translation or scale channel, straight from the clip layout.
+    XMFLOAT3 DecodeChannelKey( const AnimationClip& clip, const AnimationTrack& track, bool translation, uint32_t key )
+    {
+        const AnimationChannel& channel = translation ? track.m_translation : track.m_scale;
+        const size_t value = ( size_t( channel.m_firstValue ) + key ) * 3;
+        if ( track.m_floatChannels & ( translation ? AnimationTrack::FloatTranslations : AnimationTrack::FloatScales ) )
+        {
+            const float* floats = translation ? clip.m_floatTranslations.data() : clip.m_floatScales.data();
+            return { floats[value], floats[value + 1], floats[value + 2] };
+        }
+
+        const uint16_t* encoded = translation ? clip.m_translations.data() : clip.m_scales.data();
+        const XMFLOAT3& offset = translation ? track.m_translationOffset : track.m_scaleOffset;
+        const XMFLOAT3& range = translation ? track.m_translationRange : track.m_scaleRange;
+        return { offset.x + encoded[value] / 65535.f * range.x, offset.y + encoded[value + 1] / 65535.f * range.y, offset.z + encoded[value + 2] / 65535.f * range.z };
+    }
+
+    // Keys around frame and the blend between them, by linear search.
+    void FindSpan( const AnimationClip& clip, const AnimationChannel& channel, float frame, uint32_t& a, uint32_t& b, float& alpha )
+    {
+        const uint16_t* keys = &clip.m_keyFrames[channel.m_firstKey];
+        a = 0;
+        while ( a + 1 < channel.m_keyCount && keys[a + 1] <= frame )
+            ++a;
+        b = std::min( a + 1, channel.m_keyCount - 1 );
+        alpha = a == b ? 0.f : ( frame - keys[a] ) / float( keys[b] - keys[a] );
+    }
+
+    XMFLOAT3 Lerp( const XMFLOAT3& a, const XMFLOAT3& b, float alpha )
+    {
+        return { a.x + ( b.x - a.x ) * alpha, a.y + ( b.y - a.y ) * alpha, a.z + ( b.z - a.z ) * alpha };
+    }
+
+    XMFLOAT4 Nlerp( const XMFLOAT4& a, XMFLOAT4 b, float alpha )
+    {
+        if ( Dot( a, b ) < 0.f )
+            b = { -b.x, -b.y, -b.z, -b.w };
+        XMFLOAT4 q = { a.x + ( b.x - a.x ) * alpha, a.y + ( b.y - a.y ) * alpha, a.z + ( b.z - a.z ) * alpha, a.w + ( b.w - a.w ) * alpha };
+        const float invLength = 1.f / std::sqrt( Dot( q, q ) );
+        return { q.x * invLength, q.y * invLength, q.z * invLength, q.w * invLength };
+    }
+
+    // What the sampler should produce for a track at a frame, worked out one channel at a time.
+    TransformSample ReferenceSample( const AnimationClip& clip, size_t trackIndex, float frame )
+    {
+        const AnimationTrack& track = clip.m_tracks[trackIndex];
+        TransformSample sample;
+        uint32_t a, b;
+        float alpha;
+
+        FindSpan( clip, track.m_translation, frame, a, b, alpha );
+        sample.m_translation = Lerp( DecodeChannelKey( clip, track, true, a ), DecodeChannelKey( clip, track, true, b ), alpha );
+
+        FindSpan( clip, track.m_rotation, frame, a, b, alpha );
+        const QuantizedQuaternion* rotations = &clip.m_rotations[track.m_rotation.m_firstValue];
+        sample.m_rotation = Nlerp( DequantizeQuaternion( rotations[a] ), DequantizeQuaternion( rotations[b] ), alpha );
+
+        FindSpan( clip, track.m_scale, frame, a, b, alpha );
+        sample.m_scale = Lerp( DecodeChannelKey( clip, track, false, a ), DecodeChannelKey( clip, track, false, b ), alpha );
+        return sample;
+    }
+
+    // Largest difference relative to the magnitude of the value, so large translations are held to float precision too.
+    float MaxDifference( const TransformSample& a, const TransformSample& b )
+    {
+        auto relative = []( float value, float reference ) { return std::fabs( value - reference ) / std::max( std::fabs( reference ), 1.f ); };
+        return std::max( { relative( a.m_translation.x, b.m_translation.x ), relative( a.m_translation.y, b.m_translation.y ), relative( a.m_translation.z, b.m_translation.z ),
+            relative( a.m_scale.x, b.m_scale.x ), relative( a.m_scale.y, b.m_scale.y ), relative( a.m_scale.z, b.m_scale.z ),
+            RotationAngle( a.m_rotation, b.m_rotation ) } );
+    }
+
+    bool SameSamples( ClipSampler& sampler, const AnimationClip& clip, float time )
+    {
+        std::vector<DirectX::XMFLOAT4X4> transforms( clip.m_tracks.size() );
+        std::vector<DirectX::XMFLOAT4X4> expected( clip.m_tracks.size() );
+        sampler.Sample( clip, time, transforms.data() );
+        ClipSampler fresh;
+        fresh.Sample( clip, time, expected.data() );
+        return std::memcmp( transforms.data(), expected.data(), transforms.size() * sizeof( DirectX::XMFLOAT4X4 ) ) == 0;
+    }
+}
+
+OLEX_TEST( QuaternionRoundTripsForEveryDroppedComponent )
+{
+    Random random( 1 );
+    for ( uint32_t dropped = 0; dropped < 4; ++dropped )
+    {
+        float worstError = 0.f;
+        bool indexKept = true;
+        bool signIgnored = true;
+        for ( int i = 0; i < 500; ++i )
+        {
+            // Move the largest component into the slot under test, with either sign.
+            const XMFLOAT4 random4 = RandomRotation( random );
+            float components[4] = { random4.x, random4.y, random4.z, random4.w };
+            const auto largest = std::max_element( components, components + 4, []( float a, float b ) { return std::fabs( a ) < std::fabs( b ); } );
+            std::swap( *largest, components[dropped] );
+            if ( i % 2 )
+                components[dropped] = -components[dropped];
+            const XMFLOAT4 rotation = { components[0], components[1], components[2], components[3] };
+
+            const QuantizedQuaternion quantized = QuantizeQuaternion( rotation );
+            indexKept &= uint32_t( ( quantized.m_data[0] >> 15 ) | ( ( quantized.m_data[1] >> 15 ) << 1 ) ) == dropped;
+            worstError = std::max( worstError, RotationAngle( DequantizeQuaternion( quantized ), rotation ) );
+
+            const QuantizedQuaternion negated = QuantizeQuaternion( { -rotation.x, -rotation.y, -rotation.z, -rotation.w } );
+            signIgnored &= std::memcmp( &negated, &quantized, sizeof( quantized ) ) == 0;
+        }
+        CHECK( indexKept );
+        CHECK( signIgnored );
+        // The documented bound, 0.01 degrees.
+        CHECK( worstError < 0.01f * Pi / 180.f );
+    }
+}
+
+OLEX_TEST( CompressedClipStaysWithinTolerances )
+{
+    const BakedClip baked = MakeClip( 6, 150 );
+    for ( const float scale : { 1.f, 0.5f } )
+    {
+        AnimationCompressionSettings settings;
+        settings.m_translationTolerance *= scale;
+        settings.m_rotationTolerance *= scale;
+        settings.m_scaleTolerance *= scale;
+
+        const AnimationClip clip = CompressClip( baked, settings );
+        const AnimationError error = MeasureClipError( baked, clip );
+        CHECK( error.m_maxTranslationError <= settings.m_translationTolerance );
+        CHECK( error.m_maxRotationError <= settings.m_rotationTolerance );
+        CHECK( error.m_maxScaleError <= settings.m_scaleTolerance );
+
+        // Smooth motion needs far fewer keys than frames, and a still track one key per channel.
+        CHECK( clip.m_keyFrames.size() < baked.m_samples.size() * 3 / 2 );
+        CHECK( clip.m_tracks.back().m_translation.m_keyCount == 1 );
+        CHECK( clip.m_tracks.back().m_rotation.m_keyCount == 1 );
+        CHECK( clip.m_tracks.back().m_scale.m_keyCount == 1 );
+    }
+}
+
+OLEX_TEST( WideRangesFallBackToFloatKeys )
+{
+    // Root motion over 495 units: a 16-bit step is 0.0076, its rounding error above the 0.001 tolerance.
+    BakedClip baked = MakeClip( 2, 100, 990.f );
+    for ( uint32_t frame = 0; frame < baked.m_frameCount; ++frame )
+    {
+        // Scales from 0.01 to 100, far too wide for 16 bits at a relative tolerance.
+        XMFLOAT3& scale = baked.m_samples[frame].m_scale;
+        scale.x = std::pow( 10.f, -2.f + 4.f * frame / ( baked.m_frameCount - 1 ) );
+    }
+
+    const AnimationClip clip = CompressClip( baked );
+    const AnimationError error = MeasureClipError( baked, clip );
+    const AnimationCompressionSettings settings;
+    CHECK( error.m_maxTranslationError <= settings.m_translationTolerance );
+    CHECK( error.m_maxRotationError <= settings.m_rotationTolerance );
+    CHECK( error.m_maxScaleError <= settings.m_scaleTolerance );
+
+    CHECK( clip.m_tracks[0].m_floatChannels == ( AnimationTrack::FloatTranslations | AnimationTrack::FloatScales ) );
+    // The still track fits in 16 bits.
+    CHECK( clip.m_tracks[1].m_floatChannels == 0 );
+    CHECK( clip.m_floatTranslations.size() == clip.m_tracks[0].m_translation.m_keyCount * 3 );
+    CHECK( clip.m_floatScales.size() == clip.m_tracks[0].m_scale.m_keyCount * 3 );
+}
+
+OLEX_TEST( RotationToleranceBelowTheQuantizationThrows )
+{
+    AnimationCompressionSettings settings;
+    settings.m_rotationTolerance = 1e-6f;
+
+    bool threw = false;
+    try
+    {
+        CompressClip( MakeClip( 2, 30 ), settings );
+    }
+    catch ( const std::invalid_argument& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+}
+
+OLEX_TEST( SamplerMatchesScalarInterpolation )
+{
+    // Five tracks, so the last SIMD block is partly padding; 16-bit keys, then float translation keys.
+    float worstSample = 0.f;
+    float worstMatrix = 0.f;
+    for ( const float translationRange : { 2.f, 990.f } )
+    {
+        const AnimationClip clip = CompressClip( MakeClip( 5, 90, translationRange ) );
+        ClipSampler sampler;
+        std::vector<DirectX::XMFLOAT4X4> transforms( clip.m_tracks.size() );
+        for ( float frame = 0.f; frame <= 89.f; frame += 0.37f )
+        {
+            sampler.Sample( clip, frame / clip.m_sampleRate, transforms.data() );
+            for ( size_t track = 0; track < clip.m_tracks.size(); ++track )
+            {
+                const TransformSample sample = sampler.GetSample( track );
+                worstSample = std::max( worstSample, MaxDifference( sample, ReferenceSample( clip, track, frame ) ) );
+
+                const DirectX::XMFLOAT4X4 expected = ComposeTransform( sample );
+                for ( int row = 0; row < 4; ++row )
+                {
+                    for ( int column = 0; column < 4; ++column )
+                        worstMatrix = std::max( worstMatrix, std::fabs( transforms[track].m[row][column] - expected.m[row][column] ) );
+                }
+            }
+        }
+    }
+    // Float rounding only.
+    CHECK( worstSample < 1e-5f );
+    CHECK( worstMatrix < 1e-4f );
+}
+
+OLEX_TEST( SeekingBackwardsGivesTheSameSamples )
+{
+    const BakedClip baked = MakeClip( 4, 120 );
+    const AnimationClip clip = CompressClip( baked );
+    const float duration = clip.GetDuration();
+
+    ClipSampler sampler;
+    bool same = true;
+    // Forward play, then backwards, then jumps both ways, each against a sampler with no history.
+    for ( float time = 0.f; time <= duration; time += 1.f / 60.f )
+        same &= SameSamples( sampler, clip, time );
+    for ( float time = duration; time >= 0.f; time -= 1.f / 45.f )
+        same &= SameSamples( sampler, clip, time );
+    Random random( 5 );
+    for ( int i = 0; i < 200; ++i )
+        same &= SameSamples( sampler, clip, random.Range( -0.5f, duration + 0.5f ) );
+    CHECK( same );
+}
+
+OLEX_TEST( FloatKeysSurviveTheSceneCache )
+{
+    const BakedClip baked = MakeClip( 2, 100, 990.f );
+    const AnimationClip clip = CompressClip( baked );
+
+    Scene scene;
+    DirectX::XMFLOAT4X4 identity = {};
+    identity.m[0][0] = identity.m[1][1] = identity.m[2][2] = identity.m[3][3] = 1.f;
+    scene.AddNode( "Root", Scene::NoParent, identity );
+    scene.AddNode( "Child", 0, identity );
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "OlexAnimationClipTests.scene";
+    WriteSceneCache( path, scene, Skeleton(), { clip }, SourceStamp{ 1, 2 } );
+    BakedScene loaded;
+    {
+        const MappedSceneCache cache( path );
+        CHECK( cache.IsValid() );
+        if ( cache.IsValid() )
+            loaded = cache.Load();
+    }
+    std::error_code removeError;
+    std::filesystem::remove( path, removeError );
+
+    CHECK( loaded.m_animations.size() == 1 );
+    if ( loaded.m_animations.size() == 1 )
+    {
+        const AnimationClip& reloaded = loaded.m_animations[0];
+        CHECK( reloaded.m_floatTranslations == clip.m_floatTranslations );
+        CHECK( reloaded.m_tracks[0].m_floatChannels == clip.m_tracks[0].m_floatChannels );
+        CHECK( MeasureClipError( baked, reloaded ).m_maxTranslationError <= AnimationCompressionSettings().m_translationTolerance );
+    }
+}
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "AssetCache.h"
+#include "TemporaryDirectory.h"
+#include "Test.h"
+
+using namespace Olex;
+
+namespace
+{
+    void WriteText( const std::filesystem::path& path, const std::string& text )
+    {
+        std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+        stream << text;
+    }
+
+    std::string ReadText( const std::filesystem::path& path )
+    {
+        std::ifstream stream( path, std::ios::binary );
+        return std::string( std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() );
+    }
+
+    // Bakes key into a single .mesh object holding text.
+    void BakeText( AssetCache& cache, uint64_t key, const std::string& text )
+    {
+        cache.GetOrBake( key, { ".mesh" }, false, [&]( const std::vector<std::filesystem::path>& outputs ) { WriteText( outputs[0], text ); } );
+    }
+
+    size_t CountFiles( const std::filesystem::path& directory, const std::string& extension )
+    {
+        size_t count = 0;
+        for ( const auto& entry : std::filesystem::recursive_directory_iterator( directory ) )
+            count += entry.path().extension() == extension;
+        return count;
+    }
+}
+
+OLEX_TEST( HasherIsDeterministicAcrossChunking )
+{
+    std::string text( 1000, '\0' );
+    for ( size_t i = 0; i < text.size(); ++i )
+        text[i] = static_cast<char>( i * 7 + 3 );
+
+    ContentHasher whole;
+    whole.Update( text.data(), text.size() );
+
+    // Pieces that straddle the 32-byte stripes in every way.
+    ContentHasher pieces;
+    for ( size_t offset = 0, size = 1; offset < text.size(); offset += size, size = size % 37 + 1 )
+        pieces.Update( text.data() + offset, std::min( size, text.size() - offset ) );
+
+    CHECK( whole.Finish() == pieces.Finish() );
+    CHECK( whole.Finish() != ContentHasher( 1 ).Finish() );
+}
+
+OLEX_TEST( BakesOnceThenHits )
+{
+    const Test::TemporaryDirectory directory;
+    AssetCache cache( directory.GetPath() / "cache" );
+
+    int bakes = 0;
+    const auto bake = [&]( const std::vector<std::filesystem::path>& outputs ) { ++bakes; WriteText( outputs[0], "mesh" ); };
+    CHECK( !cache.GetOrBake( 42, { ".mesh" }, false, bake ) );
+    CHECK( cache.GetOrBake( 42, { ".mesh" }, false, bake ) );
+    CHECK( bakes == 1 );
+    CHECK( ReadText( cache.GetObjectPath( 42, ".mesh" ) ) == "mesh" );
+    // Nothing is left behind in staging.
+    CHECK( std::filesystem::is_empty( directory.GetPath() / "cache" / "staging" ) );
+}
+
+OLEX_TEST( MaterializeCopiesAndLeavesNoTemporaryFiles )
+{
+    const Test::TemporaryDirectory directory;
+    AssetCache cache( directory.GetPath() / "cache" );
+    BakeText( cache, 1, "first" );
+    BakeText( cache, 2, "second" );
+
+    const std::filesystem::path target = directory.GetPath() / "out" / "model.mesh";
+    cache.Materialize( 1, ".mesh", target );
+    CHECK( ReadText( target ) == "first" );
+
+    // The same object again is not copied, another one replaces the target.
+    cache.Materialize( 1, ".mesh", target );
+    CHECK( cache.GetStats().m_outputsCopied == 1 );
+    cache.Materialize( 2, ".mesh", target );
+    CHECK( ReadText( target ) == "second" );
+    CHECK( cache.GetStats().m_outputsCopied == 2 );
+
+    CHECK( CountFiles( directory.GetPath() / "out", ".tmp" ) == 0 );
+}
+
+OLEX_TEST( MaterializeOfAMissingObjectThrowsAndCleansUp )
+{
+    const Test::TemporaryDirectory directory;
+    AssetCache cache( directory.GetPath() / "cache" );
+
+    bool threw = false;
+    try
+    {
+        cache.Materialize( 7, ".mesh", directory.GetPath() / "out" / "model.mesh" );
+    }
+    catch ( const std::filesystem::filesystem_error& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+    CHECK( std::filesystem::is_empty( directory.GetPath() / "out" ) );
+}
+
+OLEX_TEST( IndexRemembersSourcesAcrossRuns )
+{
+    const Test::TemporaryDirectory directory;
+    const std::filesystem::path source = directory.GetPath() / "model.fbx";
+    WriteText( source, "source bytes" );
+
+    uint64_t hash;
+    {
+        AssetCache cache( directory.GetPath() / "cache" );
+        hash = cache.HashSource( source );
+        CHECK( cache.GetStats().m_sourcesHashed == 1 );
+        cache.SaveIndex();
+    }
+
+    AssetCache cache( directory.GetPath() / "cache" );
+    CHECK( cache.HashSource( source ) == hash );
+    CHECK( cache.GetStats().m_sourcesHashed == 0 );
+}
+
+OLEX_TEST( StaleLockIsBroken )
+{
+    const Test::TemporaryDirectory directory;
+    const std::filesystem::path cacheDirectory = directory.GetPath() / "cache";
+    const std::filesystem::path source = directory.GetPath() / "model.fbx";
+    WriteText( source, "source bytes" );
+
+    AssetCache cache( cacheDirectory );
+    cache.HashSource( source );
+
+    // Left behind by a baker that died holding it.
+    const std::filesystem::path lock = cacheDirectory / "index.lock";
+    WriteText( lock, "" );
+    std::filesystem::last_write_time( lock, std::filesystem::file_time_type::clock::now() - std::chrono::hours( 1 ) );
+
+    cache.SaveIndex();
+    CHECK( !std::filesystem::exists( lock ) );
+    CHECK( CountFiles( cacheDirectory, ".stale" ) == 0 );
+
+    AssetCache reloaded( cacheDirectory );
+    reloaded.HashSource( source );
+    CHECK( reloaded.GetStats().m_sourcesHashed == 0 );
+}
@@ -0,0 +1,266 @@
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "ChunkPager.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+namespace
+{
+    /**
+     * Sink whose uploads only complete when the test says so, like a copy queue the GPU has not got
+     * to yet. Keeps the uploaded bytes and the order of evictions.
+     */
+    class DelayedChunkSink final : public ChunkUploadSink
+    {
+    public:
+        explicit DelayedChunkSink( size_t stagingCapacity ) : m_staging( stagingCapacity ) {}
+
+        uint8_t* GetStagingMemory() override { return m_staging.data(); }
+        [[nodiscard]] size_t GetStagingCapacity() const override { return m_staging.size(); }
+
+        void Upload( uint32_t chunkIndex, const ChunkedMeshChunk& chunk, uint64_t stagingOffset ) override
+        {
+            const uint8_t* staged = m_staging.data() + stagingOffset;
+            m_chunks[chunkIndex].assign( staged, staged + chunk.m_size );
+        }
+
+        void Evict( uint32_t chunkIndex ) override
+        {
+            m_chunks.erase( chunkIndex );
+            m_evictions.push_back( chunkIndex );
+        }
+
+        uint64_t Submit() override { return ++m_submitted; }
+        [[nodiscard]] bool IsComplete( uint64_t ticket ) override { return ticket <= m_completed; }
+
+        // Completes every submission so far.
+        void Complete() { m_completed = m_submitted; }
+
+        [[nodiscard]] const std::unordered_map<uint32_t, std::vector<uint8_t>>& GetChunks() const { return m_chunks; }
+        [[nodiscard]] const std::vector<uint32_t>& GetEvictions() const { return m_evictions; }
+
+    private:
+        std::vector<uint8_t> m_staging;
+        std::unordered_map<uint32_t, std::vector<uint8_t>> m_chunks;
+        std::vector<uint32_t> m_evictions;
+        uint64_t m_submitted = 0;
+        uint64_t m_completed = 0;
+    };
+
+    /**
+     * An 8 x 8 grid baked into cells of 2 x 2 quads, 16 chunks of exactly the same size. The file is
+     * removed when the fixture goes.
+     */
+    class ChunkedGrid
+    {
+    public:
+        ChunkedGrid()
+        {
+            static int counter = 0;
+            m_path = std::filesystem::temp_directory_path() / ( "OlexChunkPagerTests" + std::to_string( counter++ ) + ".chunks" );
+            WriteChunkedMesh( m_path, { Test::MakeGridMesh( 8 ) }, 2.f, SourceStamp{ 1, 2 } );
+            m_file = std::make_unique<ChunkedMeshFile>( m_path );
+        }
+
+        ~ChunkedGrid()
+        {
+            m_file.reset();
+            std::error_code error;
+            std::filesystem::remove( m_path, error );
+        }
+
+        ChunkedMeshFile& GetFile() { return *m_file; }
+        uint32_t GetChunkSize() const { return m_file->GetLargestChunkSize(); }
+        // Staging room of count chunks, each starting on a blob boundary.
+        size_t GetStagingSize( size_t count ) const
+        {
+            const size_t alignment = ChunkedMeshFormat::BlobAlignment;
+            return count * ( ( GetChunkSize() + alignment - 1 ) / alignment * alignment );
+        }
+
+    private:
+        std::filesystem::path m_path;
+        std::unique_ptr<ChunkedMeshFile> m_file;
+    };
+
+    std::vector<ChunkRequest> Requests( std::initializer_list<uint32_t> chunks )
+    {
+        std::vector<ChunkRequest> requests;
+        for ( uint32_t chunk : chunks )
+            requests.push_back( ChunkRequest{ chunk, float( requests.size() ) } );
+        return requests;
+    }
+}
+
+OLEX_TEST( GridBakesIntoEqualChunks )
+{
+    ChunkedGrid grid;
+    ChunkedMeshFile& file = grid.GetFile();
+
+    CHECK( file.IsValid() );
+    CHECK( file.GetChunkCount() == 16 );
+    bool equal = true;
+    for ( uint32_t chunk = 0; chunk < file.GetChunkCount(); ++chunk )
+        equal &= file.GetChunk( chunk ).m_size == grid.GetChunkSize();
+    CHECK( equal );
+}
+
+OLEX_TEST( ChunksBecomeResidentOnlyOnceTheirUploadCompletes )
+{
+    ChunkedGrid grid;
+    DelayedChunkSink sink( grid.GetStagingSize( 4 ) );
+    ChunkPager pager( grid.GetFile(), sink, grid.GetChunkSize() * 4 );
+
+    pager.Update( Requests( { 3, 5 } ) );
+    CHECK( pager.GetStats().m_uploadingChunks == 2 );
+    CHECK( !pager.IsResident( 3 ) && !pager.IsResident( 5 ) );
+
+    pager.Update( Requests( { 3, 5 } ) );
+    CHECK( !pager.IsResident( 3 ) );
+
+    sink.Complete();
+    pager.Update( Requests( { 3, 5 } ) );
+    CHECK( pager.IsResident( 3 ) && pager.IsResident( 5 ) );
+    CHECK( pager.GetStats().m_residentChunks == 2 );
+    CHECK( pager.GetStats().m_uploadingChunks == 0 );
+    CHECK( pager.GetStats().m_loads == 2 );
+
+    // What reached the sink is the chunk as it is in the file.
+    std::vector<uint8_t> expected( grid.GetChunkSize() );
+    grid.GetFile().ReadChunk( 5, expected.data() );
+    CHECK( sink.GetChunks().at( 5 ) == expected );
+}
+
+OLEX_TEST( ResidentBytesStayWithinTheBudget )
+{
+    ChunkedGrid grid;
+    DelayedChunkSink sink( grid.GetStagingSize( 3 ) );
+    const uint64_t budget = grid.GetChunkSize() * 5;
+    ChunkPager pager( grid.GetFile(), sink, budget );
+
+    Test::Random random( 1 );
+    bool withinBudget = true;
+    bool bytesMatch = true;
+    for ( int frame = 0; frame < 500; ++frame )
+    {
+        std::vector<ChunkRequest> requests;
+        for ( uint32_t chunk = 0; chunk < 16; ++chunk )
+        {
+            if ( random.Next() % 4 == 0 )
+                requests.push_back( ChunkRequest{ chunk, random.Unit() } );
+        }
+        if ( random.Next() % 3 == 0 )
+            sink.Complete();
+        pager.Update( requests );
+
+        const ChunkPagerStats& stats = pager.GetStats();
+        withinBudget &= stats.m_residentBytes <= budget;
+        bytesMatch &= stats.m_residentBytes == uint64_t( stats.m_residentChunks + stats.m_uploadingChunks ) * grid.GetChunkSize();
+        bytesMatch &= sink.GetChunks().size() == stats.m_residentChunks + stats.m_uploadingChunks;
+    }
+    CHECK( withinBudget );
+    CHECK( bytesMatch );
+    CHECK( pager.GetStats().m_evictions > 0 );
+}
+
+OLEX_TEST( EvictsTheLeastRecentlyRequestedChunkFirst )
+{
+    ChunkedGrid grid;
+    DelayedChunkSink sink( grid.GetStagingSize( 4 ) );
+    ChunkPager pager( grid.GetFile(), sink, grid.GetChunkSize() * 3 );
+
+    for ( uint32_t chunk : { 0u, 1u, 2u } )
+    {
+        pager.Update( Requests( { chunk } ) );
+        sink.Complete();
+    }
+    // Touching 0 again leaves 1 as the oldest, then 2.
+    pager.Update( Requests( { 0 } ) );
+    CHECK( sink.GetEvictions().empty() );
+
+    pager.Update( Requests( { 7 } ) );
+    sink.Complete();
+    pager.Update( Requests( { 8 } ) );
+
+    CHECK( sink.GetEvictions() == std::vector<uint32_t>( { 1, 2 } ) );
+    CHECK( pager.IsResident( 0 ) );
+}
+
+OLEX_TEST( RequestedChunksAreNeverEvicted )
+{
+    ChunkedGrid grid;
+    DelayedChunkSink sink( grid.GetStagingSize( 4 ) );
+    ChunkPager pager( grid.GetFile(), sink, grid.GetChunkSize() * 2 );
+
+    // Three wanted chunks, room for two: the lowest priority one waits instead of pushing one out.
+    for ( int frame = 0; frame < 4; ++frame )
+    {
+        pager.Update( Requests( { 4, 9, 12 } ) );
+        sink.Complete();
+        CHECK( pager.GetStats().m_waitingChunks == 1 );
+    }
+    CHECK( sink.GetEvictions().empty() );
+    CHECK( pager.IsResident( 4 ) && pager.IsResident( 9 ) && !pager.IsResident( 12 ) );
+
+    // Once 4 is no longer wanted it makes room for 12.
+    pager.Update( Requests( { 9, 12 } ) );
+    CHECK( sink.GetEvictions() == std::vector<uint32_t>( { 4 } ) );
+    CHECK( pager.GetStats().m_waitingChunks == 0 );
+}
+
+OLEX_TEST( FullStagingMakesTheRestWait )
+{
+    ChunkedGrid grid;
+    DelayedChunkSink sink( grid.GetStagingSize( 2 ) );
+    ChunkPager pager( grid.GetFile(), sink, grid.GetChunkSize() * 16 );
+
+    // Priorities make 6 and 2 load first.
+    const std::vector<ChunkRequest> requests = { { 1, 3.f }, { 2, 1.f }, { 5, 2.f }, { 6, 0.f } };
+    pager.Update( requests );
+    CHECK( pager.GetStats().m_uploadingChunks == 2 );
+    CHECK( pager.GetStats().m_waitingChunks == 2 );
+    CHECK( sink.GetChunks().count( 6 ) == 1 && sink.GetChunks().count( 2 ) == 1 );
+
+    // Staging stays taken until the sink reports the uploads complete.
+    pager.Update( requests );
+    CHECK( pager.GetStats().m_loads == 2 );
+
+    sink.Complete();
+    pager.Update( requests );
+    CHECK( pager.GetStats().m_loads == 4 );
+    CHECK( pager.GetStats().m_waitingChunks == 0 );
+    CHECK( pager.IsResident( 6 ) && pager.IsResident( 2 ) );
+}
+
+OLEX_TEST( RejectsABudgetOrStagingBelowTheLargestChunk )
+{
+    ChunkedGrid grid;
+    bool budgetThrew = false;
+    bool stagingThrew = false;
+    try
+    {
+        DelayedChunkSink sink( grid.GetStagingSize( 1 ) );
+        ChunkPager pager( grid.GetFile(), sink, grid.GetChunkSize() - 1 );
+    }
+    catch ( const std::invalid_argument& )
+    {
+        budgetThrew = true;
+    }
+    try
+    {
+        DelayedChunkSink sink( grid.GetChunkSize() - 1 );
+        ChunkPager pager( grid.GetFile(), sink, grid.GetChunkSize() );
+    }
+    catch ( const std::invalid_argument& )
+    {
+        stagingThrew = true;
+    }
+    CHECK( budgetThrew );
+    CHECK( stagingThrew );
+}
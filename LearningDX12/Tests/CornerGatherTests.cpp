@@ -0,0 +1,82 @@
+#include <vector>
+
+#include "CornerGather.h"
+#include "Test.h"
+
+using namespace Olex;
+
+namespace
+{
+    // Two triangles over four control points, sharing the edge 1-2.
+    const int PolygonVertices[] = { 0, 1, 2, 2, 1, 3 };
+    constexpr int PolygonVertexCount = 6;
+
+    std::vector<int> Gather( LayerMapping mapping, const int* indices, int indexCount, int directCount, bool* result = nullptr )
+    {
+        std::vector<int> gathered( PolygonVertexCount, -1 );
+        const bool gatheredAll = GatherLayerIndices( mapping, PolygonVertices, PolygonVertexCount, indices, indexCount, directCount,
+            [&gathered]( int polygonVertex, int directIndex ) { gathered[polygonVertex] = directIndex; } );
+        if ( result )
+            *result = gatheredAll;
+        return gathered;
+    }
+}
+
+OLEX_TEST( CornerSlotFlipsWinding )
+{
+    const size_t expected[] = { 0, 2, 1, 3, 5, 4 };
+    for ( int polygonVertex = 0; polygonVertex < PolygonVertexCount; ++polygonVertex )
+        CHECK( CornerSlot( polygonVertex ) == expected[polygonVertex] );
+}
+
+OLEX_TEST( ByControlPointDirect )
+{
+    CHECK( Gather( LayerMapping::ByControlPoint, nullptr, 0, 4 ) == std::vector<int>( { 0, 1, 2, 2, 1, 3 } ) );
+}
+
+OLEX_TEST( ByControlPointIndexed )
+{
+    const int indices[] = { 3, 2, 1, 0 };
+    CHECK( Gather( LayerMapping::ByControlPoint, indices, 4, 4 ) == std::vector<int>( { 3, 2, 1, 1, 2, 0 } ) );
+}
+
+OLEX_TEST( ByPolygonVertexIndexed )
+{
+    // Uv seams: the shared edge reads different entries on each triangle.
+    const int indices[] = { 0, 1, 2, 4, 5, 3 };
+    CHECK( Gather( LayerMapping::ByPolygonVertex, indices, 6, 6 ) == std::vector<int>( { 0, 1, 2, 4, 5, 3 } ) );
+    CHECK( Gather( LayerMapping::ByPolygonVertex, nullptr, 0, 6 ) == std::vector<int>( { 0, 1, 2, 3, 4, 5 } ) );
+}
+
+OLEX_TEST( ByPolygonAndAllSame )
+{
+    CHECK( Gather( LayerMapping::ByPolygon, nullptr, 0, 2 ) == std::vector<int>( { 0, 0, 0, 1, 1, 1 } ) );
+    CHECK( Gather( LayerMapping::AllSame, nullptr, 0, 1 ) == std::vector<int>( 6, 0 ) );
+}
+
+OLEX_TEST( OutOfRangeFallsBack )
+{
+    bool result = true;
+
+    // Index array too short for the control points.
+    const int shortIndices[] = { 0, 1, 2 };
+    Gather( LayerMapping::ByControlPoint, shortIndices, 3, 4, &result );
+    CHECK( !result );
+
+    // Index pointing past the direct array.
+    const int badIndices[] = { 0, 1, 2, 7 };
+    Gather( LayerMapping::ByControlPoint, badIndices, 4, 4, &result );
+    CHECK( !result );
+
+    // Negative index.
+    const int negativeIndices[] = { 0, -1, 2, 3 };
+    Gather( LayerMapping::ByControlPoint, negativeIndices, 4, 4, &result );
+    CHECK( !result );
+
+    // Direct array smaller than the control points.
+    Gather( LayerMapping::ByControlPoint, nullptr, 0, 3, &result );
+    CHECK( !result );
+
+    Gather( LayerMapping::ByControlPoint, nullptr, 0, 4, &result );
+    CHECK( result );
+}
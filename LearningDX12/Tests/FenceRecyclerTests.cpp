@@ -0,0 +1,100 @@
+#include <memory>
+
+#include "FenceRecycler.h"
+#include "Test.h"
+
+using namespace Olex;
+
+OLEX_TEST( EmptyPoolMisses )
+{
+    FenceRecycler<int> pool;
+    int object = -1;
+
+    CHECK( !pool.TryAcquire( ~0ull, object ) );
+    CHECK( object == -1 );
+    CHECK( pool.GetStats().m_hits == 0 );
+    CHECK( pool.GetStats().m_misses == 1 );
+}
+
+OLEX_TEST( ObjectIsReusedOnlyOnceItsFenceHasCompleted )
+{
+    FenceRecycler<int> pool;
+    pool.Release( 7, 5 );
+
+    int object = -1;
+    for ( uint64_t completed = 0; completed < 5; ++completed )
+        CHECK( !pool.TryAcquire( completed, object ) );
+    CHECK( object == -1 );
+    CHECK( pool.GetPooledCount() == 1 );
+
+    CHECK( pool.TryAcquire( 5, object ) );
+    CHECK( object == 7 );
+    CHECK( pool.GetPooledCount() == 0 );
+}
+
+OLEX_TEST( FenceZeroIsAvailableRightAway )
+{
+    FenceRecycler<int> pool;
+    pool.Release( 3, 0 );
+
+    int object = -1;
+    CHECK( pool.TryAcquire( 0, object ) );
+    CHECK( object == 3 );
+}
+
+OLEX_TEST( ObjectsComeBackOldestFirst )
+{
+    FenceRecycler<int> pool;
+    pool.Release( 1, 1 );
+    pool.Release( 2, 2 );
+    pool.Release( 3, 2 );
+
+    int object = 0;
+    CHECK( pool.TryAcquire( 10, object ) && object == 1 );
+    CHECK( pool.TryAcquire( 10, object ) && object == 2 );
+    CHECK( pool.TryAcquire( 10, object ) && object == 3 );
+    CHECK( !pool.TryAcquire( 10, object ) );
+}
+
+OLEX_TEST( OutOfOrderReleaseNeverHandsOutAnObjectEarly )
+{
+    // Against the precondition, a later entry has the older fence. Only the front is checked, so the
+    // younger object blocks the older one, which costs reuse but never returns an object in use.
+    FenceRecycler<int> pool;
+    pool.Release( 1, 5 );
+    pool.Release( 2, 3 );
+
+    int object = 0;
+    CHECK( !pool.TryAcquire( 3, object ) );
+    CHECK( !pool.TryAcquire( 4, object ) );
+    CHECK( object == 0 );
+
+    CHECK( pool.TryAcquire( 5, object ) && object == 1 );
+    CHECK( pool.TryAcquire( 5, object ) && object == 2 );
+}
+
+OLEX_TEST( CountersTrackHitsAndMisses )
+{
+    FenceRecycler<std::unique_ptr<int>> pool;
+    uint64_t submitted = 0;
+    uint64_t created = 0;
+
+    // One object per frame with the GPU two submissions behind, as the staging pages are used.
+    for ( int frame = 0; frame < 100; ++frame )
+    {
+        const uint64_t completed = submitted > 2 ? submitted - 2 : 0;
+        std::unique_ptr<int> object;
+        if ( !pool.TryAcquire( completed, object ) )
+        {
+            object = std::make_unique<int>( 0 );
+            ++created;
+        }
+        pool.Release( std::move( object ), ++submitted );
+    }
+
+    const FenceRecyclerStats& stats = pool.GetStats();
+    CHECK( stats.m_hits + stats.m_misses == 100 );
+    CHECK( stats.m_misses == created );
+    CHECK( created == 3 );
+    CHECK( pool.GetPooledCount() == created );
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <vector>
+
+#include "FramePacer.h"
+#include "Test.h"
+
+using namespace Olex;
+
+namespace
+{
+    struct TimelineResult
+    {
+        double m_frameTime = 0.0;
+        // Most frames the GPU still had queued or running when the CPU started recording one.
+        int m_maxQueuedFrames = 0;
+        // A frame was recorded into a back buffer the GPU had not finished with.
+        bool m_bufferReusedEarly = false;
+    };
+
+    /**
+     * Runs the pacer against a simulated GPU timeline: every frame takes cpuTime to record and
+     * gpuTime to execute, the GPU runs frames in submission order, and the CPU blocks on the wait
+     * value the pacer gives before recording.
+     */
+    TimelineResult Simulate( uint32_t bufferCount, uint32_t maxFrameLatency, double cpuTime, double gpuTime, int frameCount = 1000 )
+    {
+        FramePacer pacer( bufferCount, maxFrameLatency );
+        // Completion time of every fence value, fence 0 is complete from the start.
+        std::vector<double> completionTimes = { 0.0 };
+        std::vector<uint64_t> bufferFences( bufferCount, 0 );
+
+        TimelineResult result;
+        double cpu = 0.0;
+        double gpuIdle = 0.0;
+        for ( int frame = 0; frame < frameCount; ++frame )
+        {
+            const uint32_t buffer = frame % bufferCount;
+            cpu = std::max( cpu, completionTimes[pacer.GetWaitValue( buffer )] );
+
+            const auto queued = std::count_if( completionTimes.begin(), completionTimes.end(), [cpu]( double time ) { return time > cpu; } );
+            result.m_maxQueuedFrames = std::max( result.m_maxQueuedFrames, static_cast<int>( queued ) );
+            result.m_bufferReusedEarly |= completionTimes[bufferFences[buffer]] > cpu;
+
+            cpu += cpuTime;
+            gpuIdle = std::max( cpu, gpuIdle ) + gpuTime;
+            completionTimes.push_back( gpuIdle );
+
+            const uint64_t fence = completionTimes.size() - 1;
+            bufferFences[buffer] = fence;
+            pacer.OnFrameSubmitted( buffer, fence );
+        }
+
+        result.m_frameTime = gpuIdle / frameCount;
+        return result;
+    }
+}
+
+OLEX_TEST( LatencyOneSerializesFrames )
+{
+    const TimelineResult result = Simulate( 3, 1, 10.0, 10.0 );
+
+    CHECK( result.m_maxQueuedFrames == 0 );
+    CHECK_NEAR( result.m_frameTime, 20.0, 0.1 );
+}
+
+OLEX_TEST( LatencyNLetsNFramesOverlap )
+{
+    // GPU bound, so the CPU runs as far ahead as it is allowed to.
+    for ( uint32_t latency = 1; latency <= 4; ++latency )
+    {
+        const TimelineResult result = Simulate( 4, latency, 2.0, 10.0 );
+        CHECK( result.m_maxQueuedFrames == int( latency ) - 1 );
+        CHECK( !result.m_bufferReusedEarly );
+    }
+}
+
+OLEX_TEST( OverlapHidesTheShorterSideOfTheFrame )
+{
+    // With equal CPU and GPU times, overlapping two frames halves the frame time, and a deeper queue
+    // adds nothing but latency.
+    CHECK_NEAR( Simulate( 3, 2, 10.0, 10.0 ).m_frameTime, 10.0, 0.1 );
+    CHECK_NEAR( Simulate( 3, 3, 10.0, 10.0 ).m_frameTime, 10.0, 0.1 );
+
+    // Otherwise the frame time drops from the sum to the longer of the two.
+    CHECK_NEAR( Simulate( 3, 1, 4.0, 10.0 ).m_frameTime, 14.0, 0.1 );
+    CHECK_NEAR( Simulate( 3, 2, 4.0, 10.0 ).m_frameTime, 10.0, 0.1 );
+    CHECK_NEAR( Simulate( 3, 2, 10.0, 4.0 ).m_frameTime, 10.0, 0.1 );
+}
+
+OLEX_TEST( WaitsForTheFrameThatLastUsedTheBuffer )
+{
+    FramePacer pacer( 3, 3 );
+    CHECK( pacer.GetWaitValue( 0 ) == 0 );
+
+    pacer.OnFrameSubmitted( 0, 1 );
+    pacer.OnFrameSubmitted( 1, 2 );
+
+    // Below the latency limit only the buffer's own frame matters.
+    CHECK( pacer.GetWaitValue( 0 ) == 1 );
+    CHECK( pacer.GetWaitValue( 1 ) == 2 );
+    CHECK( pacer.GetWaitValue( 2 ) == 0 );
+}
+
+OLEX_TEST( WaitsForTheFrameMaxLatencyFramesBack )
+{
+    FramePacer pacer( 3, 2 );
+    pacer.OnFrameSubmitted( 0, 1 );
+    pacer.OnFrameSubmitted( 1, 2 );
+
+    // Buffer 2 was never used, the latency limit still holds the CPU back.
+    CHECK( pacer.GetWaitValue( 2 ) == 1 );
+
+    pacer.OnFrameSubmitted( 2, 3 );
+    CHECK( pacer.GetWaitValue( 0 ) == 2 );
+}
+
+OLEX_TEST( LatencyIsClampedToTheBufferCount )
+{
+    CHECK( FramePacer( 3, 0 ).GetMaxFrameLatency() == 1 );
+    CHECK( FramePacer( 3, 9 ).GetMaxFrameLatency() == 3 );
+    CHECK( FramePacer( 0, 2 ).GetMaxFrameLatency() == 1 );
+
+    FramePacer pacer( 2, 1 );
+    pacer.SetMaxFrameLatency( 5 );
+    CHECK( pacer.GetMaxFrameLatency() == 2 );
+    pacer.SetMaxFrameLatency( 0 );
+    CHECK( pacer.GetMaxFrameLatency() == 1 );
+}
+
+OLEX_TEST( LoweringTheLatencyBelowTheQueueDepthTrimsIt )
+{
+    FramePacer pacer( 3, 3 );
+    pacer.OnFrameSubmitted( 0, 1 );
+    pacer.OnFrameSubmitted( 1, 2 );
+    pacer.OnFrameSubmitted( 2, 3 );
+    CHECK( pacer.GetWaitValue( 0 ) == 1 );
+
+    // Three frames are queued; with a latency of one the next frame waits for all of them.
+    pacer.SetMaxFrameLatency( 1 );
+    CHECK( pacer.GetWaitValue( 0 ) == 3 );
+
+    // Raising it again does not bring back the dropped frames, only the buffer's own fence counts.
+    pacer.SetMaxFrameLatency( 3 );
+    CHECK( pacer.GetWaitValue( 0 ) == 1 );
+}
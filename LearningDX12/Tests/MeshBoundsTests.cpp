@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "Mesh.h"
+#include "MeshBounds.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+namespace
+{
+    std::vector<Mesh::VertexInfo> MakeRandomVertices( size_t count, uint32_t seed )
+    {
+        Test::Random random( seed );
+        std::vector<Mesh::VertexInfo> vertices( count );
+        for ( Mesh::VertexInfo& vertex : vertices )
+            vertex = Test::MakeVertex( random.Range( -5.f, 3.f ), random.Range( 10.f, 11.f ), random.Range( -1.f, 0.f ), 0, 0, 0, 0, 0 );
+        return vertices;
+    }
+
+    // One position at a time, what the SIMD box has to match exactly.
+    void ScalarBox( const std::vector<Mesh::VertexInfo>& vertices, const std::vector<uint32_t>& indices,
+        DirectX::XMFLOAT3& minimum, DirectX::XMFLOAT3& maximum )
+    {
+        minimum = { FLT_MAX, FLT_MAX, FLT_MAX };
+        maximum = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for ( uint32_t index : indices )
+        {
+            const DirectX::XMFLOAT3& p = vertices[index].m_position;
+            minimum = { std::min( minimum.x, p.x ), std::min( minimum.y, p.y ), std::min( minimum.z, p.z ) };
+            maximum = { std::max( maximum.x, p.x ), std::max( maximum.y, p.y ), std::max( maximum.z, p.z ) };
+        }
+    }
+
+    bool Equal( const DirectX::XMFLOAT3& lhs, const DirectX::XMFLOAT3& rhs )
+    {
+        return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+    }
+
+    // Farthest position from the sphere center, over the sphere radius.
+    float Containment( const BoundingVolume& volume, const std::vector<DirectX::XMFLOAT3>& positions )
+    {
+        float farthest = 0.f;
+        for ( const DirectX::XMFLOAT3& p : positions )
+        {
+            const float dx = p.x - volume.m_sphereCenter.x;
+            const float dy = p.y - volume.m_sphereCenter.y;
+            const float dz = p.z - volume.m_sphereCenter.z;
+            farthest = std::max( farthest, std::sqrt( dx * dx + dy * dy + dz * dz ) );
+        }
+        return farthest / volume.m_sphereRadius;
+    }
+}
+
+OLEX_TEST( BoxMatchesTheScalarReductionForEveryTailLength )
+{
+    const std::vector<Mesh::VertexInfo> vertices = MakeRandomVertices( 64, 1 );
+
+    bool matches = true;
+    for ( size_t count = 1; count <= vertices.size(); ++count )
+    {
+        std::vector<uint32_t> all( count );
+        for ( uint32_t i = 0; i < count; ++i )
+            all[i] = i;
+
+        DirectX::XMFLOAT3 minimum, maximum;
+        ScalarBox( vertices, all, minimum, maximum );
+        const BoundingVolume volume = ComputeBounds( &vertices[0].m_position, count, sizeof( Mesh::VertexInfo ) );
+        matches &= Equal( volume.m_min, minimum ) && Equal( volume.m_max, maximum );
+
+        DirectX::XMFLOAT3 boxMinimum, boxMaximum;
+        ComputeBoundingBox( &vertices[0].m_position, count, sizeof( Mesh::VertexInfo ), boxMinimum, boxMaximum );
+        matches &= Equal( boxMinimum, minimum ) && Equal( boxMaximum, maximum );
+    }
+    CHECK( matches );
+}
+
+OLEX_TEST( BoxMatchesTheScalarReductionForTightAndIndexedPositions )
+{
+    const std::vector<Mesh::VertexInfo> vertices = MakeRandomVertices( 1001, 2 );
+    std::vector<DirectX::XMFLOAT3> tight;
+    for ( const Mesh::VertexInfo& vertex : vertices )
+        tight.push_back( vertex.m_position );
+
+    std::vector<uint32_t> all( vertices.size() );
+    for ( uint32_t i = 0; i < all.size(); ++i )
+        all[i] = i;
+    DirectX::XMFLOAT3 minimum, maximum;
+    ScalarBox( vertices, all, minimum, maximum );
+
+    // A 12-byte stride cannot use 16-byte loads on the last position.
+    const BoundingVolume tightVolume = ComputeBounds( tight.data(), tight.size(), sizeof( DirectX::XMFLOAT3 ) );
+    CHECK( Equal( tightVolume.m_min, minimum ) && Equal( tightVolume.m_max, maximum ) );
+
+    Test::Random random( 3 );
+    std::vector<uint32_t> indices( 301 );
+    for ( uint32_t& index : indices )
+        index = random.Next() % vertices.size();
+    ScalarBox( vertices, indices, minimum, maximum );
+    const BoundingVolume indexedVolume = ComputeBounds( &vertices[0].m_position, sizeof( Mesh::VertexInfo ), indices.data(), indices.size() );
+    CHECK( Equal( indexedVolume.m_min, minimum ) && Equal( indexedVolume.m_max, maximum ) );
+}
+
+OLEX_TEST( SphereContainsEveryPosition )
+{
+    for ( size_t count : { 1, 2, 3, 5, 17, 1000 } )
+    {
+        const std::vector<Mesh::VertexInfo> vertices = MakeRandomVertices( count, uint32_t( count ) );
+        std::vector<DirectX::XMFLOAT3> positions;
+        for ( const Mesh::VertexInfo& vertex : vertices )
+            positions.push_back( vertex.m_position );
+
+        const BoundingVolume volume = ComputeBounds( &vertices[0].m_position, count, sizeof( Mesh::VertexInfo ) );
+        if ( count == 1 )
+            CHECK( volume.m_sphereRadius == 0.f && Equal( volume.m_sphereCenter, positions[0] ) );
+        else
+            CHECK( Containment( volume, positions ) <= 1.f + 1e-6f );
+    }
+}
+
+OLEX_TEST( SphereIsCloseToTheOptimumOnAnEllipsoid )
+{
+    // Semi-axes 3, 1.5 and 0.5, so the smallest enclosing sphere has radius 3.
+    Test::Random random( 4 );
+    std::vector<Mesh::VertexInfo> vertices( 100000 );
+    for ( Mesh::VertexInfo& vertex : vertices )
+    {
+        const float z = random.Range( -1.f, 1.f );
+        const float phi = random.Range( 0.f, 2.f * Test::Pi );
+        const float r = std::sqrt( 1.f - z * z );
+        vertex = Test::MakeVertex( 3.f * r * std::cos( phi ), 1.5f * r * std::sin( phi ), 0.5f * z, 0, 0, 0, 0, 0 );
+    }
+
+    const BoundingVolume volume = ComputeBounds( &vertices[0].m_position, vertices.size(), sizeof( Mesh::VertexInfo ) );
+    CHECK( volume.m_sphereRadius <= 3.f * 1.001f );
+}
+
+OLEX_TEST( EmptyRangeIsZeroSizedAtTheOrigin )
+{
+    const BoundingVolume volume = ComputeBounds( nullptr, 0, sizeof( Mesh::VertexInfo ) );
+    const DirectX::XMFLOAT3 origin = { 0.f, 0.f, 0.f };
+    CHECK( Equal( volume.m_min, origin ) && Equal( volume.m_max, origin ) );
+    CHECK( Equal( volume.m_sphereCenter, origin ) && volume.m_sphereRadius == 0.f );
+}
@@ -0,0 +1,392 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "MeshBounds.h"
+#include "MeshCache.h"
+#include "TemporaryDirectory.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+namespace
+{
+    constexpr SourceStamp Stamp = { 1234, 5678 };
+
+    /**
+     * A grid of n x n quads split into submeshes of at most maxVertices vertices, with tangents,
+     * a skin over 4 joints and two levels of detail made of every second and fourth triangle.
+     */
+    Mesh MakeCacheMesh( uint32_t n, size_t maxVertices, IndexFormat format )
+    {
+        Mesh mesh = Test::MakeGridMesh( n );
+
+        Test::Random random( n );
+        for ( size_t i = 0; i < mesh.m_vertices.size(); ++i )
+        {
+            mesh.m_tangents.push_back( { 1.f, 0.f, 0.f, i % 2 ? 1.f : -1.f } );
+
+            const uint32_t joints[2] = { random.Next() % 4, random.Next() % 4 };
+            const float weights[2] = { random.Range( 0.1f, 1.f ), random.Range( 0.1f, 1.f ) };
+            mesh.m_skin.m_vertices.push_back( PackInfluences( joints, weights, 2 ) );
+        }
+        for ( uint32_t joint = 0; joint < 4; ++joint )
+        {
+            DirectX::XMFLOAT4X4 inverseBind = {};
+            inverseBind.m[0][0] = inverseBind.m[1][1] = inverseBind.m[2][2] = inverseBind.m[3][3] = 1.f;
+            inverseBind.m[3][0] = -float( joint );
+            mesh.m_skin.m_jointNodes.push_back( joint + 10 );
+            mesh.m_skin.m_inverseBindMatrices.push_back( inverseBind );
+        }
+
+        for ( size_t step : { size_t( 2 ), size_t( 4 ) } )
+        {
+            MeshLod lod;
+            for ( size_t triangle = 0; triangle < mesh.m_indices.size(); triangle += step )
+                lod.m_indices.push_back( mesh.m_indices[triangle] );
+            lod.m_error = 0.5f * step;
+            mesh.m_lods.push_back( lod );
+        }
+
+        mesh.m_submeshes = SplitSubmeshes( mesh, maxVertices );
+        mesh.m_indexFormat = format;
+        ComputeMeshBounds( mesh );
+        return mesh;
+    }
+
+    std::vector<uint8_t> ReadBytes( const std::filesystem::path& path )
+    {
+        std::ifstream stream( path, std::ios::binary );
+        return std::vector<uint8_t>( std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() );
+    }
+
+    void WriteBytes( const std::filesystem::path& path, const std::vector<uint8_t>& bytes )
+    {
+        std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+        stream.write( reinterpret_cast<const char*>( bytes.data() ), static_cast<std::streamsize>( bytes.size() ) );
+    }
+
+    template <typename T>
+    T Load( const std::vector<uint8_t>& bytes, uint64_t offset )
+    {
+        T value;
+        std::memcpy( &value, bytes.data() + offset, sizeof( T ) );
+        return value;
+    }
+
+    template <typename T>
+    void Store( std::vector<uint8_t>& bytes, uint64_t offset, const T& value )
+    {
+        std::memcpy( bytes.data() + offset, &value, sizeof( T ) );
+    }
+
+    bool IsValidCache( const std::filesystem::path& path )
+    {
+        const MappedMeshCache cache( path );
+        return cache.IsValid() && cache.GetMeshCount() != 0;
+    }
+
+    // Rewrites the cache at path with patch applied to its bytes and reports whether it still maps.
+    template <typename Patch>
+    bool IsValidAfter( const std::filesystem::path& path, const std::vector<uint8_t>& original, Patch patch )
+    {
+        std::vector<uint8_t> bytes = original;
+        patch( bytes );
+        WriteBytes( path, bytes );
+        return IsValidCache( path );
+    }
+
+    bool SameBytes( const void* a, const void* b, size_t size )
+    {
+        return std::memcmp( a, b, size ) == 0;
+    }
+
+    void CheckRoundTrip( const Mesh& mesh )
+    {
+        const Test::TemporaryDirectory directory;
+        const std::filesystem::path path = directory.GetPath() / "grid.mesh";
+        WriteMeshCache( path, { mesh, mesh }, Stamp );
+
+        const MappedMeshCache cache( path );
+        CHECK( cache.IsValid() );
+        CHECK( cache.GetMeshCount() == 2 );
+        if ( cache.GetMeshCount() != 2 )
+            return;
+
+        const MeshView view = cache.GetMesh( 1 );
+        CHECK( view.m_vertexCount == mesh.m_vertices.size() );
+        CHECK( SameBytes( view.m_vertices, mesh.m_vertices.data(), sizeof( Mesh::VertexInfo ) * mesh.m_vertices.size() ) );
+
+        const std::vector<uint8_t> indices = PackIndices( mesh.m_indices, mesh.m_submeshes, mesh.m_indexFormat );
+        CHECK( view.m_indexFormat == mesh.m_indexFormat );
+        CHECK( view.m_indexCount == mesh.m_indices.size() * 3 );
+        CHECK( view.GetIndexBufferSize() == indices.size() );
+        CHECK( SameBytes( view.m_indices, indices.data(), indices.size() ) );
+
+        CHECK( view.m_submeshCount == mesh.m_submeshes.size() );
+        CHECK( SameBytes( view.m_submeshes, mesh.m_submeshes.data(), sizeof( Submesh ) * mesh.m_submeshes.size() ) );
+        CHECK( SameBytes( view.m_submeshBounds, mesh.m_submeshBounds.data(), sizeof( BoundingVolume ) * mesh.m_submeshBounds.size() ) );
+        CHECK( SameBytes( &view.m_bounds, &mesh.m_bounds, sizeof( BoundingVolume ) ) );
+
+        bool tangents = view.m_tangents != nullptr;
+        for ( size_t i = 0; tangents && i < mesh.m_tangents.size(); ++i )
+        {
+            const PackedTangent packed = PackTangent( mesh.m_tangents[i] );
+            tangents &= SameBytes( &view.m_tangents[i], &packed, sizeof( PackedTangent ) );
+        }
+        CHECK( tangents );
+
+        CHECK( view.m_skin != nullptr && SameBytes( view.m_skin, mesh.m_skin.m_vertices.data(), sizeof( VertexSkin ) * mesh.m_vertices.size() ) );
+        CHECK( view.m_jointCount == mesh.m_skin.m_jointNodes.size() );
+        bool joints = view.m_joints != nullptr;
+        for ( uint32_t joint = 0; joints && joint < view.m_jointCount; ++joint )
+        {
+            joints &= view.m_joints[joint].m_node == mesh.m_skin.m_jointNodes[joint] &&
+                SameBytes( &view.m_joints[joint].m_inverseBindMatrix, &mesh.m_skin.m_inverseBindMatrices[joint], sizeof( DirectX::XMFLOAT4X4 ) );
+        }
+        CHECK( joints );
+
+        // Levels of detail are absolute into the whole vertex buffer, 16-bit only with a single submesh.
+        CHECK( view.m_lodCount == mesh.m_lods.size() );
+        const IndexFormat lodFormat = mesh.m_submeshes.size() == 1 ? mesh.m_indexFormat : IndexFormat::UInt32;
+        Submesh whole;
+        whole.m_vertexCount = static_cast<uint32_t>( mesh.m_vertices.size() );
+        for ( uint32_t lod = 0; lod < view.m_lodCount; ++lod )
+        {
+            const MeshLodView lodView = cache.GetLod( 1, lod );
+            whole.m_indexCount = static_cast<uint32_t>( mesh.m_lods[lod].m_indices.size() * 3 );
+            const std::vector<uint8_t> lodIndices = PackIndices( mesh.m_lods[lod].m_indices, { whole }, lodFormat );
+            CHECK( lodView.m_indexFormat == lodFormat );
+            CHECK( lodView.GetIndexBufferSize() == lodIndices.size() );
+            CHECK( SameBytes( lodView.m_indices, lodIndices.data(), lodIndices.size() ) );
+            CHECK( lodView.m_error == mesh.m_lods[lod].m_error );
+            CHECK( SameBytes( &lodView.m_bounds, &mesh.m_lods[lod].m_bounds, sizeof( BoundingVolume ) ) );
+        }
+    }
+
+    // A valid cache of two meshes on disk, and its bytes to corrupt.
+    struct CacheFile
+    {
+        Test::TemporaryDirectory m_directory;
+        std::filesystem::path m_path = m_directory.GetPath() / "grid.mesh";
+        std::vector<uint8_t> m_bytes;
+
+        CacheFile()
+        {
+            const Mesh mesh = MakeCacheMesh( 8, 40, IndexFormat::UInt16 );
+            WriteMeshCache( m_path, { mesh, mesh }, Stamp );
+            m_bytes = ReadBytes( m_path );
+        }
+
+        [[nodiscard]] static uint64_t GetEntryOffset( uint32_t mesh ) { return sizeof( MeshCacheHeader ) + sizeof( MeshCacheEntry ) * mesh; }
+        [[nodiscard]] MeshCacheEntry GetEntry( uint32_t mesh ) const { return Load<MeshCacheEntry>( m_bytes, GetEntryOffset( mesh ) ); }
+    };
+}
+
+OLEX_TEST( RoundTripsWith16BitSubmeshes )
+{
+    const Mesh mesh = MakeCacheMesh( 8, 40, IndexFormat::UInt16 );
+    CHECK( mesh.m_submeshes.size() > 1 );
+    CheckRoundTrip( mesh );
+}
+
+OLEX_TEST( RoundTripsWith32BitIndices )
+{
+    const Mesh mesh = MakeCacheMesh( 8, MaxIndex16Vertices, IndexFormat::UInt32 );
+    CHECK( mesh.m_submeshes.size() == 1 );
+    CheckRoundTrip( mesh );
+}
+
+OLEX_TEST( RoundTripsWith16BitLevelsOfDetail )
+{
+    const Mesh mesh = MakeCacheMesh( 8, MaxIndex16Vertices, IndexFormat::UInt16 );
+    CheckRoundTrip( mesh );
+}
+
+OLEX_TEST( RoundTripsRigidMeshesWithoutTangents )
+{
+    Mesh mesh = Test::MakeGridMesh( 4 );
+    mesh.m_submeshes = SplitSubmeshes( mesh );
+    mesh.m_indexFormat = SelectIndexFormat( mesh.m_submeshes );
+    ComputeMeshBounds( mesh );
+
+    const Test::TemporaryDirectory directory;
+    const std::filesystem::path path = directory.GetPath() / "rigid.mesh";
+    WriteMeshCache( path, { mesh }, Stamp );
+
+    const MappedMeshCache cache( path );
+    CHECK( cache.IsValid() );
+    const MeshView view = cache.GetMesh( 0 );
+    CHECK( view.m_tangents == nullptr );
+    CHECK( view.m_skin == nullptr && view.m_joints == nullptr && view.m_jointCount == 0 );
+    CHECK( view.m_lodCount == 0 );
+    CHECK( SameBytes( view.m_vertices, mesh.m_vertices.data(), sizeof( Mesh::VertexInfo ) * mesh.m_vertices.size() ) );
+}
+
+OLEX_TEST( WritingLeavesNoTemporaryFiles )
+{
+    const CacheFile file;
+    size_t files = 0;
+    for ( const auto& entry : std::filesystem::directory_iterator( file.m_directory.GetPath() ) )
+        files += entry.path() != file.m_path;
+    CHECK( files == 0 );
+}
+
+OLEX_TEST( RejectsForeignHeaders )
+{
+    const CacheFile file;
+    CHECK( IsValidAfter( file.m_path, file.m_bytes, []( std::vector<uint8_t>& ) {} ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, []( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, offsetof( MeshCacheHeader, m_magic ), uint32_t( 0x46424D4F ) );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, []( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, offsetof( MeshCacheHeader, m_version ), uint16_t( MeshCacheFormat::Version - 1 ) );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, []( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, offsetof( MeshCacheHeader, m_endianTag ), uint16_t( 0x0201 ) );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, []( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, offsetof( MeshCacheHeader, m_vertexStride ), uint32_t( 16 ) );
+        } ) );
+}
+
+OLEX_TEST( RejectsTruncatedFiles )
+{
+    const CacheFile file;
+    for ( size_t size : { size_t( 0 ), sizeof( MeshCacheHeader ) - 1, sizeof( MeshCacheHeader ), size_t( CacheFile::GetEntryOffset( 2 ) ),
+        file.m_bytes.size() / 2, file.m_bytes.size() - 1 } )
+    {
+        WriteBytes( file.m_path, std::vector<uint8_t>( file.m_bytes.begin(), file.m_bytes.begin() + size ) );
+        CHECK( !IsValidCache( file.m_path ) );
+    }
+
+    CHECK( !IsValidCache( file.m_directory.GetPath() / "missing.mesh" ) );
+}
+
+OLEX_TEST( RejectsBlobsOutsideTheFile )
+{
+    const CacheFile file;
+    const MeshCacheEntry entry = file.GetEntry( 1 );
+    const uint64_t entryOffset = CacheFile::GetEntryOffset( 1 );
+    const uint64_t fileSize = file.m_bytes.size();
+    const uint64_t pastEnd = ( fileSize + 15 ) / 16 * 16 + 16;
+
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, entryOffset + offsetof( MeshCacheEntry, m_vertexOffset ), pastEnd );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, entryOffset + offsetof( MeshCacheEntry, m_indexCount ), uint32_t( fileSize ) );
+        } ) );
+    // Pointing into the header and entry table.
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, entryOffset + offsetof( MeshCacheEntry, m_submeshOffset ), uint64_t( 16 ) );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, entryOffset + offsetof( MeshCacheEntry, m_tangentOffset ), entry.m_tangentOffset + 4 );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, entryOffset + offsetof( MeshCacheEntry, m_jointCount ), MaxSkinJoints + 1 );
+        } ) );
+}
+
+OLEX_TEST( RejectsOffsetsThatWrapAround )
+{
+    const CacheFile file;
+    const MeshCacheEntry entry = file.GetEntry( 1 );
+    const uint64_t entryOffset = CacheFile::GetEntryOffset( 1 );
+
+    // The last aligned offset below 2^64: adding any blob size larger than the alignment wraps
+    // around to a small end inside the file, which a plain end check accepts.
+    const uint64_t wrapping = ~uint64_t( 0 ) - ( MeshCacheFormat::BlobAlignment - 1 );
+    CHECK( wrapping + sizeof( Mesh::VertexInfo ) * uint64_t( entry.m_vertexCount ) < file.m_bytes.size() );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, entryOffset + offsetof( MeshCacheEntry, m_vertexOffset ), wrapping );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, entryOffset + offsetof( MeshCacheEntry, m_indexOffset ), wrapping );
+        } ) );
+
+    const MeshCacheLod lod = Load<MeshCacheLod>( file.m_bytes, entry.m_lodOffset );
+    CHECK( wrapping + uint64_t( lod.m_indexCount ) * static_cast<uint32_t>( lod.m_indexFormat ) < file.m_bytes.size() );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, entry.m_lodOffset + offsetof( MeshCacheLod, m_indexOffset ), wrapping );
+        } ) );
+}
+
+OLEX_TEST( RejectsSubmeshesOutsideTheBuffers )
+{
+    const CacheFile file;
+    const MeshCacheEntry entry = file.GetEntry( 0 );
+    const uint64_t submeshOffset = entry.m_submeshOffset;
+    const Submesh last = Load<Submesh>( file.m_bytes, submeshOffset + sizeof( Submesh ) * ( entry.m_submeshCount - 1 ) );
+    const uint64_t lastOffset = submeshOffset + sizeof( Submesh ) * ( entry.m_submeshCount - 1 );
+
+    CHECK( last.m_startIndex + last.m_indexCount == entry.m_indexCount );
+    CHECK( last.m_baseVertex + last.m_vertexCount == entry.m_vertexCount );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, lastOffset + offsetof( Submesh, m_indexCount ), last.m_indexCount + 3 );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, lastOffset + offsetof( Submesh, m_vertexCount ), last.m_vertexCount + 1 );
+        } ) );
+    // Sums that wrap in 32 bits.
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, lastOffset + offsetof( Submesh, m_startIndex ), uint32_t( 0 ) - last.m_indexCount + 3 );
+        } ) );
+    CHECK( !IsValidAfter( file.m_path, file.m_bytes, [&]( std::vector<uint8_t>& bytes )
+        {
+            Store( bytes, lastOffset + offsetof( Submesh, m_baseVertex ), uint32_t( 0 ) - last.m_vertexCount + 1 );
+        } ) );
+}
+
+OLEX_TEST( IsUpToDateComparesTheSourceStamp )
+{
+    const CacheFile file;
+    const MappedMeshCache cache( file.m_path );
+    CHECK( cache.IsUpToDate( Stamp ) );
+    CHECK( !cache.IsUpToDate( { Stamp.m_size + 1, Stamp.m_writeTime } ) );
+    CHECK( !cache.IsUpToDate( { Stamp.m_size, Stamp.m_writeTime + 1 } ) );
+
+    // An unreadable cache is never up to date, even with the right stamp.
+    const MappedMeshCache missing( file.m_directory.GetPath() / "missing.mesh" );
+    CHECK( !missing.IsUpToDate( Stamp ) );
+    CHECK( !missing.IsUpToDate( SourceStamp{} ) );
+}
+
+OLEX_TEST( SourceStampFollowsTheFile )
+{
+    const Test::TemporaryDirectory directory;
+    const std::filesystem::path source = directory.GetPath() / "source.fbx";
+    CHECK( SourceStamp::FromFile( source ) == SourceStamp{} );
+
+    WriteBytes( source, std::vector<uint8_t>( 100, 1 ) );
+    const SourceStamp stamp = SourceStamp::FromFile( source );
+    CHECK( stamp.m_size == 100 );
+    CHECK( stamp == SourceStamp::FromFile( source ) );
+
+    // A baked cache of that source is current until the source changes.
+    WriteMeshCache( directory.GetPath() / "source.mesh", { MakeCacheMesh( 2, MaxIndex16Vertices, IndexFormat::UInt16 ) }, stamp );
+    CHECK( MappedMeshCache( directory.GetPath() / "source.mesh" ).IsUpToDate( SourceStamp::FromFile( source ) ) );
+    WriteBytes( source, std::vector<uint8_t>( 101, 1 ) );
+    CHECK( !MappedMeshCache( directory.GetPath() / "source.mesh" ).IsUpToDate( SourceStamp::FromFile( source ) ) );
+}
@@ -0,0 +1,88 @@
+#include <cmath>
+
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+namespace
+{
+    Mesh MakeBumpySphere( uint32_t rings, uint32_t segments )
+    {
+        Mesh mesh = Test::MakeSphereMesh( rings, segments, 0.06f, Test::Pi - 0.06f );
+        for ( Mesh::VertexInfo& vertex : mesh.m_vertices )
+        {
+            const float theta = std::acos( vertex.m_normal.y );
+            const float phi = vertex.m_uv.x * 2.f * Test::Pi;
+            const float radius = 1.f + 0.03f * std::sin( 5.f * phi ) * std::sin( 7.f * theta );
+            vertex.m_position = { vertex.m_normal.x * radius, vertex.m_normal.y * radius, vertex.m_normal.z * radius };
+        }
+        return mesh;
+    }
+
+    bool IndicesInRange( const std::vector<DirectX::XMINT3>& triangles, size_t vertexCount )
+    {
+        for ( const DirectX::XMINT3& triangle : triangles )
+        {
+            for ( int32_t vertex : { triangle.x, triangle.y, triangle.z } )
+            {
+                if ( vertex < 0 || size_t( vertex ) >= vertexCount )
+                    return false;
+            }
+        }
+        return true;
+    }
+}
+
+OLEX_TEST( LodChainHalvesTrianglesAndAccumulatesError )
+{
+    const Mesh mesh = MakeBumpySphere( 60, 60 );
+    const std::vector<MeshLod> lods = BuildLodChain( mesh, 4 );
+    CHECK( lods.size() == 4 );
+
+    size_t previousCount = mesh.m_indices.size();
+    float previousError = 0.f;
+    for ( const MeshLod& lod : lods )
+    {
+        CHECK( lod.m_indices.size() <= previousCount * 55 / 100 );
+        CHECK( lod.m_error >= previousError );
+        CHECK( IndicesInRange( lod.m_indices, mesh.m_vertices.size() ) );
+        previousCount = lod.m_indices.size();
+        previousError = lod.m_error;
+    }
+    CHECK( previousError > 0.f );
+}
+
+OLEX_TEST( FlatGridSimplifiesWithoutError )
+{
+    const Mesh mesh = Test::MakeGridMesh( 16 );
+    float error = -1.f;
+    const std::vector<DirectX::XMINT3> simplified = SimplifyMesh( mesh, mesh.m_indices, 8, 1e-3f, &error );
+
+    CHECK( simplified.size() < mesh.m_indices.size() / 4 );
+    CHECK_NEAR( error, 0.0, 1e-5 );
+}
+
+OLEX_TEST( StopsBeforeExceedingTheMaximumError )
+{
+    const Mesh mesh = MakeBumpySphere( 40, 40 );
+    for ( float maxError : { 1e-4f, 1e-3f, 1e-2f } )
+    {
+        float error = -1.f;
+        const std::vector<DirectX::XMINT3> simplified = SimplifyMesh( mesh, mesh.m_indices, 0, maxError, &error );
+        CHECK( error <= maxError );
+        CHECK( !simplified.empty() );
+    }
+}
+
+OLEX_TEST( ChainEndsAtTheRelativeErrorBudget )
+{
+    const Mesh mesh = MakeBumpySphere( 40, 40 );
+    const std::vector<MeshLod> lods = BuildLodChain( mesh, 20, 0.5f, 0.01f );
+
+    // The extent of the sphere is its diagonal, about 2 * sqrt( 3 ).
+    CHECK( !lods.empty() && lods.size() < 20 );
+    CHECK( lods.back().m_error <= 0.01f * 2.f * std::sqrt( 3.f ) * 1.04f );
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+
+#include "MeshletBuilder.h"
+#include "Test.h"
+#include "TestMeshes.h"
+#include "VertexCacheOptimizer.h"
+
+using namespace Olex;
+using namespace Olex::Test;
+
+namespace
+{
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    Float3 operator- ( const Float3& a, const Float3& b ) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    float Dot( const Float3& a, const Float3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Float3 Cross( const Float3& a, const Float3& b ) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    Float3 ToFloat3( const DirectX::XMFLOAT3& v ) { return { v.x, v.y, v.z }; }
+
+    Float3 MeshletPosition( const Mesh& mesh, const MeshletData& data, const Meshlet& meshlet, uint32_t triangle, uint32_t corner )
+    {
+        const uint8_t local = data.m_triangles[meshlet.m_triangleOffset + triangle * 3 + corner];
+        return ToFloat3( mesh.m_vertices[data.m_vertices[meshlet.m_vertexOffset + local]].m_position );
+    }
+
+    // The camera sees the front of the triangle, by a margin that keeps grazing views out.
+    bool IsFrontFacing( const Float3& a, const Float3& b, const Float3& c, const Float3& camera )
+    {
+        const Float3 normal = Cross( b - a, c - a );
+        const float length = std::sqrt( Dot( normal, normal ) );
+        if ( length == 0.f )
+            return false;
+        return Dot( camera - a, normal ) / length > 1e-4f;
+    }
+
+    bool IsConeCulled( const MeshletBounds& bounds, const Float3& camera )
+    {
+        const Float3 view = ToFloat3( bounds.m_coneApex ) - camera;
+        const float length = std::sqrt( Dot( view, view ) );
+        if ( length == 0.f )
+            return false;
+        return Dot( view, ToFloat3( bounds.m_coneAxis ) ) / length >= bounds.m_coneCutoff;
+    }
+
+    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> MeshletTriangles( const MeshletData& data )
+    {
+        std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> triangles;
+        for ( const Meshlet& meshlet : data.m_meshlets )
+        {
+            for ( uint32_t triangle = 0; triangle < meshlet.m_triangleCount; ++triangle )
+            {
+                const uint8_t* local = &data.m_triangles[meshlet.m_triangleOffset + triangle * 3];
+                triangles.emplace_back( data.m_vertices[meshlet.m_vertexOffset + local[0]],
+                    data.m_vertices[meshlet.m_vertexOffset + local[1]], data.m_vertices[meshlet.m_vertexOffset + local[2]] );
+            }
+        }
+        std::sort( triangles.begin(), triangles.end() );
+        return triangles;
+    }
+
+    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> MeshTriangles( const Mesh& mesh )
+    {
+        std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> triangles;
+        for ( const DirectX::XMINT3& triangle : mesh.m_indices )
+            triangles.emplace_back( uint32_t( triangle.x ), uint32_t( triangle.y ), uint32_t( triangle.z ) );
+        std::sort( triangles.begin(), triangles.end() );
+        return triangles;
+    }
+
+    // The inside of a hemisphere bowl, both faces of its rim region seen from everywhere around.
+    Mesh MakeBowlMesh()
+    {
+        Mesh mesh = MakeSphereMesh( 24, 48, Pi * 0.5f, Pi, true );
+        OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+        return mesh;
+    }
+}
+
+OLEX_TEST( ConeNeverCullsAFrontFacingTriangle )
+{
+    for ( const Mesh& mesh : { MakeBowlMesh(), MakeSphereMesh( 24, 48 ) } )
+    {
+        const MeshletData data = BuildMeshlets( mesh );
+
+        Random random( 6 );
+        uint32_t culled = 0;
+        uint32_t falselyCulled = 0;
+        for ( int view = 0; view < 20000; ++view )
+        {
+            const Float3 camera = { random.Range( -3.f, 3.f ), random.Range( -3.f, 3.f ), random.Range( -3.f, 3.f ) };
+            for ( size_t index = 0; index < data.m_meshlets.size(); ++index )
+            {
+                if ( !IsConeCulled( data.m_bounds[index], camera ) )
+                    continue;
+                ++culled;
+
+                const Meshlet& meshlet = data.m_meshlets[index];
+                for ( uint32_t triangle = 0; triangle < meshlet.m_triangleCount; ++triangle )
+                {
+                    if ( IsFrontFacing( MeshletPosition( mesh, data, meshlet, triangle, 0 ), MeshletPosition( mesh, data, meshlet, triangle, 1 ),
+                        MeshletPosition( mesh, data, meshlet, triangle, 2 ), camera ) )
+                    {
+                        ++falselyCulled;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // The cone has to cull something to be worth checking.
+        CHECK( culled > 0 );
+        CHECK( falselyCulled == 0 );
+    }
+}
+
+OLEX_TEST( MeshletsStayWithinTheirLimits )
+{
+    const Mesh mesh = MakeSphereMesh( 40, 80 );
+    const uint32_t limits[][2] = { { MaxMeshletVertices, MaxMeshletTriangles }, { 32, 16 }, { 3, 1 }, { 255, 512 } };
+
+    for ( const auto& limit : limits )
+    {
+        const MeshletData data = BuildMeshlets( mesh, limit[0], limit[1] );
+        CHECK( data.m_bounds.size() == data.m_meshlets.size() );
+
+        bool withinLimits = true;
+        bool localIndicesValid = true;
+        bool verticesUnique = true;
+        for ( const Meshlet& meshlet : data.m_meshlets )
+        {
+            withinLimits &= meshlet.m_vertexCount <= limit[0] && meshlet.m_triangleCount <= limit[1] && meshlet.m_triangleCount > 0;
+
+            for ( uint32_t i = 0; i < meshlet.m_triangleCount * 3; ++i )
+                localIndicesValid &= data.m_triangles[meshlet.m_triangleOffset + i] < meshlet.m_vertexCount;
+
+            std::vector<uint32_t> vertices( data.m_vertices.begin() + meshlet.m_vertexOffset,
+                data.m_vertices.begin() + meshlet.m_vertexOffset + meshlet.m_vertexCount );
+            std::sort( vertices.begin(), vertices.end() );
+            verticesUnique &= std::adjacent_find( vertices.begin(), vertices.end() ) == vertices.end();
+        }
+        CHECK( withinLimits );
+        CHECK( localIndicesValid );
+        CHECK( verticesUnique );
+
+        // Every triangle lands in exactly one meshlet, with its winding.
+        CHECK( MeshletTriangles( data ) == MeshTriangles( mesh ) );
+    }
+}
+
+OLEX_TEST( MeshletsAreDeterministic )
+{
+    Mesh mesh = MakeSphereMesh( 30, 60 );
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+
+    const MeshletData first = BuildMeshlets( mesh );
+    const MeshletData second = BuildMeshlets( mesh );
+
+    CHECK( first.m_vertices == second.m_vertices );
+    CHECK( first.m_triangles == second.m_triangles );
+    CHECK( first.m_meshlets.size() == second.m_meshlets.size() );
+
+    bool sameMeshlets = first.m_meshlets.size() == second.m_meshlets.size();
+    for ( size_t i = 0; sameMeshlets && i < first.m_meshlets.size(); ++i )
+    {
+        const Meshlet& a = first.m_meshlets[i];
+        const Meshlet& b = second.m_meshlets[i];
+        sameMeshlets = a.m_vertexOffset == b.m_vertexOffset && a.m_vertexCount == b.m_vertexCount
+            && a.m_triangleOffset == b.m_triangleOffset && a.m_triangleCount == b.m_triangleCount;
+    }
+    CHECK( sameMeshlets );
+}
+
+OLEX_TEST( BoundingSpheresContainTheirVertices )
+{
+    const Mesh mesh = MakeSphereMesh( 20, 40 );
+    const MeshletData data = BuildMeshlets( mesh );
+
+    bool contained = true;
+    for ( size_t index = 0; index < data.m_meshlets.size(); ++index )
+    {
+        const Meshlet& meshlet = data.m_meshlets[index];
+        const MeshletBounds& bounds = data.m_bounds[index];
+        for ( uint32_t i = 0; i < meshlet.m_vertexCount; ++i )
+        {
+            const Float3 offset = ToFloat3( mesh.m_vertices[data.m_vertices[meshlet.m_vertexOffset + i]].m_position ) - ToFloat3( bounds.m_center );
+            contained &= std::sqrt( Dot( offset, offset ) ) <= bounds.m_radius * 1.0001f;
+        }
+    }
+    CHECK( contained );
+}
+
+OLEX_TEST( RejectsLimitsOutsideEightBitIndices )
+{
+    const Mesh mesh = MakeGridMesh( 2 );
+    const uint32_t limits[][2] = { { 2, 124 }, { 256, 124 }, { 64, 0 } };
+    for ( const auto& limit : limits )
+    {
+        bool threw = false;
+        try
+        {
+            BuildMeshlets( mesh, limit[0], limit[1] );
+        }
+        catch ( const std::invalid_argument& )
+        {
+            threw = true;
+        }
+        CHECK( threw );
+    }
+}
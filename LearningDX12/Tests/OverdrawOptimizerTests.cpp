@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <tuple>
+
+#include "OverdrawOptimizer.h"
+#include "Test.h"
+#include "TestMeshes.h"
+#include "VertexCacheOptimizer.h"
+
+using namespace Olex;
+using namespace Olex::Test;
+
+namespace
+{
+    std::vector<std::tuple<int32_t, int32_t, int32_t>> SortedTriangles( const Mesh& mesh )
+    {
+        std::vector<std::tuple<int32_t, int32_t, int32_t>> triangles;
+        for ( const DirectX::XMINT3& triangle : mesh.m_indices )
+            triangles.emplace_back( triangle.x, triangle.y, triangle.z );
+        std::sort( triangles.begin(), triangles.end() );
+        return triangles;
+    }
+}
+
+OLEX_TEST( DegenerateFirstTriangleIsKept )
+{
+    // The first triangle misses on two vertices only, so no cluster boundary is found at it.
+    Mesh mesh = MakeGridMesh( 1 );
+    mesh.m_indices.insert( mesh.m_indices.begin(), DirectX::XMINT3( 0, 0, 1 ) );
+
+    const auto before = SortedTriangles( mesh );
+    OptimizeOverdraw( mesh );
+    CHECK( mesh.m_indices.size() == 3 );
+    CHECK( SortedTriangles( mesh ) == before );
+}
+
+OLEX_TEST( MeshWithoutHardBoundariesIsKept )
+{
+    // Every triangle is degenerate, none of them misses on three vertices.
+    Mesh mesh = MakeGridMesh( 2 );
+    mesh.m_indices = { { 0, 0, 1 }, { 1, 1, 2 }, { 2, 2, 3 }, { 3, 3, 4 } };
+
+    const auto before = SortedTriangles( mesh );
+    OptimizeOverdraw( mesh );
+    CHECK( SortedTriangles( mesh ) == before );
+}
+
+OLEX_TEST( SharedVertexFirstTriangleIsKept )
+{
+    Mesh mesh = MakeSphereMesh( 12, 24 );
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+
+    // A first triangle sharing a vertex with itself misses only twice.
+    mesh.m_indices.insert( mesh.m_indices.begin(), DirectX::XMINT3( mesh.m_indices[0].x, mesh.m_indices[0].x, mesh.m_indices[0].y ) );
+
+    const auto before = SortedTriangles( mesh );
+    OptimizeOverdraw( mesh );
+    CHECK( SortedTriangles( mesh ) == before );
+}
+
+OLEX_TEST( OutputIsAPermutationOfTheInput )
+{
+    Mesh mesh = MakeSphereMesh( 32, 64 );
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+
+    const auto before = SortedTriangles( mesh );
+    OptimizeOverdraw( mesh );
+    CHECK( SortedTriangles( mesh ) == before );
+}
+
+OLEX_TEST( ConvexMeshHasNoOverdrawAfterOptimization )
+{
+    // Back faces are culled, so a convex mesh never shades a pixel twice in any order.
+    Mesh mesh = MakeSphereMesh( 16, 32 );
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+    OptimizeOverdraw( mesh );
+
+    const OverdrawStatistics statistics = AnalyzeOverdraw( mesh, 64 );
+    CHECK( statistics.m_pixelsCovered > 0 );
+    CHECK_NEAR( statistics.m_overdraw, 1.0, 0.02 );
+}
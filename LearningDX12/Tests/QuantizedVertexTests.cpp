@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "QuantizedVertex.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+namespace
+{
+    // QuantizedVertexF16CTests builds the encoder with F16C; on a CPU without it there is nothing to check.
+    bool CanRunEncoder()
+    {
+#if defined(OLEX_QUANTIZED_F16C) && ( defined(__GNUC__) || defined(__clang__) )
+        return __builtin_cpu_supports( "f16c" );
+#else
+        return true;
+#endif
+    }
+
+    DirectX::XMFLOAT3 RandomUnitVector( Test::Random& random )
+    {
+        const float z = random.Range( -1.f, 1.f );
+        const float phi = random.Range( 0.f, 2.f * Test::Pi );
+        const float r = std::sqrt( std::max( 1.f - z * z, 0.f ) );
+        return { r * std::cos( phi ), r * std::sin( phi ), z };
+    }
+
+    /**
+     * Random vertices inside the box [-3, 5] x [-1, 1] x [10, 10.5], which the first two span exactly,
+     * with uvs in [uvMinimum, uvMaximum] and random unit normals.
+     */
+    std::vector<Mesh::VertexInfo> MakeRandomVertices( size_t count, float uvMinimum, float uvMaximum, uint32_t seed )
+    {
+        Test::Random random( seed );
+        std::vector<Mesh::VertexInfo> vertices( count );
+        for ( Mesh::VertexInfo& vertex : vertices )
+        {
+            const DirectX::XMFLOAT3 normal = RandomUnitVector( random );
+            vertex = Test::MakeVertex( random.Range( -3.f, 5.f ), random.Range( -1.f, 1.f ), random.Range( 10.f, 10.5f ),
+                normal.x, normal.y, normal.z, random.Range( uvMinimum, uvMaximum ), random.Range( uvMinimum, uvMaximum ) );
+        }
+        vertices[0].m_position = { -3.f, -1.f, 10.f };
+        vertices[1].m_position = { 5.f, 1.f, 10.5f };
+        return vertices;
+    }
+
+    float AngleDegrees( const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b )
+    {
+        const float cosine = ( a.x * b.x + a.y * b.y + a.z * b.z ) /
+            std::sqrt( ( a.x * a.x + a.y * a.y + a.z * a.z ) * ( b.x * b.x + b.y * b.y + b.z * b.z ) );
+        return std::acos( std::min( std::max( cosine, -1.f ), 1.f ) ) * 180.f / Test::Pi;
+    }
+}
+
+OLEX_TEST( BlockEncoderMatchesScalarEncoderBitForBit )
+{
+    if ( !CanRunEncoder() )
+        return;
+
+    std::vector<Mesh::VertexInfo> vertices = MakeRandomVertices( 4000, -2.f, 2.f, 1 );
+
+    // Values where rounding, folding and half conversion have edge cases.
+    const float uvs[] = { 0.f, -0.f, 1.f, 1e-6f, -3e-5f, 6.1e-5f, 65504.f, 70000.f, -1e9f, 0.33333334f, 2049.f };
+    const DirectX::XMFLOAT3 normals[] = { { 0.f, 0.f, 0.f }, { 0.f, 0.f, -1.f }, { 1.f, 0.f, 0.f }, { -1.f, 0.f, 0.f },
+        { 0.f, -1.f, 0.f }, { 0.6f, -0.8f, 0.f }, { 0.f, 0.6f, -0.8f }, { -0.57735f, -0.57735f, -0.57735f } };
+    for ( size_t i = 0; i < std::size( uvs ); ++i )
+        vertices[2 + i].m_uv = { uvs[i], -uvs[i] };
+    for ( size_t i = 0; i < std::size( normals ); ++i )
+        vertices[20 + i].m_normal = normals[i];
+
+    // Every vertex is encoded four at a time in the whole array, and alone after the two box corners in
+    // an array of three, which goes through the scalar tail with the same quantization box.
+    const PackedVertices blocks = EncodeVertices( vertices.data(), vertices.size() );
+    bool identical = true;
+    for ( size_t i = 2; i < vertices.size(); ++i )
+    {
+        const Mesh::VertexInfo single[3] = { vertices[0], vertices[1], vertices[i] };
+        const PackedVertices scalar = EncodeVertices( single, 3 );
+        identical &= std::memcmp( &scalar.m_quantization, &blocks.m_quantization, sizeof( PositionQuantization ) ) == 0 &&
+            std::memcmp( &scalar.m_vertices[2], &blocks.m_vertices[i], sizeof( PackedVertex ) ) == 0;
+    }
+    CHECK( identical );
+}
+
+OLEX_TEST( PositionsStayWithinHalfAStep )
+{
+    if ( !CanRunEncoder() )
+        return;
+
+    const std::vector<Mesh::VertexInfo> vertices = MakeRandomVertices( 10001, 0.f, 1.f, 2 );
+    const PackedVertices packed = EncodeVertices( vertices.data(), vertices.size() );
+    const PositionQuantization& quantization = packed.m_quantization;
+    CHECK( quantization.m_offset.x == -3.f && quantization.m_offset.y == -1.f && quantization.m_offset.z == 10.f );
+    CHECK( quantization.m_scale.x == 8.f && quantization.m_scale.y == 2.f && quantization.m_scale.z == 0.5f );
+
+    std::vector<Mesh::VertexInfo> decoded( vertices.size() );
+    DecodeVertices( packed, decoded.data() );
+
+    // Half a step per axis, plus the float rounding of values around 10.
+    const float slack = 1e-6f * 16.f;
+    bool within = true;
+    for ( size_t i = 0; i < vertices.size(); ++i )
+    {
+        within &= std::fabs( decoded[i].m_position.x - vertices[i].m_position.x ) <= quantization.m_scale.x / 65535.f / 2.f + slack;
+        within &= std::fabs( decoded[i].m_position.y - vertices[i].m_position.y ) <= quantization.m_scale.y / 65535.f / 2.f + slack;
+        within &= std::fabs( decoded[i].m_position.z - vertices[i].m_position.z ) <= quantization.m_scale.z / 65535.f / 2.f + slack;
+    }
+    CHECK( within );
+    CHECK( MeasureQuantizationError( vertices.data(), packed ).m_maxPositionError <= 8.f / 65535.f / 2.f + slack );
+}
+
+OLEX_TEST( UVsStayWithinTheHalfFloatBound )
+{
+    if ( !CanRunEncoder() )
+        return;
+
+    // Inside [0, 1] the absolute error is at most 2^-12.
+    const std::vector<Mesh::VertexInfo> unit = MakeRandomVertices( 10001, 0.f, 1.f, 3 );
+    const PackedVertices packedUnit = EncodeVertices( unit.data(), unit.size() );
+    CHECK( MeasureQuantizationError( unit.data(), packedUnit ).m_maxUVError <= 1.f / 4096.f );
+
+    // Elsewhere the relative error is at most 2^-11, for values in the normal half range.
+    const std::vector<Mesh::VertexInfo> wide = MakeRandomVertices( 10001, -1000.f, 1000.f, 4 );
+    const PackedVertices packedWide = EncodeVertices( wide.data(), wide.size() );
+    std::vector<Mesh::VertexInfo> decoded( wide.size() );
+    DecodeVertices( packedWide, decoded.data() );
+
+    bool within = true;
+    for ( size_t i = 0; i < wide.size(); ++i )
+    {
+        if ( std::fabs( wide[i].m_uv.x ) >= 6.103515625e-5f )
+            within &= std::fabs( decoded[i].m_uv.x - wide[i].m_uv.x ) <= std::fabs( wide[i].m_uv.x ) / 2048.f;
+        if ( std::fabs( wide[i].m_uv.y ) >= 6.103515625e-5f )
+            within &= std::fabs( decoded[i].m_uv.y - wide[i].m_uv.y ) <= std::fabs( wide[i].m_uv.y ) / 2048.f;
+    }
+    CHECK( within );
+}
+
+OLEX_TEST( HalfConversionRoundTripsEveryHalf )
+{
+    bool exact = true;
+    for ( uint32_t bits = 0; bits < 0x10000u; ++bits )
+    {
+        const uint16_t half = static_cast<uint16_t>( bits );
+        // Skip nan, whose payload is not preserved.
+        if ( ( half & 0x7c00u ) == 0x7c00u && ( half & 0x3ffu ) != 0 )
+            continue;
+        exact &= FloatToHalf( HalfToFloat( half ) ) == half;
+    }
+    CHECK( exact );
+
+    CHECK( FloatToHalf( 1.f ) == 0x3c00 );
+    CHECK( FloatToHalf( -2.f ) == 0xc000 );
+    CHECK( FloatToHalf( 65520.f ) == 0x7c00 );
+    // Ties round to even: 1 + 2^-11 lies halfway between 1 and the next half.
+    CHECK( FloatToHalf( 1.f + 1.f / 2048.f ) == 0x3c00 );
+    CHECK( FloatToHalf( 1.f + 3.f / 2048.f ) == 0x3c02 );
+}
+
+OLEX_TEST( NormalsStayUnderADegree )
+{
+    if ( !CanRunEncoder() )
+        return;
+
+    const std::vector<Mesh::VertexInfo> vertices = MakeRandomVertices( 100001, 0.f, 1.f, 5 );
+    const PackedVertices packed = EncodeVertices( vertices.data(), vertices.size() );
+    const QuantizationError error = MeasureQuantizationError( vertices.data(), packed );
+    // The documented figure for random unit vectors.
+    CHECK( error.m_maxNormalErrorDegrees < 0.95f );
+
+    std::vector<Mesh::VertexInfo> decoded( vertices.size() );
+    DecodeVertices( packed, decoded.data() );
+    bool unit = true;
+    for ( const Mesh::VertexInfo& vertex : decoded )
+    {
+        const DirectX::XMFLOAT3& n = vertex.m_normal;
+        unit &= std::fabs( n.x * n.x + n.y * n.y + n.z * n.z - 1.f ) < 1e-5f;
+    }
+    CHECK( unit );
+}
+
+OLEX_TEST( TangentsKeepTheirSignAndDirection )
+{
+    Test::Random random( 6 );
+    float maxError = 0.f;
+    bool signs = true;
+    for ( int i = 0; i < 100000; ++i )
+    {
+        const DirectX::XMFLOAT3 direction = RandomUnitVector( random );
+        const float sign = i % 2 ? 1.f : -1.f;
+        const DirectX::XMFLOAT4 tangent = UnpackTangent( PackTangent( { direction.x, direction.y, direction.z, sign } ) );
+        maxError = std::max( maxError, AngleDegrees( direction, { tangent.x, tangent.y, tangent.z } ) );
+        signs &= tangent.w == sign;
+    }
+    CHECK( maxError < 1.f );
+    CHECK( signs );
+}
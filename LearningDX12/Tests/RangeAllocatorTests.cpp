@@ -0,0 +1,117 @@
+#include <stdexcept>
+
+#include "RangeAllocator.h"
+#include "Test.h"
+
+using namespace Olex;
+
+namespace
+{
+    template <typename Function>
+    bool ThrowsInvalidArgument( Function&& function )
+    {
+        try
+        {
+            function();
+        }
+        catch ( const std::invalid_argument& )
+        {
+            return true;
+        }
+        return false;
+    }
+}
+
+OLEX_TEST( AllocatesFromTheFirstRangeThatFits )
+{
+    RangeAllocator allocator( 1000 );
+    const uint64_t a = allocator.Allocate( 100 );
+    const uint64_t b = allocator.Allocate( 200 );
+    const uint64_t c = allocator.Allocate( 100 );
+    CHECK( a == 0 && b == 100 && c == 300 );
+
+    // The hole b leaves and the tail at 400.
+    allocator.Free( b, 200 );
+    CHECK( allocator.GetFreeRangeCount() == 2 );
+    // 150 lands in the hole rather than the larger tail; 60 then skips the 50 left of the hole.
+    CHECK( allocator.Allocate( 150 ) == 100 );
+    CHECK( allocator.Allocate( 60 ) == 400 );
+    CHECK( allocator.Allocate( 50 ) == 250 );
+    CHECK( allocator.GetFreeSize() == 1000 - 100 - 100 - 150 - 60 - 50 );
+
+    CHECK( allocator.Allocate( 1000 ) == RangeAllocator::InvalidOffset );
+}
+
+OLEX_TEST( AlignmentGapsStayFree )
+{
+    RangeAllocator allocator( 256 );
+    CHECK( allocator.Allocate( 3 ) == 0 );
+    CHECK( allocator.Allocate( 16, 16 ) == 16 );
+    // The 13 bytes skipped for alignment go back to the free list and serve a later allocation.
+    CHECK( allocator.GetFreeSize() == 256 - 3 - 16 );
+    CHECK( allocator.GetFreeRangeCount() == 2 );
+    CHECK( allocator.Allocate( 13 ) == 3 );
+    CHECK( allocator.GetFreeRangeCount() == 1 );
+}
+
+OLEX_TEST( AlignmentNeedNotBeAPowerOfTwo )
+{
+    // Vertices of a 12 byte stride, addressed with a base vertex.
+    RangeAllocator allocator( 120 );
+    CHECK( allocator.Allocate( 5 ) == 0 );
+    const uint64_t vertices = allocator.Allocate( 36, 12 );
+    CHECK( vertices == 12 );
+    CHECK( vertices % 12 == 0 );
+    CHECK( allocator.Allocate( 7 ) == 5 );
+    CHECK( allocator.Allocate( 24, 12 ) == 48 );
+    CHECK( allocator.GetFreeSize() == 120 - 5 - 36 - 7 - 24 );
+
+    // Aligned to 7 the 48 bytes left at 72 start at 77, which leaves 43.
+    CHECK( allocator.Allocate( 48, 7 ) == RangeAllocator::InvalidOffset );
+    CHECK( allocator.Allocate( 43, 7 ) == 77 );
+    CHECK( allocator.GetFreeRangeCount() == 1 );
+}
+
+OLEX_TEST( FreedRangesMergeWithBothNeighbours )
+{
+    RangeAllocator allocator( 300 );
+    const uint64_t a = allocator.Allocate( 100 );
+    const uint64_t b = allocator.Allocate( 100 );
+    const uint64_t c = allocator.Allocate( 100 );
+    CHECK( allocator.GetFreeRangeCount() == 0 );
+
+    allocator.Free( a, 100 );
+    allocator.Free( c, 100 );
+    CHECK( allocator.GetFreeRangeCount() == 2 );
+    // The middle range joins the one before and the one after into a single range.
+    allocator.Free( b, 100 );
+    CHECK( allocator.GetFreeRangeCount() == 1 );
+    CHECK( allocator.GetFreeSize() == 300 );
+    CHECK( allocator.Allocate( 300 ) == 0 );
+}
+
+OLEX_TEST( BadFreesThrow )
+{
+    RangeAllocator allocator( 100 );
+    const uint64_t a = allocator.Allocate( 40 );
+    const uint64_t b = allocator.Allocate( 40 );
+    allocator.Free( a, 40 );
+
+    // Freed twice, overlapping a free range from either side, and outside the allocator.
+    CHECK( ThrowsInvalidArgument( [&] { allocator.Free( a, 40 ); } ) );
+    CHECK( ThrowsInvalidArgument( [&] { allocator.Free( 30, 20 ); } ) );
+    CHECK( ThrowsInvalidArgument( [&] { allocator.Free( b, 50 ); } ) );
+    CHECK( ThrowsInvalidArgument( [&] { allocator.Free( 90, 20 ); } ) );
+    CHECK( ThrowsInvalidArgument( [&] { allocator.Free( 200, 1 ); } ) );
+    CHECK( ThrowsInvalidArgument( [&] { allocator.Free( ~0ull, 2 ); } ) );
+    CHECK( ThrowsInvalidArgument( [&] { allocator.Free( b, 0 ); } ) );
+    CHECK( ThrowsInvalidArgument( [&] { (void)allocator.Allocate( 0 ); } ) );
+    CHECK( ThrowsInvalidArgument( [&] { (void)allocator.Allocate( 10, 0 ); } ) );
+
+    // None of them changed anything.
+    CHECK( allocator.GetFreeSize() == 60 );
+    CHECK( allocator.GetFreeRangeCount() == 2 );
+    allocator.Free( b, 40 );
+    CHECK( allocator.GetFreeRangeCount() == 1 );
+    CHECK( allocator.GetFreeSize() == 100 );
+}
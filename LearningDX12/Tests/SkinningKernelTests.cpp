@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Skin.h"
+#include "SkinningKernel.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+
+namespace
+{
+    constexpr uint32_t JointCount = 64;
+
+    // SkinningKernelAvx2Tests builds the kernel for AVX2 and FMA; on a CPU without them there is nothing to check.
+    bool CanRunKernel()
+    {
+#if defined(OLEX_SKINNING_AVX2) && ( defined(__GNUC__) || defined(__clang__) )
+        return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+#else
+        return true;
+#endif
+    }
+
+    float MaxDifference( const std::vector<Mesh::VertexInfo>& a, const std::vector<Mesh::VertexInfo>& b )
+    {
+        float difference = 0.f;
+        for ( size_t i = 0; i < a.size(); ++i )
+        {
+            difference = std::max( { difference,
+                std::fabs( a[i].m_position.x - b[i].m_position.x ), std::fabs( a[i].m_position.y - b[i].m_position.y ),
+                std::fabs( a[i].m_position.z - b[i].m_position.z ), std::fabs( a[i].m_normal.x - b[i].m_normal.x ),
+                std::fabs( a[i].m_normal.y - b[i].m_normal.y ), std::fabs( a[i].m_normal.z - b[i].m_normal.z ),
+                std::fabs( a[i].m_uv.x - b[i].m_uv.x ), std::fabs( a[i].m_uv.y - b[i].m_uv.y ) } );
+        }
+        return difference;
+    }
+
+    uint32_t WeightSum( const VertexSkin& skin )
+    {
+        uint32_t sum = 0;
+        for ( uint8_t weight : skin.m_weights )
+            sum += weight;
+        return sum;
+    }
+}
+
+OLEX_TEST( SkinVerticesMatchesTheReference )
+{
+    if ( !CanRunKernel() )
+        return;
+
+    Test::Random random( 1 );
+    std::vector<Mesh::VertexInfo> vertices;
+    std::vector<VertexSkin> skin;
+    Test::MakeRandomSkinnedVertices( 10000, JointCount, random, vertices, skin );
+    const std::vector<DirectX::XMFLOAT4X4> palette = Test::MakeRandomPalette( JointCount, random );
+
+    std::vector<Mesh::VertexInfo> output( vertices.size() );
+    std::vector<Mesh::VertexInfo> reference( vertices.size() );
+    SkinVertices( { vertices.data(), skin.data(), vertices.size(), palette.data(), output.data() } );
+    SkinVerticesReference( { vertices.data(), skin.data(), vertices.size(), palette.data(), reference.data() } );
+
+    // Positions are within a few units, so this is a few float ulps of FMA and summation order.
+    CHECK( MaxDifference( output, reference ) < 1e-5f );
+
+    bool unitNormals = true;
+    for ( const Mesh::VertexInfo& vertex : output )
+    {
+        const DirectX::XMFLOAT3& n = vertex.m_normal;
+        unitNormals &= std::fabs( n.x * n.x + n.y * n.y + n.z * n.z - 1.f ) < 1e-5f;
+    }
+    CHECK( unitNormals );
+}
+
+OLEX_TEST( SingleInfluenceAppliesTheJointTransform )
+{
+    if ( !CanRunKernel() )
+        return;
+
+    Test::Random random( 2 );
+    const std::vector<DirectX::XMFLOAT4X4> palette = Test::MakeRandomPalette( 4, random );
+    const uint32_t joint = 3;
+    const float weight = 1.f;
+    const VertexSkin skin = PackInfluences( &joint, &weight, 1 );
+    const Mesh::VertexInfo vertex = Test::MakeVertex( 0.5f, -1.f, 2.f, 0.f, 1.f, 0.f, 0.25f, 0.75f );
+
+    Mesh::VertexInfo output;
+    SkinVertices( { &vertex, &skin, 1, palette.data(), &output } );
+
+    const DirectX::XMFLOAT4X4& m = palette[joint];
+    CHECK_NEAR( output.m_position.x, 0.5f * m.m[0][0] - m.m[1][0] + 2.f * m.m[2][0] + m.m[3][0], 1e-5 );
+    CHECK_NEAR( output.m_position.y, 0.5f * m.m[0][1] - m.m[1][1] + 2.f * m.m[2][1] + m.m[3][1], 1e-5 );
+    CHECK_NEAR( output.m_position.z, 0.5f * m.m[0][2] - m.m[1][2] + 2.f * m.m[2][2] + m.m[3][2], 1e-5 );
+    CHECK_NEAR( output.m_normal.x, m.m[1][0], 1e-5 );
+    CHECK_NEAR( output.m_normal.y, m.m[1][1], 1e-5 );
+    CHECK_NEAR( output.m_normal.z, m.m[1][2], 1e-5 );
+    CHECK( output.m_uv.x == 0.25f && output.m_uv.y == 0.75f );
+}
+
+OLEX_TEST( SkinningInPlaceGivesTheSameVertices )
+{
+    if ( !CanRunKernel() )
+        return;
+
+    Test::Random random( 3 );
+    std::vector<Mesh::VertexInfo> vertices;
+    std::vector<VertexSkin> skin;
+    Test::MakeRandomSkinnedVertices( 1000, JointCount, random, vertices, skin );
+    const std::vector<DirectX::XMFLOAT4X4> palette = Test::MakeRandomPalette( JointCount, random );
+
+    std::vector<Mesh::VertexInfo> output( vertices.size() );
+    SkinVertices( { vertices.data(), skin.data(), vertices.size(), palette.data(), output.data() } );
+    SkinVertices( { vertices.data(), skin.data(), vertices.size(), palette.data(), vertices.data() } );
+    CHECK( MaxDifference( vertices, output ) == 0.f );
+}
+
+OLEX_TEST( SkinJobsMatchesSkinVertices )
+{
+    if ( !CanRunKernel() )
+        return;
+
+    Test::Random random( 4 );
+    std::vector<Mesh::VertexInfo> vertices;
+    std::vector<VertexSkin> skin;
+    // Not a multiple of the chunk size, so the last chunk of every job is partial.
+    Test::MakeRandomSkinnedVertices( 10001, JointCount, random, vertices, skin );
+
+    const size_t characterCount = 5;
+    const std::vector<DirectX::XMFLOAT4X4> palettes = Test::MakeRandomPalette( characterCount * JointCount, random );
+    std::vector<Mesh::VertexInfo> output( characterCount * vertices.size() );
+    std::vector<Mesh::VertexInfo> expected( output.size() );
+    std::vector<SkinningJob> jobs;
+    for ( size_t character = 0; character < characterCount; ++character )
+    {
+        SkinningJob job = { vertices.data(), skin.data(), vertices.size(), &palettes[character * JointCount], &expected[character * vertices.size()] };
+        SkinVertices( job );
+        job.m_output = &output[character * vertices.size()];
+        jobs.push_back( job );
+    }
+
+    SkinJobs( jobs.data(), jobs.size() );
+    CHECK( MaxDifference( output, expected ) == 0.f );
+}
+
+OLEX_TEST( PackInfluencesKeepsTheFourLargest )
+{
+    const uint32_t joints[6] = { 10, 11, 12, 13, 14, 15 };
+    const float weights[6] = { 0.05f, 0.4f, 0.1f, 0.2f, 0.15f, 0.1f };
+    const VertexSkin skin = PackInfluences( joints, weights, 6 );
+
+    CHECK( skin.m_joints[0] == 11 );
+    CHECK( skin.m_joints[1] == 13 );
+    CHECK( skin.m_joints[2] == 14 );
+    CHECK( skin.m_joints[3] == 12 || skin.m_joints[3] == 15 );
+    CHECK( WeightSum( skin ) == 255 );
+
+    // Renormalized over the kept 0.85, then rounded to 8 bits.
+    CHECK_NEAR( skin.m_weights[0], 255 * 0.4 / 0.85, 1.0 );
+    CHECK_NEAR( skin.m_weights[1], 255 * 0.2 / 0.85, 1.0 );
+    CHECK_NEAR( skin.m_weights[2], 255 * 0.15 / 0.85, 1.0 );
+    CHECK_NEAR( skin.m_weights[3], 255 * 0.1 / 0.85, 1.0 );
+}
+
+OLEX_TEST( PackInfluencesRenormalizesAnyScale )
+{
+    Test::Random random( 5 );
+    bool exact = true;
+    float maxError = 0.f;
+    for ( int vertex = 0; vertex < 10000; ++vertex )
+    {
+        uint32_t joints[MaxSkinInfluences];
+        float weights[MaxSkinInfluences];
+        const size_t count = 1 + random.Next() % MaxSkinInfluences;
+        // Weights that do not sum to one, as exporters leave them after dropping small influences.
+        const float scale = random.Range( 0.01f, 10.f );
+        float total = 0.f;
+        for ( size_t influence = 0; influence < count; ++influence )
+        {
+            // Distinct joints, so every packed weight maps back to one input.
+            joints[influence] = static_cast<uint32_t>( influence );
+            weights[influence] = scale * random.Range( 0.001f, 1.f );
+            total += weights[influence];
+        }
+
+        const VertexSkin skin = PackInfluences( joints, weights, count );
+        exact &= WeightSum( skin ) == 255;
+        for ( uint32_t influence = 0; influence < MaxSkinInfluences; ++influence )
+        {
+            if ( skin.m_weights[influence] > 0 )
+                maxError = std::max( maxError, std::fabs( skin.m_weights[influence] - weights[skin.m_joints[influence]] / total * 255.f ) );
+        }
+    }
+    CHECK( exact );
+    // Half a step of rounding each, and the remainder of up to the other three added to the largest.
+    CHECK( maxError <= 2.f );
+}
+
+OLEX_TEST( PackInfluencesDropsNonPositiveWeights )
+{
+    const uint32_t joints[3] = { 7, 8, 9 };
+    const float weights[3] = { 0.f, 0.5f, -1.f };
+    const VertexSkin skin = PackInfluences( joints, weights, 3 );
+    CHECK( skin.m_joints[0] == 8 );
+    CHECK( skin.m_weights[0] == 255 );
+    CHECK( skin.m_weights[1] == 0 && skin.m_weights[2] == 0 && skin.m_weights[3] == 0 );
+
+    const VertexSkin unbound = PackInfluences( joints, weights, 0 );
+    CHECK( unbound.m_joints[0] == 0 );
+    CHECK( unbound.m_weights[0] == 255 );
+    CHECK( WeightSum( unbound ) == 255 );
+}
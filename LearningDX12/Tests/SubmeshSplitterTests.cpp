@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "SubmeshSplitter.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+using namespace Olex;
+using namespace Olex::Test;
+
+namespace
+{
+    // Every index of every submesh lies in its vertex window, and the windows tile the vertex buffer.
+    bool SubmeshesAreConsistent( const Mesh& mesh, const std::vector<Submesh>& submeshes )
+    {
+        const uint32_t* indices = AsIndices( mesh.m_indices );
+        uint32_t nextIndex = 0;
+        uint32_t nextVertex = 0;
+        for ( const Submesh& submesh : submeshes )
+        {
+            if ( submesh.m_startIndex != nextIndex || submesh.m_baseVertex != nextVertex )
+                return false;
+
+            for ( uint32_t i = submesh.m_startIndex; i < submesh.m_startIndex + submesh.m_indexCount; ++i )
+            {
+                if ( indices[i] < submesh.m_baseVertex || indices[i] >= submesh.m_baseVertex + submesh.m_vertexCount )
+                    return false;
+            }
+
+            nextIndex += submesh.m_indexCount;
+            nextVertex += submesh.m_vertexCount;
+        }
+        return nextIndex == mesh.m_indices.size() * 3 && nextVertex == mesh.m_vertices.size();
+    }
+
+    bool SameVertex( const Mesh::VertexInfo& a, const Mesh::VertexInfo& b )
+    {
+        return std::memcmp( &a, &b, sizeof( Mesh::VertexInfo ) ) == 0;
+    }
+
+    // A grid of 256 x 256 points, exactly MaxIndex16Vertices, grown by one triangle per extra vertex.
+    Mesh MakeMeshWithVertexCount( size_t vertexCount )
+    {
+        Mesh mesh = MakeGridMesh( 255 );
+        while ( mesh.m_vertices.size() < vertexCount )
+        {
+            const auto vertex = static_cast<int32_t>( mesh.m_vertices.size() );
+            mesh.m_vertices.push_back( MakeVertex( -1.f, float( vertex ), 0.f, 0.f, 0.f, -1.f, 0.f, 0.f ) );
+            mesh.m_indices.push_back( { 0, 1, vertex } );
+        }
+        return mesh;
+    }
+}
+
+OLEX_TEST( IndexFormatEdges )
+{
+    Submesh submesh;
+    submesh.m_vertexCount = 65535;
+    CHECK( SelectIndexFormat( { submesh } ) == IndexFormat::UInt16 );
+    submesh.m_vertexCount = 65536;
+    CHECK( SelectIndexFormat( { submesh } ) == IndexFormat::UInt16 );
+    submesh.m_vertexCount = 65537;
+    CHECK( SelectIndexFormat( { submesh } ) == IndexFormat::UInt32 );
+    CHECK( SelectIndexFormat( {} ) == IndexFormat::UInt16 );
+}
+
+OLEX_TEST( MeshAt16BitLimitIsNotSplit )
+{
+    Mesh mesh = MakeMeshWithVertexCount( MaxIndex16Vertices );
+    CHECK( mesh.m_vertices.size() == 65536 );
+
+    const Mesh original = mesh;
+    const std::vector<Submesh> submeshes = SplitSubmeshes( mesh );
+    CHECK( submeshes.size() == 1 );
+    CHECK( SelectIndexFormat( submeshes ) == IndexFormat::UInt16 );
+    CHECK( mesh.m_vertices.size() == original.m_vertices.size() );
+    CHECK( std::memcmp( mesh.m_indices.data(), original.m_indices.data(), mesh.m_indices.size() * sizeof( DirectX::XMINT3 ) ) == 0 );
+
+    // The highest vertex still packs into 16 bits.
+    const std::vector<uint8_t> packed = PackIndices( mesh.m_indices, submeshes, IndexFormat::UInt16 );
+    uint16_t maximum = 0;
+    for ( size_t i = 0; i < packed.size(); i += 2 )
+    {
+        uint16_t value;
+        std::memcpy( &value, &packed[i], sizeof( value ) );
+        maximum = std::max( maximum, value );
+    }
+    CHECK( maximum == 65535 );
+}
+
+OLEX_TEST( MeshOneVertexPastTheLimitIsSplit )
+{
+    Mesh mesh = MakeMeshWithVertexCount( MaxIndex16Vertices + 1 );
+    CHECK( mesh.m_vertices.size() == 65537 );
+
+    const std::vector<Submesh> submeshes = SplitSubmeshes( mesh );
+    CHECK( submeshes.size() == 2 );
+    CHECK( SelectIndexFormat( submeshes ) == IndexFormat::UInt16 );
+    CHECK( SubmeshesAreConsistent( mesh, submeshes ) );
+}
+
+OLEX_TEST( SplitDuplicatesSharedVerticesAndKeepsAbsoluteIndices )
+{
+    const Mesh original = MakeSphereMesh( 30, 60 );
+    Mesh mesh = original;
+    mesh.m_tangents.resize( mesh.m_vertices.size() );
+    for ( size_t vertex = 0; vertex < mesh.m_tangents.size(); ++vertex )
+        mesh.m_tangents[vertex] = { float( vertex ), 0.f, 0.f, 1.f };
+
+    const std::vector<Submesh> submeshes = SplitSubmeshes( mesh, 300 );
+    CHECK( submeshes.size() > 1 );
+    CHECK( SubmeshesAreConsistent( mesh, submeshes ) );
+
+    bool withinLimit = true;
+    for ( const Submesh& submesh : submeshes )
+        withinLimit &= submesh.m_vertexCount <= 300;
+    CHECK( withinLimit );
+
+    // Vertices shared across a cut are copied into both windows.
+    CHECK( mesh.m_vertices.size() > original.m_vertices.size() );
+    CHECK( mesh.m_tangents.size() == mesh.m_vertices.size() );
+
+    // Indices stay absolute and in order, every corner still reads its original vertex and tangent.
+    CHECK( mesh.m_indices.size() == original.m_indices.size() );
+    const uint32_t* indices = AsIndices( mesh.m_indices );
+    const uint32_t* originalIndices = AsIndices( original.m_indices );
+    bool cornersKept = true;
+    for ( size_t corner = 0; corner < mesh.m_indices.size() * 3; ++corner )
+    {
+        cornersKept &= SameVertex( mesh.m_vertices[indices[corner]], original.m_vertices[originalIndices[corner]] );
+        cornersKept &= mesh.m_tangents[indices[corner]].x == float( originalIndices[corner] );
+    }
+    CHECK( cornersKept );
+
+    // Packed indices are relative to each submesh base vertex.
+    const std::vector<uint8_t> packed = PackIndices( mesh.m_indices, submeshes, IndexFormat::UInt16 );
+    bool packedRelative = true;
+    for ( const Submesh& submesh : submeshes )
+    {
+        for ( uint32_t i = submesh.m_startIndex; i < submesh.m_startIndex + submesh.m_indexCount; ++i )
+        {
+            uint16_t value;
+            std::memcpy( &value, &packed[i * 2], sizeof( value ) );
+            packedRelative &= submesh.m_baseVertex + value == indices[i];
+        }
+    }
+    CHECK( packedRelative );
+}
+
+OLEX_TEST( PackRejectsIndicesOutsideTheirSubmesh )
+{
+    Mesh mesh = MakeGridMesh( 2 );
+    std::vector<Submesh> submeshes = SplitSubmeshes( mesh );
+    submeshes[0].m_vertexCount = 2;
+
+    bool threw = false;
+    try
+    {
+        PackIndices( mesh.m_indices, submeshes, IndexFormat::UInt16 );
+    }
+    catch ( const std::out_of_range& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+}
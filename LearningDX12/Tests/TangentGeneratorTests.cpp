@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "QuantizedVertex.h"
+#include "SubmeshSplitter.h"
+#include "TangentGenerator.h"
+#include "Test.h"
+#include "TestMeshes.h"
+#include "VertexFetchOptimizer.h"
+
+using namespace Olex;
+
+namespace
+{
+    float AngleInDegrees( const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT4& b )
+    {
+        const float cosine = ( a.x * b.x + a.y * b.y + a.z * b.z ) /
+            std::sqrt( ( a.x * a.x + a.y * a.y + a.z * a.z ) * ( b.x * b.x + b.y * b.y + b.z * b.z ) );
+        return std::acos( std::clamp( cosine, -1.f, 1.f ) ) * 180.f / Test::Pi;
+    }
+
+    // cross( normal, tangent ) . reference, the side the bitangent is on.
+    float BitangentSide( const DirectX::XMFLOAT3& n, const DirectX::XMFLOAT4& t, const DirectX::XMFLOAT3& reference )
+    {
+        const DirectX::XMFLOAT3 cross = { n.y * t.z - n.z * t.y, n.z * t.x - n.x * t.z, n.x * t.y - n.y * t.x };
+        return cross.x * reference.x + cross.y * reference.y + cross.z * reference.z > 0.f ? 1.f : -1.f;
+    }
+
+    /**
+     * The triangles as FbxLoader stores them: the counter-clockwise triangles of a right-handed source
+     * reversed, positions unchanged. MikkTSpace then defines the bitangent, w * cross( normal, tangent ),
+     * to point along increasing v.
+     */
+    Mesh AsImported( Mesh mesh )
+    {
+        for ( DirectX::XMINT3& triangle : mesh.m_indices )
+            std::swap( triangle.y, triangle.z );
+        return mesh;
+    }
+
+    // n x n quads in the z = 0 plane with u mirrored about x = n / 2, the left half maps u backwards.
+    Mesh MakeMirroredPlane( uint32_t n )
+    {
+        Mesh mesh = AsImported( Test::MakeGridMesh( n ) );
+        for ( Mesh::VertexInfo& vertex : mesh.m_vertices )
+            vertex.m_uv.x = std::fabs( vertex.m_position.x - n / 2.f ) / n;
+        return mesh;
+    }
+}
+
+OLEX_TEST( SphereMatchesTheAnalyticTangentFrame )
+{
+    Mesh mesh = AsImported( Test::MakeSphereMesh( 128, 256 ) );
+    GenerateTangents( mesh );
+    CHECK( mesh.m_tangents.size() == mesh.m_vertices.size() );
+
+    // Reference: u runs along phi and v along theta, so the tangent is dP/dphi and the bitangent dP/dtheta.
+    float worst = 0.f;
+    int signMismatches = 0;
+    for ( size_t i = 0; i < mesh.m_vertices.size(); ++i )
+    {
+        const Mesh::VertexInfo& vertex = mesh.m_vertices[i];
+        const float theta = vertex.m_uv.y * Test::Pi;
+        const float phi = vertex.m_uv.x * 2.f * Test::Pi;
+        // The tangent is undefined at the poles.
+        if ( theta < 0.05f || theta > Test::Pi - 0.05f )
+            continue;
+
+        const DirectX::XMFLOAT3 tangent = { -std::sin( phi ), 0.f, std::cos( phi ) };
+        const DirectX::XMFLOAT3 bitangent = { std::cos( theta ) * std::cos( phi ), -std::sin( theta ), std::cos( theta ) * std::sin( phi ) };
+        worst = std::max( worst, AngleInDegrees( tangent, mesh.m_tangents[i] ) );
+        signMismatches += BitangentSide( vertex.m_normal, mesh.m_tangents[i], bitangent ) != mesh.m_tangents[i].w;
+    }
+
+    // What is left is the faceting of the triangles the frame is averaged from.
+    CHECK( worst < 1.f );
+    CHECK( signMismatches == 0 );
+}
+
+OLEX_TEST( MirroredUvsGetExactTangentsAndASeamSplit )
+{
+    const uint32_t n = 8;
+    Mesh mesh = MakeMirroredPlane( n );
+    const size_t verticesBefore = mesh.m_vertices.size();
+    const TangentStatistics statistics = GenerateTangents( mesh );
+
+    // The column of vertices on the mirror line is used by both halves.
+    CHECK( statistics.m_splitVertices == n + 1 );
+    CHECK( mesh.m_vertices.size() == verticesBefore + n + 1 );
+
+    int wrongCorners = 0;
+    for ( const DirectX::XMINT3& triangle : mesh.m_indices )
+    {
+        const float centroid = ( mesh.m_vertices[triangle.x].m_position.x + mesh.m_vertices[triangle.y].m_position.x +
+            mesh.m_vertices[triangle.z].m_position.x ) / 3.f;
+        // u runs along +x on the right half and along -x on the left one, v along +y on both.
+        const DirectX::XMFLOAT3 expected = { centroid < n / 2.f ? -1.f : 1.f, 0.f, 0.f };
+        for ( int32_t vertex : { triangle.x, triangle.y, triangle.z } )
+        {
+            const DirectX::XMFLOAT4& tangent = mesh.m_tangents[vertex];
+            wrongCorners += AngleInDegrees( expected, tangent ) > 1e-3f ||
+                BitangentSide( mesh.m_vertices[vertex].m_normal, tangent, { 0.f, 1.f, 0.f } ) != tangent.w;
+        }
+    }
+    CHECK( wrongCorners == 0 );
+}
+
+OLEX_TEST( DegenerateUvsFallBackToAPerpendicularTangent )
+{
+    Mesh mesh = Test::MakeGridMesh( 2 );
+    for ( Mesh::VertexInfo& vertex : mesh.m_vertices )
+        vertex.m_uv = { 0.5f, 0.5f };
+
+    const TangentStatistics statistics = GenerateTangents( mesh );
+    CHECK( statistics.m_degenerateTriangles == mesh.m_indices.size() );
+    CHECK( statistics.m_fallbackVertices == mesh.m_vertices.size() );
+
+    bool perpendicular = true;
+    for ( size_t i = 0; i < mesh.m_vertices.size(); ++i )
+    {
+        const DirectX::XMFLOAT4& tangent = mesh.m_tangents[i];
+        perpendicular &= std::fabs( tangent.z ) < 1e-5f && std::fabs( std::sqrt( tangent.x * tangent.x + tangent.y * tangent.y ) - 1.f ) < 1e-5f;
+    }
+    CHECK( perpendicular );
+}
+
+OLEX_TEST( PackedTangentsStayWithinHalfADegree )
+{
+    Mesh mesh = Test::MakeSphereMesh( 64, 128 );
+    GenerateTangents( mesh );
+
+    float worst = 0.f;
+    bool signsKept = true;
+    for ( const DirectX::XMFLOAT4& tangent : mesh.m_tangents )
+    {
+        const DirectX::XMFLOAT4 unpacked = UnpackTangent( PackTangent( tangent ) );
+        worst = std::max( worst, AngleInDegrees( { tangent.x, tangent.y, tangent.z }, unpacked ) );
+        signsKept &= unpacked.w == tangent.w;
+    }
+    CHECK( worst < 0.5f );
+    CHECK( signsKept );
+}
+
+OLEX_TEST( LaterStagesCarryTheTangentsAlong )
+{
+    Mesh mesh = MakeMirroredPlane( 8 );
+    GenerateTangents( mesh );
+    const Mesh generated = mesh;
+
+    OptimizeVertexFetch( mesh );
+    const std::vector<Submesh> submeshes = SplitSubmeshes( mesh, 20 );
+    CHECK( submeshes.size() > 1 );
+    CHECK( mesh.m_tangents.size() == mesh.m_vertices.size() );
+
+    // Every vertex still has the tangent of the generated vertex at its position and uv.
+    bool carried = true;
+    for ( size_t i = 0; i < mesh.m_vertices.size(); ++i )
+    {
+        const Mesh::VertexInfo& vertex = mesh.m_vertices[i];
+        const auto source = std::find_if( generated.m_vertices.begin(), generated.m_vertices.end(), [&]( const Mesh::VertexInfo& candidate )
+        {
+            return candidate.m_position.x == vertex.m_position.x && candidate.m_position.y == vertex.m_position.y &&
+                candidate.m_uv.x == vertex.m_uv.x && generated.m_tangents[&candidate - generated.m_vertices.data()].w == mesh.m_tangents[i].w;
+        } );
+        carried &= source != generated.m_vertices.end() &&
+            std::memcmp( &generated.m_tangents[source - generated.m_vertices.begin()], &mesh.m_tangents[i], sizeof( DirectX::XMFLOAT4 ) ) == 0;
+    }
+    CHECK( carried );
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <filesystem>
+#include <system_error>
+
+#include "MappedFile.h"
+
+namespace Olex::Test
+{
+    // A fresh directory under the temp directory, removed with everything in it when the fixture goes.
+    class TemporaryDirectory
+    {
+    public:
+        TemporaryDirectory()
+            : m_path( std::filesystem::temp_directory_path() / ( "OlexTests-" + MakeUniqueName() ) )
+        {
+            std::filesystem::create_directories( m_path );
+        }
+
+        ~TemporaryDirectory()
+        {
+            std::error_code error;
+            std::filesystem::remove_all( m_path, error );
+        }
+
+        TemporaryDirectory( const TemporaryDirectory& ) = delete;
+        TemporaryDirectory& operator=( const TemporaryDirectory& ) = delete;
+
+        [[nodiscard]] const std::filesystem::path& GetPath() const { return m_path; }
+
+    private:
+        std::filesystem::path m_path;
+    };
+}
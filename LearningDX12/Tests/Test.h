@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/**
+ * Minimal test harness for the headless build. Every test file is its own executable, linked with
+ * TestMain.cpp, that runs the cases registered with OLEX_TEST and fails when any CHECK did.
+ */
+namespace Olex::Test
+{
+    struct Case
+    {
+        const char* m_name;
+        void ( *m_function )();
+    };
+
+    inline std::vector<Case>& GetCases()
+    {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline int& GetFailureCount()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool Register( const char* name, void ( *function )() )
+    {
+        GetCases().push_back( Case{ name, function } );
+        return true;
+    }
+
+    inline bool Check( bool passed, const char* expression, const char* file, int line )
+    {
+        if ( !passed )
+        {
+            std::fprintf( stderr, "%s:%d: CHECK( %s ) failed\n", file, line, expression );
+            ++GetFailureCount();
+        }
+        return passed;
+    }
+
+    inline bool CheckNear( double actual, double expected, double tolerance, const char* expression, const char* file, int line )
+    {
+        if ( !( std::fabs( actual - expected ) <= tolerance ) )
+        {
+            std::fprintf( stderr, "%s:%d: CHECK_NEAR( %s ) failed: %g, expected %g within %g\n",
+                file, line, expression, actual, expected, tolerance );
+            ++GetFailureCount();
+            return false;
+        }
+        return true;
+    }
+}
+
+#define OLEX_TEST( name ) \
+    static void name(); \
+    static const bool name##Registered = ::Olex::Test::Register( #name, name ); \
+    static void name()
+
+#define CHECK( condition ) ::Olex::Test::Check( static_cast<bool>( condition ), #condition, __FILE__, __LINE__ )
+#define CHECK_NEAR( actual, expected, tolerance ) \
+    ::Olex::Test::CheckNear( ( actual ), ( expected ), ( tolerance ), #actual, __FILE__, __LINE__ )
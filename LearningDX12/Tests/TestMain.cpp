@@ -0,0 +1,27 @@
+#include <cstdio>
+#include <exception>
+
+#include "Test.h"
+
+int main()
+{
+    using namespace Olex::Test;
+
+    for ( const Case& testCase : GetCases() )
+    {
+        const int failuresBefore = GetFailureCount();
+        try
+        {
+            testCase.m_function();
+        }
+        catch ( const std::exception& exception )
+        {
+            std::fprintf( stderr, "%s threw: %s\n", testCase.m_name, exception.what() );
+            ++GetFailureCount();
+        }
+
+        std::printf( "%s %s\n", GetFailureCount() == failuresBefore ? "[ ok ]" : "[fail]", testCase.m_name );
+    }
+
+    return GetFailureCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Mesh.h"
+
+/**
+ * Procedural meshes for the tests. Front faces are clockwise in the left-handed convention of the
+ * renderer, so cross( b - a, c - a ) points out of the surface.
+ */
+namespace Olex::Test
+{
+    constexpr float Pi = 3.14159265358979f;
+
+    inline Mesh::VertexInfo MakeVertex( float x, float y, float z, float nx, float ny, float nz, float u, float v )
+    {
+        Mesh::VertexInfo vertex = {};
+        vertex.m_position = { x, y, z };
+        vertex.m_normal = { nx, ny, nz };
+        vertex.m_uv = { u, v };
+        return vertex;
+    }
+
+    // n x n quads in the z = 0 plane, facing -z.
+    inline Mesh MakeGridMesh( uint32_t n )
+    {
+        Mesh mesh;
+        for ( uint32_t y = 0; y <= n; ++y )
+        {
+            for ( uint32_t x = 0; x <= n; ++x )
+                mesh.m_vertices.push_back( MakeVertex( float( x ), float( y ), 0.f, 0.f, 0.f, -1.f, x / float( n ), y / float( n ) ) );
+        }
+
+        for ( uint32_t y = 0; y < n; ++y )
+        {
+            for ( uint32_t x = 0; x < n; ++x )
+            {
+                const auto corner = [n]( uint32_t cx, uint32_t cy ) { return static_cast<int32_t>( cy * ( n + 1 ) + cx ); };
+                mesh.m_indices.push_back( { corner( x, y ), corner( x, y + 1 ), corner( x + 1, y ) } );
+                mesh.m_indices.push_back( { corner( x + 1, y ), corner( x, y + 1 ), corner( x + 1, y + 1 ) } );
+            }
+        }
+        return mesh;
+    }
+
+    /**
+     * Unit sphere section between the polar angles firstTheta and lastTheta, with rings x segments
+     * quads. Outward facing, or inward facing (normals and winding flipped) for the inside of a bowl.
+     */
+    inline Mesh MakeSphereMesh( uint32_t rings, uint32_t segments, float firstTheta = 0.f, float lastTheta = Pi, bool inward = false )
+    {
+        Mesh mesh;
+        const float sign = inward ? -1.f : 1.f;
+        for ( uint32_t ring = 0; ring <= rings; ++ring )
+        {
+            const float theta = firstTheta + ( lastTheta - firstTheta ) * ring / float( rings );
+            for ( uint32_t segment = 0; segment <= segments; ++segment )
+            {
+                const float phi = 2.f * Pi * segment / float( segments );
+                const float x = std::sin( theta ) * std::cos( phi );
+                const float y = std::cos( theta );
+                const float z = std::sin( theta ) * std::sin( phi );
+                mesh.m_vertices.push_back( MakeVertex( x, y, z, sign * x, sign * y, sign * z, segment / float( segments ), ring / float( rings ) ) );
+            }
+        }
+
+        for ( uint32_t ring = 0; ring < rings; ++ring )
+        {
+            for ( uint32_t segment = 0; segment < segments; ++segment )
+            {
+                const auto corner = [segments]( uint32_t r, uint32_t s ) { return static_cast<int32_t>( r * ( segments + 1 ) + s ); };
+                const int32_t a = corner( ring, segment );
+                const int32_t b = corner( ring, segment + 1 );
+                const int32_t c = corner( ring + 1, segment );
+                const int32_t d = corner( ring + 1, segment + 1 );
+                if ( inward )
+                {
+                    mesh.m_indices.push_back( { a, c, b } );
+                    mesh.m_indices.push_back( { b, c, d } );
+                }
+                else
+                {
+                    mesh.m_indices.push_back( { a, b, c } );
+                    mesh.m_indices.push_back( { b, d, c } );
+                }
+            }
+        }
+        return mesh;
+    }
+
+    // Small deterministic generator, so test inputs do not depend on the standard library.
+    class Random
+    {
+    public:
+        explicit Random( uint32_t seed ) : m_state( seed * 2654435761u + 1u ) {}
+
+        uint32_t Next()
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state;
+        }
+
+        // Uniform in [0, 1).
+        float Unit() { return ( Next() >> 8 ) * ( 1.f / 16777216.f ); }
+        float Range( float minimum, float maximum ) { return minimum + ( maximum - minimum ) * Unit(); }
+
+    private:
+        uint32_t m_state;
+    };
+
+    // Triangles in a random order, the worst case the triangle and vertex order optimizers meet in practice.
+    inline void ShuffleTriangles( std::vector<DirectX::XMINT3>& triangles, uint32_t seed )
+    {
+        Random random( seed );
+        for ( size_t i = triangles.size(); i > 1; --i )
+            std::swap( triangles[i - 1], triangles[random.Next() % i] );
+    }
+
+    // Random vertices bound to 4 random joints below jointCount each, with random positive weights.
+    inline void MakeRandomSkinnedVertices( size_t count, uint32_t jointCount, Random& random,
+        std::vector<Mesh::VertexInfo>& vertices, std::vector<VertexSkin>& skin )
+    {
+        vertices.resize( count );
+        skin.resize( count );
+        for ( size_t i = 0; i < count; ++i )
+        {
+            const float z = random.Range( -1.f, 1.f );
+            const float phi = random.Range( 0.f, 2.f * Pi );
+            const float r = std::sqrt( 1.f - z * z );
+            vertices[i] = MakeVertex( random.Range( -1.f, 1.f ), random.Range( -1.f, 1.f ), random.Range( -1.f, 1.f ),
+                r * std::cos( phi ), r * std::sin( phi ), z, random.Unit(), random.Unit() );
+
+            uint32_t joints[MaxSkinInfluences];
+            float weights[MaxSkinInfluences];
+            for ( uint32_t influence = 0; influence < MaxSkinInfluences; ++influence )
+            {
+                joints[influence] = random.Next() % jointCount;
+                weights[influence] = random.Range( 0.01f, 1.f );
+            }
+            skin[i] = PackInfluences( joints, weights, MaxSkinInfluences );
+        }
+    }
+
+    // Rigid joint transforms: a rotation about a random axis followed by a translation, in row-vector convention.
+    inline std::vector<DirectX::XMFLOAT4X4> MakeRandomPalette( size_t count, Random& random )
+    {
+        std::vector<DirectX::XMFLOAT4X4> palette( count );
+        for ( DirectX::XMFLOAT4X4& matrix : palette )
+        {
+            const float z = random.Range( -1.f, 1.f );
+            const float phi = random.Range( 0.f, 2.f * Pi );
+            const float r = std::sqrt( 1.f - z * z );
+            const float axis[3] = { r * std::cos( phi ), r * std::sin( phi ), z };
+            const float angle = random.Range( -Pi, Pi );
+            const float c = std::cos( angle );
+            const float s = std::sin( angle );
+
+            // Rodrigues' rotation, transposed so rows map the basis vectors.
+            matrix = {};
+            for ( int row = 0; row < 3; ++row )
+            {
+                for ( int column = 0; column < 3; ++column )
+                    matrix.m[row][column] = ( 1.f - c ) * axis[row] * axis[column] + ( row == column ? c : 0.f );
+            }
+            matrix.m[0][1] += s * axis[2];
+            matrix.m[0][2] -= s * axis[1];
+            matrix.m[1][0] -= s * axis[2];
+            matrix.m[1][2] += s * axis[0];
+            matrix.m[2][0] += s * axis[1];
+            matrix.m[2][1] -= s * axis[0];
+            matrix.m[3][0] = random.Range( -2.f, 2.f );
+            matrix.m[3][1] = random.Range( -2.f, 2.f );
+            matrix.m[3][2] = random.Range( -2.f, 2.f );
+            matrix.m[3][3] = 1.f;
+        }
+        return palette;
+    }
+
+    inline const uint32_t* AsIndices( const std::vector<DirectX::XMINT3>& triangles )
+    {
+        return reinterpret_cast<const uint32_t*>( triangles.data() );
+    }
+}
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "ParallelFor.h"
+#include "Test.h"
+#include "ThreadPool.h"
+
+using namespace Olex;
+
+namespace
+{
+    // Runs body on pool through the same type-erased entry point ParallelFor uses.
+    template <typename Body>
+    void Run( ThreadPool& pool, size_t count, Body body, unsigned threadCount = 0 )
+    {
+        pool.Run( count, []( void* context, size_t i ) { ( *static_cast<Body*>( context ) )( i ); }, &body, threadCount );
+    }
+
+    // Thread ids seen by the bodies, to check no thread is created per call.
+    class ThreadSet
+    {
+    public:
+        void Add()
+        {
+            const std::lock_guard<std::mutex> lock( m_mutex );
+            m_threads.insert( std::this_thread::get_id() );
+        }
+
+        [[nodiscard]] size_t GetCount() const { return m_threads.size(); }
+
+    private:
+        std::mutex m_mutex;
+        std::set<std::thread::id> m_threads;
+    };
+}
+
+OLEX_TEST( EveryItemRunsExactlyOnce )
+{
+    ThreadPool pool( 3 );
+    std::vector<std::atomic<int>> runs( 10000 );
+    Run( pool, runs.size(), [&runs]( size_t i ) { ++runs[i]; } );
+
+    bool once = true;
+    for ( const std::atomic<int>& count : runs )
+        once &= count == 1;
+    CHECK( once );
+}
+
+OLEX_TEST( ThreadsAreReusedAcrossCalls )
+{
+    ThreadPool pool( 3 );
+    ThreadSet threads;
+    for ( int call = 0; call < 200; ++call )
+        Run( pool, 64, [&threads]( size_t ) { threads.Add(); } );
+    CHECK( threads.GetCount() <= pool.GetThreadCount() );
+}
+
+OLEX_TEST( NestedCallsShareTheWorkers )
+{
+    ThreadPool pool( 3 );
+    ThreadSet threads;
+    std::atomic<size_t> inner{ 0 };
+    Run( pool, 16, [&]( size_t )
+        {
+            Run( pool, 100, [&]( size_t )
+                {
+                    threads.Add();
+                    ++inner;
+                } );
+        } );
+    CHECK( inner == 1600 );
+    CHECK( threads.GetCount() <= pool.GetThreadCount() );
+}
+
+OLEX_TEST( ThreadCountLimitsTheHelpers )
+{
+    ThreadPool pool( 3 );
+    ThreadSet threads;
+    Run( pool, 1000, [&threads]( size_t ) { threads.Add(); }, 1 );
+    CHECK( threads.GetCount() == 1 );
+}
+
+OLEX_TEST( FirstExceptionIsRethrownOnTheCaller )
+{
+    ThreadPool pool( 3 );
+    std::atomic<size_t> runs{ 0 };
+    bool threw = false;
+    try
+    {
+        Run( pool, 100000, [&runs]( size_t i )
+            {
+                ++runs;
+                if ( i == 10 )
+                    throw std::runtime_error( "item 10" );
+            } );
+    }
+    catch ( const std::runtime_error& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+    // Items after the failure are skipped.
+    CHECK( runs < 100000 );
+
+    // The pool is still usable afterwards.
+    std::atomic<size_t> after{ 0 };
+    Run( pool, 100, [&after]( size_t ) { ++after; } );
+    CHECK( after == 100 );
+}
+
+OLEX_TEST( ParallelForNestsOnTheSharedPool )
+{
+    std::vector<std::vector<int>> results( 8, std::vector<int>( 1000 ) );
+    ParallelFor( results.size(), [&results]( size_t i )
+        {
+            ParallelFor( results[i].size(), [&results, i]( size_t j ) { results[i][j] = static_cast<int>( i * 1000 + j ); } );
+        } );
+
+    bool filled = true;
+    for ( size_t i = 0; i < results.size(); ++i )
+    {
+        for ( size_t j = 0; j < results[i].size(); ++j )
+            filled &= results[i][j] == static_cast<int>( i * 1000 + j );
+    }
+    CHECK( filled );
+}
+
+OLEX_TEST( EmptyRangeDoesNothing )
+{
+    ThreadPool pool( 2 );
+    bool called = false;
+    Run( pool, 0, [&called]( size_t ) { called = true; } );
+    CHECK( !called );
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <tuple>
+
+#include "Test.h"
+#include "TestMeshes.h"
+#include "VertexCacheOptimizer.h"
+
+using namespace Olex;
+using namespace Olex::Test;
+
+namespace
+{
+    std::vector<std::tuple<int32_t, int32_t, int32_t>> SortedTriangles( const std::vector<DirectX::XMINT3>& indices )
+    {
+        std::vector<std::tuple<int32_t, int32_t, int32_t>> triangles;
+        for ( const DirectX::XMINT3& triangle : indices )
+            triangles.emplace_back( triangle.x, triangle.y, triangle.z );
+        std::sort( triangles.begin(), triangles.end() );
+        return triangles;
+    }
+}
+
+OLEX_TEST( OutputIsAPermutationOfTheInputTriangles )
+{
+    Mesh mesh = MakeSphereMesh( 16, 32 );
+    ShuffleTriangles( mesh.m_indices, 1 );
+
+    const auto before = SortedTriangles( mesh.m_indices );
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+    // Triangles are moved whole, so their winding is kept too.
+    CHECK( SortedTriangles( mesh.m_indices ) == before );
+}
+
+OLEX_TEST( ShuffledGridComesCloseToTheIdealMissRatio )
+{
+    Mesh mesh = MakeGridMesh( 64 );
+    ShuffleTriangles( mesh.m_indices, 2 );
+
+    const float shuffled = AnalyzeVertexCache( mesh.m_indices, mesh.m_vertices.size() ).m_acmr;
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+    const VertexCacheStatistics optimized = AnalyzeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+
+    CHECK( shuffled > 2.5f );
+    CHECK( optimized.m_acmr < 0.8f );
+    CHECK( optimized.m_atvr < 1.6f );
+}
+
+OLEX_TEST( SphereImprovesOnItsScanlineOrder )
+{
+    Mesh mesh = MakeSphereMesh( 48, 96 );
+
+    const float scanline = AnalyzeVertexCache( mesh.m_indices, mesh.m_vertices.size() ).m_acmr;
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+    const float optimized = AnalyzeVertexCache( mesh.m_indices, mesh.m_vertices.size() ).m_acmr;
+
+    CHECK( optimized < scanline );
+}
+
+OLEX_TEST( DisconnectedPiecesAreAllEmitted )
+{
+    // Two grids sharing no vertex; the walk dead-ends after the first and restarts on the second.
+    Mesh mesh = MakeGridMesh( 8 );
+    const int32_t offset = static_cast<int32_t>( mesh.m_vertices.size() );
+    const size_t firstCount = mesh.m_indices.size();
+    for ( size_t i = 0; i < firstCount; ++i )
+    {
+        const DirectX::XMINT3 triangle = mesh.m_indices[i];
+        mesh.m_indices.push_back( { triangle.x + offset, triangle.y + offset, triangle.z + offset } );
+    }
+    ShuffleTriangles( mesh.m_indices, 3 );
+
+    const auto before = SortedTriangles( mesh.m_indices );
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() * 2 );
+    CHECK( SortedTriangles( mesh.m_indices ) == before );
+}
+
+OLEX_TEST( EmptyInputIsKept )
+{
+    std::vector<DirectX::XMINT3> triangles;
+    OptimizeVertexCache( triangles, 0 );
+    CHECK( triangles.empty() );
+    CHECK( AnalyzeVertexCache( triangles, 0 ).m_vertexTransforms == 0 );
+}
@@ -0,0 +1,118 @@
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "Test.h"
+#include "TestMeshes.h"
+#include "VertexCacheOptimizer.h"
+#include "VertexFetchOptimizer.h"
+
+using namespace Olex;
+using namespace Olex::Test;
+
+namespace
+{
+    /**
+     * A grid with its triangles and its vertices both in random order, as an importer may leave them,
+     * with a tangent and skin per vertex and one vertex no triangle uses.
+     */
+    Mesh MakeShuffledGrid( uint32_t n, uint32_t seed )
+    {
+        Mesh mesh = MakeGridMesh( n );
+        ShuffleTriangles( mesh.m_indices, seed );
+        mesh.m_vertices.push_back( MakeVertex( -1.f, -1.f, -1.f, 0.f, 0.f, 1.f, 0.f, 0.f ) );
+
+        Random random( seed );
+        std::vector<int32_t> newIndex( mesh.m_vertices.size() );
+        std::iota( newIndex.begin(), newIndex.end(), 0 );
+        for ( size_t i = newIndex.size(); i > 1; --i )
+            std::swap( newIndex[i - 1], newIndex[random.Next() % i] );
+
+        std::vector<Mesh::VertexInfo> vertices( mesh.m_vertices.size() );
+        for ( size_t i = 0; i < vertices.size(); ++i )
+            vertices[newIndex[i]] = mesh.m_vertices[i];
+        mesh.m_vertices.swap( vertices );
+        for ( DirectX::XMINT3& triangle : mesh.m_indices )
+            triangle = { newIndex[triangle.x], newIndex[triangle.y], newIndex[triangle.z] };
+
+        std::vector<Mesh::VertexInfo> unused;
+        MakeRandomSkinnedVertices( mesh.m_vertices.size(), 16, random, unused, mesh.m_skin.m_vertices );
+        for ( size_t i = 0; i < mesh.m_vertices.size(); ++i )
+            mesh.m_tangents.push_back( { static_cast<float>( i ), 0.f, 0.f, 1.f } );
+        return mesh;
+    }
+
+    bool SameCorners( const Mesh& a, const Mesh& b )
+    {
+        if ( a.m_indices.size() != b.m_indices.size() )
+            return false;
+
+        bool same = true;
+        const auto* indicesA = reinterpret_cast<const uint32_t*>( a.m_indices.data() );
+        const auto* indicesB = reinterpret_cast<const uint32_t*>( b.m_indices.data() );
+        for ( size_t i = 0; i < a.m_indices.size() * 3; ++i )
+        {
+            const uint32_t indexA = indicesA[i];
+            const uint32_t indexB = indicesB[i];
+            same &= std::memcmp( &a.m_vertices[indexA], &b.m_vertices[indexB], sizeof( Mesh::VertexInfo ) ) == 0;
+            same &= std::memcmp( &a.m_tangents[indexA], &b.m_tangents[indexB], sizeof( DirectX::XMFLOAT4 ) ) == 0;
+            same &= std::memcmp( &a.m_skin.m_vertices[indexA], &b.m_skin.m_vertices[indexB], sizeof( VertexSkin ) ) == 0;
+        }
+        return same;
+    }
+}
+
+OLEX_TEST( VerticesAreNumberedInFirstUseOrder )
+{
+    Mesh mesh = MakeShuffledGrid( 32, 1 );
+    OptimizeVertexFetch( mesh );
+
+    // Every index is either one seen before or the next new one.
+    const auto* indices = reinterpret_cast<const uint32_t*>( mesh.m_indices.data() );
+    uint32_t next = 0;
+    bool firstUse = true;
+    for ( size_t i = 0; i < mesh.m_indices.size() * 3; ++i )
+    {
+        firstUse &= indices[i] <= next;
+        if ( indices[i] == next )
+            ++next;
+    }
+    CHECK( firstUse );
+    // The vertex no triangle uses is dropped, along with its attributes.
+    CHECK( next == mesh.m_vertices.size() );
+    CHECK( mesh.m_vertices.size() == 33 * 33 );
+    CHECK( mesh.m_tangents.size() == mesh.m_vertices.size() );
+    CHECK( mesh.m_skin.m_vertices.size() == mesh.m_vertices.size() );
+}
+
+OLEX_TEST( TrianglesKeepTheirVertexData )
+{
+    const Mesh original = MakeShuffledGrid( 32, 2 );
+    Mesh mesh = original;
+    OptimizeVertexFetch( mesh );
+    CHECK( SameCorners( mesh, original ) );
+}
+
+OLEX_TEST( ShuffledGridDoesNotFetchMore )
+{
+    // Vertex fetch follows the triangle order, so it runs after the cache optimizer as in ReadMesh.
+    Mesh mesh = MakeShuffledGrid( 64, 3 );
+    OptimizeVertexCache( mesh.m_indices, mesh.m_vertices.size() );
+    const VertexFetchStatistics before = AnalyzeVertexFetch( mesh );
+    OptimizeVertexFetch( mesh );
+    const VertexFetchStatistics after = AnalyzeVertexFetch( mesh );
+
+    CHECK( after.m_overfetch <= before.m_overfetch );
+    CHECK( after.m_bytesFetched <= before.m_bytesFetched );
+    // Vertices used together now share cache lines.
+    CHECK( after.m_overfetch < 1.6f );
+}
+
+OLEX_TEST( EmptyMeshIsKept )
+{
+    Mesh mesh;
+    OptimizeVertexFetch( mesh );
+    CHECK( mesh.m_vertices.empty() );
+    CHECK( AnalyzeVertexFetch( mesh ).m_bytesFetched == 0 );
+}
@@ -0,0 +1,164 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "Test.h"
+#include "VertexWeld.h"
+
+using namespace Olex;
+
+namespace
+{
+    Mesh::VertexInfo MakeVertex( float x, float y, float u, float v )
+    {
+        Mesh::VertexInfo vertex = {};
+        vertex.m_position = { x, y, 0.f };
+        vertex.m_uv = { u, v };
+        vertex.m_normal = { 0.f, 0.f, 1.f };
+        return vertex;
+    }
+
+    uint32_t CornerIndex( const Mesh& mesh, size_t corner )
+    {
+        return static_cast<uint32_t>( ( &mesh.m_indices[corner / 3].x )[corner % 3] );
+    }
+
+    // Two triangles per quad of an n x n grid, every interior corner repeated by its neighbours.
+    std::vector<Mesh::VertexInfo> MakeGrid( int n )
+    {
+        const auto corner = [n]( int x, int y ) { return MakeVertex( float( x ), float( y ), x / float( n ), y / float( n ) ); };
+
+        std::vector<Mesh::VertexInfo> corners;
+        for ( int y = 0; y < n; ++y )
+        {
+            for ( int x = 0; x < n; ++x )
+            {
+                corners.push_back( corner( x, y ) );
+                corners.push_back( corner( x + 1, y ) );
+                corners.push_back( corner( x, y + 1 ) );
+                corners.push_back( corner( x + 1, y ) );
+                corners.push_back( corner( x + 1, y + 1 ) );
+                corners.push_back( corner( x, y + 1 ) );
+            }
+        }
+        return corners;
+    }
+}
+
+OLEX_TEST( GridWeldsToOneVertexPerGridPoint )
+{
+    const int n = 64;
+    const std::vector<Mesh::VertexInfo> corners = MakeGrid( n );
+    const Mesh mesh = WeldVertices( corners );
+
+    CHECK( mesh.m_vertices.size() == size_t( ( n + 1 ) * ( n + 1 ) ) );
+    CHECK( mesh.m_indices.size() == corners.size() / 3 );
+
+    // Every corner still reads back exactly its own attributes.
+    bool cornersKept = true;
+    for ( size_t corner = 0; corner < corners.size(); ++corner )
+        cornersKept &= std::memcmp( &mesh.m_vertices[CornerIndex( mesh, corner )], &corners[corner], sizeof( Mesh::VertexInfo ) ) == 0;
+    CHECK( cornersKept );
+}
+
+OLEX_TEST( VerticesAreEmittedInFirstOccurrenceOrder )
+{
+    const Mesh mesh = WeldVertices( MakeGrid( 4 ) );
+
+    uint32_t next = 0;
+    bool ordered = true;
+    for ( size_t corner = 0; corner < mesh.m_indices.size() * 3; ++corner )
+    {
+        const uint32_t index = CornerIndex( mesh, corner );
+        ordered &= index <= next;
+        if ( index == next )
+            ++next;
+    }
+    CHECK( ordered );
+    CHECK( next == mesh.m_vertices.size() );
+}
+
+OLEX_TEST( UvSeamsStaySplit )
+{
+    std::vector<Mesh::VertexInfo> corners = {
+        MakeVertex( 0, 0, 0, 0 ), MakeVertex( 1, 0, 1, 0 ), MakeVertex( 0, 1, 0, 1 ),
+        MakeVertex( 1, 0, 1, 0 ), MakeVertex( 1, 1, 1, 1 ), MakeVertex( 0, 1, 0, 1 ),
+    };
+    CHECK( WeldVertices( corners ).m_vertices.size() == 4 );
+
+    // Same position on the other side of a seam.
+    corners[3].m_uv = { 0.5f, 0.5f };
+    CHECK( WeldVertices( corners ).m_vertices.size() == 5 );
+}
+
+OLEX_TEST( HardEdgesStaySplit )
+{
+    std::vector<Mesh::VertexInfo> corners = {
+        MakeVertex( 0, 0, 0, 0 ), MakeVertex( 1, 0, 1, 0 ), MakeVertex( 0, 1, 0, 1 ),
+        MakeVertex( 1, 0, 1, 0 ), MakeVertex( 1, 1, 1, 1 ), MakeVertex( 0, 1, 0, 1 ),
+    };
+    for ( size_t corner = 3; corner < 6; ++corner )
+        corners[corner].m_normal = { 0.f, 1.f, 0.f };
+
+    CHECK( WeldVertices( corners ).m_vertices.size() == 6 );
+}
+
+OLEX_TEST( NegativeZeroWeldsWithZero )
+{
+    std::vector<Mesh::VertexInfo> corners = {
+        MakeVertex( 0, 0, 0, 0 ), MakeVertex( 1, 0, 1, 0 ), MakeVertex( 0, 1, 0, 1 ),
+        MakeVertex( -0.f, 0, 0, 0 ), MakeVertex( 0, 1, 0, 1 ), MakeVertex( 1, 0, 1, 0 ),
+    };
+    CHECK( WeldVertices( corners ).m_vertices.size() == 3 );
+}
+
+OLEX_TEST( CornersWithDifferentKeysStaySplit )
+{
+    // Two coincident control points, 1 and 3, that a skin may bind differently.
+    const std::vector<Mesh::VertexInfo> corners = {
+        MakeVertex( 0, 0, 0, 0 ), MakeVertex( 1, 0, 1, 0 ), MakeVertex( 0, 1, 0, 1 ),
+        MakeVertex( 1, 0, 1, 0 ), MakeVertex( 1, 1, 1, 1 ), MakeVertex( 0, 1, 0, 1 ),
+    };
+    const Mesh mesh = WeldVertices( corners, { 0, 1, 2, 3, 4, 2 } );
+
+    CHECK( mesh.m_vertices.size() == 5 );
+    CHECK( CornerIndex( mesh, 1 ) != CornerIndex( mesh, 3 ) );
+    CHECK( CornerIndex( mesh, 2 ) == CornerIndex( mesh, 5 ) );
+}
+
+OLEX_TEST( CornersWithEqualKeysStillWeld )
+{
+    const std::vector<Mesh::VertexInfo> corners = MakeGrid( 8 );
+    std::vector<uint32_t> keys;
+    for ( const Mesh::VertexInfo& corner : corners )
+        keys.push_back( static_cast<uint32_t>( corner.m_position.y * 9.f + corner.m_position.x ) );
+
+    CHECK( WeldVertices( corners, keys ).m_vertices.size() == WeldVertices( corners ).m_vertices.size() );
+}
+
+OLEX_TEST( RejectsAKeyCountOtherThanTheCornerCount )
+{
+    bool threw = false;
+    try
+    {
+        WeldVertices( MakeGrid( 2 ), { 0, 1, 2 } );
+    }
+    catch ( const std::invalid_argument& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+}
+
+OLEX_TEST( RejectsPartialTriangles )
+{
+    bool threw = false;
+    try
+    {
+        WeldVertices( std::vector<Mesh::VertexInfo>( 4 ) );
+    }
+    catch ( const std::invalid_argument& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+}
@@ -0,0 +1,227 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Olex
+{
+    namespace
+    {
+        constexpr uint32_t BytesPerPixel = 4;
+
+        bool IsLittleEndianHost()
+        {
+            const uint16_t value = 1;
+            uint8_t firstByte;
+            std::memcpy( &firstByte, &value, 1 );
+            return firstByte == 1;
+        }
+
+        uint64_t AlignUp( uint64_t value, uint64_t alignment )
+        {
+            return ( value + alignment - 1 ) & ~( alignment - 1 );
+        }
+
+        uint32_t GetRowPitch( uint32_t width )
+        {
+            return static_cast<uint32_t>( AlignUp( uint64_t( width ) * BytesPerPixel, TextureCacheFormat::RowPitchAlignment ) );
+        }
+
+        // Averages the up to 2x2 source texels under each destination texel; odd edges reuse their last row or column.
+        Image Downsample( const Image& source )
+        {
+            Image result;
+            result.m_width = std::max( source.m_width / 2, 1u );
+            result.m_height = std::max( source.m_height / 2, 1u );
+            result.m_pixels.resize( size_t( result.m_width ) * result.m_height * BytesPerPixel );
+
+            for ( uint32_t y = 0; y < result.m_height; ++y )
+            {
+                const uint32_t y0 = std::min( y * 2, source.m_height - 1 );
+                const uint32_t y1 = std::min( y * 2 + 1, source.m_height - 1 );
+                for ( uint32_t x = 0; x < result.m_width; ++x )
+                {
+                    const uint32_t x0 = std::min( x * 2, source.m_width - 1 );
+                    const uint32_t x1 = std::min( x * 2 + 1, source.m_width - 1 );
+                    const uint8_t* texels[4] = {
+                        &source.m_pixels[( size_t( y0 ) * source.m_width + x0 ) * BytesPerPixel],
+                        &source.m_pixels[( size_t( y0 ) * source.m_width + x1 ) * BytesPerPixel],
+                        &source.m_pixels[( size_t( y1 ) * source.m_width + x0 ) * BytesPerPixel],
+                        &source.m_pixels[( size_t( y1 ) * source.m_width + x1 ) * BytesPerPixel] };
+
+                    uint8_t* target = &result.m_pixels[( size_t( y ) * result.m_width + x ) * BytesPerPixel];
+                    for ( uint32_t channel = 0; channel < BytesPerPixel; ++channel )
+                        target[channel] = static_cast<uint8_t>( ( texels[0][channel] + texels[1][channel] + texels[2][channel] + texels[3][channel] + 2 ) / 4 );
+                }
+            }
+            return result;
+        }
+    }
+
+    std::vector<Image> GenerateMips( const Image& image )
+    {
+        if ( image.m_width == 0 || image.m_height == 0 || image.m_pixels.size() != size_t( image.m_width ) * image.m_height * BytesPerPixel )
+        {
+            throw std::invalid_argument( "Image must hold width * height RGBA pixels" );
+        }
+
+        std::vector<Image> mips = { image };
+        while ( mips.back().m_width > 1 || mips.back().m_height > 1 )
+            mips.push_back( Downsample( mips.back() ) );
+        return mips;
+    }
+
+    void WriteTextureCache( const std::filesystem::path& cachePath, const std::vector<Image>& mips, const SourceStamp& sourceStamp )
+    {
+        // The file is mapped straight into native structs, so it is only ever produced in little-endian.
+        if ( !IsLittleEndianHost() )
+        {
+            throw std::runtime_error( "Texture cache can only be written on a little-endian host" );
+        }
+        if ( mips.empty() )
+        {
+            throw std::invalid_argument( "Texture needs at least one mip" );
+        }
+
+        TextureCacheHeader header = {};
+        header.m_magic = TextureCacheFormat::Magic;
+        header.m_version = TextureCacheFormat::Version;
+        header.m_endianTag = TextureCacheFormat::EndianTag;
+        header.m_format = TextureCacheFormat::Rgba8Unorm;
+        header.m_width = mips[0].m_width;
+        header.m_height = mips[0].m_height;
+        header.m_mipCount = static_cast<uint32_t>( mips.size() );
+        header.m_sourceSize = sourceStamp.m_size;
+        header.m_sourceWriteTime = sourceStamp.m_writeTime;
+
+        std::vector<TextureCacheMip> entries( mips.size() );
+        uint64_t offset = sizeof( TextureCacheHeader ) + sizeof( TextureCacheMip ) * entries.size();
+        for ( size_t i = 0; i < mips.size(); ++i )
+        {
+            entries[i] = {};
+            entries[i].m_width = mips[i].m_width;
+            entries[i].m_height = mips[i].m_height;
+            entries[i].m_rowPitch = GetRowPitch( mips[i].m_width );
+            entries[i].m_offset = offset = AlignUp( offset, TextureCacheFormat::MipAlignment );
+            offset += uint64_t( entries[i].m_rowPitch ) * entries[i].m_height;
+        }
+
+        std::filesystem::path temporaryPath = cachePath;
+        temporaryPath += "." + MakeUniqueName() + ".tmp";
+
+        {
+            std::ofstream stream( temporaryPath, std::ios::binary | std::ios::trunc );
+            if ( !stream )
+            {
+                throw std::runtime_error( "Unable to create texture cache file" );
+            }
+
+            uint64_t written = 0;
+            auto write = [&stream, &written]( const void* data, uint64_t size )
+            {
+                stream.write( static_cast<const char*>( data ), static_cast<std::streamsize>( size ) );
+                written += size;
+            };
+            static const uint8_t zeros[TextureCacheFormat::MipAlignment] = {};
+            auto pad = [&write, &written]( uint64_t position )
+            {
+                write( zeros, position - written );
+            };
+
+            write( &header, sizeof( header ) );
+            write( entries.data(), sizeof( TextureCacheMip ) * entries.size() );
+            for ( size_t i = 0; i < mips.size(); ++i )
+            {
+                pad( entries[i].m_offset );
+                const uint32_t rowSize = mips[i].m_width * BytesPerPixel;
+                for ( uint32_t row = 0; row < mips[i].m_height; ++row )
+                {
+                    write( &mips[i].m_pixels[size_t( row ) * rowSize], rowSize );
+                    write( zeros, entries[i].m_rowPitch - rowSize );
+                }
+            }
+
+            if ( !stream )
+            {
+                throw std::runtime_error( "Failed writing texture cache file" );
+            }
+        }
+
+        std::filesystem::rename( temporaryPath, cachePath );
+    }
+
+    MappedTextureCache::MappedTextureCache( const std::filesystem::path& cachePath )
+        : m_file( cachePath )
+    {
+        if ( m_file.IsOpen() && m_file.GetSize() >= sizeof( TextureCacheHeader ) )
+        {
+            m_header = reinterpret_cast<const TextureCacheHeader*>( m_file.GetData() );
+            m_mips = reinterpret_cast<const TextureCacheMip*>( m_file.GetData() + sizeof( TextureCacheHeader ) );
+
+            if ( !Validate() )
+            {
+                m_header = nullptr;
+                m_mips = nullptr;
+            }
+        }
+    }
+
+    bool MappedTextureCache::Validate() const
+    {
+        if ( m_header->m_magic != TextureCacheFormat::Magic ||
+            m_header->m_version != TextureCacheFormat::Version ||
+            m_header->m_endianTag != TextureCacheFormat::EndianTag ||
+            m_header->m_format != TextureCacheFormat::Rgba8Unorm ||
+            m_header->m_mipCount == 0 || m_header->m_mipCount > 32 )
+        {
+            return false;
+        }
+
+        const uint64_t fileSize = m_file.GetSize();
+        const uint64_t tableEnd = sizeof( TextureCacheHeader ) + sizeof( TextureCacheMip ) * uint64_t( m_header->m_mipCount );
+        if ( tableEnd > fileSize )
+            return false;
+
+        uint32_t width = m_header->m_width;
+        uint32_t height = m_header->m_height;
+        for ( uint32_t i = 0; i < m_header->m_mipCount; ++i )
+        {
+            const TextureCacheMip& mip = m_mips[i];
+            if ( mip.m_width != width || mip.m_height != height || mip.m_rowPitch != GetRowPitch( width ) ||
+                mip.m_offset < tableEnd || mip.m_offset % TextureCacheFormat::MipAlignment != 0 ||
+                mip.m_offset + uint64_t( mip.m_rowPitch ) * mip.m_height > fileSize )
+            {
+                return false;
+            }
+
+            width = std::max( width / 2, 1u );
+            height = std::max( height / 2, 1u );
+        }
+
+        return true;
+    }
+
+    bool MappedTextureCache::IsUpToDate( const SourceStamp& sourceStamp ) const
+    {
+        return IsValid() &&
+            m_header->m_sourceSize == sourceStamp.m_size &&
+            m_header->m_sourceWriteTime == sourceStamp.m_writeTime;
+    }
+
+    TextureMipView MappedTextureCache::GetMip( uint32_t mip ) const
+    {
+        if ( mip >= GetMipCount() )
+        {
+            throw std::out_of_range( "Mip index out of range" );
+        }
+
+        TextureMipView view;
+        view.m_pixels = m_file.GetData() + m_mips[mip].m_offset;
+        view.m_width = m_mips[mip].m_width;
+        view.m_height = m_mips[mip].m_height;
+        view.m_rowPitch = m_mips[mip].m_rowPitch;
+        return view;
+    }
+}
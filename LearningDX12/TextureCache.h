@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MeshCache.h"
+
+namespace Olex
+{
+    /**
+     * Baked texture container: a full mip chain, already laid out the way a D3D12 upload buffer
+     * wants it, so loading is a mapping and one copy per mip with no decoding.
+     *
+     *   TextureCacheHeader
+     *   TextureCacheMip[m_mipCount]
+     *   per mip: m_height rows of m_rowPitch bytes
+     *
+     * Mips start on TextureCacheFormat::MipAlignment and rows are padded to RowPitchAlignment,
+     * the D3D12 texture data placement and pitch alignments. All values are little-endian.
+     */
+    namespace TextureCacheFormat
+    {
+        constexpr uint32_t Magic = 0x5845544F; // "OTEX"
+        constexpr uint16_t Version = 1;
+        constexpr uint16_t EndianTag = 0x0102;
+        constexpr uint64_t MipAlignment = 512;
+        constexpr uint32_t RowPitchAlignment = 256;
+        // Pixel formats, with their DXGI_FORMAT values.
+        constexpr uint32_t Rgba8Unorm = 28;
+    }
+
+    struct TextureCacheHeader
+    {
+        uint32_t m_magic;
+        uint16_t m_version;
+        uint16_t m_endianTag;
+        uint32_t m_format;
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_mipCount;
+        // Identifies the source file the cache was baked from, see SourceStamp.
+        uint64_t m_sourceSize;
+        int64_t m_sourceWriteTime;
+    };
+
+    struct TextureCacheMip
+    {
+        uint64_t m_offset;
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_rowPitch;
+        uint32_t m_padding;
+    };
+
+    static_assert( sizeof( TextureCacheHeader ) == 40, "TextureCacheHeader layout is part of the file format" );
+    static_assert( sizeof( TextureCacheMip ) == 24, "TextureCacheMip layout is part of the file format" );
+
+    // Tightly packed 8-bit RGBA pixels, rows top to bottom.
+    struct Image
+    {
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        std::vector<uint8_t> m_pixels;
+    };
+
+    // Halves the image down to 1x1 with a box filter; the source image is the first entry.
+    std::vector<Image> GenerateMips( const Image& image );
+
+    // Written under a temporary name and then renamed, like WriteMeshCache.
+    void WriteTextureCache( const std::filesystem::path& cachePath, const std::vector<Image>& mips, const SourceStamp& sourceStamp );
+
+    // Non-owning view of one mip inside a mapped texture cache.
+    struct TextureMipView
+    {
+        const uint8_t* m_pixels = nullptr;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_rowPitch = 0;
+    };
+
+    /**
+     * Memory-mapped read access to a baked texture.
+     */
+    class MappedTextureCache
+    {
+    public:
+        explicit MappedTextureCache( const std::filesystem::path& cachePath );
+
+        // False if the file is missing, truncated or was written by an incompatible version.
+        [[nodiscard]] bool IsValid() const { return m_header != nullptr; }
+        [[nodiscard]] bool IsUpToDate( const SourceStamp& sourceStamp ) const;
+
+        // One of the TextureCacheFormat pixel formats.
+        [[nodiscard]] uint32_t GetFormat() const { return m_header ? m_header->m_format : 0; }
+        [[nodiscard]] uint32_t GetWidth() const { return m_header ? m_header->m_width : 0; }
+        [[nodiscard]] uint32_t GetHeight() const { return m_header ? m_header->m_height : 0; }
+        [[nodiscard]] uint32_t GetMipCount() const { return m_header ? m_header->m_mipCount : 0; }
+        [[nodiscard]] TextureMipView GetMip( uint32_t mip ) const;
+
+    private:
+        MappedFile m_file;
+        const TextureCacheHeader* m_header = nullptr;
+        const TextureCacheMip* m_mips = nullptr;
+
+        bool Validate() const;
+    };
+}
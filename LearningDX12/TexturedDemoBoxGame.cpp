@@ -4,8 +4,6 @@
 #include <d3dcompiler.h>
 #include <wrl/client.h>
 #include <filesystem>
-#include <WICTextureLoader.h>
-#include <ResourceUploadBatch.h>
 
 #include "d3dx12.h"
 #include "DX12App.h"
@@ -49,31 +47,8 @@ namespace Olex
 
         m_DSVHeap = m_app.CreateDescriptorHeap( D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 1 );
 
-#if (_WIN32_WINNT >= 0x0A00 /*_WIN32_WINNT_WIN10*/)
-        Microsoft::WRL::Wrappers::RoInitializeWrapper initialize( RO_INIT_MULTITHREADED );
-        if ( FAILED( initialize ) )
-            // error
-#else
-        HRESULT hr = CoInitializeEx( nullptr, COINITBASE_MULTITHREADED );
-        if ( FAILED( hr ) )
-            // error
-#endif
-
-            Microsoft::WRL::ComPtr<ID3D12Resource> texture;
-
-        using namespace std::filesystem;
-        DirectX::ResourceUploadBatch uploadBatch( m_app.GetDevice().Get() );
-        uploadBatch.Begin();
-
-        ThrowIfFailed( DirectX::CreateWICTextureFromFile(
-            m_app.GetDevice().Get(),
-            uploadBatch,
-            L"texture.jpg",
-            &m_texture,
-            true ) );
-
-        const std::future<void> uploadTask = uploadBatch.End( m_app.GetCommandQueue().GetD3D12CommandQueue().Get() );
-        uploadTask.wait();
+        // Baked with its mip chain by the asset baker, see TextureCache.
+        m_texture = LoadBakedTexture( m_app.GetUploadService(), "texture.tex" );
 
         {
             D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -81,7 +56,7 @@ namespace Olex
             srvDesc.Format = /*DXGI_FORMAT_R8G8B8A8_UNORM*/ m_texture->GetDesc().Format;
             srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // The resource is a 2D texture.
             srvDesc.Texture2D.MostDetailedMip = 0; // so the first in memory is the largest mipmap level
-            srvDesc.Texture2D.MipLevels = 1;
+            srvDesc.Texture2D.MipLevels = m_texture->GetDesc().MipLevels;
             srvDesc.Texture2D.ResourceMinLODClamp = 0.0f; // A value to clamp sample LOD values to.
 
             device->CreateShaderResourceView( m_texture.Get(), &srvDesc, m_SrvHeap->GetCPUDescriptorHandleForHeapStart() );
@@ -119,32 +94,14 @@ namespace Olex
         psoDesc.SampleDesc.Count = 1;
         ThrowIfFailed( m_app.GetDevice()->CreateGraphicsPipelineState( &psoDesc, IID_PPV_ARGS( m_PipelineState.ReleaseAndGetAddressOf() ) ) );
 
-        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> commandList = m_app.GetCommandQueue().CreateCommandList();
-
-        // Upload vertex buffer data.
-        ComPtr<ID3D12Resource> intermediateVertexBuffer;
-        UpdateBufferResource( commandList.Get(),
-            &m_VertexBuffer, &intermediateVertexBuffer,
-            _countof( m_Vertices ), sizeof( VertexPosUV ), m_Vertices );
-
-        // Create the vertex buffer view.
-        m_VertexBufferView.BufferLocation = m_VertexBuffer->GetGPUVirtualAddress();
-        m_VertexBufferView.SizeInBytes = sizeof( m_Vertices );
-        m_VertexBufferView.StrideInBytes = sizeof( VertexPosUV );
+        // Upload the cube into the shared geometry arena.
+        m_geometry = m_app.GetGeometryArena().Allocate( m_app.GetUploadService(),
+            m_Vertices, _countof( m_Vertices ), sizeof( VertexPosUV ),
+            m_Indices, _countof( m_Indices ), IndexFormat::UInt16 );
 
-        // Upload index buffer data.
-        ComPtr<ID3D12Resource> intermediateIndexBuffer;
-        UpdateBufferResource( commandList.Get(),
-            &m_IndexBuffer, &intermediateIndexBuffer,
-            _countof( m_Indices ), sizeof( WORD ), m_Indices );
-
-        // Create index buffer view.
-        m_IndexBufferView.BufferLocation = m_IndexBuffer->GetGPUVirtualAddress();
-        m_IndexBufferView.Format = DXGI_FORMAT_R16_UINT;
-        m_IndexBufferView.SizeInBytes = sizeof( m_Indices );
-
-        const FenceValue fenceValue = m_app.GetCommandQueue().ExecuteCommandList( commandList );
-        m_app.GetCommandQueue().WaitForFenceValue( fenceValue );
+        // The copies run on the copy queue. The render queue waits for them on the GPU, the CPU goes on.
+        UploadService& uploadService = m_app.GetUploadService();
+        m_app.GetCommandQueue().Wait( uploadService.GetFenceWait( uploadService.Submit() ) );
 
         m_ContentLoaded = true;
 
@@ -217,7 +174,7 @@ namespace Olex
         if ( m_ContentLoaded )
         {
             // Flush any GPU commands that might be referencing the depth buffer.
-            //m_app.Flush();
+            m_app.GetCommandQueue().WaitForFenceValue( m_lastFenceValue );
 
             width = std::max( 1, width );
             height = std::max( 1, height );
@@ -271,18 +228,11 @@ namespace Olex
         const path texturePath( fileName );
         if ( exists( texturePath ) == true )
         {
-            DirectX::ResourceUploadBatch uploadBatch( m_app.GetDevice().Get() );
-            uploadBatch.Begin();
-
-            ThrowIfFailed( DirectX::CreateWICTextureFromFile(
-                m_app.GetDevice().Get(),
-                uploadBatch,
-                fileName,
-                textureResource.ReleaseAndGetAddressOf(),
-                false ) );
-
-            const std::future<void> uploadTask = uploadBatch.End( m_app.GetCommandQueue().GetD3D12CommandQueue().Get() );
-            uploadTask.wait();
+            UploadService& uploadService = m_app.GetUploadService();
+            textureResource = LoadBakedTexture( uploadService, texturePath );
+
+            // Work submitted to the render queue from now on waits on the GPU for the upload.
+            m_app.GetCommandQueue().Wait( uploadService.GetFenceWait( uploadService.Submit() ) );
         }
 
         return textureResource;
@@ -290,6 +240,8 @@ namespace Olex
 
     void TexturedDemoBoxGame::UnloadResources()
     {
+        m_app.GetGeometryArena().Free( m_geometry );
+        m_geometry = {};
     }
 
     void TexturedDemoBoxGame::Update( UpdateEventArgs args )
@@ -335,7 +287,6 @@ namespace Olex
     void TexturedDemoBoxGame::Render( RenderEventArgs args )
     {
         if ( m_frameCount == 0 ) return;
-        m_app.GetCommandQueue().WaitForFenceValue( m_lastFenceValue );
 
         PIXBeginEvent( PIX_COLOR_DEFAULT, L"Render" );
 
@@ -373,8 +324,7 @@ namespace Olex
 
         // IA = Input Assembler
         commandList->IASetPrimitiveTopology( D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-        commandList->IASetVertexBuffers( 0, 1, &m_VertexBufferView );
-        commandList->IASetIndexBuffer( &m_IndexBufferView );
+        m_app.GetGeometryArena().Bind( commandList.Get(), sizeof( VertexPosUV ), IndexFormat::UInt16 );
 
         // RS = Rasterizer State
         commandList->RSSetViewports( 1, &m_Viewport );
@@ -384,7 +334,7 @@ namespace Olex
         commandList->OMSetRenderTargets( 1, &rtv, FALSE, &dsv );
 
         // draw the cube
-        commandList->DrawIndexedInstanced( _countof( m_Indices ), 1, 0, 0, 0 );
+        commandList->DrawIndexedInstanced( m_geometry.m_indexCount, 1, m_geometry.m_startIndex, m_geometry.m_baseVertex, 0 );
 
         PIXEndEvent();
         PIXBeginEvent( PIX_COLOR_DEFAULT, L"Present" );
@@ -396,7 +346,7 @@ namespace Olex
 
             m_lastFenceValue = m_app.GetCommandQueue().ExecuteCommandList( commandList );
 
-            m_app.Present();
+            m_app.Present( m_lastFenceValue );
         }
 
         PIXEndEvent();
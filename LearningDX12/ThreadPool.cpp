@@ -0,0 +1,143 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace Olex
+{
+    struct ThreadPool::Job
+    {
+        void ( *m_invoke )( void* context, size_t i ) = nullptr;
+        void* m_context = nullptr;
+        size_t m_count = 0;
+        // Workers that may still join, the caller not counted.
+        unsigned m_helpers = 0;
+
+        std::atomic<size_t> m_next{ 0 };
+        // Items run, or skipped after a failure.
+        std::atomic<size_t> m_finished{ 0 };
+        std::atomic<bool> m_failed{ false };
+        std::exception_ptr m_error;
+        std::mutex m_mutex;
+        std::condition_variable m_done;
+    };
+
+    ThreadPool& ThreadPool::Get()
+    {
+        static ThreadPool pool( std::max( 1u, std::thread::hardware_concurrency() ) - 1 );
+        return pool;
+    }
+
+    ThreadPool::ThreadPool( unsigned workerCount )
+    {
+        m_workers.reserve( workerCount );
+        for ( unsigned i = 0; i < workerCount; ++i )
+            m_workers.emplace_back( [this]() { WorkerLoop(); } );
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            const std::lock_guard<std::mutex> lock( m_mutex );
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for ( std::thread& worker : m_workers )
+            worker.join();
+    }
+
+    void ThreadPool::Run( size_t count, void ( *invoke )( void* context, size_t i ), void* context, unsigned threadCount )
+    {
+        if ( count == 0 )
+            return;
+
+        if ( threadCount == 0 )
+            threadCount = GetThreadCount();
+        const unsigned helpers = static_cast<unsigned>( std::min<size_t>( std::min( threadCount, GetThreadCount() ), count ) ) - 1;
+
+        const auto job = std::make_shared<Job>();
+        job->m_invoke = invoke;
+        job->m_context = context;
+        job->m_count = count;
+        job->m_helpers = helpers;
+
+        if ( helpers > 0 )
+        {
+            {
+                const std::lock_guard<std::mutex> lock( m_mutex );
+                m_jobs.push_back( job );
+            }
+            if ( helpers == 1 )
+                m_wake.notify_one();
+            else
+                m_wake.notify_all();
+        }
+
+        Work( *job );
+
+        if ( helpers > 0 )
+        {
+            // Every item is taken; workers that pick the job up from now on find nothing left to do.
+            {
+                const std::lock_guard<std::mutex> lock( m_mutex );
+                const auto queued = std::find( m_jobs.begin(), m_jobs.end(), job );
+                if ( queued != m_jobs.end() )
+                    m_jobs.erase( queued );
+            }
+
+            std::unique_lock<std::mutex> lock( job->m_mutex );
+            job->m_done.wait( lock, [&job]() { return job->m_finished == job->m_count; } );
+        }
+
+        if ( job->m_error )
+            std::rethrow_exception( job->m_error );
+    }
+
+    void ThreadPool::WorkerLoop()
+    {
+        for ( ;; )
+        {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock( m_mutex );
+                m_wake.wait( lock, [this]() { return m_stopping || !m_jobs.empty(); } );
+                if ( m_stopping )
+                    return;
+
+                job = m_jobs.front();
+                if ( --job->m_helpers == 0 || job->m_next >= job->m_count )
+                    m_jobs.pop_front();
+            }
+            Work( *job );
+        }
+    }
+
+    void ThreadPool::Work( Job& job )
+    {
+        for ( size_t i = job.m_next++; i < job.m_count; i = job.m_next++ )
+        {
+            if ( !job.m_failed )
+            {
+                try
+                {
+                    job.m_invoke( job.m_context, i );
+                }
+                catch ( ... )
+                {
+                    const std::lock_guard<std::mutex> lock( job.m_mutex );
+                    if ( !job.m_error )
+                        job.m_error = std::current_exception();
+                    job.m_failed = true;
+                }
+            }
+
+            if ( ++job.m_finished == job.m_count )
+            {
+                // Under the lock, so the caller cannot miss the notification between its check and its wait.
+                const std::lock_guard<std::mutex> lock( job.m_mutex );
+                job.m_done.notify_all();
+            }
+        }
+    }
+}
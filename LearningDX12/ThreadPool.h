@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Olex
+{
+    /**
+     * Persistent worker threads for ParallelFor, started once and shared by every caller.
+     *
+     * A call posts a job and works on it itself; idle workers join in and take items from the same
+     * counter. The caller only ever waits for items other threads have already taken, so a body may
+     * call ParallelFor again: the nested job runs on the calling worker and whichever threads are
+     * idle, and never waits for a thread that is waiting in turn.
+     */
+    class ThreadPool
+    {
+    public:
+        // Shared pool, one worker less than the hardware threads, as the caller works too.
+        static ThreadPool& Get();
+
+        explicit ThreadPool( unsigned workerCount );
+        ~ThreadPool();
+
+        ThreadPool( const ThreadPool& ) = delete;
+        ThreadPool& operator=( const ThreadPool& ) = delete;
+
+        // Workers plus the calling thread.
+        [[nodiscard]] unsigned GetThreadCount() const { return static_cast<unsigned>( m_workers.size() ) + 1; }
+
+        /**
+         * Calls invoke( context, i ) for every i in [0, count) on at most threadCount threads, the
+         * calling one included, and returns once all calls are done. The first exception thrown stops
+         * handing out new items and is rethrown here. See ParallelFor for the typed front end.
+         */
+        void Run( size_t count, void ( *invoke )( void* context, size_t i ), void* context, unsigned threadCount );
+
+    private:
+        struct Job;
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        // Jobs that still take helpers, oldest first.
+        std::deque<std::shared_ptr<Job>> m_jobs;
+        bool m_stopping = false;
+
+        void WorkerLoop();
+        static void Work( Job& job );
+    };
+}
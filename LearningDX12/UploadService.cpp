@@ -0,0 +1,148 @@
+#include "UploadService.h"
+
+#include <cstring>
+#include <exception>
+
+#include "d3dx12.h"
+#include "DX12App.h"
+
+namespace Olex
+{
+    namespace
+    {
+        uint64_t AlignUp( uint64_t value, uint64_t alignment )
+        {
+            return ( value + alignment - 1 ) / alignment * alignment;
+        }
+    }
+
+    UploadService::UploadService( DX12App& app, uint64_t pageSize )
+        : m_app( app )
+        , m_queue( app, D3D12_COMMAND_LIST_TYPE_COPY )
+        , m_pageSize( pageSize )
+    {
+    }
+
+    UploadService::~UploadService()
+    {
+        Flush();
+    }
+
+    void UploadService::UploadBuffer( ID3D12Resource* destination, uint64_t destinationOffset, const void* data, uint64_t size )
+    {
+        if ( size == 0 )
+            return;
+
+        const StagingAllocation staging = AllocateStaging( size, 4 );
+        std::memcpy( staging.m_data, data, size );
+        GetCommandList()->CopyBufferRegion( destination, destinationOffset, staging.m_resource, staging.m_offset, size );
+    }
+
+    void UploadService::UploadTexture( ID3D12Resource* destination, uint32_t firstSubresource,
+        const D3D12_SUBRESOURCE_DATA* subresources, uint32_t subresourceCount )
+    {
+        if ( subresourceCount == 0 )
+            return;
+
+        // Rows are laid out with the copy pitch of the destination, which the helper works out.
+        const uint64_t size = GetRequiredIntermediateSize( destination, firstSubresource, subresourceCount );
+        const StagingAllocation staging = AllocateStaging( size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT );
+        if ( UpdateSubresources( GetCommandList(), destination, staging.m_resource, staging.m_offset,
+            firstSubresource, subresourceCount, subresources ) == 0 )
+        {
+            throw std::exception();
+        }
+    }
+
+    FenceValue UploadService::Submit()
+    {
+        if ( !m_commandList )
+            return m_lastToken;
+
+        m_lastToken = m_queue.ExecuteCommandList( m_commandList );
+        m_commandList.Reset();
+
+        // The last page may have room left, it is still only reused once the whole batch completes.
+        for ( StagingPage& page : m_batchPages )
+            m_pages.Release( std::move( page ), m_lastToken.Get() );
+        for ( StagingPage& page : m_batchOversized )
+            m_oversizedInFlight.emplace_back( m_lastToken, std::move( page ) );
+        m_batchPages.clear();
+        m_batchOversized.clear();
+        m_pageOffset = 0;
+
+        RetireCompleted();
+        return m_lastToken;
+    }
+
+    void UploadService::RetireCompleted()
+    {
+        const FenceValue completed = m_queue.RetireCompleted();
+        while ( !m_oversizedInFlight.empty() && m_oversizedInFlight.front().first.Get() <= completed.Get() )
+        {
+            m_oversizedInFlight.pop_front();
+        }
+    }
+
+    void UploadService::Flush()
+    {
+        m_queue.WaitForFenceValue( Submit() );
+        RetireCompleted();
+    }
+
+    UploadService::StagingAllocation UploadService::AllocateStaging( uint64_t size, uint64_t alignment )
+    {
+        if ( size > m_pageSize )
+        {
+            m_batchOversized.push_back( CreatePage( size ) );
+            const StagingPage& page = m_batchOversized.back();
+            return StagingAllocation{ page.m_resource.Get(), 0, page.m_data };
+        }
+
+        uint64_t offset = AlignUp( m_pageOffset, alignment );
+        if ( m_batchPages.empty() || offset + size > m_pageSize )
+        {
+            StagingPage page;
+            if ( !m_pages.TryAcquire( m_queue.RetireCompleted().Get(), page ) )
+                page = CreatePage( m_pageSize );
+            m_batchPages.push_back( std::move( page ) );
+            offset = 0;
+        }
+
+        m_pageOffset = offset + size;
+        const StagingPage& page = m_batchPages.back();
+        return StagingAllocation{ page.m_resource.Get(), offset, page.m_data + offset };
+    }
+
+    UploadService::StagingPage UploadService::CreatePage( uint64_t size )
+    {
+        StagingPage page;
+        page.m_size = size;
+        ThrowIfFailed( m_app.GetDevice()->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES( D3D12_HEAP_TYPE_UPLOAD ),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer( size ),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS( &page.m_resource ) ) );
+
+        const CD3DX12_RANGE noRead( 0, 0 );
+        ThrowIfFailed( page.m_resource->Map( 0, &noRead, reinterpret_cast<void**>( &page.m_data ) ) );
+        return page;
+    }
+
+    ID3D12GraphicsCommandList2* UploadService::GetCommandList()
+    {
+        if ( !m_commandList )
+            m_commandList = m_queue.CreateCommandList();
+        return m_commandList.Get();
+    }
+
+    void UploadService::ThrowIfFailed( HRESULT hr )
+    {
+        if ( FAILED( hr ) )
+        {
+            throw std::exception();
+        }
+    }
+}
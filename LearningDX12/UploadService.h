@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <d3d12.h>
+#include <deque>
+#include <utility>
+#include <vector>
+#include <wrl/client.h>
+
+#include "CommandQueue.h"
+#include "FenceRecycler.h"
+
+namespace Olex
+{
+    class DX12App;
+
+    /**
+     * Uploads buffers and textures on a copy queue of its own, so loading neither stalls the render
+     * queue nor blocks the CPU.
+     *
+     * Upload calls copy the data into staging pages right away, the caller's memory can go once they
+     * return, and record the GPU copies on one open command list. Submit sends that batch and returns
+     * its token, the copy queue fence value it completes with. Rather than waiting on the CPU, the
+     * render queue is made to wait for the token on the GPU before its first use of the data:
+     *
+     *   renderQueue.Wait( uploadService.GetFenceWait( uploadService.Submit() ) );
+     *
+     * Destinations must be in the common state. The copy queue promotes them to COPY_DEST and they
+     * decay back to common when the batch completes, from where the render queue promotes buffers to
+     * any read state and textures to the shader resource states, so no barrier is needed anywhere.
+     *
+     * Staging pages are recycled once the batch that used them has completed. An upload larger than a
+     * page gets a buffer of its own, which is released the same way.
+     */
+    class UploadService
+    {
+    public:
+        UploadService( DX12App& app, uint64_t pageSize );
+        ~UploadService();
+
+        UploadService( const UploadService& ) = delete;
+        UploadService& operator=( const UploadService& ) = delete;
+
+        void UploadBuffer( ID3D12Resource* destination, uint64_t destinationOffset, const void* data, uint64_t size );
+        void UploadTexture( ID3D12Resource* destination, uint32_t firstSubresource,
+            const D3D12_SUBRESOURCE_DATA* subresources, uint32_t subresourceCount );
+
+        // Sends the uploads recorded since the last call without blocking. Returns the token of the
+        // batch, or of the previous one when nothing was recorded.
+        FenceValue Submit();
+
+        [[nodiscard]] bool IsComplete( FenceValue token ) const { return m_queue.IsFenceComplete( token ); }
+        // For CommandQueue::Wait or the waits of CommandQueue::ExecuteCommandLists.
+        [[nodiscard]] FenceWait GetFenceWait( FenceValue token ) const { return FenceWait{ m_queue.GetD3D12Fence(), token }; }
+
+        // Frees the staging memory of completed batches without blocking.
+        void RetireCompleted();
+        // Submits what is recorded and blocks until every batch has completed.
+        void Flush();
+
+        [[nodiscard]] const FenceRecyclerStats& GetStagingPageStats() const { return m_pages.GetStats(); }
+
+    private:
+        struct StagingPage
+        {
+            Microsoft::WRL::ComPtr<ID3D12Resource> m_resource;
+            // Upload heap memory stays mapped for the lifetime of the resource.
+            uint8_t* m_data = nullptr;
+            uint64_t m_size = 0;
+        };
+
+        struct StagingAllocation
+        {
+            ID3D12Resource* m_resource = nullptr;
+            uint64_t m_offset = 0;
+            // Mapped memory at m_offset.
+            uint8_t* m_data = nullptr;
+        };
+
+        DX12App& m_app;
+        CommandQueue m_queue;
+        uint64_t m_pageSize;
+
+        // Open batch, null until the first upload after a Submit.
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> m_commandList;
+        // Pages and oversized buffers of the open batch, the last page is the one being filled.
+        std::vector<StagingPage> m_batchPages;
+        std::vector<StagingPage> m_batchOversized;
+        uint64_t m_pageOffset = 0;
+        FenceValue m_lastToken{ 0 };
+
+        FenceRecycler<StagingPage> m_pages;
+        // Oversized buffers of submitted batches, oldest first, dropped once their batch completes.
+        std::deque<std::pair<FenceValue, StagingPage>> m_oversizedInFlight;
+
+        StagingAllocation AllocateStaging( uint64_t size, uint64_t alignment );
+        StagingPage CreatePage( uint64_t size );
+        ID3D12GraphicsCommandList2* GetCommandList();
+
+        void ThrowIfFailed( HRESULT hr );
+    };
+}
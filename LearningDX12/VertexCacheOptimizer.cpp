@@ -0,0 +1,219 @@
+#include "VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Olex
+{
+    namespace
+    {
+        constexpr int ScoredCacheSize = 32;
+        constexpr float CacheDecayPower = 1.5f;
+        constexpr float LastTriangleScore = 0.75f;
+        constexpr float ValenceBoostScale = 2.0f;
+        constexpr float ValenceBoostPower = 0.5f;
+        constexpr int MaxScoredValence = 32;
+
+        const uint32_t* AsIndices( const std::vector<DirectX::XMINT3>& triangles )
+        {
+            static_assert( sizeof( DirectX::XMINT3 ) == 3 * sizeof( uint32_t ), "XMINT3 is read as three consecutive indices" );
+            return reinterpret_cast<const uint32_t*>( triangles.data() );
+        }
+
+        struct ScoreTables
+        {
+            float m_cache[ScoredCacheSize];
+            float m_valence[MaxScoredValence + 1];
+
+            ScoreTables()
+            {
+                for ( int position = 0; position < ScoredCacheSize; ++position )
+                {
+                    if ( position < 3 )
+                    {
+                        // The vertices of the last emitted triangle get a fixed score,
+                        // so the walk does not favour reusing the exact same edge.
+                        m_cache[position] = LastTriangleScore;
+                    }
+                    else
+                    {
+                        const float scaler = 1.0f / ( ScoredCacheSize - 3 );
+                        m_cache[position] = std::pow( 1.0f - ( position - 3 ) * scaler, CacheDecayPower );
+                    }
+                }
+
+                m_valence[0] = 0.f;
+                for ( int valence = 1; valence <= MaxScoredValence; ++valence )
+                {
+                    m_valence[valence] = ValenceBoostScale * std::pow( static_cast<float>( valence ), -ValenceBoostPower );
+                }
+            }
+
+            float VertexScore( int cachePosition, uint32_t remainingValence ) const
+            {
+                if ( remainingValence == 0 )
+                    return -1.f; // no triangles left, the vertex is irrelevant
+
+                const float cacheScore = cachePosition >= 0 ? m_cache[cachePosition] : 0.f;
+                return cacheScore + m_valence[std::min<uint32_t>( remainingValence, MaxScoredValence )];
+            }
+        };
+    }
+
+    VertexCacheStatistics AnalyzeVertexCache( const std::vector<DirectX::XMINT3>& triangles, size_t vertexCount, uint32_t cacheSize )
+    {
+        VertexCacheStatistics statistics;
+        if ( triangles.empty() || vertexCount == 0 )
+            return statistics;
+
+        // A vertex is in the FIFO cache while fewer than cacheSize misses happened since it was inserted.
+        std::vector<uint32_t> insertedAt( vertexCount, 0 );
+        uint32_t missCounter = cacheSize + 1;
+
+        const uint32_t* indices = AsIndices( triangles );
+        for ( size_t i = 0; i < triangles.size() * 3; ++i )
+        {
+            const uint32_t index = indices[i];
+            if ( missCounter - insertedAt[index] > cacheSize )
+            {
+                insertedAt[index] = missCounter++;
+            }
+        }
+
+        statistics.m_vertexTransforms = missCounter - ( cacheSize + 1 );
+        statistics.m_acmr = static_cast<float>( statistics.m_vertexTransforms ) / triangles.size();
+        statistics.m_atvr = static_cast<float>( statistics.m_vertexTransforms ) / vertexCount;
+        return statistics;
+    }
+
+    void OptimizeVertexCache( std::vector<DirectX::XMINT3>& triangles, size_t vertexCount )
+    {
+        const size_t triangleCount = triangles.size();
+        if ( triangleCount == 0 )
+            return;
+
+        static const ScoreTables scoreTables;
+        const uint32_t* indices = AsIndices( triangles );
+
+        // Vertex -> triangle adjacency, packed into one array.
+        std::vector<uint32_t> remainingValence( vertexCount, 0 );
+        for ( size_t i = 0; i < triangleCount * 3; ++i )
+            ++remainingValence[indices[i]];
+
+        std::vector<uint32_t> adjacencyOffsets( vertexCount + 1, 0 );
+        for ( size_t vertex = 0; vertex < vertexCount; ++vertex )
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remainingValence[vertex];
+
+        std::vector<uint32_t> adjacency( triangleCount * 3 );
+        {
+            std::vector<uint32_t> fill( adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 );
+            for ( size_t i = 0; i < triangleCount * 3; ++i )
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>( i / 3 );
+        }
+
+        std::vector<float> vertexScores( vertexCount );
+        for ( size_t vertex = 0; vertex < vertexCount; ++vertex )
+            vertexScores[vertex] = scoreTables.VertexScore( -1, remainingValence[vertex] );
+
+        std::vector<float> triangleScores( triangleCount );
+        for ( size_t triangle = 0; triangle < triangleCount; ++triangle )
+        {
+            triangleScores[triangle] = vertexScores[indices[triangle * 3 + 0]] +
+                vertexScores[indices[triangle * 3 + 1]] +
+                vertexScores[indices[triangle * 3 + 2]];
+        }
+
+        std::vector<bool> emitted( triangleCount, false );
+        std::vector<DirectX::XMINT3> result;
+        result.reserve( triangleCount );
+
+        // LRU cache, with room for the three vertices pushed by the emitted triangle.
+        uint32_t cache[ScoredCacheSize + 3];
+        int cacheCount = 0;
+
+        size_t inputCursor = 0;
+        uint32_t currentTriangle = 0;
+
+        while ( result.size() < triangleCount )
+        {
+            emitted[currentTriangle] = true;
+            result.push_back( triangles[currentTriangle] );
+
+            // Push the triangle's vertices to the front of the cache, dropping duplicates.
+            uint32_t newCache[ScoredCacheSize + 3];
+            int newCacheCount = 0;
+            for ( int corner = 0; corner < 3; ++corner )
+                newCache[newCacheCount++] = indices[currentTriangle * 3 + corner];
+
+            for ( int i = 0; i < cacheCount; ++i )
+            {
+                const uint32_t vertex = cache[i];
+                if ( vertex != newCache[0] && vertex != newCache[1] && vertex != newCache[2] )
+                    newCache[newCacheCount++] = vertex;
+            }
+
+            // Remove the emitted triangle from its vertices' adjacency.
+            for ( int corner = 0; corner < 3; ++corner )
+            {
+                const uint32_t vertex = indices[currentTriangle * 3 + corner];
+                uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+                uint32_t* end = begin + remainingValence[vertex];
+                *std::find( begin, end, currentTriangle ) = *( end - 1 );
+                --remainingValence[vertex];
+            }
+
+            // Rescore the cached vertices first: a triangle around several of them collects a delta from
+            // each, and is only comparable with the others once all of them are in.
+            for ( int i = 0; i < newCacheCount; ++i )
+            {
+                const uint32_t vertex = newCache[i];
+                const int cachePosition = i < ScoredCacheSize ? i : -1;
+                const float score = scoreTables.VertexScore( cachePosition, remainingValence[vertex] );
+                const float delta = score - vertexScores[vertex];
+                vertexScores[vertex] = score;
+
+                const uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+                for ( uint32_t a = 0; a < remainingValence[vertex]; ++a )
+                    triangleScores[begin[a]] += delta;
+            }
+
+            // Then pick the best triangle around them.
+            uint32_t bestTriangle = ~0u;
+            float bestScore = 0.f;
+
+            for ( int i = 0; i < newCacheCount; ++i )
+            {
+                const uint32_t vertex = newCache[i];
+                const uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+                for ( uint32_t a = 0; a < remainingValence[vertex]; ++a )
+                {
+                    const uint32_t triangle = begin[a];
+                    if ( bestTriangle == ~0u || triangleScores[triangle] > bestScore )
+                    {
+                        bestTriangle = triangle;
+                        bestScore = triangleScores[triangle];
+                    }
+                }
+            }
+
+            cacheCount = std::min( newCacheCount, ScoredCacheSize );
+            std::copy( newCache, newCache + cacheCount, cache );
+
+            // Dead end: nothing around the cache is left, restart from the next unemitted triangle in input order.
+            if ( bestTriangle == ~0u )
+            {
+                while ( inputCursor < triangleCount && emitted[inputCursor] )
+                    ++inputCursor;
+
+                if ( inputCursor == triangleCount )
+                    break;
+
+                bestTriangle = static_cast<uint32_t>( inputCursor );
+            }
+
+            currentTriangle = bestTriangle;
+        }
+
+        triangles.swap( result );
+    }
+}
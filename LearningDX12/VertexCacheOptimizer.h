@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    struct VertexCacheStatistics
+    {
+        // Number of vertex shader invocations with a FIFO post-transform cache.
+        uint32_t m_vertexTransforms = 0;
+        // Average cache miss ratio: transforms per triangle, 0.5 is the ideal for a regular grid, 3 is the worst.
+        float m_acmr = 0.f;
+        // Average transform to vertex ratio: transforms per vertex, 1 is the ideal.
+        float m_atvr = 0.f;
+    };
+
+    // Simulates a FIFO post-transform cache of the given size over the index buffer.
+    VertexCacheStatistics AnalyzeVertexCache( const std::vector<DirectX::XMINT3>& triangles, size_t vertexCount, uint32_t cacheSize = 16 );
+
+    /**
+     * Reorders triangles to improve post-transform vertex cache reuse.
+     *
+     * Greedy triangle walk following Tom Forsyth's "Linear-Speed Vertex Cache Optimisation":
+     * every vertex is scored by its position in a simulated LRU cache and by how many
+     * unemitted triangles still use it, and the best scoring triangle touching the cache
+     * is emitted next. Runs in linear time in the number of triangles.
+     */
+    void OptimizeVertexCache( std::vector<DirectX::XMINT3>& triangles, size_t vertexCount );
+}
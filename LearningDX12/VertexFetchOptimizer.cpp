@@ -0,0 +1,88 @@
+#include "VertexFetchOptimizer.h"
+
+#include <vector>
+
+namespace Olex
+{
+    namespace
+    {
+        constexpr uint32_t PostTransformCacheSize = 16;
+        constexpr uint32_t CachedLineCount = 64;
+        constexpr uint32_t Unassigned = ~0u;
+    }
+
+    VertexFetchStatistics AnalyzeVertexFetch( const Mesh& mesh, uint32_t cacheLineSize )
+    {
+        VertexFetchStatistics statistics;
+        if ( mesh.m_indices.empty() || mesh.m_vertices.empty() || cacheLineSize == 0 )
+            return statistics;
+
+        const uint64_t stride = sizeof( Mesh::VertexInfo );
+        const size_t lineCount = static_cast<size_t>( ( mesh.m_vertices.size() * stride + cacheLineSize - 1 ) / cacheLineSize );
+
+        // Both caches are FIFO, an entry is resident while fewer than the cache size misses happened since it was inserted.
+        std::vector<uint32_t> vertexInsertedAt( mesh.m_vertices.size(), 0 );
+        uint32_t vertexMisses = PostTransformCacheSize + 1;
+        std::vector<uint32_t> lineInsertedAt( lineCount, 0 );
+        uint32_t lineMisses = CachedLineCount + 1;
+
+        std::vector<bool> referenced( mesh.m_vertices.size(), false );
+        size_t referencedCount = 0;
+
+        const auto* indices = reinterpret_cast<const uint32_t*>( mesh.m_indices.data() );
+        for ( size_t i = 0; i < mesh.m_indices.size() * 3; ++i )
+        {
+            const uint32_t index = indices[i];
+            if ( !referenced[index] )
+            {
+                referenced[index] = true;
+                ++referencedCount;
+            }
+
+            if ( vertexMisses - vertexInsertedAt[index] <= PostTransformCacheSize )
+                continue;
+
+            vertexInsertedAt[index] = vertexMisses++;
+
+            const uint64_t firstLine = index * stride / cacheLineSize;
+            const uint64_t lastLine = ( ( index + 1 ) * stride - 1 ) / cacheLineSize;
+            for ( uint64_t line = firstLine; line <= lastLine; ++line )
+            {
+                if ( lineMisses - lineInsertedAt[line] > CachedLineCount )
+                {
+                    lineInsertedAt[line] = lineMisses++;
+                    statistics.m_bytesFetched += cacheLineSize;
+                }
+            }
+        }
+
+        statistics.m_bytesPerVertex = static_cast<float>( statistics.m_bytesFetched ) / referencedCount;
+        statistics.m_overfetch = statistics.m_bytesPerVertex / stride;
+        return statistics;
+    }
+
+    void OptimizeVertexFetch( Mesh& mesh )
+    {
+        std::vector<uint32_t> remap( mesh.m_vertices.size(), Unassigned );
+        std::vector<Mesh::VertexInfo> vertices;
+        vertices.reserve( mesh.m_vertices.size() );
+        std::vector<uint32_t> source;
+        source.reserve( mesh.m_vertices.size() );
+
+        auto* indices = reinterpret_cast<uint32_t*>( mesh.m_indices.data() );
+        for ( size_t i = 0; i < mesh.m_indices.size() * 3; ++i )
+        {
+            uint32_t& newIndex = remap[indices[i]];
+            if ( newIndex == Unassigned )
+            {
+                newIndex = static_cast<uint32_t>( vertices.size() );
+                vertices.push_back( mesh.m_vertices[indices[i]] );
+                source.push_back( indices[i] );
+            }
+            indices[i] = newIndex;
+        }
+
+        mesh.m_vertices.swap( vertices );
+        RemapVertexAttributes( mesh, source );
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    struct VertexFetchStatistics
+    {
+        // Bytes read from the vertex buffer, counted in whole cache lines.
+        uint64_t m_bytesFetched = 0;
+        // Fetched bytes per referenced vertex, sizeof( Mesh::VertexInfo ) is the ideal.
+        float m_bytesPerVertex = 0.f;
+        // Fetched bytes divided by the size of all referenced vertices, 1 is the ideal.
+        float m_overfetch = 0.f;
+    };
+
+    // Simulates vertex fetches of the post-transform cache misses through a small cache of 64-byte lines.
+    VertexFetchStatistics AnalyzeVertexFetch( const Mesh& mesh, uint32_t cacheLineSize = 64 );
+
+    /**
+     * Renumbers vertices in the order the index buffer first references them,
+     * so vertex fetches stream linearly through m_vertices. Vertices that are
+     * never referenced are dropped. Triangle order is left untouched, run it
+     * after every stage that reorders triangles.
+     */
+    void OptimizeVertexFetch( Mesh& mesh );
+}
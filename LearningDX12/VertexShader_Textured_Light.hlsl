@@ -1,17 +1,40 @@
 struct ModelViewProjection
 {
     matrix MVP;
+#ifdef PACKED_VERTICES
+    // position = PositionOffset + unorm * PositionScale, see PositionQuantization
+    float4 PositionOffset;
+    float4 PositionScale;
+#endif
 };
 
 // this line required shader model 5.1
 ConstantBuffer<ModelViewProjection> ModelViewProjectionCB : register(b0);
 
+#ifdef PACKED_VERTICES
+// Matches Olex::PackedVertex: R16G16B16A16_UNORM, R16G16_FLOAT, R8G8_SNORM
+struct VertexPosColor
+{
+    float4 Position  : POSITION;
+    float2 uv        : TEXCOORD;
+    float2 normal    : NORMAL;
+};
+
+float3 OctahedralDecode(float2 encoded)
+{
+    float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-normal.z);
+    normal.xy += (normal.xy >= 0.0f) ? -t : t;
+    return normalize(normal);
+}
+#else
 struct VertexPosColor
 {
     float3 Position  : POSITION;
     float2 uv        : TEXCOORD;
     float3 normal    : NORMAL;
 };
+#endif
 
 struct VertexShaderOutput
 {
@@ -30,10 +53,18 @@ VertexShaderOutput main(VertexPosColor IN)
 {
     VertexShaderOutput OUT;
 
+#ifdef PACKED_VERTICES
+    float3 position = ModelViewProjectionCB.PositionOffset.xyz + IN.Position.xyz * ModelViewProjectionCB.PositionScale.xyz;
+    float3 normal = OctahedralDecode(IN.normal);
+#else
+    float3 position = IN.Position;
+    float3 normal = IN.normal;
+#endif
+
     // transform to world space
-    OUT.Position = mul(ModelViewProjectionCB.MVP, float4(IN.Position, 1.0f));
+    OUT.Position = mul(ModelViewProjectionCB.MVP, float4(position, 1.0f));
     OUT.uv = IN.uv;
-    OUT.normal = normalize(mul((float3x3)ModelViewProjectionCB.MVP, IN.normal));
+    OUT.normal = normalize(mul((float3x3)ModelViewProjectionCB.MVP, normal));
 
     return OUT;
 }
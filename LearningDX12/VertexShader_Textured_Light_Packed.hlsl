@@ -0,0 +1,3 @@
+// VertexShader_Textured_Light reading Olex::PackedVertex instead of Mesh::VertexInfo.
+#define PACKED_VERTICES 1
+#include "VertexShader_Textured_Light.hlsl"
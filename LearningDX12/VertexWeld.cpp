@@ -0,0 +1,114 @@
+#include "VertexWeld.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace Olex
+{
+    namespace
+    {
+        constexpr uint32_t EmptySlot = ~0u;
+        // The vertex followed by the corner key.
+        constexpr size_t WordsPerVertex = sizeof( Mesh::VertexInfo ) / sizeof( uint32_t ) + 1;
+
+        static_assert( sizeof( Mesh::VertexInfo ) % sizeof( uint32_t ) == 0, "VertexInfo is hashed as 32-bit words" );
+
+        // Copies the vertex as raw words with -0.0 folded into +0.0,
+        // so both compare and hash equal, then appends the key.
+        void ToWords( const Mesh::VertexInfo& vertex, uint32_t key, uint32_t( &words )[WordsPerVertex] )
+        {
+            std::memcpy( words, &vertex, sizeof( vertex ) );
+            for ( size_t word = 0; word + 1 < WordsPerVertex; ++word )
+            {
+                if ( words[word] == 0x80000000u )
+                    words[word] = 0;
+            }
+            words[WordsPerVertex - 1] = key;
+        }
+
+        uint32_t HashWords( const uint32_t( &words )[WordsPerVertex] )
+        {
+            // MurmurHash2 style mixing, good enough to spread nearby float bit patterns.
+            uint32_t hash = 0;
+            for ( uint32_t word : words )
+            {
+                word *= 0x5bd1e995u;
+                word ^= word >> 24;
+                word *= 0x5bd1e995u;
+                hash = ( hash * 0x5bd1e995u ) ^ word;
+            }
+            hash ^= hash >> 13;
+            hash *= 0x5bd1e995u;
+            hash ^= hash >> 15;
+            return hash;
+        }
+
+        size_t TableSizeFor( size_t elementCount )
+        {
+            // Power of two, at most half full.
+            size_t size = 16;
+            while ( size < elementCount * 2 )
+                size *= 2;
+            return size;
+        }
+    }
+
+    Mesh WeldVertices( const std::vector<Mesh::VertexInfo>& corners, const std::vector<uint32_t>& cornerKeys )
+    {
+        if ( corners.size() % 3 != 0 )
+        {
+            throw std::invalid_argument( "Corner count must be a multiple of three" );
+        }
+        if ( !cornerKeys.empty() && cornerKeys.size() != corners.size() )
+        {
+            throw std::invalid_argument( "Corner keys must be empty or one per corner" );
+        }
+
+        Mesh mesh;
+        mesh.m_indices.resize( corners.size() / 3 );
+        mesh.m_vertices.reserve( corners.size() / 2 );
+
+        // Open addressing with linear probing. Slots hold indices into mesh.m_vertices,
+        // the words of welded vertices are kept alongside to avoid re-normalizing on compare.
+        std::vector<uint32_t> table( TableSizeFor( corners.size() ), EmptySlot );
+        std::vector<uint32_t> weldedWords;
+        weldedWords.reserve( corners.size() / 2 * WordsPerVertex );
+        const size_t mask = table.size() - 1;
+
+        auto* outIndices = reinterpret_cast<int32_t*>( mesh.m_indices.data() );
+        static_assert( sizeof( DirectX::XMINT3 ) == 3 * sizeof( int32_t ), "XMINT3 is written as three consecutive ints" );
+
+        for ( size_t cornerIndex = 0; cornerIndex < corners.size(); ++cornerIndex )
+        {
+            uint32_t words[WordsPerVertex];
+            ToWords( corners[cornerIndex], cornerKeys.empty() ? 0 : cornerKeys[cornerIndex], words );
+
+            size_t slot = HashWords( words ) & mask;
+            for ( ;; )
+            {
+                const uint32_t candidate = table[slot];
+                if ( candidate == EmptySlot )
+                {
+                    const auto vertexIndex = static_cast<uint32_t>( mesh.m_vertices.size() );
+                    table[slot] = vertexIndex;
+                    mesh.m_vertices.push_back( corners[cornerIndex] );
+                    weldedWords.insert( weldedWords.end(), std::begin( words ), std::end( words ) );
+                    outIndices[cornerIndex] = static_cast<int32_t>( vertexIndex );
+                    break;
+                }
+
+                if ( std::memcmp( &weldedWords[candidate * WordsPerVertex], words, sizeof( words ) ) == 0 )
+                {
+                    outIndices[cornerIndex] = static_cast<int32_t>( candidate );
+                    break;
+                }
+
+                slot = ( slot + 1 ) & mask;
+            }
+        }
+
+        mesh.m_vertices.shrink_to_fit();
+        return mesh;
+    }
+}
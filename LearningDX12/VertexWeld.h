@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace Olex
+{
+    /**
+     * Builds an indexed mesh out of unindexed triangle corners.
+     *
+     * Corners are consumed three at a time, one triangle each. Corners whose
+     * (position, uv, normal) are bitwise identical are merged into a single vertex,
+     * so vertices on UV seams and hard edges stay split while everything else is shared.
+     * Vertices are emitted in first-occurrence order.
+     *
+     * cornerKeys, when not empty, holds one value per corner and only corners with equal keys
+     * merge. Keying corners by their control point keeps apart vertices that differ only in per
+     * control point data such as skin weights.
+     */
+    Mesh WeldVertices( const std::vector<Mesh::VertexInfo>& corners, const std::vector<uint32_t>& cornerKeys = {} );
+}